@@ -0,0 +1,38 @@
+import sys
+import numpy
+import netCDF4
+
+# Compares the statistics of a single precision run with those of a double precision run.
+# The difference of a profile is scaled with the maximum absolute value of the reference profile.
+if len(sys.argv) < 3:
+  print("Usage: python drycblprecision.py stats_double.nc stats_single.nc [tolerance]")
+  sys.exit(1)
+
+tolerance = float(sys.argv[3]) if len(sys.argv) > 3 else 1.e-3
+
+ref  = netCDF4.Dataset(sys.argv[1],"r")
+test = netCDF4.Dataset(sys.argv[2],"r")
+
+variables = ["b", "b2", "bflux", "u2", "w2", "tke", "pe_total"]
+
+failed = False
+for name in variables:
+  data_ref  = ref .variables[name][:,:]
+  data_test = test.variables[name][:,:]
+
+  scale = numpy.max(numpy.abs(data_ref))
+  if scale == 0.:
+    scale = 1.
+
+  error = numpy.max(numpy.abs(data_test - data_ref)) / scale
+  status = "OK" if error <= tolerance else "FAILED"
+  if error > tolerance:
+    failed = True
+
+  print("{0:10s} {1:12.4e} {2}".format(name, error, status))
+
+if failed:
+  print("TEST FAILED!")
+  sys.exit(1)
+else:
+  print("TEST PASSED!")
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Runs the first seconds of the dry CBL with a double and a single precision build
+# (cmake -DUSESINGLE=TRUE) and compares the statistics of both runs.
+# Usage: ./precision.sh path/to/microhh_double path/to/microhh_single
+microhh_double=$(readlink -f $1)
+microhh_single=$(readlink -f $2)
+
+python drycblprof.py
+
+for prec in double single; do
+  rm -rf $prec
+  mkdir $prec
+  sed -e 's/^endtime=.*/endtime=2./' -e 's/^sampletime=0.4/sampletime=0.1/' drycbl.ini > $prec/drycbl.ini
+  cp drycbl.prof $prec/
+done
+
+cd double
+$microhh_double init drycbl
+$microhh_double run drycbl
+cd ..
+
+cd single
+$microhh_single init drycbl
+$microhh_single run drycbl
+cd ..
+
+python drycblprecision.py double/drycbl.default.0000000.nc single/drycbl.default.0000000.nc
@@ -46,6 +46,9 @@ class Advec
         static Advec* factory(Master*, Input*, Model*, const std::string); ///< Factory function for advection class generation.
 
         std::string get_switch();
+        std::string get_simd_switch(); ///< Get the instruction set of the SIMD kernels.
+
+        static bool is_simd_supported(const std::string); ///< Check whether the processor supports an instruction set.
 
         // Pure virtual functions that have to be implemented in derived class.
         virtual void exec() = 0; ///< Execute the advection scheme.
@@ -62,5 +65,6 @@ class Advec
         static const double cflmin; ///< Minimum value for CFL used to avoid overflows.
 
         std::string swadvec;
+        std::string swsimd; ///< Instruction set of the kernels with SIMD entry points, see SIMD_INLINE.
 };
 #endif
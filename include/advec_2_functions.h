@@ -0,0 +1,81 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADVEC_2_FUNCTIONS
+#define ADVEC_2_FUNCTIONS
+
+#include "defines.h"
+#include "finite_difference.h"
+
+// 2nd order advection tendencies of the velocity components at one grid point. They are
+// shared by Advec_2 and the fused advection-diffusion kernels of Diff_smag_2, such that both
+// paths evaluate the same expression.
+namespace Advec_2_functions
+{
+    using namespace Finite_difference::O2;
+
+    inline real advec_u_2nd(const real* const restrict u, const real* const restrict v, const real* const restrict w,
+                              const real* const restrict rhoref, const real* const restrict rhorefh,
+                              const real* const restrict dzi, const double dxi, const double dyi,
+                              const int ijk, const int k, const int ii, const int jj, const int kk)
+    {
+        return - ( interp2(u[ijk   ], u[ijk+ii]) * interp2(u[ijk   ], u[ijk+ii])
+                 - interp2(u[ijk-ii], u[ijk   ]) * interp2(u[ijk-ii], u[ijk   ]) ) * dxi
+
+               - ( interp2(v[ijk-ii+jj], v[ijk+jj]) * interp2(u[ijk   ], u[ijk+jj])
+                 - interp2(v[ijk-ii   ], v[ijk   ]) * interp2(u[ijk-jj], u[ijk   ]) ) * dyi
+
+               - ( rhorefh[k+1] * interp2(w[ijk-ii+kk], w[ijk+kk]) * interp2(u[ijk   ], u[ijk+kk])
+                 - rhorefh[k  ] * interp2(w[ijk-ii   ], w[ijk   ]) * interp2(u[ijk-kk], u[ijk   ]) ) / rhoref[k] * dzi[k];
+    }
+
+    inline real advec_v_2nd(const real* const restrict u, const real* const restrict v, const real* const restrict w,
+                              const real* const restrict rhoref, const real* const restrict rhorefh,
+                              const real* const restrict dzi, const double dxi, const double dyi,
+                              const int ijk, const int k, const int ii, const int jj, const int kk)
+    {
+        return - ( interp2(u[ijk+ii-jj], u[ijk+ii]) * interp2(v[ijk   ], v[ijk+ii])
+                 - interp2(u[ijk   -jj], u[ijk   ]) * interp2(v[ijk-ii], v[ijk   ]) ) * dxi
+
+               - ( interp2(v[ijk   ], v[ijk+jj]) * interp2(v[ijk   ], v[ijk+jj])
+                 - interp2(v[ijk-jj], v[ijk   ]) * interp2(v[ijk-jj], v[ijk   ]) ) * dyi
+
+               - ( rhorefh[k+1] * interp2(w[ijk-jj+kk], w[ijk+kk]) * interp2(v[ijk   ], v[ijk+kk])
+                 - rhorefh[k  ] * interp2(w[ijk-jj   ], w[ijk   ]) * interp2(v[ijk-kk], v[ijk   ]) ) / rhoref[k] * dzi[k];
+    }
+
+    inline real advec_w_2nd(const real* const restrict u, const real* const restrict v, const real* const restrict w,
+                              const real* const restrict rhoref, const real* const restrict rhorefh,
+                              const real* const restrict dzhi, const double dxi, const double dyi,
+                              const int ijk, const int k, const int ii, const int jj, const int kk)
+    {
+        return - ( interp2(u[ijk+ii-kk], u[ijk+ii]) * interp2(w[ijk   ], w[ijk+ii])
+                 - interp2(u[ijk   -kk], u[ijk   ]) * interp2(w[ijk-ii], w[ijk   ]) ) * dxi
+
+               - ( interp2(v[ijk+jj-kk], v[ijk+jj]) * interp2(w[ijk   ], w[ijk+jj])
+                 - interp2(v[ijk   -kk], v[ijk   ]) * interp2(w[ijk-jj], w[ijk   ]) ) * dyi
+
+               - ( rhoref[k  ] * interp2(w[ijk   ], w[ijk+kk]) * interp2(w[ijk   ], w[ijk+kk])
+                 - rhoref[k-1] * interp2(w[ijk-kk], w[ijk   ]) * interp2(w[ijk-kk], w[ijk   ]) ) / rhorefh[k] * dzhi[k];
+    }
+}
+#endif
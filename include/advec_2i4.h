@@ -24,6 +24,7 @@
 #define ADVEC_2I4
 
 #include "advec.h"
+#include "defines.h"
 
 class Model;
 class Input;
@@ -42,11 +43,19 @@ class Advec_2i4 : public Advec
         double get_cfl(double); ///< Get the CFL number.
 
     private:
-        double calc_cfl(double*, double*, double*, double*, double); ///< Calculate the CFL number.
-
-        void advec_u(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate longitudinal velocity advection.
-        void advec_v(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate latitudinal velocity advection.
-        void advec_w(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate vertical velocity advection.
-        void advec_s(double*, double*, double*, double*, double*, double*, double*, double*); ///< Calculate scalar advection.
+        double calc_cfl(real*, real*, real*, real*, double); ///< Calculate the CFL number.
+
+        // The kernels are inlined into an entry point per instruction set, see SIMD_INLINE.
+        void exec_default();
+        #ifdef USESIMDTARGETS
+        SIMD_TARGET_AVX2   void exec_avx2();
+        SIMD_TARGET_AVX512 void exec_avx512();
+        #endif
+        SIMD_INLINE void exec_kernels(); ///< Execute the kernels within a parallel region.
+
+        SIMD_INLINE void advec_u(real*, real*, real*, real*, real*, real*, real*); ///< Calculate longitudinal velocity advection.
+        SIMD_INLINE void advec_v(real*, real*, real*, real*, real*, real*, real*); ///< Calculate latitudinal velocity advection.
+        SIMD_INLINE void advec_w(real*, real*, real*, real*, real*, real*, real*); ///< Calculate vertical velocity advection.
+        SIMD_INLINE void advec_s(real*, real*, real*, real*, real*, real*, real*, real*); ///< Calculate scalar advection.
 };
 #endif
@@ -43,15 +43,23 @@ class Advec_4 : public Advec
         double get_cfl(double); ///< Get the CFL number.
 
     private:
-        double calc_cfl(double*, double*, double*, double*, double); ///< Calculate the CFL number.
-
-        template<bool>
-        void advec_u(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate longitudinal velocity advection.
-        template<bool>
-        void advec_v(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate latitudinal velocity advection.
-        template<bool>
-        void advec_w(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate vertical velocity advection.
-        template<bool>
-        void advec_s(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate scalar advection.
+        double calc_cfl(real*, real*, real*, real*, double); ///< Calculate the CFL number.
+
+        // The kernels are inlined into an entry point per instruction set, see SIMD_INLINE.
+        void exec_default();
+        #ifdef USESIMDTARGETS
+        SIMD_TARGET_AVX2   void exec_avx2();
+        SIMD_TARGET_AVX512 void exec_avx512();
+        #endif
+        SIMD_INLINE void exec_kernels(); ///< Execute the kernels within a parallel region.
+
+        template<bool> SIMD_INLINE
+        void advec_u(real* restrict, real* restrict, real* restrict, real* restrict, real* restrict); ///< Calculate longitudinal velocity advection.
+        template<bool> SIMD_INLINE
+        void advec_v(real* restrict, real* restrict, real* restrict, real* restrict, real* restrict); ///< Calculate latitudinal velocity advection.
+        template<bool> SIMD_INLINE
+        void advec_w(real* restrict, real* restrict, real* restrict, real* restrict, real* restrict); ///< Calculate vertical velocity advection.
+        template<bool> SIMD_INLINE
+        void advec_s(real* restrict, real* restrict, real* restrict, real* restrict, real* restrict, real* restrict); ///< Calculate scalar advection.
 };
 #endif
@@ -24,6 +24,7 @@
 #define ADVEC_4M
 
 #include "advec.h"
+#include "defines.h"
 
 class Model;
 class Input;
@@ -44,11 +45,11 @@ class Advec_4m : public Advec
         double get_cfl(double); ///< Get the CFL number.
 
     private:
-        double calc_cfl(double*, double*, double*, double*, double); ///< Calculate the CFL number.
+        double calc_cfl(real*, real*, real*, real*, double); ///< Calculate the CFL number.
 
-        void advec_u(double*, double*, double*, double*, double*);          ///< Calculate longitudinal velocity advection.
-        void advec_v(double*, double*, double*, double*, double*);          ///< Calculate latitudinal velocity advection.
-        void advec_w(double*, double*, double*, double*, double*);          ///< Calculate vertical velocity advection.
-        void advec_s(double*, double*, double*, double*, double*, double*); ///< Calculate scalar advection.
+        void advec_u(real*, real*, real*, real*, real*);          ///< Calculate longitudinal velocity advection.
+        void advec_v(real*, real*, real*, real*, real*);          ///< Calculate latitudinal velocity advection.
+        void advec_w(real*, real*, real*, real*, real*);          ///< Calculate vertical velocity advection.
+        void advec_s(real*, real*, real*, real*, real*, real*); ///< Calculate scalar advection.
 };
 #endif
@@ -23,6 +23,8 @@
 #ifndef BOUNDARY
 #define BOUNDARY
 
+#include "defines.h"
+
 class Master;
 class Model;
 class Input;
@@ -103,30 +105,30 @@ class Boundary
         std::string swtimedep;
         std::vector<double> timedeptime;
         std::vector<std::string> timedeplist;
-        std::map<std::string, double*> timedepdata;
+        std::map<std::string, real*> timedepdata;
 
         void process_bcs(Input *); ///< Process the boundary condition settings from the ini file.
 
         void process_time_dependent(Input *); ///< Process the time dependent settings from the ini file.
 
-        void set_bc(double*, double*, double*, Boundary_type, double, double, double); ///< Set the values for the boundary fields.
+        void set_bc(real*, real*, real*, Boundary_type, double, double, double); ///< Set the values for the boundary fields.
 
         // GPU functions and variables
-        void set_bc_g(double*, double*, double*, Boundary_type, double, double, double); ///< Set the values for the boundary fields.
+        void set_bc_g(real*, real*, real*, Boundary_type, double, double, double); ///< Set the values for the boundary fields.
 
     private:
         virtual void update_bcs();       ///< Update the boundary values.
         virtual void update_slave_bcs(); ///< Update the slave boundary values.
 
-        void calc_ghost_cells_bot_2nd(double*, double*, Boundary_type, double*, double*); ///< Calculate the bottom ghost cells with 2nd-order accuracy.
-        void calc_ghost_cells_top_2nd(double*, double*, Boundary_type, double*, double*); ///< Calculate the top ghost cells with 2nd-order accuracy.
-        void calc_ghost_cells_bot_4th(double*, double*, Boundary_type, double*, double*); ///< Calculate the bottom ghost cells with 4th-order accuracy.
-        void calc_ghost_cells_top_4th(double*, double*, Boundary_type, double*, double*); ///< Calculate the top ghost cells with 4th-order accuracy.
+        void calc_ghost_cells_bot_2nd(real*, real*, Boundary_type, real*, real*); ///< Calculate the bottom ghost cells with 2nd-order accuracy.
+        void calc_ghost_cells_top_2nd(real*, real*, Boundary_type, real*, real*); ///< Calculate the top ghost cells with 2nd-order accuracy.
+        void calc_ghost_cells_bot_4th(real*, real*, Boundary_type, real*, real*); ///< Calculate the bottom ghost cells with 4th-order accuracy.
+        void calc_ghost_cells_top_4th(real*, real*, Boundary_type, real*, real*); ///< Calculate the top ghost cells with 4th-order accuracy.
 
-        void calc_ghost_cells_botw_4th(double*); ///< Calculate the bottom ghost cells for the vertical velocity with 4th order accuracy.
-        void calc_ghost_cells_topw_4th(double*); ///< Calculate the top ghost cells for the vertical velocity with 4th order accuracy.
+        void calc_ghost_cells_botw_4th(real*); ///< Calculate the bottom ghost cells for the vertical velocity with 4th order accuracy.
+        void calc_ghost_cells_topw_4th(real*); ///< Calculate the top ghost cells for the vertical velocity with 4th order accuracy.
 
-        void calc_ghost_cells_botw_cons_4th(double*); ///< Calculate the bottom ghost cells for the vertical velocity with global conservation.
-        void calc_ghost_cells_topw_cons_4th(double*); ///< Calculate the top ghost cells for the vertical velocity with global conservation.
+        void calc_ghost_cells_botw_cons_4th(real*); ///< Calculate the bottom ghost cells for the vertical velocity with global conservation.
+        void calc_ghost_cells_topw_cons_4th(real*); ///< Calculate the top ghost cells for the vertical velocity with global conservation.
 };
 #endif
@@ -25,6 +25,7 @@
 
 #include "boundary_patch.h"
 #include "boundary.h"
+#include "defines.h"
 
 class Model;
 class Input;
@@ -42,8 +43,8 @@ class Boundary_patch : public Boundary
         void get_surface_mask(Field3d*);
 
     private:
-        void calc_patch(double*, const double*, const double*, int, double, double, double, double, double, double, double, double);  ///< Calculate the patches
-        void set_bc_patch(double*, double*, double*, double*, const double, const double, const int, const double, const double, const double);       ///< Set the values for the boundary fields.
+        void calc_patch(real*, const real*, const real*, int, double, double, double, double, double, double, double, double);  ///< Calculate the patches
+        void set_bc_patch(real*, real*, real*, real*, const double, const double, const int, const double, const double, const double);       ///< Set the values for the boundary fields.
 
         // Patch properties.
         int    patch_dim;
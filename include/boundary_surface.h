@@ -25,6 +25,7 @@
 
 #include "boundary.h"
 #include "stats.h"
+#include "defines.h"
 
 class Model;
 class Input;
@@ -45,9 +46,9 @@ class Boundary_surface : public Boundary
         void exec_cross();      ///< Execute cross sections of surface
 
         // Make these variables public for out-of-class usage.
-        double* obuk;
+        real* obuk;
         int*    nobuk;
-        double* ustar;
+        real* ustar;
 
         double z0m;
         double z0h;
@@ -59,8 +60,8 @@ class Boundary_surface : public Boundary
         void forward_device();  // TMP BVS
         void backward_device(); // TMP BVS 
 
-        double* obuk_g;
-        double* ustar_g;
+        real* obuk_g;
+        real* ustar_g;
         int*    nobuk_g;
 #endif
 
@@ -75,20 +76,20 @@ class Boundary_surface : public Boundary
         // surface scheme
         void update_bcs();
 
-        void stability(double*, double*, double*,
-                       double*, double*, double*,
-                       double*, double*, double*,
-                       double*, double*);
-        void stability_neutral(double*, double*,
-                               double*, double*,
-                               double*, double*,
-                               double*, double*);
-        void surfm(double*, double*,
-                   double*, double*, double*, double*,
-                   double*, double*, double*, double*,
+        void stability(real*, real*, real*,
+                       real*, real*, real*,
+                       real*, real*, real*,
+                       real*, real*);
+        void stability_neutral(real*, real*,
+                               real*, real*,
+                               real*, real*,
+                               real*, real*);
+        void surfm(real*, real*,
+                   real*, real*, real*, real*,
+                   real*, real*, real*, real*,
                    double, int);
-        void surfs(double*, double*, double*,
-                   double*, double*, double*,
+        void surfs(real*, real*, real*,
+                   real*, real*, real*,
                    double, int);
 
         double calc_obuk_noslip_flux     (const float* const, const float* const, int&, double, double, double);
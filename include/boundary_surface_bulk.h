@@ -25,6 +25,7 @@
 
 #include "boundary_surface.h"
 #include "stats.h"
+#include "defines.h"
 
 class Model;
 class Input;
@@ -43,10 +44,10 @@ class Boundary_surface_bulk : public Boundary_surface
     private:
         // surface scheme
         void update_bcs();
-        void calculate_du(double*, double*, double*, double*, double*);
-        void momentum_fluxgrad(double*, double*, double*, double*, double*, double*, double*, double*, double*, double, double);
-        void scalar_fluxgrad(double*, double*, double*, double*, double*, double, double);
-        void surface_scaling(double*, double*, double*, double*, double);
+        void calculate_du(real*, real*, real*, real*, real*);
+        void momentum_fluxgrad(real*, real*, real*, real*, real*, real*, real*, real*, real*, double, double);
+        void scalar_fluxgrad(real*, real*, real*, real*, real*, double, double);
+        void surface_scaling(real*, real*, real*, real*, double);
 
         // transfer coefficients
         double bulk_cm;
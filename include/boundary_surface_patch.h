@@ -24,6 +24,7 @@
 #define BOUNDARY_SURFACE_PATCH
 
 #include "boundary_surface.h"
+#include "defines.h"
 
 class Model;
 class Input;
@@ -41,8 +42,8 @@ class Boundary_surface_patch : public Boundary_surface
         void get_surface_mask(Field3d*);
 
     private:
-        void calc_patch(double*, const double*, const double*, int, double, double, double, double, double, double, double, double);  ///< Calculate the patches
-        void set_bc_patch(double*, double*, double*, double*, const double, const double, const int, const double, const double, const double);       ///< Set the values for the boundary fields.
+        void calc_patch(real*, const real*, const real*, int, double, double, double, double, double, double, double, double);  ///< Calculate the patches
+        void set_bc_patch(real*, real*, real*, real*, const double, const double, const int, const double, const double, const double);       ///< Set the values for the boundary fields.
 
         // Patch properties.
         int    patch_dim;
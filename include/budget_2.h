@@ -23,6 +23,8 @@
 #ifndef BUDGET_2
 #define BUDGET_2
 
+#include "defines.h"
+
 class Input;
 class Master;
 class Stats;
@@ -46,54 +48,54 @@ class Budget_2 : public Budget
         void exec_stats(Mask*);
 
     private:
-        double* umodel;
-        double* vmodel;
+        real* umodel;
+        real* vmodel;
 
-        void calc_kinetic_energy(double*, double*, const double*, const double*, const double*, const double*, const double*, const double, const double);
+        void calc_kinetic_energy(double*, double*, const real*, const real*, const real*, const real*, const real*, const double, const double);
 
         void calc_advection_terms(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*,
-                                  const double*, const double*, const double*, const double*, const double*,
-                                  double*, double*, const double*, const double*); 
+                                  const real*, const real*, const real*, const real*, const real*,
+                                  real*, real*, const real*, const real*); 
 
         void calc_advection_terms_scalar(double*, double*, double*, double*,
-                                         const double*, const double*, const double*, const double*, const double*);
+                                         const real*, const real*, const real*, const real*, const real*);
 
         void calc_pressure_terms(double*, double*, double*, double*, double*, 
                                  double*, double*, double*, double*,
-                                 const double*, const double*, const double*, const double*,
-                                 const double*, const double*, const double*, const double*,
+                                 const real*, const real*, const real*, const real*,
+                                 const real*, const real*, const real*, const real*,
                                  const double, const double);
 
         void calc_pressure_terms_scalar(double*, double*, 
-                                        const double*, const double*, const double*, 
-                                        const double*, const double*, const double*);
+                                        const real*, const real*, const real*, 
+                                        const real*, const real*, const real*);
 
         void calc_diffusion_terms_DNS(double*, double*, double*, double*, double*, double*,
-                                      double*, double*, double*, double*, double*, double*, double*,
-                                      const double*, const double*, const double*, const double*,
-                                      const double*, const double*, const double*,
+                                      double*, double*, double*, double*, real*, real*, real*,
+                                      const real*, const real*, const real*, const real*,
+                                      const real*, const real*, const real*,
                                       const double, const double, const double);
 
         void calc_diffusion_terms_scalar_DNS(double*, double*, double*, double*,
-                                             const double*, const double*, const double*, const double*, const double*,
+                                             const real*, const real*, const real*, const real*, const real*,
                                              const double, const double, const double, const double);
 
         void calc_diffusion_terms_LES(double*, double*, double*, double*, double*, double*,
                                       double*, double*, double*, double*, double*, double*,
                                       double*, double*, double*, double*, double*, double*,
-                                      double*, double*, double*,
-                                      const double*, const double*, const double*, const double*, const double*,
-                                      const double*, const double*, const double*, const double*, const double*,
+                                      real*, real*, real*,
+                                      const real*, const real*, const real*, const real*, const real*,
+                                      const real*, const real*, const real*, const real*, const real*,
                                       const double, const double);
 
         void calc_buoyancy_terms(double*, double*, double*, double*,
-                                 const double*, const double*, const double*, const double*, 
-                                 const double*, const double*, const double*);
+                                 const real*, const real*, const real*, const real*, 
+                                 const real*, const real*, const real*);
 
-        void calc_buoyancy_terms_scalar(double*, const double*, const double*, const double*, const double*);
+        void calc_buoyancy_terms_scalar(double*, const real*, const real*, const real*, const real*);
 
         void calc_coriolis_terms(double*, double*, double*, double*,
-                                 const double*, const double*, const double*, 
-                                 const double*, const double*, const double);
+                                 const real*, const real*, const real*, 
+                                 const real*, const real*, const double);
 };
 #endif
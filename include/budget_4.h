@@ -23,6 +23,8 @@
 #ifndef BUDGET_4
 #define BUDGET_4
 
+#include "defines.h"
+
 class Input;
 class Master;
 class Stats;
@@ -46,65 +48,65 @@ class Budget_4 : public Budget
         void exec_stats(Mask*);
 
     private:
-        double* umodel;
-        double* vmodel;
+        real* umodel;
+        real* vmodel;
 
-        void calc_ke(double*, double*, double*,
-                     double*, double*,
+        void calc_ke(real*, real*, real*,
+                     real*, real*,
                      double, double,
                      double*, double*);
 
-        void calc_tke_budget_shear_turb(double*, double*, double*,
-                                        double*, double*,
-                                        double*, double*,
+        void calc_tke_budget_shear_turb(real*, real*, real*,
+                                        real*, real*,
+                                        real*, real*,
                                         double*, double*, double*, double*,
                                         double*, double*, double*, double*, double*,
-                                        double*, double*);
+                                        real*, real*);
 
-        void calc_tke_budget(double*, double*, double*, double*,
-                             double*, double*,
-                             double*, double*,
+        void calc_tke_budget(real*, real*, real*, real*,
+                             real*, real*,
+                             real*, real*,
                              double*, double*, double*, double*, double*,
                              double*, double*, double*, double*, double*,
                              double*, double*, double*,
                              double*, double*, double*, double*,
-                             double*, double*, double);
+                             real*, real*, double);
 
-        void calc_tke_budget_buoy(double*, double*, double*,
-                                  double*, double*,
+        void calc_tke_budget_buoy(real*, real*, real*,
+                                  real*, real*,
                                   double*, double*, double*);
 
-        void calc_b2_budget(double*, double*,
-                            double*,
+        void calc_b2_budget(real*, real*,
+                            real*,
                             double*, double*, double*, double*,
-                            double*, double*,
+                            real*, real*,
                             double);
 
-        void calc_bw_budget(double*, double*, double*, double*,
-                            double*, double*,
+        void calc_bw_budget(real*, real*, real*, real*,
+                            real*, real*,
                             double*, double*, double*,
                             double*, double*, double*, double*,
-                            double*, double*,
+                            real*, real*,
                             double);
 
-        void calc_pe(double*, double*, double*, double*,
-                     double*,
+        void calc_pe(real*, real*, real*, real*,
+                     real*,
                      double*,
                      double*, double*, double*,
                      double*);
 
-        void calc_pe_budget(double*, double*, double*, double*,
+        void calc_pe_budget(real*, real*, real*, real*,
                             double*, double*, double*,
-                            double*, double*, double*, double*,
+                            real*, real*, real*, real*,
                             double);
 
-        void calc_bpe_budget(double*, double*, double*, double*, double*,
-                             double*, double*, double*,
-                             double*,
-                             double*, double*, double*,
+        void calc_bpe_budget(real*, real*, real*, real*, real*,
+                             real*, real*, real*,
+                             real*,
+                             real*, real*, real*,
                              double);
 
-        double calc_zsort   (double, double*, double*, int);
-        double calc_dzstardb(double, double*, double*);
+        double calc_zsort   (double, double*, real*, int);
+        double calc_dzstardb(double, real*, real*);
 };
 #endif
@@ -23,6 +23,8 @@
 #ifndef BUFFER
 #define BUFFER
 
+#include "defines.h"
+
 class Master;
 class Model;
 class Grid;
@@ -60,16 +62,16 @@ class Buffer
         int bufferkstart;  ///< Grid point at cell center at which damping starts.
         int bufferkstarth; ///< Grid point at cell face at which damping starts.
 
-        std::map<std::string, double*> bufferprofs;   ///< Map containing the buffer profiles.
+        std::map<std::string, real*> bufferprofs;   ///< Map containing the buffer profiles.
 
         std::string swbuffer; ///< Switch for buffer.
         std::string swupdate; ///< Switch for enabling runtime updating of buffer profile.
 
-        void buffer(double* const, const double* const, 
-                    const double* const, const double* const); ///< Calculate the tendency.
+        void buffer(real* const, const real* const, 
+                    const real* const, const real* const); ///< Calculate the tendency.
 
         // GPU functions and variables
-        std::map<std::string, double*> bufferprofs_g; ///< Map containing the buffer profiles at GPU.
+        std::map<std::string, real*> bufferprofs_g; ///< Map containing the buffer profiles at GPU.
 
 };
 #endif
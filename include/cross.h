@@ -23,6 +23,10 @@
 #ifndef CROSS
 #define CROSS
 
+#include <map>
+#include "defines.h"
+#include "grid.h"
+
 class Master;
 class Model;
 class Grid;
@@ -38,6 +42,7 @@ class Cross
 
         void init(double);
         void create();
+        void flush(); ///< Writes the buffered records of the NetCDF cross-section files to disk.
         std::string get_switch();
         std::vector<std::string>* get_crosslist();
 
@@ -47,11 +52,11 @@ class Cross
         std::string swcross;
         bool do_cross();
 
-        int cross_simple(double*, double*, std::string);
-        int cross_lngrad(double*, double*, double*, double*, std::string);
-        int cross_plane (double*, double*, std::string);
-        int cross_path  (double*, double*, double*, std::string);
-        int cross_height_threshold(double*, double*, double*, double*, double, Direction, std::string);
+        int cross_simple(real*, real*, std::string);
+        int cross_lngrad(real*, real*, real*, real*, std::string);
+        int cross_plane (real*, real*, std::string);
+        int cross_path  (real*, real*, real*, std::string);
+        int cross_height_threshold(real*, real*, real*, real*, double, Direction, std::string);
 
     private:
         Master* master;
@@ -63,6 +68,10 @@ class Cross
         unsigned long isampletime;
 
         std::vector<std::string> crosslist; ///< List with all crosses from the ini file.
+        std::map<std::string, Error_bound> bounds; ///< Error bounds for lossy compression per cross.
+
+        std::string swformat; ///< Switch for saving the cross-sections as binary files per slice and time or as NetCDF files per variable.
+        std::map<std::string, Cross_file> crossfiles; ///< NetCDF files per variable and orientation.
 
         std::vector<int> jxz;   ///< Index of nearest full y position of xz input
         std::vector<int> ixz;   ///< Index of nearest full x position of yz input
@@ -81,7 +90,10 @@ class Cross
         std::vector<std::string> path;
 
         int check_list(std::vector<std::string> *, FieldMap *, std::string crossname);
-        int check_save(int, char *);
+        int check_save(int, char *, Error_bound* bound=0);
+        Error_bound* get_bound(std::string); ///< Gets the error bound of a cross, or a null pointer if it is saved lossless.
+        Cross_file& get_cross_file(std::string, std::string, const std::vector<int>&, const int*); ///< Gets the NetCDF file of a cross with a new time record.
+        int save_slices(real*, real*, std::string, std::string, const std::vector<int>&, const int*); ///< Saves the slices of one orientation.
 };
 #endif
 
@@ -20,5 +20,30 @@
  * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef DEFINES
+#define DEFINES
+
 #define restrict RESTRICTKEYWORD
 
+// Floating point type of the fields, single precision builds are compiled with -DFLOAT_SINGLE.
+#ifdef FLOAT_SINGLE
+typedef float real;
+#else
+typedef double real;
+#endif
+
+// Kernels marked with SIMD_INLINE are inlined into one entry point per instruction set: the default
+// one of the build, AVX2 with FMA (SIMD_TARGET_AVX2) and AVX-512 (SIMD_TARGET_AVX512). The entry point
+// is selected at runtime with [advec][swsimd]. The targets list the instruction set extensions instead
+// of an architecture, because GCC does not inline kernels into functions with a different arch.
+// Compile with -DNOSIMDTARGETS to build only the default version.
+#if defined(__GNUC__) && (__GNUC__ >= 6) && !defined(__clang__) && !defined(__INTEL_COMPILER) && \
+    !defined(__CUDACC__) && defined(__x86_64__) && !defined(NOSIMDTARGETS)
+#define USESIMDTARGETS
+#define SIMD_TARGET_AVX2   __attribute__((target("avx2,fma")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#define SIMD_INLINE inline __attribute__((always_inline))
+#else
+#define SIMD_INLINE inline
+#endif
+#endif
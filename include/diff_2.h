@@ -24,6 +24,7 @@
 #define DIFF_2
 
 #include "diff.h"
+#include "defines.h"
 
 class Diff_2 : public Diff
 {
@@ -47,7 +48,7 @@ class Diff_2 : public Diff
     private:
         double dnmul;
 
-        void diff_c(double*, double*, double*, double*, double);
-        void diff_w(double*, double*, double*, double*, double);
+        void diff_c(real*, real*, real*, real*, double);
+        void diff_w(real*, real*, real*, real*, double);
 };
 #endif
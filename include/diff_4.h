@@ -49,8 +49,8 @@ class Diff_4 : public Diff
         double dnmul;
 
         template<bool>
-        void diff_c(double* restrict, double* restrict, double* restrict, double* restrict, double);
+        void diff_c(real* restrict, real* restrict, real* restrict, real* restrict, double);
         template<bool> 
-        void diff_w(double* restrict, double* restrict, double* restrict, double* restrict, double);
+        void diff_w(real* restrict, real* restrict, real* restrict, real* restrict, double);
 };
 #endif
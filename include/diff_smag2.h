@@ -24,6 +24,7 @@
 #define DIFF_SMAG_2
 
 #include "diff.h"
+#include "defines.h"
 
 class Diff_smag_2 : public Diff
 {
@@ -50,40 +51,44 @@ class Diff_smag_2 : public Diff
 
     private:
         template<bool>
-        void calc_strain2(double*,
-                          double*, double*, double*,
-                          double*, double*,
-                          double*, double*,
-                          double*, double*, double*);
-
-        void calc_evisc(double*,
-                        double*, double*, double*, double*,
-                        double*, double*, double*,
-                        double*, double*,
-                        double*, double*, double*,
+        void calc_strain2(real*,
+                          real*, real*, real*,
+                          real*, real*,
+                          real*, real*,
+                          real*, real*, real*);
+
+        void calc_evisc(real*,
+                        real*, real*, real*, real*,
+                        real*, real*, real*,
+                        real*, real*,
+                        real*, real*, real*,
                         double);
 
         template<bool>
-        void calc_evisc_neutral(double*,
-                                double*, double*, double*,
-                                double*, double*,
-                                double*, double*,
+        void calc_evisc_neutral(real*,
+                                real*, real*, real*,
+                                real*, real*,
+                                real*, real*,
                                 double, double);
 
+        // The second template argument adds the 2nd order advection in the same sweep.
+        template<bool, bool>
+        void diff_u(real*, real*, real*, real*, real*, real*, real*, real*, real*, real*, real*);
+        template<bool, bool>
+        void diff_v(real*, real*, real*, real*, real*, real*, real*, real*, real*, real*, real*);
         template<bool>
-        void diff_u(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*);
-        template<bool>
-        void diff_v(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*);
+        void diff_w(real*, real*, real*, real*, real*, real*, real*, real*, real*);
 
-        void diff_w(double*, double*, double*, double*, double*, double*, double*, double*, double*);
-        void diff_c(double*, double*, double*, double*, double*, double*, double*, double*, double*, double);
+        void diff_c(real*, real*, real*, real*, real*, real*, real*, real*, real*, double);
 
-        double calc_dnmul(double*, double*, double);
+        double calc_dnmul(real*, real*, double);
 
         double cs;
 
+        std::string swfusedadvec; ///< Switch for computing the momentum advection (swadvec=2) in the diffusion kernels.
+
         #ifdef USECUDA
-        double* mlen_g;
+        real* mlen_g;
         #endif
 };
 #endif
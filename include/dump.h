@@ -23,6 +23,10 @@
 #ifndef DUMP
 #define DUMP
 
+#include <map>
+#include "defines.h"
+#include "grid.h"
+
 class Master;
 class Model;
 class Grid;
@@ -42,8 +46,10 @@ class Dump
         std::vector<std::string>* get_dumplist();
 
         std::string swdump;
+        std::string swcompress; ///< Switch for lossless compression of the dumps.
+        std::string swformat;   ///< Switch for saving the dumps as binary files or as chunked NetCDF files.
         bool do_dump();
-        void save_dump(double*, double*, std::string);
+        void save_dump(real*, real*, std::string);
 
     private:
         Master* master;
@@ -52,6 +58,7 @@ class Dump
         Fields* fields;
 
         std::vector<std::string> dumplist; ///< List with all dumps from the ini file.
+        std::map<std::string, Error_bound> bounds; ///< Error bounds for lossy compression per dump.
 
         double sampletime;
         unsigned long isampletime;
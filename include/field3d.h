@@ -24,6 +24,7 @@
 #define FIELD3D
 
 #include <string>
+#include "defines.h"
 
 class Master;
 class Grid;
@@ -39,14 +40,14 @@ class Field3d
         // int checkfornan();
 
         // variables at CPU
-        double* data;
-        double* databot;
-        double* datatop;
-        double* datamean;
-        double* datagradbot;
-        double* datagradtop;
-        double* datafluxbot;
-        double* datafluxtop;
+        real* data;
+        real* databot;
+        real* datatop;
+        real* datamean;
+        real* datagradbot;
+        real* datagradtop;
+        real* datafluxbot;
+        real* datafluxtop;
         std::string name;
         std::string unit;
         std::string longname;
@@ -56,14 +57,14 @@ class Field3d
         void init_device();  ///< Allocate Field3D fields at device 
         void clear_device(); ///< Deallocate Field3D fields at device 
 
-        double* data_g;
-        double* databot_g;
-        double* datatop_g;
-        double* datamean_g;
-        double* datagradbot_g;
-        double* datagradtop_g;
-        double* datafluxbot_g;
-        double* datafluxtop_g;
+        real* data_g;
+        real* databot_g;
+        real* datatop_g;
+        real* datamean_g;
+        real* datagradbot_g;
+        real* datagradtop_g;
+        real* datafluxbot_g;
+        real* datafluxtop_g;
 
     private:
         Grid* grid;
@@ -22,9 +22,13 @@
 
 #ifndef FIELDS
 #define FIELDS
+#include <cstdio>
 #include <map>
+#include <string>
+#include <thread>
 #include <vector>
 #include "field3d.h"
+#include "defines.h"
 
 class Master;
 class Input;
@@ -48,7 +52,7 @@ class Fields
 
         void exec();
         void get_mask(Field3d*, Field3d*, Mask*);
-        void exec_stats(Mask*);
+        void exec_stats(); ///< Computes the statistics of the selected masks in one sweep per kernel.
 
         void init_momentum_field  (Field3d*&, Field3d*&, std::string, std::string, std::string);
         void init_prognostic_field(std::string, std::string, std::string);
@@ -57,6 +61,7 @@ class Fields
 
         void save(int);
         void load(int);
+        void wait_save(); ///< Waits for the completion of an asynchronous save and checks its errors.
 
         double check_momentum();
         double check_tke();
@@ -89,8 +94,8 @@ class Fields
 
         FieldMap atmp; ///< Map containing all temporary field3d instances
 
-        double* rhoref;  ///< Reference density at full levels 
-        double* rhorefh; ///< Reference density at half levels
+        real* rhoref;  ///< Reference density at full levels 
+        real* rhorefh; ///< Reference density at half levels
 
         // TODO remove these to and bring them to diffusion model
         double visc;
@@ -105,15 +110,15 @@ class Fields
         void backward_device(); ///< Copy of all fields required for statistics and output from device to host
         void clear_device();    ///< Deallocation of all fields at device
 
-        void forward_field_device_3d (double*, double*, Offset_type); ///< Copy of a single 3d field from host to device
-        void forward_field_device_2d (double*, double*, Offset_type); ///< Copy of a single 2d field from host to device
-        void forward_field_device_1d (double*, double*, int);         ///< Copy of a single array from host to device
-        void backward_field_device_3d(double*, double*, Offset_type); ///< Copy of a single 3d field from device to host
-        void backward_field_device_2d(double*, double*, Offset_type); ///< Copy of a single 2d field from device to host
-        void backward_field_device_1d(double*, double*, int);         ///< Copy of a single array from device to host
+        void forward_field_device_3d (real*, real*, Offset_type); ///< Copy of a single 3d field from host to device
+        void forward_field_device_2d (real*, real*, Offset_type); ///< Copy of a single 2d field from host to device
+        void forward_field_device_1d (real*, real*, int);         ///< Copy of a single array from host to device
+        void backward_field_device_3d(real*, real*, Offset_type); ///< Copy of a single 3d field from device to host
+        void backward_field_device_2d(real*, real*, Offset_type); ///< Copy of a single 2d field from device to host
+        void backward_field_device_1d(real*, real*, int);         ///< Copy of a single array from device to host
 
-        double* rhoref_g;  ///< Reference density at full levels at device
-        double* rhorefh_g; ///< Reference density at half levels at device
+        real* rhoref_g;  ///< Reference density at full levels at device
+        real* rhorefh_g; ///< Reference density at half levels at device
 
     private:
         // variables
@@ -124,6 +129,24 @@ class Fields
 
         bool calc_mean_profs;
 
+        // asynchronous saving of the restart files
+        std::string swasyncsave;       ///< Switch for writing the restart files on a background thread.
+        std::thread savethread;        ///< Thread that writes the staged fields to disk.
+        std::vector<real> savebuffer;  ///< Staging buffer with a copy of all prognostic fields in file order.
+        std::vector<FILE*> savefiles;  ///< Files of the staged fields.
+        std::vector<std::string> savenames; ///< Names of the files of the staged fields.
+        std::vector<char> saveheader;  ///< Header of the staged restart container, only on the master process.
+        std::vector<int>  saveblockfile;   ///< Index of the file per staged field.
+        std::vector<long> saveblockoffset; ///< Byte offset in the file per staged field.
+        int saveerror;                 ///< Number of failed writes of the background thread.
+        bool savetimefile;             ///< Switch for writing the time file once the staged fields are on disk.
+        int saveiotime;                ///< Time in the names of the staged files.
+        unsigned long saveitime;       ///< Integer time of the staged fields.
+        unsigned long saveidt;         ///< Integer time step of the staged fields.
+        int saveiteration;             ///< Iteration of the staged fields.
+
+        void write_staged_fields();    ///< Writes the staged fields to disk, runs on the background thread.
+
         // cross sections
         std::vector<std::string> crosslist; ///< List with all crosses from the ini file.
         std::vector<std::string> dumplist;  ///< List with all 3d dumps from the ini file.
@@ -139,8 +162,8 @@ class Fields
         void check_added_cross(std::string, std::string, std::vector<std::string>*, std::vector<std::string>*);
 
         // masks
-        void calc_mask_wplus(double*, double*, double*, int*, int*, int*, double*);
-        void calc_mask_wmin (double*, double*, double*, int*, int*, int*, double*);
+        void calc_mask_wplus(real*, real*, real*, int*, int*, int*, real*);
+        void calc_mask_wmin (real*, real*, real*, int*, int*, int*, real*);
 
         // perturbations
         double rndamp;
@@ -151,18 +174,14 @@ class Fields
         std::string vortexaxis;
 
         // Kernels for the check functions.
-        double calc_momentum_2nd(double*, double*, double*, double*);
-        double calc_tke_2nd     (double*, double*, double*, double*);
-        double calc_mass        (double*, double*);
+        double calc_momentum_2nd(real*, real*, real*, real*);
+        double calc_tke_2nd     (real*, real*, real*, real*);
+        double calc_mass        (real*, real*);
 
-        int add_mean_prof(Input*, std::string, double*, double);
-        int randomize    (Input*, std::string, double*);
+        int add_mean_prof(Input*, std::string, real*, double);
+        int randomize    (Input*, std::string, real*);
         int add_vortex_pair(Input*);
 
-        // statistics
-        double* umodel;
-        double* vmodel;
-
         int n_tmp_fields;   // number of temporary fields
 
         /* 
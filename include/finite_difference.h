@@ -21,6 +21,7 @@
  */
 
 #ifndef FINITE_DIFFERENCE
+#define FINITE_DIFFERENCE
 
 // In case the code is compiled with NVCC, add the macros for CUDA
 #ifdef __CUDACC__
@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include "defines.h"
 
 class Model;
 class Grid;
@@ -53,13 +54,13 @@ class Force
         void update_time_dependent(); ///< Update the time dependent parameters.
 
         std::vector<std::string> lslist;         ///< List of variables that have large-scale forcings.
-        std::map<std::string, double*> lsprofs; ///< Map of profiles with forcings stored by its name.
+        std::map<std::string, real*> lsprofs; ///< Map of profiles with forcings stored by its name.
 
         // GPU functions and variables
         void prepare_device();
         void clear_device();
 
-        std::map<std::string, double*> lsprofs_g; ///< Map of profiles with forcings stored by its name.
+        std::map<std::string, real*> lsprofs_g; ///< Map of profiles with forcings stored by its name.
 
         // Accessor functions
         std::string get_switch_lspres()      { return swlspres; }
@@ -78,39 +79,39 @@ class Force
         double uflux; ///< Mean velocity used to enforce constant flux.
         double fc;    ///< Coriolis parameter.
 
-        double* ug;  ///< Pointer to array u-component geostrophic wind.
-        double* vg;  ///< Pointer to array v-component geostrophic wind.
-        double* wls; ///< Pointer to array large-scale vertical velocity.
+        real* ug;  ///< Pointer to array u-component geostrophic wind.
+        real* vg;  ///< Pointer to array v-component geostrophic wind.
+        real* wls; ///< Pointer to array large-scale vertical velocity.
 
         // time dependent variables
         std::string swtimedep;
         std::vector<double> timedeptime;
         std::vector<std::string> timedeplist;
-        std::map<std::string, double*> timedepdata;
+        std::map<std::string, real*> timedepdata;
 
         void update_time_dependent_profs(double, double, int, int); ///< Set the time dependent profiles.
 
-        void calc_flux(double* const, const double* const,
-                       const double* const, const double);  ///< Calculates the pressure force to enforce a constant mass-flux.
+        void calc_flux(real* const, const real* const,
+                       const real* const, const double);  ///< Calculates the pressure force to enforce a constant mass-flux.
 
-        void calc_coriolis_2nd(double* const, double* const,
-                               const double* const, const double* const,
-                               const double* const, const double* const); ///< Calculates Coriolis force with 2nd-order accuracy.
+        void calc_coriolis_2nd(real* const, real* const,
+                               const real* const, const real* const,
+                               const real* const, const real* const); ///< Calculates Coriolis force with 2nd-order accuracy.
 
-        void calc_coriolis_4th(double* const, double* const,
-                               const double* const, const double* const,
-                               const double* const, const double* const); ///< Calculates Coriolis force with 4th-order accuracy.
+        void calc_coriolis_4th(real* const, real* const,
+                               const real* const, const real* const,
+                               const real* const, const real* const); ///< Calculates Coriolis force with 4th-order accuracy.
 
-        void calc_large_scale_source(double* const, const double* const); ///< Applies the large scale scalar tendency.
+        void calc_large_scale_source(real* const, const real* const); ///< Applies the large scale scalar tendency.
 
-        void advec_wls_2nd(double* const, const double* const,
-                           const double* const, const double* const); ///< Calculates the large-scale vertical transport.
+        void advec_wls_2nd(real* const, const real* const,
+                           const real* const, const real* const); ///< Calculates the large-scale vertical transport.
 
         // GPU functions and variables
-        double* ug_g;  ///< Pointer to GPU array u-component geostrophic wind.
-        double* vg_g;  ///< Pointer to GPU array v-component geostrophic wind.
-        double* wls_g; ///< Pointer to GPU array large-scale vertical velocity.
-        std::map<std::string, double*> timedepdata_g;
+        real* ug_g;  ///< Pointer to GPU array u-component geostrophic wind.
+        real* vg_g;  ///< Pointer to GPU array v-component geostrophic wind.
+        real* wls_g; ///< Pointer to GPU array large-scale vertical velocity.
+        std::map<std::string, real*> timedepdata_g;
 
 };
 #endif
@@ -27,13 +27,80 @@
 #include <mpi.h>
 #endif
 #include <fftw3.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
 #include "input.h"
+#include "defines.h"
+
+// Select the FFTW3 interface that matches the precision of the fields.
+#ifdef FLOAT_SINGLE
+#define FFTW(name) fftwf_ ## name
+#else
+#define FFTW(name) fftw_ ## name
+#endif
 
 class Model;
 class Master;
+class Profiler;
 
 enum Edge {East_west_edge, North_south_edge, Both_edges};
 
+/**
+ * Horizontal block of the domain over which the stencil kernels loop.
+ * Looping over the full height of a tile keeps the neighboring planes of
+ * the stencil in cache in case the horizontal domain per process is large.
+ * The threads share out the tiles, such that each thread owns whole tiles.
+ */
+struct Tile
+{
+    int istart; ///< Index of the first grid point of the tile in the x-direction.
+    int iend;   ///< Index of the last grid point+1 of the tile in the x-direction.
+    int jstart; ///< Index of the first grid point of the tile in the y-direction.
+    int jend;   ///< Index of the last grid point+1 of the tile in the y-direction.
+};
+
+/**
+ * Header of the restart container, which stores all prognostic fields of one save time in a single file.
+ * The header is followed by one contiguous block per field in the order of the names.
+ */
+struct Restart_header
+{
+    unsigned long itime; ///< Integer time of the restart.
+    unsigned long idt;   ///< Integer time step of the restart.
+    int iteration;       ///< Iteration number of the restart.
+    std::vector<std::string> names;       ///< Names of the stored fields.
+    std::vector<unsigned long> checksums; ///< Position weighted checksums of the stored fields.
+};
+
+/**
+ * Error bound of the lossy compression of an output field.
+ * The mantissa bits of each value below the bound are rounded off, such that the
+ * field compresses well while the file remains readable as plain floating point numbers.
+ */
+struct Error_bound
+{
+    Error_bound() : type("0"), error(0.), maxerror(0.) {}
+    std::string type; ///< Type of the bound, "0" for lossless, "abs" for an absolute and "rel" for a relative error.
+    double error;     ///< Maximum allowed absolute or relative error.
+    double maxerror;  ///< Maximum absolute error of the last saved field over all processes.
+};
+
+/**
+ * NetCDF file with all cross-sections of one variable in one orientation.
+ * Every sampling time is appended as a record along the unlimited time dimension.
+ */
+struct Cross_file
+{
+    Cross_file() : ncid(-1), varid(-1), timeid(-1), nrecord(0) {}
+    std::string filename; ///< Name of the file.
+    int ncid;    ///< NetCDF id of the file.
+    int varid;   ///< NetCDF id of the cross-section variable.
+    int timeid;  ///< NetCDF id of the time variable.
+    int nrecord; ///< Number of time records in the file.
+};
+
 /**
  * Class for the grid settings and operators.
  * This class contains the grid properties, such as dimensions and resolution.
@@ -52,6 +119,8 @@ class Grid
         void save();         ///< Saves grid data to file.
         void load();         ///< Loads grid data to file.
 
+        void create_fftw_plans(); ///< Creates the batched FFTW3 plans that transform the transposed fields in place.
+
         int itot; ///< Total number of grid cells in the x-direction.
         int jtot; ///< Total number of grid cells in the y-direction.
         int ktot; ///< Total number of grid cells in the z-direction.
@@ -90,90 +159,131 @@ class Grid
         double dy;     ///< Distance between the center of two grid cell in the y-direction.
         double dxi;    ///< Reciprocal of dx.
         double dyi;    ///< Reciprocal of dy.
-        double* dz;    ///< Distance between the center of two grid cell in the z-direction.
-        double* dzh;   ///< Distance between the two grid cell faces in the z-direction.
-        double* dzi;   ///< Reciprocal of dz.
-        double* dzhi;  ///< Reciprocal of dzh.
-        double* dzi4;  ///< Fourth order gradient of the distance between cell centers to be used in 4th-order schemes.
-        double* dzhi4; ///< Fourth order gradient of the distance between cell faces to be used in 4th-order schemes.
+        real* dz;    ///< Distance between the center of two grid cell in the z-direction.
+        real* dzh;   ///< Distance between the two grid cell faces in the z-direction.
+        real* dzi;   ///< Reciprocal of dz.
+        real* dzhi;  ///< Reciprocal of dzh.
+        real* dzi4;  ///< Fourth order gradient of the distance between cell centers to be used in 4th-order schemes.
+        real* dzhi4; ///< Fourth order gradient of the distance between cell faces to be used in 4th-order schemes.
 
         double dzhi4bot;
         double dzhi4top;
 
-        double* x;  ///< Grid coordinate of cell center in x-direction.
-        double* y;  ///< Grid coordinate of cell center in y-direction.
-        double* z;  ///< Grid coordinate of cell center in z-direction.
-        double* xh; ///< Grid coordinate of cell faces in x-direction.
-        double* yh; ///< Grid coordinate of cell faces in x-direction.
-        double* zh; ///< Grid coordinate of cell faces in x-direction.
+        real* x;  ///< Grid coordinate of cell center in x-direction.
+        real* y;  ///< Grid coordinate of cell center in y-direction.
+        real* z;  ///< Grid coordinate of cell center in z-direction.
+        real* xh; ///< Grid coordinate of cell faces in x-direction.
+        real* yh; ///< Grid coordinate of cell faces in x-direction.
+        real* zh; ///< Grid coordinate of cell faces in x-direction.
 
         double utrans; ///< Galilean transformation velocity in x-direction.
         double vtrans; ///< Galilean transformation velocity in y-direction.
 
         std::string swspatialorder; ///< Default spatial order of the operators to be used on this grid.
 
+        // Cache blocking of the stencil kernels
+        std::string swtiling;    ///< Switch for the tiling of the stencil kernels (0, 1 or auto).
+        int itile;               ///< Number of grid cells in the x-direction of one tile.
+        int jtile;               ///< Number of grid cells in the y-direction of one tile.
+        std::vector<Tile> tiles; ///< Tiles that cover the interior of the domain of one process.
+
+        void set_tiles(int, int);  ///< Splits the domain into tiles of the given size.
+        void start_tile_timer();   ///< Starts the timing of one tendency calculation in the autotuner.
+        void stop_tile_timer();    ///< Stops the timing and moves the autotuner to the next tile shape.
+
         void set_minimum_ghost_cells(int, int, int);
 
         // MPI functions
         void init_mpi(); ///< Creates the MPI data types used in grid operations.
         void exit_mpi(); ///< Destructs the MPI data types used in grid operations.
-        void boundary_cyclic   (double*, Edge=Both_edges); ///< Fills the ghost cells in the periodic directions.
-        void boundary_cyclic_2d(double*); ///< Fills the ghost cells of one slice in the periodic direction.
-        void transpose_zx(double*, double*); ///< Changes the transpose orientation from z to x.
-        void transpose_xz(double*, double*); ///< Changes the transpose orientation from x to z.
-        void transpose_xy(double*, double*); ///< changes the transpose orientation from x to y.
-        void transpose_yx(double*, double*); ///< Changes the transpose orientation from y to x.
-        void transpose_yz(double*, double*); ///< Changes the transpose orientation from y to z.
-        void transpose_zy(double*, double*); ///< Changes the transpose orientation from z to y.
-
-        void get_max (double*);      ///< Gets the maximum of a number over all processes.
-        void get_max (int*);         ///< Gets the maximum of a number over all processes.
-        void get_sum (double*);      ///< Gets the sum of a number over all processes.
-        void get_prof(double*, int); ///< Averages a vertical profile over all processes.
-        void calc_mean(double*, const double*, int);
+        void boundary_cyclic   (real*, Edge=Both_edges); ///< Fills the ghost cells in the periodic directions.
+        void boundary_cyclic_2d(real*); ///< Fills the ghost cells of one slice in the periodic direction.
+        void transpose_zx(real*, real*); ///< Changes the transpose orientation from z to x.
+        void transpose_xz(real*, real*); ///< Changes the transpose orientation from x to z.
+        void transpose_xy(real*, real*); ///< changes the transpose orientation from x to y.
+        void transpose_yx(real*, real*); ///< Changes the transpose orientation from y to x.
+        void transpose_yz(real*, real*); ///< Changes the transpose orientation from y to z.
+        void transpose_zy(real*, real*); ///< Changes the transpose orientation from z to y.
+
+        void get_max (double*);    ///< Gets the maximum of a number over all processes.
+        void get_max (int*);       ///< Gets the maximum of a number over all processes.
+        void get_sum (double*);    ///< Gets the sum of a number over all processes.
+        void get_prof(double*, int); ///< Averages a vertical profile over all processes in double precision.
+        void calc_mean(real*, const real*, int);
 
         // IO functions
-        int save_field3d(double*, double*, double*, char*, double); ///< Saves a full 3d field.
-        int load_field3d(double*, double*, double*, char*, double); ///< Loads a full 3d field.
-
-        int save_xz_slice(double*, double*, char*, int);           ///< Saves a xz-slice from a 3d field.
-        int save_yz_slice(double*, double*, char*, int);           ///< Saves a yz-slice from a 3d field.
-        int save_xy_slice(double*, double*, char*, int kslice=-1); ///< Saves a xy-slice from a 3d field.
-        int load_xy_slice(double*, double*, char*, int kslice=-1); ///< Loads a xy-slice.
+        int save_field3d(real*, real*, real*, char*, double, bool compress=false, Error_bound* bound=0); ///< Saves a full 3d field, optionally compressed.
+        int load_field3d(real*, real*, real*, char*, double); ///< Loads a full 3d field, compressed or not.
+        void  stage_field3d(real*, real*, real*, double); ///< Copies a 3d field in file order into a staging buffer.
+        FILE* create_field3d_file(char*);                 ///< Creates the file of a 3d field and opens it on all processes.
+        int   write_field3d_file(FILE*, real*, long);     ///< Writes a staged 3d field at a byte offset without communication.
+
+        // Restart container functions
+        int  save_restart(char*, Restart_header&, const std::vector<real*>&, real*, real*); ///< Saves fields and time state in a single file.
+        int  load_restart(char*, const Restart_header&, const std::vector<std::string>&,
+                          const std::vector<real*>&, real*, real*);                        ///< Loads the selected fields from a restart container.
+        int  read_restart_header(char*, Restart_header&);       ///< Reads the header of a restart container on all processes.
+        bool has_restart(char*);                                ///< Checks whether a restart container exists.
+        std::vector<char> pack_restart_header(const Restart_header&); ///< Serializes the header of a restart container.
+        long get_restart_offset(const Restart_header&, int);    ///< Gets the byte offset of a field block in a restart container.
+        unsigned long calc_checksum(const real*);               ///< Calculates the local part of the checksum of a staged field.
+
+        int save_xz_slice(real*, real*, char*, int, Error_bound* bound=0);             ///< Saves a xz-slice from a 3d field.
+        int save_yz_slice(real*, real*, char*, int, Error_bound* bound=0);             ///< Saves a yz-slice from a 3d field.
+        int save_xy_slice(real*, real*, char*, int kslice=-1, Error_bound* bound=0);   ///< Saves a xy-slice from a 3d field.
+        int load_xy_slice(real*, real*, char*, int kslice=-1); ///< Loads a xy-slice.
+        double round_field(real*, int, const Error_bound&);    ///< Rounds off the bits below the error bound and returns the local maximum error.
+        int get_error_bounds(std::map<std::string, Error_bound>&, Input*, std::string,
+                             const std::vector<std::string>&, std::string, bool compress=false); ///< Reads and checks the lossy error bounds of the listed output variables.
+
+        // NetCDF cross-section functions, the slices are appended to the last time record
+        // and a failing NetCDF call throws
+        void create_cross_file(Cross_file&, char*, std::string, std::string, const std::vector<int>&, const int*, bool); ///< Creates a cross-section file.
+        void add_cross_record(Cross_file&, double);                                  ///< Appends a time record to a cross-section file.
+        void sync_cross_file(Cross_file&);                                           ///< Writes the buffered records of a cross-section file to disk.
+        void close_cross_file(Cross_file&);                                          ///< Closes a cross-section file.
+        void save_xz_slice(real*, real*, Cross_file&, int, int, Error_bound* bound=0); ///< Saves a xz-slice into a cross-section file.
+        void save_yz_slice(real*, real*, Cross_file&, int, int, Error_bound* bound=0); ///< Saves a yz-slice into a cross-section file.
+        void save_xy_slice(real*, real*, Cross_file&, int, int, Error_bound* bound=0); ///< Saves a xy-slice or a 2d plane (index -1) into a cross-section file.
+        void save_field3d_netcdf(real*, real*, char*, std::string, const int*, double, bool, Error_bound* bound=0); ///< Saves a full 3d field into a chunked NetCDF file.
+        bool has_netcdf_deflate(); ///< Checks whether the NetCDF library can deflate the variables of the NetCDF output.
 
         // Fourier tranforms
-        double*fftini, *fftouti; ///< Help arrays for fast-fourier transforms in x-direction.
-        double*fftinj, *fftoutj; ///< Help arrays for fast-fourier transforms in y-direction.
-        fftw_plan iplanf, iplanb; ///< FFTW3 plans for forward and backward transforms in x-direction.
-        fftw_plan jplanf, jplanb; ///< FFTW3 plans for forward and backward transforms in y-direction.
+        std::vector<FFTW(plan)> iplanf, iplanb; ///< FFTW3 plans for forward and backward transforms in x-direction, one per chunk.
+        std::vector<FFTW(plan)> jplanf, jplanb; ///< FFTW3 plans for forward and backward transforms in y-direction, one per chunk.
+        std::string fftwplanner; ///< Planner rigor of the FFTW3 plans (estimate, measure, patient or exhaustive).
 
-        void fft_forward (double*, double*, double*, double*, double*, double*); ///< Forward fast-fourier transform.
-        void fft_backward(double*, double*, double*, double*, double*, double*); ///< Backward fast-fourier transform.
+        void fft_forward (real*, real*, bool=true); ///< Forward fast-fourier transform, if false the result stays in y-orientation in the second array (MPI only).
+        void fft_backward(real*, real*, bool=true); ///< Backward fast-fourier transform, if false the input is taken in y-orientation from the second array (MPI only).
+
+        // Pipelining of the transposes and fourier transforms
+        std::string swfftpipe; ///< Switch for overlapping the fourier transforms with the transposes (0 or 1).
+        int nfftchunks;        ///< Number of chunks in the vertical in which the transposes are split.
 
         // interpolation functions
-        void interpolate_2nd(double*, const double*, const int[3], const int[3]); ///< Second order interpolation
-        void interpolate_4th(double*, double*, const int[3], const int[3]); ///< Fourth order interpolation
+        void interpolate_2nd(real*, const real*, const int[3], const int[3]); ///< Second order interpolation
+        void interpolate_4th(real*, real*, const int[3], const int[3]); ///< Fourth order interpolation
 
         // GPU functions and variables
         int ithread_block; ///< Number of grid cells in the x-direction for GPU thread block.
         int jthread_block; ///< Number of grid cells in the y-direction for GPU thread block.
 
-        double* z_g;
-        double* zh_g;
-        double* dz_g;
-        double* dzh_g;
-        double* dzi_g;
-        double* dzhi_g;
-        double* dzi4_g;
-        double* dzhi4_g;
+        real* z_g;
+        real* zh_g;
+        real* dz_g;
+        real* dzh_g;
+        real* dzi_g;
+        real* dzhi_g;
+        real* dzi4_g;
+        real* dzhi4_g;
 
         void prepare_device();                          ///< Load the arrays onto the GPU
         void clear_device();                            ///< Deallocate the arrays onto the GPU
-        void boundary_cyclic_g(double*);               ///< Fills the ghost cells in the periodic directions.
-        void boundary_cyclic2d_g(double*);             ///< Fills the ghost cells of one slice in the periodic directions.
-        double get_max_g(double*, double*);           ///< Get maximum value from field at GPU
-        double get_sum_g(double*, double*);           ///< Get summed value from field at GPU
-        void calc_mean_g(double*, double*, double*); ///< Get mean profile from field at GPU
+        void boundary_cyclic_g(real*);               ///< Fills the ghost cells in the periodic directions.
+        void boundary_cyclic2d_g(real*);             ///< Fills the ghost cells of one slice in the periodic directions.
+        double get_max_g(real*, real*);           ///< Get maximum value from field at GPU
+        double get_sum_g(real*, real*);           ///< Get summed value from field at GPU
+        void calc_mean_g(real*, real*, real*); ///< Get mean profile from field at GPU
 
         // Extra variables for aligning global memory on GPU
         int memoffset;
@@ -183,12 +293,52 @@ class Grid
 
     private:
         Master* master; ///< Pointer to master class.
+        Profiler* profiler; ///< Pointer to profiler class.
         bool mpitypes;  ///< Boolean to check whether MPI datatypes are created.
         bool fftwplan;  ///< Boolean to check whether FFTW3 plans are created.
 
         void calculate(); ///< Computation of dimensions, faces and ghost cells.
+        unsigned int fftwflags;   ///< FFTW3 planner flags that follow from fftwplanner.
+
+        std::vector<int> kchunks; ///< Vertical levels at which the chunks of the transposed fields start.
+        void init_tiling(); ///< Sets the tiles and the candidate tile shapes of the autotuner.
+
+        // Autotuner of the tile shapes
+        bool tile_tuning;                  ///< Boolean to check whether the autotuner is running.
+        int tile_ntime;                    ///< Number of timings per tile shape.
+        int tile_itime;                    ///< Number of timings done for the current tile shape.
+        unsigned int tile_icandidate;      ///< Index of the tile shape that is being timed.
+        double tile_time_start;            ///< Wall clock time at the start of the timing.
+        std::vector<int> itile_candidates; ///< Tile sizes in the x-direction of the autotuner.
+        std::vector<int> jtile_candidates; ///< Tile sizes in the y-direction of the autotuner.
+        std::vector<double> tile_times;    ///< Fastest measured time per tile shape.
         void check_ghost_cells(); ///< Check whether slice thickness is at least equal to number of ghost cells.
 
+        // Cross-section and NetCDF helpers
+        void stage_xz_slice(real*, real*, int);      ///< Copies a xz-slice without ghost cells into a buffer.
+        void stage_yz_slice(real*, real*, int);      ///< Copies a yz-slice without ghost cells into a buffer.
+        void stage_xy_slice(real*, real*, int);      ///< Copies a xy-slice without ghost cells into a buffer.
+        void round_slice(real*, int, bool, Error_bound*);  ///< Rounds off a staged slice and gathers the maximum error.
+        void define_cross_file(Cross_file&, std::string, std::string, const std::vector<int>&, const int*, bool); ///< Defines the dimensions and variables of a cross-section file.
+        void nc_check(int, const char*);              ///< Prints the NetCDF error message of a failed call and throws.
+        void create_netcdf_file(char*, int*);         ///< Creates a NetCDF-4 file, in parallel on all processes.
+        void set_netcdf_collective(int, int, char*);  ///< Sets the access to a NetCDF variable to collective in parallel runs.
+        void calc_global_coords(std::vector<double>&, std::vector<double>&, std::vector<double>&, const int*); ///< Calculates the coordinates of the whole domain.
+        void put_cross_slice(Cross_file&, real*, const size_t*, const size_t*); ///< Writes a staged slice collectively.
+
+        // Lossless compression of the 3d fields, per row of the transposed field in the x-direction
+        int  save_field3d_compressed(real*, char*);  ///< Saves a staged 3d field as compressed rows with an index.
+        int  load_field3d_compressed(real*, char*);  ///< Loads a compressed 3d field into a staged field.
+        bool is_compressed_field3d(char*);           ///< Checks whether a 3d field file is compressed.
+        int  check_field3d_size(char*);              ///< Checks whether an uncompressed 3d field file has the size and precision of the grid.
+        int  compress_rows(std::vector<unsigned char>&, std::vector<unsigned long>&, const real*, int);   ///< Shuffles the bytes and deflates each row.
+        int  decompress_rows(real*, const unsigned char*, const unsigned long*, const unsigned long*, int); ///< Inflates and unshuffles each row from its start in the buffer.
+        void get_compressed_row_sizes(const unsigned long*, unsigned long*); ///< Gets the size of every row from the index of a compressed 3d field.
+        long get_compressed_header_size();           ///< Gets the size of the header and index of a compressed 3d field.
+        long get_compressed_index_offset();          ///< Gets the byte offset of the index of a compressed 3d field.
+        std::vector<char> pack_compressed_header();  ///< Serializes the header without the index of a compressed 3d field.
+        int  check_compressed_header(const std::vector<char>&, char*); ///< Checks the header of a compressed 3d field against the grid.
+
 #ifdef USEMPI
         // MPI Datatypes
         MPI_Datatype eastwestedge;     ///< MPI datatype containing the ghostcells at the east-west sides.
@@ -203,6 +353,20 @@ class Grid
         MPI_Datatype transposey;  ///< MPI datatype containing base blocks for y-orientation in xy-transpose.
         MPI_Datatype transposey2; ///< MPI datatype containing base blocks for y-orientation in zy-transpose.
 
+        MPI_Datatype transposezk;  ///< MPI datatype containing one vertical level for z-orientation in zx-transpose.
+        MPI_Datatype transposezk2; ///< MPI datatype containing one vertical level for z-orientation in zy-transpose.
+        MPI_Datatype transposexk;  ///< MPI datatype containing one vertical level for x-orientation in zx-transpose.
+        MPI_Datatype transposexk2; ///< MPI datatype containing one vertical level for x-orientation in xy-transpose.
+        MPI_Datatype transposeyk;  ///< MPI datatype containing one vertical level for y-orientation in xy-transpose.
+        MPI_Datatype transposeyk2; ///< MPI datatype containing one vertical level for y-orientation in zy-transpose.
+
+        MPI_Request* chunkreqs; ///< Requests of the chunks of the pipelined transposes.
+
+        void start_transpose_chunks(real*, real*, MPI_Comm, int,
+                                    MPI_Datatype, int, int,
+                                    MPI_Datatype, int, int); ///< Starts the communication of all chunks of a transpose.
+        void wait_transpose_chunk(int, int); ///< Waits for the communication of one chunk of a transpose.
+
         MPI_Datatype subi;       ///< MPI datatype containing a subset of the entire x-axis.
         MPI_Datatype subj;       ///< MPI datatype containing a subset of the entire y-axis.
         MPI_Datatype subarray;   ///< MPI datatype containing the dimensions of the total array that is contained in one process.
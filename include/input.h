@@ -26,6 +26,7 @@
 #include <map>
 #include <string>
 #include <vector>
+#include "defines.h"
 
 // Forward declaration to avoid circular dependency.
 class Master;
@@ -35,11 +36,15 @@ typedef std::map<std::string, std::vector<double> > Data_map;
 class Input
 {
     public:
-        Input(Master*);
+        Input(Master*, bool readfiles=true);
         ~Input();
 
         void clear();
 
+        // Functions to fill the input without input files.
+        void set_item(std::string, std::string, std::string, std::string);
+        void set_prof(std::string, const std::vector<double>&);
+
         // Item retrieval functions
         int get_item(int*        , std::string, std::string, std::string);
         int get_item(int*        , std::string, std::string, std::string, int);
@@ -55,9 +60,9 @@ class Input
         int get_list(std::vector<double> *     , std::string, std::string, std::string);
         int get_list(std::vector<std::string> *, std::string, std::string, std::string);
 
-        int get_prof(double*, std::string, int size);
-        int get_time(double**, std::vector<double>*, std::string);
-        int get_time_prof(double**, std::vector<double>*, std::string, int);
+        int get_prof(real*, std::string, int size);
+        int get_time(real**, std::vector<double>*, std::string);
+        int get_time_prof(real**, std::vector<double>*, std::string, int);
 
         void print_unused();
         void flag_as_used(std::string, std::string);
@@ -28,6 +28,16 @@
 #endif
 #include <string>
 #include "input.h"
+#include "defines.h"
+
+#ifdef USEMPI
+// MPI datatype that matches the precision of the fields.
+#ifdef FLOAT_SINGLE
+#define mpi_fp_type MPI_FLOAT
+#else
+#define mpi_fp_type MPI_DOUBLE
+#endif
+#endif
 
 class Input;
 
@@ -54,6 +64,7 @@ class Master
         // overload the sum function
         void sum(int *, int);
         void sum(double *, int);
+        void sum(unsigned long *, int);
 
         // overload the max function
         void max(double *, int);
@@ -61,6 +72,15 @@ class Master
         // overload the min function
         void min(double *, int);
 
+        void allgather_x(real*, real*, int); ///< Gathers the blocks of all processes in the x-direction on each of them.
+
+#ifdef FLOAT_SINGLE
+        // single precision versions for field data
+        void broadcast(float *, int);
+        void max(float *, int);
+        void min(float *, int);
+#endif
+
         void print_message(const char *format, ...);
         void print_warning(const char *format, ...);
         void print_error  (const char *format, ...);
@@ -75,6 +95,8 @@ class Master
         int mpicoordx;
         int mpicoordy;
 
+        int nthreads; ///< Number of OpenMP threads per process.
+
 #ifdef USEMPI
         int nnorth;
         int nsouth;
@@ -90,6 +112,8 @@ class Master
 #endif
 
     private:
+        void init_threads(Input*);
+
         bool initialized;
         bool allocated;
 
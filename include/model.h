@@ -41,6 +41,7 @@ class Stats;
 class Cross;
 class Dump;
 class Budget;
+class Profiler;
 
 class Model
 {
@@ -76,6 +77,9 @@ class Model
         Dump*   dump;
         Budget* budget;
 
+        // Timing of the model components.
+        Profiler* profiler;
+
     private:
         // list of masks for statistics
         std::vector<std::string> masklist;
@@ -83,7 +87,8 @@ class Model
         void delete_objects();
 
         void print_status();
-        void calc_stats(std::string);
+        bool get_mask(std::string);
+        void calc_stats();
         void set_time_step();
 };
 #endif
@@ -23,6 +23,8 @@
 #ifndef PRES
 #define PRES
 
+#include "defines.h"
+
 class Model;
 class Grid;
 class Fields;
@@ -55,8 +57,8 @@ class Pres
 
 #ifdef USECUDA
         void make_cufft_plan();
-        void fft_forward (double*, double*, double*);
-        void fft_backward(double*, double*, double*);
+        void fft_forward (real*, real*, real*);
+        void fft_backward(real*, real*, real*);
 
         bool FFTPerSlice;
         cufftHandle iplanf;
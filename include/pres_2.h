@@ -24,6 +24,7 @@
 #define PRES_2
 
 #include "pres.h"
+#include "defines.h"
 
 class Model;
 
@@ -45,36 +46,47 @@ class Pres_2 : public Pres
 #endif
 
     private:
-        double* bmati;
-        double* bmatj;
-        double* a;
-        double* c;
-        double* work2d;
+        real* bmati;
+        real* bmatj;
+        real* a;
+        real* c;
+        real* work2d;
+
+        // Partitioned vertical solver
+        std::string swtdma;  ///< Switch for the vertical solver (serial or partitioned).
+        real* work3d_r;      ///< Response of the local columns to the separator above.
+        real* tdmasend;      ///< Coefficients of the reduced system of this process.
+        real* tdmarecv;      ///< Coefficients of the reduced systems of all processes in the x-direction.
 
 #ifdef USECUDA
-        double* bmati_g;
-        double* bmatj_g;
-        double* a_g;
-        double* c_g;
-        double* work2d_g;
+        real* bmati_g;
+        real* bmatj_g;
+        real* a_g;
+        real* c_g;
+        real* work2d_g;
 #endif
 
-        void input(double*, 
-                   double*, double*, double*,
-                   double*, double*, double*,
-                   double*, double*, double*,
+        void input(real*, 
+                   real*, real*, real*,
+                   real*, real*, real*,
+                   real*, real*, real*,
                    double);
 
-        void solve(double*, double*, double*,
-                   double*, double*,
-                   double*, double*, double*, double*);
+        void solve(real*, real*, real*,
+                   real*, real*);
 
-        void output(double*, double*, double*,
-                    double*, double*);
+        void solve_partitioned(real*, real*, real*,
+                               real*, real*); ///< Solves the system in spectral space without transposing back to z.
 
-        void tdma(double*, double*, double*, double*, 
-                  double*, double*);
+        void output(real*, real*, real*,
+                    real*, real*);
 
-        double calc_divergence(double*, double*, double*, double*, double*, double*);
+        void tdma(real*, real*, real*, real*, 
+                  real*, real*);
+
+        void tdma_partitioned(real*, real*, real*, real*,
+                              real*, real*); ///< Tridiagonal solver with the vertical distributed over the processes in the x-direction.
+
+        double calc_divergence(real*, real*, real*, real*, real*, real*);
 };
 #endif
@@ -50,26 +50,26 @@ class Pres_4 : public Pres
 #endif
 
     private:
-        double* bmati;
-        double* bmatj;
-        double* m1;
-        double* m2;
-        double* m3;
-        double* m4;
-        double* m5;
-        double* m6;
-        double* m7;
+        real* bmati;
+        real* bmatj;
+        real* m1;
+        real* m2;
+        real* m3;
+        real* m4;
+        real* m5;
+        real* m6;
+        real* m7;
 
 #ifdef USECUDA
-        double* bmati_g;
-        double* bmatj_g;
-        double* m1_g;
-        double* m2_g;
-        double* m3_g;
-        double* m4_g;
-        double* m5_g;
-        double* m6_g;
-        double* m7_g;
+        real* bmati_g;
+        real* bmatj_g;
+        real* m1_g;
+        real* m2_g;
+        real* m3_g;
+        real* m4_g;
+        real* m5_g;
+        real* m6_g;
+        real* m7_g;
 
         cufftDoubleComplex* ffti_complex_g;
         cufftDoubleComplex* fftj_complex_g;
@@ -80,27 +80,27 @@ class Pres_4 : public Pres
 #endif
 
         template<bool>
-        void input(double* restrict, 
-                   double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict, double* restrict,
-                   double* restrict, double);
-
-        void solve(double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict, double* restrict, double* restrict,
-                   double* restrict, double* restrict,
+        void input(real* restrict, 
+                   real* restrict, real* restrict, real* restrict,
+                   real* restrict, real* restrict, real* restrict,
+                   real* restrict, double);
+
+        void solve(real* restrict, real* restrict, real* restrict,
+                   real* restrict, real* restrict, real* restrict, real* restrict,
+                   real* restrict, real* restrict, real* restrict,
+                   real* restrict, real* restrict, real* restrict, real* restrict,
+                   real* restrict, real* restrict, real* restrict, real* restrict,
+                   real* restrict, real* restrict,
                    int);
 
         template<bool>
-        void output(double* restrict, double* restrict, double* restrict,
-                    double* restrict, double* restrict);
+        void output(real* restrict, real* restrict, real* restrict,
+                    real* restrict, real* restrict);
 
-        void hdma(double* restrict, double* restrict, double* restrict, double* restrict,
-                  double* restrict, double* restrict, double* restrict, double* restrict,
+        void hdma(real* restrict, real* restrict, real* restrict, real* restrict,
+                  real* restrict, real* restrict, real* restrict, real* restrict,
                   int);
 
-        double calc_divergence(double* restrict, double* restrict, double* restrict, double* restrict);
+        double calc_divergence(real* restrict, real* restrict, real* restrict, real* restrict);
 };
 #endif
@@ -0,0 +1,77 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER
+#define PROFILER
+
+#include <string>
+#include <map>
+
+class Master;
+class Model;
+class Input;
+
+/**
+ * Class for the timing of the model components.
+ * The wall clock time spent in each component is accumulated over the run in named timers.
+ * Timers of nested components include the time of the components they contain. The report
+ * contains the minimum, maximum and mean time over all processes and is written in JSON format.
+ */
+class Profiler
+{
+    public:
+        Profiler(Model*, Input*); ///< Constructor of the profiler class.
+        ~Profiler();              ///< Destructor of the profiler class.
+
+        void start(const std::string&); ///< Starts the timer of a component.
+        void stop (const std::string&); ///< Stops the timer of a component and adds the elapsed time.
+        void count(const std::string&, long); ///< Adds an event count, such as the number of reductions, of a component.
+
+        void exec(int, double); ///< Writes an intermediate report in case periodic reports are enabled.
+        void save(int, double); ///< Writes the final report.
+
+    private:
+        Master* master; ///< Pointer to master class.
+
+        std::string swprofiler; ///< Switch for the timing of the model components.
+        std::string swperiodic; ///< Switch for writing a report at every status output.
+
+        struct Timer
+        {
+            double start;  ///< Wall clock time at which the timer was started.
+            double total;  ///< Accumulated wall clock time.
+            long   ncalls; ///< Number of timed calls.
+        };
+
+        struct Counter
+        {
+            long total;  ///< Accumulated number of events.
+            long ncalls; ///< Number of times that events are counted.
+        };
+
+        std::map<std::string, Timer> timers;     ///< Map containing the timers of the components.
+        std::map<std::string, Counter> counters; ///< Map containing the event counters of the components.
+        double wall_clock_start;             ///< Wall clock time at the creation of the profiler.
+
+        void write_report(const std::string&, int, double); ///< Gathers the timers over all processes and writes the report.
+};
+#endif
@@ -0,0 +1,370 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RAIN_FUNCTIONS
+#define RAIN_FUNCTIONS
+
+#include <cmath>
+#include <algorithm>
+#include "defines.h"
+
+// Rain drop size distribution of the 2-moment warm microphysics of Thermo_moist, its lookup tables and
+// the sedimentation of rain. They are shared with microhh_bench, which checks the tables against the
+// direct evaluation and the sedimentation in a single column.
+namespace Rain_functions
+{
+    const double pi      = std::acos(-1.);
+    const double rho_w   = 1.e3;     // Density water
+    const double pirhow  = pi * rho_w / 6.;
+    const double mc_min  = 4.2e-15;  // Min mean mass of cloud droplet
+    const double mc_max  = 2.6e-10;  // Max mean mass of cloud droplet
+    const double mr_min  = mc_max;   // Min mean mass of precipitation drop
+    const double mr_max  = 3e-6;     // Max mean mass of precipitation drop // as in UCLA-LES
+    const double qr_min  = 1.e-15;   // Min rain liquid water for which calculations are performed 
+
+    // Fall speed of rain
+    const double a_R     = 9.65;     // SB06, p51
+    const double c_R     = 600;      // SB06, p51
+    const double Dv      = 25.0e-6;
+    const double b_R     = a_R * std::exp(c_R*Dv); // UCLA-LES
+
+    // Lookup tables of the rain drop size distribution as a function of the mean rain drop mass, which
+    // is limited to [mr_min, mr_max]. The tables are log-spaced in mass. With 1024 points, the maximum
+    // relative interpolation error is 1.2e-6 for the diameter, 5e-6 for mu_r, 2.2e-6 for lambda_r and
+    // 4.4e-7 for the fall speed reductions, the tabulated fall speeds differ less than 3.1e-6 m/s.
+    const int nrain_table = 1024;
+    enum Rain_table_column {Dr_column, Mur_column, Lambdar_column, Wqr_column, Wnr_column, Rain_table_ncolumns};
+
+    const double lnmr_min     = std::log(mr_min);
+    const double dlnmr_table  = (std::log(mr_max) - lnmr_min) / (nrain_table-1);
+    const double dlnmri_table = 1. / dlnmr_table;
+
+    // Given rain water content (qr), number density (nr) and density (rho)
+    // calculate mean mass of rain drop
+    inline double calc_rain_mass(const double qr, const double nr, const double rho)
+    {
+        //double mr = rho * qr / (nr + dsmall);
+        double mr = rho * qr / std::max(nr, 1.);
+        mr        = std::min(std::max(mr, mr_min), mr_max);
+        return mr;
+    }
+
+    inline double minmod(const double a, const double b)
+    {
+        return copysign(1., a) * std::max(0., std::min(std::abs(a), copysign(1., a)*b));
+    }
+
+    // Rational tanh approximation  
+    inline double tanh2(const double x)
+    {
+        return x * (27 + x * x) / (27 + 9 * x * x);
+    }
+
+    // Given mean mass rain drop, calculate mean diameter
+    inline double calc_rain_diameter(const double mr)
+    {
+        return std::pow(mr/pirhow, 1./3.);
+    }
+
+    // Shape parameter mu_r
+    inline double calc_mu_r(const double dr)
+    {
+        //return 1./3.; // SB06
+        //return 10. * (1. + tanh(1200 * (dr - 0.0015))); // SS08 (Milbrandt&Yau, 2005) -> similar as UCLA
+        return 10. * (1. + tanh2(1200 * (dr - 0.0015))); // SS08 (Milbrandt&Yau, 2005) -> similar as UCLA
+    }
+
+    // Slope parameter lambda_r
+    inline double calc_lambda_r(const double mur, const double dr)
+    {
+        return std::pow((mur+3)*(mur+2)*(mur+1), 1./3.) / dr;
+    }
+
+    // Reduction of the fall speed by the drop size distribution, moment=4 for the rain mass and moment=1 for the number
+    inline double calc_w_reduction(const double mur, const double lambdar, const double moment)
+    {
+        return b_R * std::pow(1. + c_R/lambdar, -1.*(mur+moment));
+    }
+
+    // Fractional index of the mean rain drop mass in the rain lookup tables
+    inline double calc_rain_table_index(const double mr)
+    {
+        const double index = (std::log(mr) - lnmr_min) * dlnmri_table;
+        return std::min(std::max(index, 0.), nrain_table-1.);
+    }
+
+    // Linear interpolation in one column of the rain lookup tables
+    inline double interp_rain_table(const double* const restrict table, const Rain_table_column column, const double index)
+    {
+        const int n    = std::min(static_cast<int>(index), nrain_table-2);
+        const double f = index - n;
+        const double* const restrict t = &table[column*nrain_table];
+        return (1.-f)*t[n] + f*t[n+1];
+    }
+
+    // Fill the lookup tables, which hold Rain_table_ncolumns columns of nrain_table points
+    inline void calc_rain_tables(double* const restrict table)
+    {
+        for (int n=0; n<nrain_table; ++n)
+        {
+            const double mr      = std::exp(lnmr_min + n*dlnmr_table);
+            const double dr      = calc_rain_diameter(mr);
+            const double mur     = calc_mu_r(dr);
+            const double lambdar = calc_lambda_r(mur, dr);
+
+            table[Dr_column     *nrain_table + n] = dr;
+            table[Mur_column    *nrain_table + n] = mur;
+            table[Lambdar_column*nrain_table + n] = lambdar;
+            table[Wqr_column    *nrain_table + n] = calc_w_reduction(mur, lambdar, 4.);
+            table[Wnr_column    *nrain_table + n] = calc_w_reduction(mur, lambdar, 1.);
+        }
+    }
+
+    // Sedimentation from Stevens and Seifert (2008), integrated in sub-steps such that the sedimentation
+    // CFL number of each sub-step stays below cflmax. The tendency is the time mean over the sub-steps.
+    inline void sedimentation_ss08(real* const restrict qrt, real* const restrict nrt, 
+                                   real* const restrict tmpxz1, real* const restrict tmpxz2,
+                                   real* const restrict tmpxz3, real* const restrict tmpxz4,
+                                   real* const restrict tmpxz5, real* const restrict tmpxz6,
+                                   real* const restrict tmpxz7, real* const restrict tmpxz8,
+                                   const real* const restrict rain_mass,
+                                   const real* const restrict mu_r, const real* const restrict lambda_r,
+                                   const double* const restrict rain_table,
+                                   const real* const restrict qr3d, const real* const restrict nr3d, 
+                                   const real* const restrict rho, const real* const restrict dzi,
+                                   const real* const restrict dz, const double dt, const double cflmax,
+                                   const int istart, const int jstart, const int kstart,
+                                   const int iend,   const int jend,   const int kend,
+                                   const int icells, const int kcells, const int ijcells, const int j)
+    {
+        const double w_max = 9.65; // 9.65=UCLA, 20=SS08, appendix A
+
+        const int kk2d = icells;
+
+        // 0. Copy the rain of the slice, including one ghost cell at the bottom and top.
+        // The copy is updated after every sub-step, the 3d fields are left untouched.
+        real* restrict qr = tmpxz7;
+        real* restrict nr = tmpxz8;
+
+        for (int k=kstart-1; k<kend+1; k++)
+            #pragma ivdep
+            for (int i=istart; i<iend; i++)
+            {
+                const int ijk = i + j*icells + k*ijcells;
+                const int ik  = i + k*icells;
+                qr[ik] = qr3d[ijk];
+                nr[ik] = nr3d[ijk];
+            }
+
+        real* restrict w_qr = tmpxz1;
+        real* restrict w_nr = tmpxz2;
+        real* restrict c_qr = tmpxz3;
+        real* restrict c_nr = tmpxz4;
+        real* restrict slope_qr = tmpxz1;
+        real* restrict slope_nr = tmpxz2;
+        real* restrict flux_qr = tmpxz5;
+        real* restrict flux_nr = tmpxz6;
+
+        // The length of each sub-step follows from the fall speeds of the rain at its start, as the rain
+        // that falls into the lower levels can speed up the sedimentation during the time step.
+        double tleft = dt;
+
+        for (int n=0; tleft > 0.; ++n)
+        {
+            // 1. Calculate sedimentation velocity at cell center. The first sub-step uses the
+            // drop size distribution of the slice preparation, later ones that of the updated rain.
+            // With the lookup tables, the fall speed reductions are interpolated from the rain mass.
+            for (int k=kstart; k<kend; k++)
+            {
+                const double rho_n = pow(1.2 / rho[k], 0.5);
+                #pragma ivdep
+                for (int i=istart; i<iend; i++)
+                {
+                    const int ik = i + k*icells;
+
+                    if(qr[ik] > qr_min)
+                    {
+                        double wqr_reduction, wnr_reduction;
+                        if (rain_table)
+                        {
+                            const double mr    = (n == 0) ? rain_mass[ik] : calc_rain_mass(qr[ik], nr[ik], rho[k]);
+                            const double index = calc_rain_table_index(mr);
+                            wqr_reduction = interp_rain_table(rain_table, Wqr_column, index);
+                            wnr_reduction = interp_rain_table(rain_table, Wnr_column, index);
+                        }
+                        else
+                        {
+                            double mur, lambdar;
+                            if (n == 0)
+                            {
+                                mur     = mu_r[ik];
+                                lambdar = lambda_r[ik];
+                            }
+                            else
+                            {
+                                const double dr = calc_rain_diameter(calc_rain_mass(qr[ik], nr[ik], rho[k]));
+                                mur     = calc_mu_r(dr);
+                                lambdar = calc_lambda_r(mur, dr);
+                            }
+                            wqr_reduction = calc_w_reduction(mur, lambdar, 4.);
+                            wnr_reduction = calc_w_reduction(mur, lambdar, 1.);
+                        }
+
+                        // SS08:
+                        w_qr[ik] = std::min(w_max, std::max(0.1, rho_n * a_R - wqr_reduction));
+                        w_nr[ik] = std::min(w_max, std::max(0.1, rho_n * a_R - wnr_reduction));
+                    }
+                    else
+                    {
+                        w_qr[ik] = 0.;
+                        w_nr[ik] = 0.;
+                    }
+                }
+            }
+
+            // 1.1 Set one ghost cell to zero
+            for (int i=istart; i<iend; i++)
+            {
+                const int ik1  = i + (kstart-1)*icells;
+                const int ik2  = i + (kend    )*icells;
+                w_qr[ik1] = w_qr[ik1+kk2d];
+                w_nr[ik1] = w_nr[ik1+kk2d];
+                w_qr[ik2] = 0;
+                w_nr[ik2] = 0;
+            } 
+
+            // 1.2 Determine the sub-step from the maximum sedimentation CFL number over all columns and levels
+            // of the slice, such that the remaining time is split in equal steps with a CFL below cflmax
+            double cfl = 0.;
+            for (int k=kstart; k<kend; k++)
+                for (int i=istart; i<iend; i++)
+                {
+                    const int ik  = i + k*icells;
+                    cfl = std::max(cfl, 0.25 * (w_qr[ik-kk2d] + 2.*w_qr[ik] + w_qr[ik+kk2d]) * dzi[k] * tleft);
+                }
+
+            const int nsubstep = std::max(1, static_cast<int>(std::ceil(cfl / cflmax)));
+            const double dts = (nsubstep == 1) ? tleft : tleft / nsubstep;
+            tleft = (nsubstep == 1) ? 0. : tleft - dts;
+
+             // 2. Calculate CFL number using interpolated sedimentation velocity
+            for (int k=kstart; k<kend; k++)
+                #pragma ivdep
+                for (int i=istart; i<iend; i++)
+                {
+                    const int ik  = i + k*icells;
+                    c_qr[ik] = 0.25 * (w_qr[ik-kk2d] + 2.*w_qr[ik] + w_qr[ik+kk2d]) * dzi[k] * dts; 
+                    c_nr[ik] = 0.25 * (w_nr[ik-kk2d] + 2.*w_nr[ik] + w_nr[ik+kk2d]) * dzi[k] * dts; 
+                }
+
+            // 3. Calculate slopes
+            for (int k=kstart; k<kend; k++)
+                #pragma ivdep
+                for (int i=istart; i<iend; i++)
+                {
+                    const int ik  = i + k*icells;
+
+                    slope_qr[ik] = minmod(qr[ik]-qr[ik-kk2d], qr[ik+kk2d]-qr[ik]);
+                    slope_nr[ik] = minmod(nr[ik]-nr[ik-kk2d], nr[ik+kk2d]-nr[ik]);
+                }
+
+            // Calculate flux
+            // Set the fluxes at the top of the domain (kend) to zero
+            for (int i=istart; i<iend; i++)
+            {
+                const int ik  = i + kend*icells;
+                flux_qr[ik] = 0;
+                flux_nr[ik] = 0;
+            } 
+
+            for (int k=kend-1; k>kstart-1; k--)
+                #pragma ivdep
+                for (int i=istart; i<iend; i++)
+                {    
+                    const int ik  = i + k*icells;
+
+                    int kk;
+                    double ftot, dzz, cc;
+
+                    // q_rain
+                    kk    = k;  // current grid level
+                    ftot  = 0;  // cumulative 'flux' (kg m-2) 
+                    dzz   = 0;  // distance from zh[k]
+                    cc    = std::min(real(1.), c_qr[ik]);
+                    while (cc > 0 && kk < kend)
+                    {
+                        const int ikk  = i + kk*icells;
+
+                        ftot  += rho[kk] * (qr[ikk] + 0.5 * slope_qr[ikk] * (1.-cc)) * cc * dz[kk];
+
+                        dzz   += dz[kk];
+                        kk    += 1;
+                        cc     = std::min(1., c_qr[ikk] - dzz*dzi[kk]);
+                    }
+
+                    // Given flux at top, limit bottom flux such that the total rain content stays >= 0.
+                    ftot = std::min(ftot, rho[k] * dz[k] * qr[ik] - flux_qr[ik+icells] * dts);
+                    flux_qr[ik] = -ftot / dts;
+
+                    // number density
+                    kk    = k;  // current grid level
+                    ftot  = 0;  // cumulative 'flux'
+                    dzz   = 0;  // distance from zh[k]
+                    cc    = std::min(real(1.), c_nr[ik]);
+                    while (cc > 0 && kk < kend)
+                    {    
+                        const int ikk  = i + kk*icells;
+
+                        ftot += rho[kk] * (nr[ikk] + 0.5 * slope_nr[ikk] * (1.-cc)) * cc * dz[kk];
+
+                        dzz   += dz[kk];
+                        kk    += 1;
+                        cc     = std::min(1., c_nr[ikk] - dzz*dzi[k]);
+                    }
+
+                    // Given flux at top, limit bottom flux such that the number density stays >= 0.
+                    ftot = std::min(ftot, rho[k] * dz[k] * nr[ik] - flux_nr[ik+icells] * dts);
+                    flux_nr[ik] = -ftot / dts;
+                }
+
+            // Calculate tendency, averaged over the sub-steps, and update the rain of the slice
+            const double fsub = dts / dt;
+            for (int k=kstart; k<kend; k++)
+                #pragma ivdep
+                for (int i=istart; i<iend; i++)
+                {    
+                    const int ijk = i + j*icells + k*ijcells;
+                    const int ik  = i + k*icells;
+
+                    const double qr_tend = -(flux_qr[ik+kk2d] - flux_qr[ik]) / rho[k] * dzi[k]; 
+                    const double nr_tend = -(flux_nr[ik+kk2d] - flux_nr[ik]) / rho[k] * dzi[k]; 
+
+                    qrt[ijk] += fsub * qr_tend;
+                    nrt[ijk] += fsub * nr_tend;
+
+                    qr[ik] += dts * qr_tend;
+                    nr[ik] += dts * nr_tend;
+                }
+        }
+    }
+}
+#endif
@@ -24,7 +24,9 @@
 #define STATS
 
 //#include <netcdfcpp.h>
+#include <deque>
 #include <netcdf>
+#include "defines.h"
 using namespace netCDF;
 
 class Master;
@@ -37,6 +39,7 @@ struct Prof_var
 {
     NcVar ncvar;
     double* data;
+    std::vector<double> buffer; ///< Profiles of the samples that are not yet written.
 };
 
 // struct for time series
@@ -44,6 +47,7 @@ struct Time_series_var
 {
     NcVar ncvar;
     double data;
+    std::vector<double> buffer; ///< Values of the samples that are not yet written.
 };
 
 // typedefs for containers of profiles and time series
@@ -60,6 +64,8 @@ struct Mask
     NcDim t_dim;
     NcVar iter_var;
     NcVar t_var;
+    std::vector<int> iter_buffer; ///< Iteration numbers of the samples that are not yet written.
+    std::vector<double> t_buffer; ///< Times of the samples that are not yet written.
     Prof_map profs;
     Time_series_map tseries;
 };
@@ -78,6 +84,7 @@ class Stats
         unsigned long get_time_limit(unsigned long);
         void get_mask(Field3d*, Field3d*, Mask*);
         void exec(int, double, unsigned long);
+        void flush(); ///< Writes all buffered samples to the NetCDF files.
         bool doStats();
         std::string get_switch();
 
@@ -90,44 +97,85 @@ class Stats
         // Interface functions.
         void add_mask(const std::string);
         void add_prof(std::string, std::string, std::string, std::string);
-        void add_fixed_prof(std::string, std::string, std::string, std::string, double*);
+        void add_fixed_prof(std::string, std::string, std::string, std::string, real*);
         void add_time_series(std::string, std::string, std::string);
 
-        void calc_area(double*, const int[3], int*);
-
-        void calc_mean(double* const, const double* const,
-                       const double, const int[3],
-                       const double* const, const int* const);
-
-        void calc_mean2d(double* const, const double* const,
+        void calc_mean2d(double* const, const real* const,
                          const double,
-                         const double* const, const int* const);
-
-        void calc_moment  (double*, double*, double*, double, const int[3], double*, int*);
-
-        void calc_diff_2nd(double*, double*, double*, double, const int[3], double*, int*);
-        void calc_diff_2nd(double*, double*, double*, double*, double*,
-                           double*, double*, double, const int[3], double*, int*);
-        void calc_diff_4th(double*, double*, double*, double, const int[3], double*, int*);
-
-        void calc_grad_2nd(double*, double*, double*, const int[3], double*, int*);
-        void calc_grad_4th(double*, double*, double*, const int[3], double*, int*);
-
-        void calc_flux_2nd(double*, double*, double*, double*, double*, double*, const int[3], double*, int*);
-        void calc_flux_4th(double*, double*, double*, double*, const int[3], double*, int*);
-
-        void add_fluxes   (double*, double*, double*);
-        void calc_count   (double*, double*, double, double*, int*);
-        void calc_path    (double*, double*, int*, double*);
-        void calc_cover   (double*, double*, int*, double*, double);
-
-        void calc_sorted_prof(double*, double*, double*);
+                         const real* const, const int* const);
+
+        void reduce_profs();                     ///< Reduces all staged profiles in a single call.
+        void calc_count   (real*, double*, double, real*, int*);
+        void calc_path    (real*, real*, int*, double*);
+        void calc_cover   (real*, real*, int*, double*, double);
+
+        void calc_sorted_prof(real*, double*);
+
+        // The masks are stored as bits per grid point, such that the kernels below can process all
+        // of them in one sweep. The profiles are selected by name in the selected masks.
+        bool do_multimask();                             ///< Returns whether all masks are processed in one sweep.
+        void clear_masks();                              ///< Removes all masks from the set.
+        void store_mask(Field3d*, Field3d*, Mask*);      ///< Adds the mask in the fields to the set and selects all masks.
+        Mask* load_mask(Field3d*, Field3d*, const int);  ///< Restores a mask of the set into the fields and counts and selects it.
+        void select_masks(const int, const int);         ///< Selects the range of masks that the kernels process.
+        int get_nmasks();                                ///< Returns the number of masks in the set.
+
+        void calc_area    (std::string, const int[3]);
+        void calc_mean    (std::string, real*, const double, const int[3]);
+        void calc_moments (real*, std::string, const double, std::string, std::string, std::string, const int[3]); ///< Computes the 2nd, 3rd and 4th central moment in one pass.
+        void calc_moments_fluxes(real*, std::string, const double, std::string, std::string, std::string,
+                                 real*, real*, std::string, std::string, std::string, const double,
+                                 real*, real*, real*, const double, const int[3]); ///< Computes the moments, the turbulent flux, the gradient and the diffusive flux in one pass.
+        void add_fluxes   (std::string, std::string, std::string); ///< Computes the total flux once the profiles are reduced.
 
     private:
-        int nstats;
+        int nstats;        ///< Number of samples, including the buffered ones.
+        int nbuffer;       ///< Number of samples in the buffers.
+        int flushinterval; ///< Number of samples that are buffered before they are written.
 
         // mask calculations
-        void calc_mask(double*, double*, double*, int*, int*, int*);
+        void calc_mask(real*, real*, real*, int*, int*, int*);
+
+        // deferred reduction of the profiles
+        struct Pending_prof
+        {
+            double* prof;             ///< Profile that receives the normalized sums.
+            int kbegin;               ///< First level that is normalized.
+            std::vector<int> nmask;   ///< Number of points in the mask at the time of staging.
+            std::vector<double> sums; ///< Local sums of the profile.
+        };
+
+        struct Pending_flux
+        {
+            double* flux; ///< Total flux.
+            double* turb; ///< Turbulent flux.
+            double* diff; ///< Diffusive flux.
+        };
+
+        std::vector<double> partials;             ///< Buffer in which the local sums of all staged profiles are reduced.
+        std::deque<Pending_prof> pending_profs;   ///< Profiles of which the reduction is deferred.
+        std::vector<Pending_flux> pending_fluxes; ///< Total fluxes that are computed after the reduction.
+        int nreductions;                          ///< Number of deferred reductions of the staged profiles in the current sample.
+        int nimmediate;                           ///< Number of immediate reductions of surface means, paths and covers in the current sample.
+
+        double* stage_prof(double*, const int*, const int); ///< Returns the space for the local sums of a profile.
+
+        // masks, stored as bits
+        std::string swmultimask;                ///< Switch for processing all masks in one sweep.
+        static const int max_masks = 8;         ///< Maximum number of masks, equal to the number of bits of the mask type.
+        std::vector<Mask*> multimasks;          ///< Masks in the order of their bits.
+        int mask_begin;                         ///< First selected mask.
+        int mask_end;                           ///< One past the last selected mask.
+        std::vector<unsigned char> maskbits;    ///< Bits of the masks at the full levels.
+        std::vector<unsigned char> maskbitsh;   ///< Bits of the masks at the half levels.
+        std::vector<unsigned char> maskbitsbot; ///< Bits of the masks at the surface.
+        std::vector<int> multinmask;            ///< Number of points per full level of all masks.
+        std::vector<int> multinmaskh;           ///< Number of points per half level of all masks.
+        std::vector<int> multinmaskbot;         ///< Number of points at the surface of all masks.
+
+        const unsigned char* get_mask_bits(const int[3]); ///< Returns the mask bits of a location.
+        const int* get_mask_counts(const int[3]);         ///< Returns the point counts of all masks of a location.
+        int get_mask_shift(const int[3]);                 ///< Returns the offset to the neighbour for the interpolation of the mask.
 
     protected:
         Model*  model;
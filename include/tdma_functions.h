@@ -0,0 +1,206 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDMA_FUNCTIONS
+#define TDMA_FUNCTIONS
+
+#include "defines.h"
+
+// Tridiagonal solvers of the vertical system of Pres_2, for the columns ij in [ijbegin, ijend) of fields
+// with ncol columns per level. The a and c coefficients are profiles over the whole column. They are
+// shared with microhh_bench, which checks the partitioned solver against the serial one.
+namespace Tdma_functions
+{
+    // tridiagonal matrix solver, taken from Numerical Recipes, Press
+    inline void tdma(const real* restrict a, const real* restrict b, const real* restrict c,
+                     real* restrict p, real* restrict work2d, real* restrict work3d,
+                     const int ijbegin, const int ijend, const int ncol, const int kmax)
+    {
+        const int kk = ncol;
+
+#pragma ivdep
+        for (int ij=ijbegin; ij<ijend; ij++)
+        {
+            work2d[ij] = b[ij];
+            p[ij] /= work2d[ij];
+        }
+
+        for (int k=1; k<kmax; k++)
+#pragma ivdep
+            for (int ij=ijbegin; ij<ijend; ij++)
+            {
+                const int ijk = ij + k*kk;
+                work3d[ijk] = c[k-1] / work2d[ij];
+                work2d[ij] = b[ijk] - a[k]*work3d[ijk];
+                p[ijk] -= a[k]*p[ijk-kk];
+                p[ijk] /= work2d[ij];
+            }
+
+        for (int k=kmax-2; k>=0; k--)
+#pragma ivdep
+            for (int ij=ijbegin; ij<ijend; ij++)
+            {
+                const int ijk = ij + k*kk;
+                p[ijk] -= work3d[ijk+kk]*p[ijk+kk];
+            }
+    }
+
+    // The partitioned solver splits the columns in npart partitions of at least two levels, which need not
+    // have the same size. The last level of each partition is a separator. The interior levels are solved
+    // locally as a function of the separators below and above, which leaves a reduced tridiagonal system of
+    // one equation per partition for the separators. Each partition stores 7*ncol coefficients of the reduced
+    // system, which are gathered in the order of the partitions to solve the reduced system.
+
+    // Solves the interior levels of the partition of kblock levels that starts at level kofs for the right
+    // hand side and for the couplings to the separators below (work3d_l) and above (work3d_r), and stores
+    // its coefficients of the reduced system in send. The elimination factors overwrite b.
+    inline void solve_partition(const real* restrict a, real* restrict b, const real* restrict c,
+                                real* restrict p, real* restrict work2d, real* restrict work3d_l, real* restrict work3d_r,
+                                real* restrict send, const int ijbegin, const int ijend, const int ncol,
+                                const int kofs, const int kblock, const bool has_below, const bool has_above)
+    {
+        const int kk = ncol;
+        const int ks = kblock-1;
+
+        // coupling of the first level to the separator below, absent in the bottom partition
+        const double al = has_below ? a[kofs] : 0.;
+
+#pragma ivdep
+        for (int ij=ijbegin; ij<ijend; ij++)
+        {
+            work2d[ij] = b[ij];
+            p[ij] /= work2d[ij];
+            work3d_l[ij] = -al / work2d[ij];
+            work3d_r[ij] = (ks == 1) ? -c[kofs] / work2d[ij] : 0.;
+        }
+
+        for (int k=1; k<ks; k++)
+        {
+            const double cr = (k == ks-1) ? -c[kofs+k] : 0.;
+#pragma ivdep
+            for (int ij=ijbegin; ij<ijend; ij++)
+            {
+                const int ijk = ij + k*kk;
+                const double gam = c[kofs+k-1] / work2d[ij];
+                work2d[ij] = b[ijk] - a[kofs+k]*gam;
+                b[ijk] = gam;
+                p[ijk]        = (p[ijk] - a[kofs+k]*p[ijk-kk]) / work2d[ij];
+                work3d_l[ijk] = (-a[kofs+k]*work3d_l[ijk-kk]) / work2d[ij];
+                work3d_r[ijk] = (cr - a[kofs+k]*work3d_r[ijk-kk]) / work2d[ij];
+            }
+        }
+
+        for (int k=ks-2; k>=0; k--)
+#pragma ivdep
+            for (int ij=ijbegin; ij<ijend; ij++)
+            {
+                const int ijk = ij + k*kk;
+                p[ijk]        -= b[ijk+kk]*p[ijk+kk];
+                work3d_l[ijk] -= b[ijk+kk]*work3d_l[ijk+kk];
+                work3d_r[ijk] -= b[ijk+kk]*work3d_r[ijk+kk];
+            }
+
+        // store the equation of the separator and the response of the first level to the separators
+        const double as = a[kofs+ks];
+        const double cs = has_above ? c[kofs+ks] : 0.;
+
+#pragma ivdep
+        for (int ij=ijbegin; ij<ijend; ij++)
+        {
+            const int ijs = ij + ks*kk;
+            const int ijn = ij + (ks-1)*kk;
+            send[0*ncol+ij] = as*work3d_l[ijn];
+            send[1*ncol+ij] = b[ijs] + as*work3d_r[ijn];
+            send[2*ncol+ij] = cs;
+            send[3*ncol+ij] = p[ijs] - as*p[ijn];
+            send[4*ncol+ij] = p[ij];
+            send[5*ncol+ij] = work3d_l[ij];
+            send[6*ncol+ij] = work3d_r[ij];
+        }
+    }
+
+    // Solves the reduced system of the separators of all partitions, the first level of the next partition
+    // is substituted in the equation of each separator. The factors overwrite field 0 and the separators
+    // field 3 of the gathered coefficients r.
+    inline void solve_reduced(real* restrict r, real* restrict work2d,
+                              const int ijbegin, const int ijend, const int ncol, const int npart)
+    {
+        const int nn = 7*ncol;
+
+        for (int ij=ijbegin; ij<ijend; ij++)
+        {
+            double bq = r[1*ncol+ij];
+            double dq = r[3*ncol+ij];
+            if (npart > 1)
+            {
+                bq += r[2*ncol+ij]*r[nn+5*ncol+ij];
+                dq -= r[2*ncol+ij]*r[nn+4*ncol+ij];
+            }
+            work2d[ij] = bq;
+            r[3*ncol+ij] = dq / bq;
+
+            for (int q=1; q<npart; q++)
+            {
+                const int qn = q*nn;
+                const double cq = r[qn-nn+2*ncol+ij]*r[qn+6*ncol+ij];
+                bq = r[qn+1*ncol+ij];
+                dq = r[qn+3*ncol+ij];
+                if (q < npart-1)
+                {
+                    bq += r[qn+2*ncol+ij]*r[qn+nn+5*ncol+ij];
+                    dq -= r[qn+2*ncol+ij]*r[qn+nn+4*ncol+ij];
+                }
+                const double gam = cq / work2d[ij];
+                work2d[ij] = bq - r[qn+0*ncol+ij]*gam;
+                r[qn+3*ncol+ij] = (dq - r[qn+0*ncol+ij]*r[qn-nn+3*ncol+ij]) / work2d[ij];
+                r[qn+0*ncol+ij] = gam;
+            }
+
+            for (int q=npart-2; q>=0; q--)
+                r[q*nn+3*ncol+ij] -= r[(q+1)*nn+0*ncol+ij]*r[(q+1)*nn+3*ncol+ij];
+        }
+    }
+
+    // Adds the responses to the separators to the interior of partition part and sets its separator.
+    inline void substitute_separators(real* restrict p, const real* restrict work3d_l, const real* restrict work3d_r,
+                                      const real* restrict r, const int ijbegin, const int ijend, const int ncol,
+                                      const int kblock, const int part)
+    {
+        const int kk = ncol;
+        const int nn = 7*ncol;
+        const int ks = kblock-1;
+
+        for (int k=0; k<kblock; k++)
+#pragma ivdep
+            for (int ij=ijbegin; ij<ijend; ij++)
+            {
+                const double sl = (part > 0) ? r[(part-1)*nn+3*ncol+ij] : 0.;
+                const double sr = r[part*nn+3*ncol+ij];
+                const int ijk = ij + k*kk;
+                if (k < ks)
+                    p[ijk] += work3d_l[ijk]*sl + work3d_r[ijk]*sr;
+                else
+                    p[ijk] = sr;
+            }
+    }
+}
+#endif
@@ -24,6 +24,7 @@
 #define THERMO_BUOY
 
 #include "thermo.h"
+#include "defines.h"
 
 class Master;
 class Grid;
@@ -65,18 +66,18 @@ class Thermo_buoy : public Thermo
 #endif
 
 private:
-        void calc_buoyancy(double*, double*);              ///< Calculation of the buoyancy.
-        void calc_buoyancy_bot(double*, double*,
-                               double*, double*);          ///< Calculation of the near-surface and surface buoyancy.
-        void calc_buoyancy_fluxbot(double*, double*);      ///< Calculation of the buoyancy flux at the bottom.
-        void calc_buoyancy_tend_2nd(double*, double*);     ///< Calculation of the buoyancy tendency with 2nd order accuracy.
-        void calc_buoyancy_tend_u_2nd(double *, double *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
-        void calc_buoyancy_tend_w_2nd(double *, double *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
-        void calc_buoyancy_tend_b_2nd(double *, double *, double *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
-        void calc_buoyancy_tend_4th(double*, double*);     ///< Calculation of the buoyancy tendency with 4th order accuracy.
-        void calc_buoyancy_tend_u_4th(double *, double *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
-        void calc_buoyancy_tend_w_4th(double *, double *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
-        void calc_buoyancy_tend_b_4th(double *, double *, double *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
+        void calc_buoyancy(real*, real*);              ///< Calculation of the buoyancy.
+        void calc_buoyancy_bot(real*, real*,
+                               real*, real*);          ///< Calculation of the near-surface and surface buoyancy.
+        void calc_buoyancy_fluxbot(real*, real*);      ///< Calculation of the buoyancy flux at the bottom.
+        void calc_buoyancy_tend_2nd(real*, real*);     ///< Calculation of the buoyancy tendency with 2nd order accuracy.
+        void calc_buoyancy_tend_u_2nd(real *, real *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
+        void calc_buoyancy_tend_w_2nd(real *, real *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
+        void calc_buoyancy_tend_b_2nd(real *, real *, real *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
+        void calc_buoyancy_tend_4th(real*, real*);     ///< Calculation of the buoyancy tendency with 4th order accuracy.
+        void calc_buoyancy_tend_u_4th(real *, real *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
+        void calc_buoyancy_tend_w_4th(real *, real *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
+        void calc_buoyancy_tend_b_4th(real *, real *, real *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
         double alpha;  ///< Slope angle in radians.
         double n2;     ///< Background stratification.
         bool has_slope; ///< Boolean switch for slope flows
@@ -24,6 +24,7 @@
 #define THERMO_DRY
 
 #include "thermo.h"
+#include "defines.h"
 
 class Master;
 class Grid;
@@ -73,22 +74,22 @@ class Thermo_dry : public Thermo
         void init_cross(); ///< Initialize the thermo cross-sections
         void init_dump();  ///< Initialize the thermo field dumps
 
-        void calc_buoyancy(double *, double *, double *);     ///< Calculation of the buoyancy.
-        void calc_N2(double *, double *, double *, double *); ///< Calculation of the Brunt-Vaissala frequency.
+        void calc_buoyancy(real *, real *, real *);     ///< Calculation of the buoyancy.
+        void calc_N2(real *, real *, real *, real *); ///< Calculation of the Brunt-Vaissala frequency.
 
         // cross sections
         std::vector<std::string> crosslist;        ///< List with all crosses from ini file
         std::vector<std::string> allowedcrossvars; ///< List with allowed cross variables
         std::vector<std::string> dumplist;         ///< List with all 3d dumps from the ini file.
 
-        void calc_buoyancy_bot(double *, double *,
-                               double *, double *,
-                               double *, double *); ///< Calculation of the near-surface and surface buoyancy.
-        void calc_buoyancy_fluxbot(double *, double *, double *);  ///< Calculation of the buoyancy flux at the bottom.
-        void calc_buoyancy_tend_2nd(double *, double *, double *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
-        void calc_buoyancy_tend_4th(double *, double *, double *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
+        void calc_buoyancy_bot(real *, real *,
+                               real *, real *,
+                               real *, real *); ///< Calculation of the near-surface and surface buoyancy.
+        void calc_buoyancy_fluxbot(real *, real *, real *);  ///< Calculation of the buoyancy flux at the bottom.
+        void calc_buoyancy_tend_2nd(real *, real *, real *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
+        void calc_buoyancy_tend_4th(real *, real *, real *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
 
-        void calc_base_state(double *, double *, double *, double *, double *, double *, double *, double *, double); ///< For anelastic setup, calculate base state from initial input profiles
+        void calc_base_state(real *, real *, real *, real *, real *, real *, real *, real *, double); ///< For anelastic setup, calculate base state from initial input profiles
 
         Stats* stats;
 
@@ -97,19 +98,19 @@ class Thermo_dry : public Thermo
         double pbot;   ///< Surface pressure.
         double thref0; ///< Reference potential temperature in case of Boussinesq
 
-        double* thref;
-        double* threfh;
-        double* pref;
-        double* prefh;
-        double* exnref;
-        double* exnrefh;
+        real* thref;
+        real* threfh;
+        real* pref;
+        real* prefh;
+        real* exnref;
+        real* exnrefh;
 
         // GPU functions and variables
-        double* thref_g;
-        double* threfh_g;
-        double* pref_g;
-        double* prefh_g;
-        double* exnref_g;
-        double* exnrefh_g;
+        real* thref_g;
+        real* threfh_g;
+        real* pref_g;
+        real* prefh_g;
+        real* exnref_g;
+        real* exnrefh_g;
 };
 #endif
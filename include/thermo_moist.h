@@ -24,6 +24,7 @@
 #define THERMO_MOIST
 
 #include "thermo.h"
+#include "defines.h"
 
 class Master;
 class Grid;
@@ -77,51 +78,83 @@ class Thermo_moist : public Thermo
         Stats *stats;
 
         // masks
-        void calc_mask_ql    (double*, double*, double*, int *, int *, int *, double*);
-        void calc_mask_qlcore(double*, double*, double*, int *, int *, int *, double*, double*, double*);
-
-        void calc_buoyancy_tend_2nd(double*, double*, double*, double*, double*, double*, double*, double*);
-        void calc_buoyancy_tend_4th(double*, double*, double*, double*, double*, double*, double*, double*);
-
-        void calc_buoyancy(double*, double*, double*, double*, double*, double*);
-        void calc_N2(double*, double*, double*, double*); ///< Calculation of the Brunt-Vaissala frequency.
-        void calc_base_state(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*);
-
-        void calc_maximum_thv_perturbation_cloud(double*, double*, double*, double*, double*, double*, double*);
-        void calc_liquid_water(double*, double*, double*, double*);
-        void calc_buoyancy_bot(double*, double*,
-                               double*, double*,
-                               double*, double*,
-                               double*, double*);
-        void calc_buoyancy_fluxbot(double*, double*, double*, double*, double*, double*);
+        void calc_mask_ql    (real*, real*, real*, int *, int *, int *, real*);
+        void calc_mask_qlcore(real*, real*, real*, int *, int *, int *, real*, real*, real*);
+
+        void calc_buoyancy_tend_2nd(real*, real*, real*, real*, real*, real*, real*, real*);
+        void calc_buoyancy_tend_4th(real*, real*, real*, real*, real*, real*, real*, real*);
+
+        void calc_buoyancy(real*, real*, real*, real*, real*, real*); ///< Calculation of the buoyancy from the cached liquid water.
+        void calc_N2(real*, real*, real*, real*); ///< Calculation of the Brunt-Vaissala frequency.
+        void calc_base_state(real*, real*, real*, real*, real*, real*, real*, real*, real*, real*);
+
+        void calc_maximum_thv_perturbation_cloud(real*, real*, real*, real*, real*, real*, real*);
+        void calc_liquid_water(real*, real*, real*, real*);   ///< Calculation of the liquid water at all levels.
+        void get_liquid_water(real*);                         ///< Copy the cached liquid water with zeroed ghost cells.
+        real* get_liquid_water_cache();                       ///< Return the cached liquid water, recalculated if outdated.
+        void invalidate_liquid_water() { ql_valid = false; } ///< Force a recalculation of the cached liquid water.
+        void calc_buoyancy_bot(real*, real*,
+                               real*, real*,
+                               real*, real*,
+                               real*, real*);
+        void calc_buoyancy_fluxbot(real*, real*, real*, real*, real*, real*);
 
         std::string swbasestate;
         double pbot;
         double thvref0; ///< Reference virtual potential temperature in case of Boussinesq
 
         // REFERENCE PROFILES
-        double* thl0;    // Initial thl profile 
-        double* qt0;     // Initial qt profile
-        double* thvref; 
-        double* thvrefh;
-        double* exnref;
-        double* exnrefh;
-        double* pref;
-        double* prefh;
+        real* thl0;    // Initial thl profile 
+        real* qt0;     // Initial qt profile
+        real* thvref; 
+        real* thvrefh;
+        real* exnref;
+        real* exnrefh;
+        real* pref;
+        real* prefh;
+
+        // Liquid water of the current prognostic state, shared by all consumers within a substep
+        real* qlcache;          ///< Cached liquid water at all levels.
+        bool ql_valid;          ///< Switch that marks the cached liquid water as up to date.
+        unsigned long ql_itime; ///< Integer model time at which the cached liquid water was calculated.
+        int ql_substep;         ///< Runge-Kutta substep at which the cached liquid water was calculated.
 
         // GPU functions and variables
-        double* thvref_g; 
-        double* thvrefh_g;
-        double* exnref_g;
-        double* exnrefh_g;
-        double* pref_g;
-        double* prefh_g;
+        real* thvref_g; 
+        real* thvrefh_g;
+        real* exnref_g;
+        real* exnrefh_g;
+        real* pref_g;
+        real* prefh_g;
 
         // Microphysics
         std::string swmicro; ///< Microphysics scheme
         std::string swmicrobudget; ///< Calculate budget statistics
+        std::string swmicrosubstep; ///< Sub-step the sedimentation instead of limiting the time step
+        std::string swmicrolookup;  ///< Interpolate the rain drop size distribution from lookup tables
         double cflmax_micro; ///< Maximum allowed CFL for sedimentation.
         void exec_microphysics();
 
+        // Bounding box of the grid points of an xz-slice that need microphysics, empty if istart == iend
+        struct Active_box
+        {
+            int istart;
+            int iend;
+            int kstart;
+            int kend;
+        };
+
+        std::vector<Active_box> cloud_boxes; ///< Per xz-slice bounding box of the cloud (ql > ql_min).
+        std::vector<Active_box> rain_boxes;  ///< Per xz-slice bounding box of the rain (qr > qr_min).
+        void calc_active_boxes(std::vector<Active_box>&, const real*, double); ///< Calculate the bounding boxes of all xz-slices.
+
+        // The threads share out the xz-slices, every thread has its own xz-slices for the intermediate quantities
+        static const int nmicroslices = 12;  ///< Number of xz-slices per thread.
+        std::vector<real> microslices;       ///< xz-slices of all threads.
+        real* get_micro_slices();            ///< Get the xz-slices of the calling thread.
+
+        double* rain_table;     ///< Lookup tables of the rain drop size distribution and fall speeds versus rain drop mass.
+        void init_rain_tables(); ///< Calculate the rain lookup tables.
+
 };
 #endif
@@ -8,6 +8,7 @@
 #  define CUDA_MACRO
 #endif
 
+#include "defines.h"
 #include "constants.h"
 
 namespace Thermo_moist_functions
@@ -68,5 +69,55 @@ namespace Thermo_moist_functions
     {
         return pow((p/p0),(Rd/cp));
     }
+
+    // Saturation adjustment, which returns the liquid water for given thl, qt, p and Exner function.
+    // A fixed number of Newton iterations without branches is done, such that loops over whole rows
+    // vectorize. The first iteration reuses qsat at the liquid water temperature of the unsaturated
+    // test. Three iterations give an error in ql below 1e-8 kg/kg for supersaturations up to 10%,
+    // which is smaller than that of the former iteration to a relative tolerance of 1e-5.
+    CUDA_MACRO inline double sat_adjust(const double thl, const double qt, const double p, const double exn)
+    {
+        const int niter = 3;
+
+        const double tl   = thl * exn;
+        const double qstl = qsat(p, tl);
+
+        double tnr = tl;
+        double qs  = qstl;
+        for (int n=0; n<niter; ++n)
+        {
+            tnr -= (tnr + (Lv/cp)*(qs-qt) - tl) / (1. + Lv*Lv*qs / (Rv*cp*tnr*tnr));
+            if (n+1 < niter)
+                qs = qsat(p, tnr);
+        }
+
+        // the liquid water follows from the conservation of the liquid water temperature
+        const double ql = (cp/Lv) * (tnr - tl);
+        return (qt > qstl && ql > 0.) ? ql : 0.;
+    }
+
+    // Saturation adjustment of a row of n points. The adjustment costs three qsat evaluations per point,
+    // therefore the row is first tested for saturation at the cost of one, and the adjustment is only
+    // done for rows with at least one saturated point. Both loops vectorize.
+    inline void sat_adjust_row(real* restrict ql, const real* restrict thl, const real* restrict qt,
+                               const double p, const double exn, const int n)
+    {
+        int nsat = 0;
+        #pragma ivdep
+        for (int i=0; i<n; ++i)
+            nsat += (qt[i] > qsat(p, thl[i]*exn));
+
+        if (nsat == 0)
+        {
+            for (int i=0; i<n; ++i)
+                ql[i] = 0.;
+        }
+        else
+        {
+            #pragma ivdep
+            for (int i=0; i<n; ++i)
+                ql[i] = sat_adjust(thl[i], qt[i], p, exn);
+        }
+    }
 }
 #endif
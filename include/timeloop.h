@@ -25,6 +25,7 @@
 
 #include <sys/time.h>
 #include <string>
+#include "defines.h"
 
 class Input;
 class Master;
@@ -50,6 +51,7 @@ class Timeloop
         double check();
 
         void save(int);
+        void save(int, unsigned long, unsigned long, int); ///< Saves the time file of a given time state.
         void load(int);
 
         // Query functions for main loop
@@ -67,6 +69,9 @@ class Timeloop
         unsigned long get_idt()   { return idt;   }
         int get_iotime()    { return iotime;    }
         int get_iteration() { return iteration; }
+        int get_substep()   { return substep;   }
+        std::string get_restart_switch() { return swrestart; }
+        std::string get_compress_switch() { return swcompress; }
 
     private:
         Master* master;
@@ -81,8 +86,8 @@ class Timeloop
 
         int outputiter;
 
-        void rk3(double*, double*, double);
-        void rk4(double*, double*, double);
+        void rk3(real*, real*, double);
+        void rk4(real*, real*, double);
 
         double rk3subdt(double);
         double rk4subdt(double);
@@ -116,5 +121,8 @@ class Timeloop
         unsigned long iiotimeprec;
 
         double ifactor;
+
+        std::string swrestart;  ///< Switch for writing the restarts as one file per field or as a single container.
+        std::string swcompress; ///< Switch for lossless compression of the restart files per field.
 };
 #endif
@@ -23,6 +23,8 @@
 #ifndef TOOLS
 #define TOOLS
 
+#include "defines.h"
+
 /* CUDA error checking, from: http://choorucode.com/2011/03/02/how-to-do-error-checking-in-cuda/
    In debug mode, CUDACHECKS is defined and all kernel calls are checked with cudaCheckError().
    All CUDA api calls are always checked with cudaSafeCall() */
@@ -34,8 +36,8 @@ namespace Tools_g
     enum ReduceType {sumType, maxType}; ///< Enumerator holding the different reduction types
     const int reduceMaxThreads = 512;   ///< Maximum number of threads used in reduce algorithms
 
-    void reduce_interior(double *, double *, int, int, int, int, int, int, int, int, int, int, ReduceType);
-    void reduce_all(double *, double *, int, int, int, ReduceType, double);
+    void reduce_interior(real *, real *, int, int, int, int, int, int, int, int, int, int, ReduceType);
+    void reduce_all(real *, real *, int, int, int, ReduceType, double);
 
     // Wrapper to check for errors in CUDA api calls (e.g. cudaMalloc)
     inline void __cuda_safe_call(cudaError err, const char *file, const int line)
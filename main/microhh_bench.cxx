@@ -0,0 +1,996 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <limits>
+#include "master.h"
+#include "input.h"
+#include "model.h"
+#include "grid.h"
+#include "fields.h"
+#include "boundary.h"
+#include "advec.h"
+#include "diff.h"
+#include "pres.h"
+#include "thermo.h"
+#include "stats.h"
+#include "timeloop.h"
+#include "thermo_moist_functions.h"
+#include "rain_functions.h"
+#include "tdma_functions.h"
+#include "defines.h"
+
+#ifdef USECUDA
+#include <cuda_runtime_api.h>
+#endif
+
+// The micro-benchmark builds the model on synthetic data, without any input files, and times the
+// individual kernels. The bandwidth is computed from the number of 3d fields a kernel has to stream
+// at minimum, where a field that is read and written counts twice. It is a nominal number that is
+// meant to compare the kernels with each other and with the STREAM bandwidth of the machine.
+namespace
+{
+    struct Bench_settings
+    {
+        int itot;
+        int jtot;
+        int ktot;
+        int npx;
+        int npy;
+        int nthreads;
+        int niter;
+    };
+
+    void print_usage(Master& master)
+    {
+        master.print_message("Usage: microhh_bench [--itot N] [--jtot N] [--ktot N] [--niter N] [--npx N] [--npy N] [--nthreads N]\n");
+    }
+
+    void parse_arguments(Master& master, Bench_settings& settings, int argc, char *argv[])
+    {
+        for (int n=1; n<argc; n+=2)
+        {
+            int* value = 0;
+            if (std::strcmp(argv[n], "--itot") == 0)
+                value = &settings.itot;
+            else if (std::strcmp(argv[n], "--jtot") == 0)
+                value = &settings.jtot;
+            else if (std::strcmp(argv[n], "--ktot") == 0)
+                value = &settings.ktot;
+            else if (std::strcmp(argv[n], "--niter") == 0)
+                value = &settings.niter;
+            else if (std::strcmp(argv[n], "--npx") == 0)
+                value = &settings.npx;
+            else if (std::strcmp(argv[n], "--npy") == 0)
+                value = &settings.npy;
+            else if (std::strcmp(argv[n], "--nthreads") == 0)
+                value = &settings.nthreads;
+
+            if (value == 0 || n+1 == argc || std::atoi(argv[n+1]) < 1)
+            {
+                print_usage(master);
+                throw 1;
+            }
+
+            *value = std::atoi(argv[n+1]);
+        }
+    }
+
+    std::string to_string(const double value)
+    {
+        char buffer[32];
+        std::sprintf(buffer, "%.8g", value);
+        return std::string(buffer);
+    }
+
+    // Fill the input with a setup that uses all the kernels of the given spatial order. The 2nd order
+    // setup is a moist LES with rain, the 4th order setup is a DNS, as the moist thermodynamics are 2nd order only.
+    void set_input(Input& input, const Bench_settings& settings, const std::string& swspatialorder)
+    {
+        const double dx = 50.;
+        const double dz = 25.;
+        const double zsize = settings.ktot*dz;
+
+        input.set_item("master", "npx"     , "", to_string(settings.npx));
+        input.set_item("master", "npy"     , "", to_string(settings.npy));
+        input.set_item("master", "nthreads", "", to_string(settings.nthreads));
+
+        input.set_item("grid", "itot"          , "", to_string(settings.itot));
+        input.set_item("grid", "jtot"          , "", to_string(settings.jtot));
+        input.set_item("grid", "ktot"          , "", to_string(settings.ktot));
+        input.set_item("grid", "xsize"         , "", to_string(settings.itot*dx));
+        input.set_item("grid", "ysize"         , "", to_string(settings.jtot*dx));
+        input.set_item("grid", "zsize"         , "", to_string(zsize));
+        input.set_item("grid", "swspatialorder", "", swspatialorder);
+        input.set_item("grid", "fftwplanner"   , "", "measure");
+
+        input.set_item("time", "starttime"   , "", "0");
+        input.set_item("time", "endtime"     , "", "1");
+        input.set_item("time", "savetime"    , "", "1");
+        input.set_item("time", "dt"          , "", "1");
+        input.set_item("time", "adaptivestep", "", "false");
+
+        input.set_item("fields", "visc"  , "", "1.e-5");
+        input.set_item("fields", "svisc" , "", "1.e-5");
+        input.set_item("fields", "rndamp", "", "0.1");
+        input.set_item("fields", "rndz"  , "", to_string(zsize));
+
+        input.set_item("boundary", "mbcbot", "", "noslip");
+        input.set_item("boundary", "mbctop", "", "freeslip");
+        input.set_item("boundary", "sbcbot", "", "dirichlet");
+        input.set_item("boundary", "sbctop", "", "neumann");
+        input.set_item("boundary", "sbot"  , "", "0");
+        input.set_item("boundary", "stop"  , "", "0");
+
+        std::vector<double> z(settings.ktot), u(settings.ktot), thl(settings.ktot), qt(settings.ktot);
+        for (int k=0; k<settings.ktot; ++k)
+        {
+            z  [k] = (k+0.5)*dz;
+            u  [k] = 5.;
+            thl[k] = 298. + 0.004*z[k];
+            qt [k] = std::max(0.017 - 6.e-6*std::max(z[k]-500., 0.), 1.e-3);
+        }
+        input.set_prof("z", z);
+        input.set_prof("u", u);
+
+        if (swspatialorder == "2")
+        {
+            input.set_item("advec", "swadvec", "", "2");
+            input.set_item("diff" , "swdiff" , "", "smag2");
+
+            input.set_item("boundary", "swboundary", "", "surface_bulk");
+            input.set_item("boundary", "sbot"      , "thl", "298.5");
+            input.set_item("boundary", "sbot"      , "qt" , "0.0217");
+            input.set_item("boundary", "bulk_cm"   , "", "0.001229");
+            input.set_item("boundary", "bulk_cs"   , "", "0.0011");
+            input.set_item("boundary", "z0m"       , "", "0.0002");
+            input.set_item("boundary", "z0h"       , "", "0.0002");
+
+            input.set_item("thermo", "swthermo"         , "", "moist");
+            input.set_item("thermo", "swbasestate"      , "", "anelastic");
+            input.set_item("thermo", "swupdatebasestate", "", "0");
+            input.set_item("thermo", "pbot"             , "", "101540.");
+            #ifndef USECUDA
+            input.set_item("thermo", "swmicro"          , "", "2mom_warm");
+            #endif
+
+            input.set_item("fields", "rndamp", "thl", "0.1");
+            input.set_item("fields", "rndamp", "qt" , "2.5e-5");
+
+            input.set_prof("thl", thl);
+            input.set_prof("qt" , qt );
+        }
+        else
+        {
+            input.set_item("advec", "swadvec", "", "4");
+            input.set_item("diff" , "swdiff" , "", "4");
+        }
+    }
+
+    // The former saturation adjustment, a Newton iteration until the relative change in temperature
+    // is below 1e-5, that returns the liquid water from qsat of the previous iterate.
+    double sat_adjust_former(const double thl, const double qt, const double p, const double exn)
+    {
+        using namespace Thermo_moist_functions;
+
+        const int nitermax = 30;
+        const double tl = thl * exn;
+
+        if (qt-qsat(p, tl) <= 0)
+            return 0.;
+
+        int niter = 0;
+        double tnr_old = 1.e9;
+        double tnr = tl;
+        double qs = 0;
+        while (std::fabs(tnr-tnr_old)/tnr_old > 1.e-5 && niter < nitermax)
+        {
+            ++niter;
+            tnr_old = tnr;
+            qs = qsat(p, tnr);
+            tnr = tnr - (tnr+(Lv/cp)*qs-tl-(Lv/cp)*qt)/(1+(Lv*Lv*qs)/(Rv*cp*tnr*tnr));
+        }
+
+        return std::max(0., qt - qs);
+    }
+
+    // The converged liquid water, found by bisection of T + Lv/cp*(qsat(T)-qt) - Tl, which increases
+    // monotonically between Tl and the temperature at which all excess water has condensed at qsat(Tl).
+    double sat_adjust_bisection(const double thl, const double qt, const double p, const double exn)
+    {
+        using namespace Thermo_moist_functions;
+
+        const double tl   = thl * exn;
+        const double qstl = qsat(p, tl);
+
+        if (qt <= qstl)
+            return 0.;
+
+        double tmin = tl;
+        double tmax = tl + (Lv/cp)*(qt - qstl);
+        for (int n=0; n<100; ++n)
+        {
+            const double t = 0.5*(tmin + tmax);
+            if (t + (Lv/cp)*(qsat(p, t) - qt) - tl > 0.)
+                tmax = t;
+            else
+                tmin = t;
+        }
+
+        return (cp/Lv)*(0.5*(tmin + tmax) - tl);
+    }
+
+    // Compare the saturation adjustment of the model and the former one with the converged solution
+    // for p = 200-1050 hPa, Tl = 200-320 K and qt from 0.5 to 2 times qsat(Tl). States with more than
+    // 0.05 kg/kg of total water are skipped: they only occur at low pressures and high temperatures,
+    // where the saturation curve has a second solution and the check is meaningless.
+    void check_sat_adjust(Master& master)
+    {
+        using namespace Thermo_moist_functions;
+
+        const double qtmax = 0.05;
+        double error_new[2] = {0., 0.};
+        double error_old[2] = {0., 0.};
+
+        for (int ip=0; ip<=85; ++ip)
+            for (int it=0; it<=120; ++it)
+                for (int iq=0; iq<=150; ++iq)
+                {
+                    const double p   = 2.e4 + ip*1.e3;
+                    const double tl  = 200. + it;
+                    const double exn = exner(p);
+                    const double thl = tl/exn;
+                    const double qt  = (0.5 + iq*0.01)*qsat(p, tl);
+
+                    if (qt > qtmax)
+                        continue;
+
+                    const double ql_ref = sat_adjust_bisection(thl, qt, p, exn);
+                    const int n = iq <= 60 ? 0 : 1;
+                    error_new[n] = std::max(error_new[n], std::abs(sat_adjust       (thl, qt, p, exn) - ql_ref));
+                    error_old[n] = std::max(error_old[n], std::abs(sat_adjust_former(thl, qt, p, exn) - ql_ref));
+                }
+
+        error_new[1] = std::max(error_new[0], error_new[1]);
+        error_old[1] = std::max(error_old[0], error_old[1]);
+
+        master.print_message("%-32s %12s %12s\n", "sat_adjust max error ql (kg/kg)", "current", "former");
+        master.print_message("%-32s %12.4E %12.4E\n", "  qt <= 1.1 qsat(Tl)", error_new[0], error_old[0]);
+        master.print_message("%-32s %12.4E %12.4E\n", "  qt <= 2.0 qsat(Tl)", error_new[1], error_old[1]);
+
+        // The current scheme has to stay within the errors that were found when it was introduced.
+        if (error_new[0] > 1.e-8 || error_new[1] > 1.e-6)
+        {
+            master.print_error("the saturation adjustment deviates from the converged solution\n");
+            throw 1;
+        }
+    }
+
+    // Compare the rain lookup tables with the direct evaluation of the drop size distribution over the full
+    // range of the mean rain drop mass, at 64 points per table interval, such that the midpoints, where the
+    // interpolation error peaks, are included. The bounds are the maximum errors stated with the tables.
+    void check_rain_tables(Master& master)
+    {
+        using namespace Rain_functions;
+
+        std::vector<double> table(Rain_table_ncolumns*nrain_table);
+        calc_rain_tables(table.data());
+
+        const char* names[] = {"  diameter", "  mu_r", "  lambda_r", "  fall speed reduction qr", "  fall speed reduction nr"};
+        const double bounds[] = {1.2e-6, 5.e-6, 2.2e-6, 4.4e-7, 4.4e-7};
+        double errors[Rain_table_ncolumns] = {0.};
+
+        const int nsamples = 64*(nrain_table-1);
+        for (int n=0; n<=nsamples; ++n)
+        {
+            const double mr = std::exp(lnmr_min + n*dlnmr_table/64.);
+            const double dr = calc_rain_diameter(std::min(mr, mr_max));
+            const double mur = calc_mu_r(dr);
+            const double lambdar = calc_lambda_r(mur, dr);
+            const double exact[] = {dr, mur, lambdar, calc_w_reduction(mur, lambdar, 4.), calc_w_reduction(mur, lambdar, 1.)};
+
+            const double index = calc_rain_table_index(mr);
+            for (int c=0; c<Rain_table_ncolumns; ++c)
+            {
+                const double value = interp_rain_table(table.data(), static_cast<Rain_table_column>(c), index);
+                errors[c] = std::max(errors[c], std::abs(value/exact[c] - 1.));
+            }
+        }
+
+        master.print_message("%-32s %12s %12s\n", "rain tables max rel. error", "table", "bound");
+        bool failed = false;
+        for (int c=0; c<Rain_table_ncolumns; ++c)
+        {
+            master.print_message("%-32s %12.4E %12.4E\n", names[c], errors[c], bounds[c]);
+            if (errors[c] > bounds[c])
+                failed = true;
+        }
+
+        if (failed)
+        {
+            master.print_error("the rain lookup tables exceed their stated interpolation error\n");
+            throw 1;
+        }
+    }
+
+    // Integrate the sedimentation of a single column in nsteps steps of dt, the drop size distribution
+    // at the start of every step is computed directly, as without the lookup tables.
+    void sediment_column(std::vector<real>& qr, std::vector<real>& nr, const std::vector<real>& rho,
+                         const std::vector<real>& dz, const std::vector<real>& dzi,
+                         const double dt, const double cflmax, const int nsteps)
+    {
+        using namespace Rain_functions;
+
+        const int kcells = qr.size();
+        const int kstart = 1;
+        const int kend   = kcells-1;
+
+        std::vector<real> qrt(kcells), nrt(kcells), rain_mass(kcells), mu_r(kcells), lambda_r(kcells);
+        std::vector<real> tmpxz(8*kcells);
+
+        for (int n=0; n<nsteps; ++n)
+        {
+            for (int k=kstart; k<kend; ++k)
+            {
+                qrt[k] = 0.;
+                nrt[k] = 0.;
+                rain_mass[k] = calc_rain_mass(qr[k], nr[k], rho[k]);
+                const double dr = calc_rain_diameter(rain_mass[k]);
+                mu_r[k] = calc_mu_r(dr);
+                lambda_r[k] = calc_lambda_r(mu_r[k], dr);
+            }
+
+            sedimentation_ss08(qrt.data(), nrt.data(),
+                               &tmpxz[0*kcells], &tmpxz[1*kcells], &tmpxz[2*kcells], &tmpxz[3*kcells],
+                               &tmpxz[4*kcells], &tmpxz[5*kcells], &tmpxz[6*kcells], &tmpxz[7*kcells],
+                               rain_mass.data(), mu_r.data(), lambda_r.data(), 0,
+                               qr.data(), nr.data(), rho.data(), dzi.data(), dz.data(), dt, cflmax,
+                               0, 0, kstart,
+                               1, 1, kend,
+                               1, kcells, 1, 0);
+
+            for (int k=kstart; k<kend; ++k)
+            {
+                qr[k] += dt*qrt[k];
+                nr[k] += dt*nrt[k];
+            }
+        }
+    }
+
+    // A rain shaft of 140 m at 1.4 km height falls for 30 s through a column of 20 m levels, which is a
+    // sedimentation CFL number of about 7. The sub-stepped sedimentation with cflmax = 1 has to conserve the
+    // rain, keep it positive and give the fall speed of a reference with 0.1 s steps within 5%. A single
+    // step is listed for comparison, it underestimates the fall speed by a third.
+    void check_rain_sedimentation(Master& master)
+    {
+        const int kmax = 100;
+        const int kcells = kmax+2;
+        const double dzc = 20.;
+        const double time = 30.;
+
+        std::vector<real> rho(kcells), z(kcells), dz(kcells, dzc), dzi(kcells, 1./dzc);
+        std::vector<real> qr0(kcells, 0.), nr0(kcells, 0.);
+        for (int k=0; k<kcells; ++k)
+        {
+            z  [k] = (k-0.5)*dzc;
+            rho[k] = 1.2*std::exp(-z[k]/8000.);
+        }
+        for (int k=71; k<78; ++k)
+        {
+            qr0[k] = 1.e-3;
+            nr0[k] = rho[k]*qr0[k]/1.e-7;
+        }
+
+        const char* names[] = {"  single step", "  sub-stepped", "  reference"};
+        const double dts[] = {time, time, 0.1};
+        const double cflmaxs[] = {Constants::dhuge, 1., Constants::dhuge};
+
+        double mass0 = 0., number0 = 0., zmass0 = 0.;
+        for (int k=1; k<kmax+1; ++k)
+        {
+            mass0   += rho[k]*dz[k]*qr0[k];
+            number0 += rho[k]*dz[k]*nr0[k];
+            zmass0  += rho[k]*dz[k]*qr0[k]*z[k];
+        }
+
+        double wfall[3], error_mass[3], error_number[3], qrmin[3];
+        for (int n=0; n<3; ++n)
+        {
+            std::vector<real> qr(qr0), nr(nr0);
+            sediment_column(qr, nr, rho, dz, dzi, dts[n], cflmaxs[n], static_cast<int>(time/dts[n] + 0.5));
+
+            double mass = 0., number = 0., zmass = 0.;
+            qrmin[n] = 0.;
+            for (int k=1; k<kmax+1; ++k)
+            {
+                mass   += rho[k]*dz[k]*qr[k];
+                number += rho[k]*dz[k]*nr[k];
+                zmass  += rho[k]*dz[k]*qr[k]*z[k];
+                qrmin[n] = std::min(qrmin[n], static_cast<double>(qr[k]));
+            }
+
+            wfall[n] = (zmass0/mass0 - zmass/mass)/time;
+            error_mass[n] = std::abs(mass/mass0 - 1.);
+            error_number[n] = std::abs(number/number0 - 1.);
+        }
+
+        master.print_message("%-32s %12s %12s %12s %12s\n", "rain sedimentation column", "w (m/s)", "err mass", "err number", "min qr");
+        for (int n=0; n<3; ++n)
+            master.print_message("%-32s %12.4f %12.4E %12.4E %12.4E\n", names[n], wfall[n], error_mass[n], error_number[n], qrmin[n]);
+
+        const double tolerance = 1.e-6;
+        if (error_mass[1] > tolerance || error_number[1] > tolerance || qrmin[1] < 0. ||
+            std::abs(wfall[1]/wfall[2] - 1.) > 0.05)
+        {
+            master.print_error("the sub-stepped rain sedimentation does not match the reference column\n");
+            throw 1;
+        }
+    }
+
+    // Solve a random diagonally dominant system of ncol columns and ktot levels with the partitioned solver
+    // in npart partitions, as the processes in the x-direction of Pres_2 do, and return the maximum error
+    // relative to the serial solver. The first ktot%npart partitions hold one level more.
+    double calc_tdma_partitioned_error(const int ktot, const int npart)
+    {
+        using namespace Tdma_functions;
+
+        const int ncol = 16;
+        std::srand(ktot + 100*npart);
+        std::vector<real> a(ktot), c(ktot), b(ktot*ncol), rhs(ktot*ncol);
+        for (int k=0; k<ktot; ++k)
+        {
+            a[k] = 0.5 + 0.5*std::rand()/RAND_MAX;
+            c[k] = 0.5 + 0.5*std::rand()/RAND_MAX;
+            for (int ij=0; ij<ncol; ++ij)
+            {
+                b  [ij + k*ncol] = -(a[k] + c[k]) - 0.5 - 0.5*std::rand()/RAND_MAX;
+                rhs[ij + k*ncol] = 2.*std::rand()/RAND_MAX - 1.;
+            }
+        }
+
+        std::vector<real> p(rhs), work2d(ncol), work3d(ktot*ncol);
+        tdma(a.data(), b.data(), c.data(), p.data(), work2d.data(), work3d.data(), 0, ncol, ncol, ktot);
+
+        // the partitions keep their levels, couplings and factors until the separators are known
+        std::vector<int> kofs(npart+1, 0);
+        for (int q=0; q<npart; ++q)
+            kofs[q+1] = kofs[q] + ktot/npart + (q < ktot%npart ? 1 : 0);
+
+        std::vector<real> pp(rhs), bp(b), work3d_l(ktot*ncol), work3d_r(ktot*ncol), r(7*ncol*npart);
+        for (int q=0; q<npart; ++q)
+        {
+            const int ijk = kofs[q]*ncol;
+            solve_partition(a.data(), &bp[ijk], c.data(), &pp[ijk], work2d.data(), &work3d_l[ijk], &work3d_r[ijk],
+                            &r[7*ncol*q], 0, ncol, ncol, kofs[q], kofs[q+1]-kofs[q], q > 0, q < npart-1);
+        }
+
+        solve_reduced(r.data(), work2d.data(), 0, ncol, ncol, npart);
+
+        double error = 0.;
+        for (int q=0; q<npart; ++q)
+        {
+            const int ijk = kofs[q]*ncol;
+            substitute_separators(&pp[ijk], &work3d_l[ijk], &work3d_r[ijk], r.data(), 0, ncol, ncol, kofs[q+1]-kofs[q], q);
+        }
+        for (int n=0; n<ktot*ncol; ++n)
+            error = std::max(error, std::abs(static_cast<double>(pp[n] - p[n])) / std::abs(static_cast<double>(p[n])));
+
+        return error;
+    }
+
+    // The partitioned tridiagonal solver has to give the solution of the serial one for partitions of equal
+    // size, for partitions that differ in size and for a single partition.
+    void check_tdma_partitioned(Master& master)
+    {
+        const int ktots[] = {64, 67, 30, 64};
+        const int nparts[] = {4, 4, 7, 1};
+        const int ncases = sizeof(ktots)/sizeof(ktots[0]);
+        const double tolerance = (sizeof(real) == 4) ? 1.e-3 : 1.e-10;
+
+        master.print_message("%-32s %12s %12s\n", "tdma partitioned/serial", "rel. error", "bound");
+        bool failed = false;
+        for (int n=0; n<ncases; ++n)
+        {
+            char name[64];
+            std::sprintf(name, "  ktot = %d, npart = %d", ktots[n], nparts[n]);
+            const double error = calc_tdma_partitioned_error(ktots[n], nparts[n]);
+            master.print_message("%-32s %12.4E %12.4E\n", name, error, tolerance);
+            if (!(error <= tolerance))
+                failed = true;
+        }
+
+        if (failed)
+        {
+            master.print_error("the partitioned tridiagonal solver does not match the serial solver\n");
+            throw 1;
+        }
+    }
+
+    // The statistics are not created in the bench, so the masks and the profiles of u that the kernels
+    // write are set up here. The profiles of all masks share one array.
+    const char* bench_prof_names[] = {"area", "w", "u", "u2", "u3", "u4", "uw", "ugrad", "udiff", "uflux"};
+    const int bench_nprofs = sizeof(bench_prof_names)/sizeof(bench_prof_names[0]);
+
+    void create_bench_masks(Model& model, std::vector<Mask>& masks, std::vector<double>& profs)
+    {
+        Grid& grid = *model.grid;
+        Stats& stats = *model.stats;
+        Field3d* mfield  = model.fields->atmp["tmp3"];
+        Field3d* mfieldh = model.fields->atmp["tmp4"];
+
+        profs.assign(masks.size()*bench_nprofs*grid.kcells, 0.);
+        for (size_t n=0; n<masks.size(); ++n)
+            for (int np=0; np<bench_nprofs; ++np)
+                masks[n].profs[bench_prof_names[np]].data = &profs[(n*bench_nprofs + np)*grid.kcells];
+
+        // The first mask is the full domain, the others are the masks of the fields.
+        stats.clear_masks();
+        for (size_t n=0; n<masks.size(); ++n)
+        {
+            if (n == 0)
+                stats.get_mask(mfield, mfieldh, &masks[n]);
+            else
+                model.fields->get_mask(mfield, mfieldh, &masks[n]);
+            stats.store_mask(mfield, mfieldh, &masks[n]);
+        }
+    }
+
+    // Compute the statistics of u of the selected masks as the fields do.
+    void calc_bench_stats(Model& model)
+    {
+        Grid& grid = *model.grid;
+        Fields& fields = *model.fields;
+        Stats& stats = *model.stats;
+
+        const int sloc[] = {0,0,0};
+        const int uloc[] = {1,0,0};
+        const int wloc[] = {0,0,1};
+
+        stats.calc_area("area", sloc);
+        stats.calc_mean("w", fields.w->data, 0., wloc);
+        stats.calc_mean("u", fields.u->data, grid.utrans, uloc);
+        stats.reduce_profs();
+
+        // the eddy viscosity only exists with the Smagorinsky diffusion
+        real* evisc = fields.sd.count("evisc") ? fields.sd["evisc"]->data : 0;
+        stats.calc_moments_fluxes(fields.u->data, "u", grid.utrans, "u2", "u3", "u4",
+                                  fields.w->data, fields.atmp["tmp2"]->data, "uw", "ugrad", "udiff", fields.visc,
+                                  evisc, fields.u->datafluxbot, fields.u->datafluxtop, 1., uloc);
+
+        stats.add_fluxes("uflux", "uw", "udiff");
+        stats.reduce_profs();
+    }
+
+    // The statistics of a mask have to be the same whether they are computed in the sweep over all masks
+    // or in a sweep over that mask alone.
+    void check_stats_masks(Master& master, Model& model)
+    {
+        std::vector<Mask> masks(2);
+        masks[0].name = "default";
+        masks[1].name = "wplus";
+
+        std::vector<double> profs;
+        create_bench_masks(model, masks, profs);
+        Stats& stats = *model.stats;
+
+        stats.select_masks(0, masks.size());
+        calc_bench_stats(model);
+        const std::vector<double> profs_all(profs);
+
+        std::fill(profs.begin(), profs.end(), 0.);
+        for (size_t n=0; n<masks.size(); ++n)
+        {
+            stats.select_masks(n, n+1);
+            calc_bench_stats(model);
+        }
+
+        int nmismatch = 0;
+        for (size_t n=0; n<profs.size(); ++n)
+            if (profs[n] != profs_all[n])
+                ++nmismatch;
+
+        if (nmismatch == 0)
+            master.print_message("%-32s %12s\n", "  stats one mask/all masks", "IDENTICAL");
+        else
+        {
+            master.print_error("%d values of the statistics of one mask differ from those of all masks\n", nmismatch);
+            throw 1;
+        }
+    }
+
+    void synchronize()
+    {
+        #ifdef USECUDA
+        cudaDeviceSynchronize();
+        #endif
+    }
+
+    // Time a kernel over a number of iterations after a single warm-up call and print the
+    // time per call of the slowest process, the nominal bandwidth and the grid point throughput.
+    template<class Kernel>
+    void time_kernel(Master& master, Grid& grid, const int niter, const std::string& name,
+                     const double nfields, Kernel kernel)
+    {
+        kernel();
+        synchronize();
+
+        const double start = master.get_wall_clock_time();
+        for (int n=0; n<niter; ++n)
+            kernel();
+        synchronize();
+        double time = (master.get_wall_clock_time() - start) / niter;
+        master.max(&time, 1);
+
+        const double npoints = (double)grid.itot * (double)grid.jtot * (double)grid.ktot;
+        const double nbytes  = nfields * npoints * sizeof(real);
+
+        master.print_message("%-32s %12.4E %10.2f %12.4E\n", name.c_str(), time, nbytes/time*1.e-9, npoints/time);
+    }
+
+    void run_bench(Master& master, const Bench_settings& settings, const std::string& swspatialorder, bool& master_initialized)
+    {
+        Input input(&master, false);
+        set_input(input, settings, swspatialorder);
+
+        Model model(&master, &input);
+
+        // Create the schemes that are not selected by the input, before the grid is initialized
+        // because they can increase the number of ghost cells.
+        input.set_item("advec", "swadvec", "", swspatialorder == "2" ? "2i4" : "4m");
+        Advec* advec_alt = Advec::factory(&master, &input, &model, swspatialorder);
+        input.set_item("advec", "swadvec", "", swspatialorder == "2" ? "2" : "4");
+
+        Diff* diff_alt = 0;
+        if (swspatialorder == "2")
+        {
+            input.set_item("diff", "swdiff", "", "2");
+            diff_alt = Diff::factory(&master, &input, &model, swspatialorder);
+            input.set_item("diff", "swdiff", "", "smag2");
+        }
+
+        // The advection scheme with SIMD entry points is created for each instruction set that the processor
+        // supports, to time the entry points and to compare their tendencies with those of the default one.
+        std::vector<Advec*> advec_simd;
+        const std::string swadvec_simd = swspatialorder == "2" ? "2i4" : "4";
+        const char* simd_isas[] = {"default", "avx2", "avx512"};
+        input.set_item("advec", "swadvec", "", swadvec_simd);
+        for (int n=0; n<3; ++n)
+            if (Advec::is_simd_supported(simd_isas[n]))
+            {
+                input.set_item("advec", "swsimd", "", simd_isas[n]);
+                advec_simd.push_back(Advec::factory(&master, &input, &model, swspatialorder));
+            }
+        input.set_item("advec", "swsimd" , "", "default");
+        input.set_item("advec", "swadvec", "", swspatialorder);
+
+        // The fused advection-diffusion path is compared with the default one, which calls the
+        // advection and the diffusion after each other.
+        Advec* advec_fused = 0;
+        Diff*  diff_fused  = 0;
+        #ifndef USECUDA
+        if (swspatialorder == "2")
+        {
+            input.set_item("diff", "swfusedadvec", "", "1");
+            advec_fused = Advec::factory(&master, &input, &model, swspatialorder);
+            diff_fused  = Diff ::factory(&master, &input, &model, swspatialorder);
+            input.set_item("diff", "swfusedadvec", "", "0");
+        }
+        #endif
+
+        try
+        {
+            if (!master_initialized)
+            {
+                master.init(&input);
+                master_initialized = true;
+            }
+
+            model.init();
+
+            Grid&   grid   = *model.grid;
+            Fields& fields = *model.fields;
+
+            // Create the data in memory instead of loading it from disk.
+            grid.create(&input);
+            grid.create_fftw_plans();
+            fields.create(&input);
+
+            model.boundary->create(&input);
+            model.thermo  ->create(&input);
+            model.boundary->set_values();
+            model.diff    ->set_values();
+            model.pres    ->set_values();
+
+            #ifdef USECUDA
+            grid.prepare_device();
+            fields.prepare_device();
+            model.thermo  ->prepare_device();
+            model.boundary->prepare_device();
+            model.diff    ->prepare_device();
+            model.pres    ->prepare_device();
+            if (diff_alt)
+                diff_alt->prepare_device();
+            #endif
+
+            // Set the boundary conditions and the eddy viscosity as in the first model step.
+            model.boundary->update_time_dependent();
+            model.boundary->exec();
+            fields.exec();
+            model.diff->exec_viscosity();
+
+            const int niter = settings.niter;
+            const double nprog = fields.ap.size();
+            const double dt = model.timeloop->get_sub_time_step();
+
+            master.print_message("\nBenchmark of the %s order kernels on %d x %d x %d grid points, %d iterations\n",
+                                 swspatialorder == "2" ? "2nd" : "4th", grid.itot, grid.jtot, grid.ktot, niter);
+            master.print_message("%-32s %12s %10s %12s\n", "KERNEL", "TIME (s)", "GB/s", "POINTS/s");
+
+            // Advection and diffusion read all prognostic fields and update their tendencies.
+            time_kernel(master, grid, niter, "Advec_" + model.advec->get_switch(), 3*nprog, [&]{ model.advec->exec(); });
+            time_kernel(master, grid, niter, "Advec_" + advec_alt  ->get_switch(), 3*nprog, [&]{ advec_alt  ->exec(); });
+            for (size_t n=0; n<advec_simd.size(); ++n)
+                time_kernel(master, grid, niter, "Advec_" + swadvec_simd + " " + advec_simd[n]->get_simd_switch(), 3*nprog,
+                            [&]{ advec_simd[n]->exec(); });
+
+            // The instruction sets with FMA round differently, therefore the tendencies are compared with a tolerance
+            // relative to the largest tendency.
+            std::vector< std::vector<real> > tend_default;
+            for (size_t n=0; n<advec_simd.size(); ++n)
+            {
+                for (FieldMap::const_iterator it=fields.at.begin(); it!=fields.at.end(); ++it)
+                    std::fill(it->second->data, it->second->data + grid.ncells, 0.);
+                advec_simd[n]->exec();
+
+                if (n == 0)
+                {
+                    for (FieldMap::const_iterator it=fields.at.begin(); it!=fields.at.end(); ++it)
+                        tend_default.push_back(std::vector<real>(it->second->data, it->second->data + grid.ncells));
+                    continue;
+                }
+
+                double diff[2] = {0., 0.};
+                int nt = 0;
+                for (FieldMap::const_iterator it=fields.at.begin(); it!=fields.at.end(); ++it, ++nt)
+                    for (int ijk=0; ijk<grid.ncells; ++ijk)
+                    {
+                        diff[0] = std::max(diff[0], (double)std::abs(it->second->data[ijk] - tend_default[nt][ijk]));
+                        diff[1] = std::max(diff[1], (double)std::abs(tend_default[nt][ijk]));
+                    }
+                master.max(diff, 2);
+
+                const double reldiff = diff[0] / std::max(diff[1], Constants::dsmall);
+                master.print_message("%-32s %12.4E\n", ("  max rel. diff " + advec_simd[n]->get_simd_switch() + "/default").c_str(), reldiff);
+                if (reldiff > 1.e3*std::numeric_limits<real>::epsilon())
+                {
+                    master.print_error("the tendencies of swsimd=\"%s\" differ from the default ones\n",
+                                       advec_simd[n]->get_simd_switch().c_str());
+                    throw 1;
+                }
+            }
+
+            if (diff_alt)
+                time_kernel(master, grid, niter, "Diff_" + diff_alt->get_switch(), 3*nprog, [&]{ diff_alt->exec(); });
+            time_kernel(master, grid, niter, "Diff_" + model.diff->get_switch(), 3*nprog + 1, [&]{ model.diff->exec(); });
+
+            if (advec_fused)
+            {
+                // Each velocity tendency is updated once by the advection, which reads the three velocity
+                // components, and once by the diffusion, which reads the eddy viscosity as well. The fused
+                // kernels read the velocities and the eddy viscosity once and update the tendency once.
+                // The scalars are treated the same in both paths.
+                const double nscalars = fields.sp.size();
+                const double nunfused = 3*(3 + 2) + 3*(4 + 2) + nscalars*(6 + 4);
+                const double nfused   = 3*(4 + 2)             + nscalars*(6 + 4);
+
+                time_kernel(master, grid, niter, "Advec_2+Diff_smag2 unfused", nunfused,
+                            [&]{ model.advec->exec(); model.diff->exec(); });
+                time_kernel(master, grid, niter, "Advec_2+Diff_smag2 fused", nfused,
+                            [&]{ advec_fused->exec(); diff_fused->exec(); });
+                master.print_message("%-32s %12.0f %12.0f\n", "  bytes per grid point unf/fused",
+                                     nunfused*sizeof(real), nfused*sizeof(real));
+
+                // The tendencies of both paths have to be bitwise identical.
+                std::vector< std::vector<real> > tend_unfused;
+                for (FieldMap::const_iterator it=fields.at.begin(); it!=fields.at.end(); ++it)
+                    std::fill(it->second->data, it->second->data + grid.ncells, 0.);
+                model.advec->exec();
+                model.diff->exec();
+                for (FieldMap::const_iterator it=fields.at.begin(); it!=fields.at.end(); ++it)
+                    tend_unfused.push_back(std::vector<real>(it->second->data, it->second->data + grid.ncells));
+
+                for (FieldMap::const_iterator it=fields.at.begin(); it!=fields.at.end(); ++it)
+                    std::fill(it->second->data, it->second->data + grid.ncells, 0.);
+                advec_fused->exec();
+                diff_fused->exec();
+
+                int nmismatch = 0;
+                int nt = 0;
+                for (FieldMap::const_iterator it=fields.at.begin(); it!=fields.at.end(); ++it, ++nt)
+                    for (int n=0; n<grid.ncells; ++n)
+                        if (it->second->data[n] != tend_unfused[nt][n])
+                            ++nmismatch;
+                master.sum(&nmismatch, 1);
+
+                if (nmismatch == 0)
+                    master.print_message("%-32s %12s\n", "  fused tendencies", "IDENTICAL");
+                else
+                {
+                    master.print_error("%d tendencies of the fused advection-diffusion differ from the unfused ones\n", nmismatch);
+                    throw 1;
+                }
+            }
+
+            // The pressure solver reads the velocities and their tendencies, and writes the pressure
+            // that is transformed forth and back and subtracted from the velocity tendencies.
+            time_kernel(master, grid, niter, "Pres_" + swspatialorder + " solve", 22, [&]{ model.pres->exec(dt); });
+            if (swspatialorder == "2")
+                check_tdma_partitioned(master);
+
+            if (model.thermo->get_switch() == "moist")
+            {
+                Field3d* tmp1 = fields.atmp["tmp1"];
+
+                // The saturation adjustment reads thl and qt and writes ql. It is timed by calling the row function
+                // of the kernels directly, as the ql field of the thermodynamics is cached per model state, and
+                // compared with the former Newton iteration ("old"). This is done for the bench state, which is mostly
+                // unsaturated, and for a state that is saturated everywhere ("sat"). The pressure is a hydrostatic
+                // profile at a constant temperature.
+                check_sat_adjust(master);
+                check_rain_tables(master);
+                check_rain_sedimentation(master);
+
+                std::vector<double> p(grid.kcells), exn(grid.kcells);
+                for (int k=0; k<grid.kcells; ++k)
+                {
+                    p  [k] = 101540.*std::exp(-Constants::grav*grid.z[k]/(Constants::Rd*300.));
+                    exn[k] = Thermo_moist_functions::exner(p[k]);
+                }
+
+                const real* restrict thl = fields.sp["thl"]->data;
+                real* restrict ql = tmp1->data;
+                real* restrict qtsat = fields.atmp["tmp2"]->data;
+                for (int k=grid.kstart; k<grid.kend; ++k)
+                    for (int j=grid.jstart; j<grid.jend; ++j)
+                        for (int i=grid.istart; i<grid.iend; ++i)
+                        {
+                            const int ijk = i + j*grid.icells + k*grid.ijcells;
+                            qtsat[ijk] = 1.05*Thermo_moist_functions::qsat(p[k], thl[ijk]*exn[k]);
+                        }
+
+                const char* states[] = {"", " sat"};
+                const real* qts[] = {fields.sp["qt"]->data, qtsat};
+                for (int n=0; n<2; ++n)
+                {
+                    const real* restrict qt = qts[n];
+                    time_kernel(master, grid, niter, std::string("Thermo_moist sat_adjust") + states[n], 3, [&]{
+                        #pragma omp parallel for
+                        for (int k=grid.kstart; k<grid.kend; ++k)
+                            for (int j=grid.jstart; j<grid.jend; ++j)
+                            {
+                                const int ijk = grid.istart + j*grid.icells + k*grid.ijcells;
+                                Thermo_moist_functions::sat_adjust_row(&ql[ijk], &thl[ijk], &qt[ijk], p[k], exn[k], grid.imax);
+                            } });
+                    time_kernel(master, grid, niter, std::string("Thermo_moist sat_adjust") + states[n] + " old", 3, [&]{
+                        #pragma omp parallel for
+                        for (int k=grid.kstart; k<grid.kend; ++k)
+                            for (int j=grid.jstart; j<grid.jend; ++j)
+                                for (int i=grid.istart; i<grid.iend; ++i)
+                                {
+                                    const int ijk = i + j*grid.icells + k*grid.ijcells;
+                                    ql[ijk] = sat_adjust_former(thl[ijk], qt[ijk], p[k], exn[k]);
+                                } });
+                }
+
+                // The buoyancy reads thl and qt and updates the w tendency, the microphysics
+                // read qt, thl, qr and nr and update their tendencies.
+                #ifdef USECUDA
+                const double nmicro = 0;
+                #else
+                const double nmicro = 12;
+                #endif
+                time_kernel(master, grid, niter, "Thermo_moist exec+microphysics", 4 + nmicro,
+                            [&]{ model.thermo->exec(); });
+            }
+
+            #ifndef USECUDA
+            // The statistics of u read the field and the mask of the full domain, the kernels of the fields
+            // are timed for one mask, including the deferred reduction as in the statistics of a run.
+            std::vector<Mask> masks(1);
+            masks[0].name = "default";
+            std::vector<double> profs;
+            create_bench_masks(model, masks, profs);
+
+            time_kernel(master, grid, niter, "Stats u", 4, [&]{ calc_bench_stats(model); });
+            check_stats_masks(master, model);
+
+            // The ghost cell exchange reads and writes the halo only.
+            const double nhalo = 2.*( (double)grid.igc*grid.jmax + (double)grid.jgc*grid.icells ) * grid.kcells;
+            time_kernel(master, grid, niter, "Grid boundary_cyclic", 2.*nhalo/((double)grid.imax*grid.jmax*grid.kmax),
+                        [&]{ grid.boundary_cyclic(fields.u->data); });
+            #endif
+        }
+        catch (...)
+        {
+            delete advec_alt;
+            delete diff_alt;
+            delete advec_fused;
+            delete diff_fused;
+            for (size_t n=0; n<advec_simd.size(); ++n)
+                delete advec_simd[n];
+            throw;
+        }
+
+        delete advec_alt;
+        delete diff_alt;
+        delete advec_fused;
+        delete diff_fused;
+        for (size_t n=0; n<advec_simd.size(); ++n)
+            delete advec_simd[n];
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // Initialize the master class, it cannot fail.
+    Master master;
+    try
+    {
+        // Start the master class in run mode, the benchmark does not read or write any files.
+        char name[] = "microhh_bench";
+        char mode[] = "run";
+        char simname[] = "bench";
+        char* masterargv[] = { name, mode, simname };
+        master.start(3, masterargv);
+
+        master.print_message("Microhh git-hash: " GITHASH "\n");
+
+        Bench_settings settings;
+        settings.itot = 64;
+        settings.jtot = 64;
+        settings.ktot = 64;
+        settings.npx  = 1;
+        settings.npy  = 1;
+        settings.nthreads = 1;
+        settings.niter = 10;
+        parse_arguments(master, settings, argc, argv);
+
+        bool master_initialized = false;
+        run_bench(master, settings, "2", master_initialized);
+        run_bench(master, settings, "4", master_initialized);
+    }
+
+    // Catch any exceptions and return 1.
+    catch (...)
+    {
+        return 1;
+    }
+
+    // Return 0 in case of normal exit.
+    return 0;
+}
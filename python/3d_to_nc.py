@@ -37,7 +37,7 @@ else:
 # Calculate the number of time steps
 nt = int((endtime - starttime) / sampletime + 1)
 
-# Read grid properties from grid.0000000
+# Read grid properties from grid.0000000, which is always stored in double precision
 n   = nx*ny*nz
 fin = open("grid.{:07d}".format(0),"rb")
 raw = fin.read(nx*8)
@@ -46,11 +46,34 @@ Advec::Advec(Model* modelin, Input* inputin)
 
     int nerror = 0;
     nerror += inputin->get_item(&cflmax, "advec", "cflmax", "", 1.);
+    nerror += inputin->get_item(&swsimd, "advec", "swsimd", "", "default");
 
     swadvec = "0";
 
     if (nerror)
         throw 1;
+
+    // The entry point of the build is the default, such that the results do not depend on the processor.
+    // With "auto" the widest instruction set of the processor is taken, which changes the round-off.
+    if (swsimd == "auto")
+    {
+        if (is_simd_supported("avx512"))
+            swsimd = "avx512";
+        else if (is_simd_supported("avx2"))
+            swsimd = "avx2";
+        else
+            swsimd = "default";
+    }
+    else if (swsimd != "default" && swsimd != "avx2" && swsimd != "avx512")
+    {
+        master->print_error("\"%s\" is an illegal value for swsimd\n", swsimd.c_str());
+        throw 1;
+    }
+    else if (!is_simd_supported(swsimd))
+    {
+        master->print_error("swsimd=\"%s\" is not supported by this build or processor\n", swsimd.c_str());
+        throw 1;
+    }
 }
 
 Advec::~Advec()
@@ -85,4 +108,23 @@ std::string Advec::get_switch()
     return swadvec;
 }
 
+std::string Advec::get_simd_switch()
+{
+    return swsimd;
+}
+
+bool Advec::is_simd_supported(const std::string swsimdin)
+{
+    if (swsimdin == "default")
+        return true;
+    #ifdef USESIMDTARGETS
+    else if (swsimdin == "avx2")
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    else if (swsimdin == "avx512")
+        return __builtin_cpu_supports("avx512f");
+    #endif
+    else
+        return false;
+}
+
 const double Advec::cflmin = 1.E-5;
@@ -29,13 +29,19 @@
 #include "defines.h"
 #include "constants.h"
 #include "finite_difference.h"
+#include "advec_2_functions.h"
 #include "model.h"
 
 using namespace Finite_difference::O2;
+using namespace Advec_2_functions;
 
 Advec_2::Advec_2(Model* modelin, Input* inputin) : Advec(modelin, inputin)
 {
     swadvec = "2";
+
+    // The momentum advection can be fused into the Smagorinsky diffusion kernels.
+    if (inputin->get_item(&swfusedadvec, "diff", "swfusedadvec", "", "0"))
+        throw 1;
 }
 
 Advec_2::~Advec_2()
@@ -58,12 +64,16 @@ unsigned long Advec_2::get_time_limit(unsigned long idt, double dt)
 
 void Advec_2::exec()
 {
-    advec_u(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
-            fields->rhoref, fields->rhorefh);
-    advec_v(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
-            fields->rhoref, fields->rhorefh);
-    advec_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi,
-            fields->rhoref, fields->rhorefh);
+    // In case of fused advection and diffusion, the momentum tendencies are computed in Diff_smag_2::exec().
+    if (swfusedadvec == "0")
+    {
+        advec_u(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
+                fields->rhoref, fields->rhorefh);
+        advec_v(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
+                fields->rhoref, fields->rhorefh);
+        advec_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi,
+                fields->rhoref, fields->rhorefh);
+    }
 
     for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
         advec_s(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data,
@@ -71,7 +81,7 @@ void Advec_2::exec()
 }
 #endif
 
-double Advec_2::calc_cfl(double* restrict u, double* restrict v, double* restrict w, double* restrict dzi, double dt)
+double Advec_2::calc_cfl(real* restrict u, real* restrict v, real* restrict w, real* restrict dzi, double dt)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -82,6 +92,7 @@ double Advec_2::calc_cfl(double* restrict u, double* restrict v, double* restric
 
     double cfl = 0;
 
+    #pragma omp parallel for reduction(max:cfl)
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -98,8 +109,8 @@ double Advec_2::calc_cfl(double* restrict u, double* restrict v, double* restric
     return cfl;
 }
 
-void Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2::advec_u(real* restrict ut, real* restrict u, real* restrict v, real* restrict w,
+                      real* restrict dzi, real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -108,26 +119,25 @@ void Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                ut[ijk] +=
-                         - ( interp2(u[ijk   ], u[ijk+ii]) * interp2(u[ijk   ], u[ijk+ii])
-                           - interp2(u[ijk-ii], u[ijk   ]) * interp2(u[ijk-ii], u[ijk   ]) ) * dxi
-
-                         - ( interp2(v[ijk-ii+jj], v[ijk+jj]) * interp2(u[ijk   ], u[ijk+jj])
-                           - interp2(v[ijk-ii   ], v[ijk   ]) * interp2(u[ijk-jj], u[ijk   ]) ) * dyi
-
-                         - ( rhorefh[k+1] * interp2(w[ijk-ii+kk], w[ijk+kk]) * interp2(u[ijk   ], u[ijk+kk])
-                           - rhorefh[k  ] * interp2(w[ijk-ii   ], w[ijk   ]) * interp2(u[ijk-kk], u[ijk   ]) ) / rhoref[k] * dzi[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    ut[ijk] += advec_u_2nd(u, v, w, rhoref, rhorefh, dzi, dxi, dyi, ijk, k, ii, jj, kk);
+                }
+        }
+    }
 }
 
-void Advec_2::advec_v(double* restrict vt, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2::advec_v(real* restrict vt, real* restrict u, real* restrict v, real* restrict w,
+                      real* restrict dzi, real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -136,26 +146,25 @@ void Advec_2::advec_v(double* restrict vt, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                vt[ijk] +=
-                         - ( interp2(u[ijk+ii-jj], u[ijk+ii]) * interp2(v[ijk   ], v[ijk+ii])
-                           - interp2(u[ijk   -jj], u[ijk   ]) * interp2(v[ijk-ii], v[ijk   ]) ) * dxi
-
-                         - ( interp2(v[ijk   ], v[ijk+jj]) * interp2(v[ijk   ], v[ijk+jj])
-                           - interp2(v[ijk-jj], v[ijk   ]) * interp2(v[ijk-jj], v[ijk   ]) ) * dyi
-
-                         - ( rhorefh[k+1] * interp2(w[ijk-jj+kk], w[ijk+kk]) * interp2(v[ijk   ], v[ijk+kk])
-                           - rhorefh[k  ] * interp2(w[ijk-jj   ], w[ijk   ]) * interp2(v[ijk-kk], v[ijk   ]) ) / rhoref[k] * dzi[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    vt[ijk] += advec_v_2nd(u, v, w, rhoref, rhorefh, dzi, dxi, dyi, ijk, k, ii, jj, kk);
+                }
+        }
+    }
 }
 
-void Advec_2::advec_w(double* restrict wt, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2::advec_w(real* restrict wt, real* restrict u, real* restrict v, real* restrict w,
+                      real* restrict dzhi, real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -164,26 +173,25 @@ void Advec_2::advec_w(double* restrict wt, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                wt[ijk] +=
-                         - ( interp2(u[ijk+ii-kk], u[ijk+ii]) * interp2(w[ijk   ], w[ijk+ii])
-                           - interp2(u[ijk   -kk], u[ijk   ]) * interp2(w[ijk-ii], w[ijk   ]) ) * dxi
-
-                         - ( interp2(v[ijk+jj-kk], v[ijk+jj]) * interp2(w[ijk   ], w[ijk+jj])
-                           - interp2(v[ijk   -kk], v[ijk   ]) * interp2(w[ijk-jj], w[ijk   ]) ) * dyi
-
-                         - ( rhoref[k  ] * interp2(w[ijk   ], w[ijk+kk]) * interp2(w[ijk   ], w[ijk+kk])
-                           - rhoref[k-1] * interp2(w[ijk-kk], w[ijk   ]) * interp2(w[ijk-kk], w[ijk   ]) ) / rhorefh[k] * dzhi[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    wt[ijk] += advec_w_2nd(u, v, w, rhoref, rhorefh, dzhi, dxi, dyi, ijk, k, ii, jj, kk);
+                }
+        }
+    }
 }
 
-void Advec_2::advec_s(double* restrict st, double* restrict s, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2::advec_s(real* restrict st, real* restrict s, real* restrict u, real* restrict v, real* restrict w,
+                      real* restrict dzi, real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -192,20 +200,27 @@ void Advec_2::advec_s(double* restrict st, double* restrict s, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                st[ijk] +=
-                         - ( u[ijk+ii] * interp2(s[ijk   ], s[ijk+ii])
-                           - u[ijk   ] * interp2(s[ijk-ii], s[ijk   ]) ) * dxi
-
-                         - ( v[ijk+jj] * interp2(s[ijk   ], s[ijk+jj])
-                           - v[ijk   ] * interp2(s[ijk-jj], s[ijk   ]) ) * dyi
-
-                         - ( rhorefh[k+1] * w[ijk+kk] * interp2(s[ijk   ], s[ijk+kk])
-                           - rhorefh[k  ] * w[ijk   ] * interp2(s[ijk-kk], s[ijk   ]) ) / rhoref[k] * dzi[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    st[ijk] +=
+                             - ( u[ijk+ii] * interp2(s[ijk   ], s[ijk+ii])
+                               - u[ijk   ] * interp2(s[ijk-ii], s[ijk   ]) ) * dxi
+
+                             - ( v[ijk+jj] * interp2(s[ijk   ], s[ijk+jj])
+                               - v[ijk   ] * interp2(s[ijk-jj], s[ijk   ]) ) * dyi
+
+                             - ( rhorefh[k+1] * w[ijk+kk] * interp2(s[ijk   ], s[ijk+kk])
+                               - rhorefh[k  ] * w[ijk   ] * interp2(s[ijk-kk], s[ijk   ]) ) / rhoref[k] * dzi[k];
+                }
+        }
+    }
 }
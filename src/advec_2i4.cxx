@@ -68,6 +68,40 @@ double Advec_2i4::get_cfl(double dt)
 
 #ifndef USECUDA
 void Advec_2i4::exec()
+{
+    #ifdef USESIMDTARGETS
+    if (swsimd == "avx512")
+        exec_avx512();
+    else if (swsimd == "avx2")
+        exec_avx2();
+    else
+    #endif
+        exec_default();
+}
+
+// The parallel region is opened in the entry points, such that the kernels and their loops are compiled
+// for the instruction set of the entry point. The kernels share out their loops over the threads.
+void Advec_2i4::exec_default()
+{
+    #pragma omp parallel
+    exec_kernels();
+}
+
+#ifdef USESIMDTARGETS
+void Advec_2i4::exec_avx2()
+{
+    #pragma omp parallel
+    exec_kernels();
+}
+
+void Advec_2i4::exec_avx512()
+{
+    #pragma omp parallel
+    exec_kernels();
+}
+#endif
+
+void Advec_2i4::exec_kernels()
 {
     advec_u(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, 
             fields->rhoref, fields->rhorefh);
@@ -77,13 +111,12 @@ void Advec_2i4::exec()
             fields->rhoref, fields->rhorefh);
 
     for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-        advec_s(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
+        advec_s(it->second->data, fields->sp.at(it->first)->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
                 fields->rhoref, fields->rhorefh);
-
 }
 #endif
 
-double Advec_2i4::calc_cfl(double* restrict u, double* restrict v, double* restrict w, double* restrict dzi, double dt)
+double Advec_2i4::calc_cfl(real* restrict u, real* restrict v, real* restrict w, real* restrict dzi, double dt)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -111,6 +144,7 @@ double Advec_2i4::calc_cfl(double* restrict u, double* restrict v, double* restr
                               + std::abs(interp2(w[ijk    ], w[ijk+kk1]))*dzi[k]);
         }
 
+    #pragma omp parallel for reduction(max:cfl)
     for (k=grid->kstart+1; k<grid->kend-1; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -140,8 +174,8 @@ double Advec_2i4::calc_cfl(double* restrict u, double* restrict v, double* restr
     return cfl;
 }
 
-void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restrict v, double* restrict w, 
-                        double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2i4::advec_u(real* restrict ut, real* restrict u, real* restrict v, real* restrict w, 
+                        real* restrict dzi, real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -158,6 +192,7 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
 
     int k = kstart; 
 
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -177,6 +212,7 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
         }
 
     k = kstart + 1; 
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -196,27 +232,35 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
                        - rhorefh[k  ] * interp2(w[ijk-ii1    ], w[ijk    ]) * interp2(u[ijk-kk1], u[ijk    ]) ) / rhoref[k] * dzi[k];
         }
 
-    for (k=grid->kstart+2; k<grid->kend-2; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (k=grid->kstart+2; k<grid->kend-2; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                ut[ijk] += 
-                         // u*du/dx
-                         - ( interp2(u[ijk        ], u[ijk+ii1]) * interp4(u[ijk-ii1], u[ijk    ], u[ijk+ii1], u[ijk+ii2])
-                           - interp2(u[ijk-ii1    ], u[ijk    ]) * interp4(u[ijk-ii2], u[ijk-ii1], u[ijk    ], u[ijk+ii1]) ) * dxi
-
-                         // v*du/dy
-                         - ( interp2(v[ijk-ii1+jj1], v[ijk+jj1]) * interp4(u[ijk-jj1], u[ijk    ], u[ijk+jj1], u[ijk+jj2])
-                           - interp2(v[ijk-ii1    ], v[ijk    ]) * interp4(u[ijk-jj2], u[ijk-jj1], u[ijk    ], u[ijk+jj1]) ) * dyi 
-
-                         // w*du/dz
-                         - ( rhorefh[k+1] * interp2(w[ijk-ii1+kk1], w[ijk+kk1]) * interp4(u[ijk-kk1], u[ijk    ], u[ijk+kk1], u[ijk+kk2])
-                           - rhorefh[k  ] * interp2(w[ijk-ii1    ], w[ijk    ]) * interp4(u[ijk-kk2], u[ijk-kk1], u[ijk    ], u[ijk+kk1]) ) / rhoref[k] * dzi[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    ut[ijk] += 
+                             // u*du/dx
+                             - ( interp2(u[ijk        ], u[ijk+ii1]) * interp4(u[ijk-ii1], u[ijk    ], u[ijk+ii1], u[ijk+ii2])
+                               - interp2(u[ijk-ii1    ], u[ijk    ]) * interp4(u[ijk-ii2], u[ijk-ii1], u[ijk    ], u[ijk+ii1]) ) * dxi
+
+                             // v*du/dy
+                             - ( interp2(v[ijk-ii1+jj1], v[ijk+jj1]) * interp4(u[ijk-jj1], u[ijk    ], u[ijk+jj1], u[ijk+jj2])
+                               - interp2(v[ijk-ii1    ], v[ijk    ]) * interp4(u[ijk-jj2], u[ijk-jj1], u[ijk    ], u[ijk+jj1]) ) * dyi 
+
+                             // w*du/dz
+                             - ( rhorefh[k+1] * interp2(w[ijk-ii1+kk1], w[ijk+kk1]) * interp4(u[ijk-kk1], u[ijk    ], u[ijk+kk1], u[ijk+kk2])
+                               - rhorefh[k  ] * interp2(w[ijk-ii1    ], w[ijk    ]) * interp4(u[ijk-kk2], u[ijk-kk1], u[ijk    ], u[ijk+kk1]) ) / rhoref[k] * dzi[k];
+                }
+        }
+    }
 
     k = kend - 2; 
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -237,6 +281,7 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
         }
 
     k = kend - 1; 
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -256,8 +301,8 @@ void Advec_2i4::advec_u(double* restrict ut, double* restrict u, double* restric
         }
 }
 
-void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restrict v, double* restrict w,
-                        double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2i4::advec_v(real* restrict vt, real* restrict u, real* restrict v, real* restrict w,
+                        real* restrict dzi, real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -273,6 +318,7 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
     const int kend   = grid->kend;
 
     int k = kstart;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -292,6 +338,7 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
         }
 
     k = kstart+1;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -311,27 +358,35 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
                        - rhorefh[k  ] * interp2(w[ijk-jj1    ], w[ijk    ]) * interp2(v[ijk-kk1], v[ijk    ]) ) / rhoref[k] * dzi[k];
         }
 
-    for (k=grid->kstart+2; k<grid->kend-2; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (k=grid->kstart+2; k<grid->kend-2; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                vt[ijk] += 
-                         // u*dv/dx
-                         - ( interp2(u[ijk+ii1-jj1], u[ijk+ii1]) * interp4(v[ijk-ii1], v[ijk    ], v[ijk+ii1], v[ijk+ii2])
-                           - interp2(u[ijk    -jj1], u[ijk    ]) * interp4(v[ijk-ii2], v[ijk-ii1], v[ijk    ], v[ijk+ii1]) ) * dxi
-
-                         // v*dv/dy
-                         - ( interp2(v[ijk        ], v[ijk+jj1]) * interp4(v[ijk-jj1], v[ijk    ], v[ijk+jj1], v[ijk+jj2])
-                           - interp2(v[ijk-jj1    ], v[ijk    ]) * interp4(v[ijk-jj2], v[ijk-jj1], v[ijk    ], v[ijk+jj1]) ) * dyi
-
-                         // w*dv/dz
-                         - ( rhorefh[k+1] * interp2(w[ijk-jj1+kk1], w[ijk+kk1]) * interp4(v[ijk-kk1], v[ijk    ], v[ijk+kk1], v[ijk+kk2])
-                           - rhorefh[k  ] * interp2(w[ijk-jj1    ], w[ijk    ]) * interp4(v[ijk-kk2], v[ijk-kk1], v[ijk    ], v[ijk+kk1]) ) / rhoref[k] * dzi[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    vt[ijk] += 
+                             // u*dv/dx
+                             - ( interp2(u[ijk+ii1-jj1], u[ijk+ii1]) * interp4(v[ijk-ii1], v[ijk    ], v[ijk+ii1], v[ijk+ii2])
+                               - interp2(u[ijk    -jj1], u[ijk    ]) * interp4(v[ijk-ii2], v[ijk-ii1], v[ijk    ], v[ijk+ii1]) ) * dxi
+
+                             // v*dv/dy
+                             - ( interp2(v[ijk        ], v[ijk+jj1]) * interp4(v[ijk-jj1], v[ijk    ], v[ijk+jj1], v[ijk+jj2])
+                               - interp2(v[ijk-jj1    ], v[ijk    ]) * interp4(v[ijk-jj2], v[ijk-jj1], v[ijk    ], v[ijk+jj1]) ) * dyi
+
+                             // w*dv/dz
+                             - ( rhorefh[k+1] * interp2(w[ijk-jj1+kk1], w[ijk+kk1]) * interp4(v[ijk-kk1], v[ijk    ], v[ijk+kk1], v[ijk+kk2])
+                               - rhorefh[k  ] * interp2(w[ijk-jj1    ], w[ijk    ]) * interp4(v[ijk-kk2], v[ijk-kk1], v[ijk    ], v[ijk+kk1]) ) / rhoref[k] * dzi[k];
+                }
+        }
+    }
 
     k = kend-2;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -352,6 +407,7 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
         }
 
     k = kend-1;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -371,8 +427,8 @@ void Advec_2i4::advec_v(double* restrict vt, double* restrict u, double* restric
         }
 }
 
-void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restrict v, double* restrict w,
-                        double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2i4::advec_w(real* restrict wt, real* restrict u, real* restrict v, real* restrict w,
+                        real* restrict dzhi, real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -388,6 +444,7 @@ void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restric
     const int kend   = grid->kend;
 
     int k = kstart+1;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -407,27 +464,35 @@ void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restric
                        - rhoref[k-1] * interp2(w[ijk-kk1    ], w[ijk    ]) * interp2(w[ijk-kk1], w[ijk    ]) ) / rhorefh[k] * dzhi[k];
         }
 
-    for (k=grid->kstart+2; k<grid->kend-1; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (k=grid->kstart+2; k<grid->kend-1; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                wt[ijk] +=
-                         // u*dw/dx 
-                         - ( interp2(u[ijk+ii1-kk1], u[ijk+ii1]) * interp4(w[ijk-ii1], w[ijk    ], w[ijk+ii1], w[ijk+ii2])
-                           - interp2(u[ijk    -kk1], u[ijk    ]) * interp4(w[ijk-ii2], w[ijk-ii1], w[ijk    ], w[ijk+ii1]) ) * dxi
-
-                         // v*dw/dy 
-                         - ( interp2(v[ijk+jj1-kk1], v[ijk+jj1]) * interp4(w[ijk-jj1], w[ijk    ], w[ijk+jj1], w[ijk+jj2])
-                           - interp2(v[ijk    -kk1], v[ijk    ]) * interp4(w[ijk-jj2], w[ijk-jj1], w[ijk    ], w[ijk+jj1]) ) * dyi
-
-                         // w*dw/dz 
-                         - ( rhoref[k  ] * interp2(w[ijk        ], w[ijk+kk1]) * interp4(w[ijk-kk1], w[ijk    ], w[ijk+kk1], w[ijk+kk2])
-                           - rhoref[k-1] * interp2(w[ijk-kk1    ], w[ijk    ]) * interp4(w[ijk-kk2], w[ijk-kk1], w[ijk    ], w[ijk+kk1]) ) / rhorefh[k] * dzhi[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    wt[ijk] +=
+                             // u*dw/dx 
+                             - ( interp2(u[ijk+ii1-kk1], u[ijk+ii1]) * interp4(w[ijk-ii1], w[ijk    ], w[ijk+ii1], w[ijk+ii2])
+                               - interp2(u[ijk    -kk1], u[ijk    ]) * interp4(w[ijk-ii2], w[ijk-ii1], w[ijk    ], w[ijk+ii1]) ) * dxi
+
+                             // v*dw/dy 
+                             - ( interp2(v[ijk+jj1-kk1], v[ijk+jj1]) * interp4(w[ijk-jj1], w[ijk    ], w[ijk+jj1], w[ijk+jj2])
+                               - interp2(v[ijk    -kk1], v[ijk    ]) * interp4(w[ijk-jj2], w[ijk-jj1], w[ijk    ], w[ijk+jj1]) ) * dyi
+
+                             // w*dw/dz 
+                             - ( rhoref[k  ] * interp2(w[ijk        ], w[ijk+kk1]) * interp4(w[ijk-kk1], w[ijk    ], w[ijk+kk1], w[ijk+kk2])
+                               - rhoref[k-1] * interp2(w[ijk-kk1    ], w[ijk    ]) * interp4(w[ijk-kk2], w[ijk-kk1], w[ijk    ], w[ijk+kk1]) ) / rhorefh[k] * dzhi[k];
+                }
+        }
+    }
 
     k = kend-1;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -448,8 +513,8 @@ void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restric
         }
 }
 
-void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restrict u, double* restrict v, double* restrict w,
-                        double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+void Advec_2i4::advec_s(real* restrict st, real* restrict s, real* restrict u, real* restrict v, real* restrict w,
+                        real* restrict dzi, real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -466,6 +531,7 @@ void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restric
 
     // assume that w at the boundary equals zero...
     int k = kstart;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -482,6 +548,7 @@ void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restric
         }
 
     k = kstart+1;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -498,24 +565,32 @@ void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restric
                        - rhorefh[k  ] * w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]) ) / rhoref[k] * dzi[k];
         }
 
-    for (k=grid->kstart+2; k<grid->kend-2; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (k=grid->kstart+2; k<grid->kend-2; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                st[ijk] += 
-                         - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                           - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
-
-                         - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                           - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
-
-                         - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijk-kk1], s[ijk    ], s[ijk+kk1], s[ijk+kk2])
-                           - rhorefh[k  ] * w[ijk    ] * interp4(s[ijk-kk2], s[ijk-kk1], s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    st[ijk] += 
+                             - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
+                               - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+
+                             - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
+                               - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+
+                             - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijk-kk1], s[ijk    ], s[ijk+kk1], s[ijk+kk2])
+                               - rhorefh[k  ] * w[ijk    ] * interp4(s[ijk-kk2], s[ijk-kk1], s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
+                }
+        }
+    }
 
     k = kend-2;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
@@ -534,6 +609,7 @@ void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restric
 
     // assume that w at the boundary equals zero...
     k = kend-1;
+    #pragma omp for
     for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
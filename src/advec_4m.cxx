@@ -70,7 +70,7 @@ void Advec_4m::exec()
 }
 #endif
 
-double Advec_4m::calc_cfl(double * restrict u, double * restrict v, double * restrict w, double * restrict dzi, double dt)
+double Advec_4m::calc_cfl(real * restrict u, real * restrict v, real * restrict w, real * restrict dzi, double dt)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -84,6 +84,7 @@ double Advec_4m::calc_cfl(double * restrict u, double * restrict v, double * res
 
     double cfl = 0;
 
+    #pragma omp parallel for reduction(max:cfl)
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -102,7 +103,7 @@ double Advec_4m::calc_cfl(double * restrict u, double * restrict v, double * res
     return cfl;
 }
 
-void Advec_4m::advec_u(double * restrict ut, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
+void Advec_4m::advec_u(real * restrict ut, real * restrict u, real * restrict v, real * restrict w, real * restrict dzi4)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -145,29 +146,36 @@ void Advec_4m::advec_u(double * restrict ut, double * restrict u, double * restr
                        * dzi4[kstart];
         }
 
-    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend-1; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                ut[ijk] +=
-                         - grad4(interp4(u[ijk-ii3], u[ijk-ii2], u[ijk-ii1], u[ijk    ]) * interp2(u[ijk-ii3], u[ijk    ]),
-                                 interp4(u[ijk-ii2], u[ijk-ii1], u[ijk    ], u[ijk+ii1]) * interp2(u[ijk-ii1], u[ijk    ]),
-                                 interp4(u[ijk-ii1], u[ijk    ], u[ijk+ii1], u[ijk+ii2]) * interp2(u[ijk    ], u[ijk+ii1]),
-                                 interp4(u[ijk    ], u[ijk+ii1], u[ijk+ii2], u[ijk+ii3]) * interp2(u[ijk    ], u[ijk+ii3]), dxi)
-
-                         - grad4(interp4(v[ijk-ii2-jj1], v[ijk-ii1-jj1], v[ijk-jj1], v[ijk+ii1-jj1]) * interp2(u[ijk-jj3], u[ijk    ]),
-                                 interp4(v[ijk-ii2    ], v[ijk-ii1    ], v[ijk    ], v[ijk+ii1    ]) * interp2(u[ijk-jj1], u[ijk    ]),
-                                 interp4(v[ijk-ii2+jj1], v[ijk-ii1+jj1], v[ijk+jj1], v[ijk+ii1+jj1]) * interp2(u[ijk    ], u[ijk+jj1]),
-                                 interp4(v[ijk-ii2+jj2], v[ijk-ii1+jj2], v[ijk+jj2], v[ijk+ii1+jj2]) * interp2(u[ijk    ], u[ijk+jj3]), dyi)
-
-                         - grad4x(interp4(w[ijk-ii2-kk1], w[ijk-ii1-kk1], w[ijk-kk1], w[ijk+ii1-kk1]) * interp2(u[ijk-kk3], u[ijk    ]),
-                                  interp4(w[ijk-ii2    ], w[ijk-ii1    ], w[ijk    ], w[ijk+ii1    ]) * interp2(u[ijk-kk1], u[ijk    ]),
-                                  interp4(w[ijk-ii2+kk1], w[ijk-ii1+kk1], w[ijk+kk1], w[ijk+ii1+kk1]) * interp2(u[ijk    ], u[ijk+kk1]),
-                                  interp4(w[ijk-ii2+kk2], w[ijk-ii1+kk2], w[ijk+kk2], w[ijk+ii1+kk2]) * interp2(u[ijk    ], u[ijk+kk3]))
-                           * dzi4[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    ut[ijk] +=
+                             - grad4(interp4(u[ijk-ii3], u[ijk-ii2], u[ijk-ii1], u[ijk    ]) * interp2(u[ijk-ii3], u[ijk    ]),
+                                     interp4(u[ijk-ii2], u[ijk-ii1], u[ijk    ], u[ijk+ii1]) * interp2(u[ijk-ii1], u[ijk    ]),
+                                     interp4(u[ijk-ii1], u[ijk    ], u[ijk+ii1], u[ijk+ii2]) * interp2(u[ijk    ], u[ijk+ii1]),
+                                     interp4(u[ijk    ], u[ijk+ii1], u[ijk+ii2], u[ijk+ii3]) * interp2(u[ijk    ], u[ijk+ii3]), dxi)
+
+                             - grad4(interp4(v[ijk-ii2-jj1], v[ijk-ii1-jj1], v[ijk-jj1], v[ijk+ii1-jj1]) * interp2(u[ijk-jj3], u[ijk    ]),
+                                     interp4(v[ijk-ii2    ], v[ijk-ii1    ], v[ijk    ], v[ijk+ii1    ]) * interp2(u[ijk-jj1], u[ijk    ]),
+                                     interp4(v[ijk-ii2+jj1], v[ijk-ii1+jj1], v[ijk+jj1], v[ijk+ii1+jj1]) * interp2(u[ijk    ], u[ijk+jj1]),
+                                     interp4(v[ijk-ii2+jj2], v[ijk-ii1+jj2], v[ijk+jj2], v[ijk+ii1+jj2]) * interp2(u[ijk    ], u[ijk+jj3]), dyi)
+
+                             - grad4x(interp4(w[ijk-ii2-kk1], w[ijk-ii1-kk1], w[ijk-kk1], w[ijk+ii1-kk1]) * interp2(u[ijk-kk3], u[ijk    ]),
+                                      interp4(w[ijk-ii2    ], w[ijk-ii1    ], w[ijk    ], w[ijk+ii1    ]) * interp2(u[ijk-kk1], u[ijk    ]),
+                                      interp4(w[ijk-ii2+kk1], w[ijk-ii1+kk1], w[ijk+kk1], w[ijk+ii1+kk1]) * interp2(u[ijk    ], u[ijk+kk1]),
+                                      interp4(w[ijk-ii2+kk2], w[ijk-ii1+kk2], w[ijk+kk2], w[ijk+ii1+kk2]) * interp2(u[ijk    ], u[ijk+kk3]))
+                               * dzi4[k];
+                }
+        }
+    }
 
     // top boundary
     for (int j=grid->jstart; j<grid->jend; ++j)
@@ -194,7 +202,7 @@ void Advec_4m::advec_u(double * restrict ut, double * restrict u, double * restr
         }
 }
 
-void Advec_4m::advec_v(double * restrict vt, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
+void Advec_4m::advec_v(real * restrict vt, real * restrict u, real * restrict v, real * restrict w, real * restrict dzi4)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -236,29 +244,36 @@ void Advec_4m::advec_v(double * restrict vt, double * restrict u, double * restr
                        * dzi4[kstart];
         }
 
-    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend-1; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                vt[ijk] +=
-                         - grad4(interp4(u[ijk-ii1-jj2], u[ijk-ii1-jj1], u[ijk-ii1], u[ijk-ii1+jj1]) * interp2(v[ijk-ii3], v[ijk    ]),
-                                 interp4(u[ijk    -jj2], u[ijk    -jj1], u[ijk    ], u[ijk    +jj1]) * interp2(v[ijk-ii1], v[ijk    ]),
-                                 interp4(u[ijk+ii1-jj2], u[ijk+ii1-jj1], u[ijk+ii1], u[ijk+ii1+jj1]) * interp2(v[ijk    ], v[ijk+ii1]),
-                                 interp4(u[ijk+ii2-jj2], u[ijk+ii2-jj1], u[ijk+ii2], u[ijk+ii2+jj1]) * interp2(v[ijk    ], v[ijk+ii3]), dxi)
-
-                         - grad4(interp4(v[ijk-jj3], v[ijk-jj2], v[ijk-jj1], v[ijk    ]) * interp2(v[ijk-jj3], v[ijk    ]),
-                                 interp4(v[ijk-jj2], v[ijk-jj1], v[ijk    ], v[ijk+jj1]) * interp2(v[ijk-jj1], v[ijk    ]),
-                                 interp4(v[ijk-jj1], v[ijk    ], v[ijk+jj1], v[ijk+jj2]) * interp2(v[ijk    ], v[ijk+jj1]),
-                                 interp4(v[ijk    ], v[ijk+jj1], v[ijk+jj2], v[ijk+jj3]) * interp2(v[ijk    ], v[ijk+jj3]), dyi)
-
-                         - grad4x(interp4(w[ijk-jj2-kk1], w[ijk-jj1-kk1], w[ijk-kk1], w[ijk+jj1-kk1]) * interp2(v[ijk-kk3], v[ijk    ]),
-                                  interp4(w[ijk-jj2    ], w[ijk-jj1    ], w[ijk    ], w[ijk+jj1    ]) * interp2(v[ijk-kk1], v[ijk    ]),
-                                  interp4(w[ijk-jj2+kk1], w[ijk-jj1+kk1], w[ijk+kk1], w[ijk+jj1+kk1]) * interp2(v[ijk    ], v[ijk+kk1]),
-                                  interp4(w[ijk-jj2+kk2], w[ijk-jj1+kk2], w[ijk+kk2], w[ijk+jj1+kk2]) * interp2(v[ijk    ], v[ijk+kk3]))
-                           * dzi4[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    vt[ijk] +=
+                             - grad4(interp4(u[ijk-ii1-jj2], u[ijk-ii1-jj1], u[ijk-ii1], u[ijk-ii1+jj1]) * interp2(v[ijk-ii3], v[ijk    ]),
+                                     interp4(u[ijk    -jj2], u[ijk    -jj1], u[ijk    ], u[ijk    +jj1]) * interp2(v[ijk-ii1], v[ijk    ]),
+                                     interp4(u[ijk+ii1-jj2], u[ijk+ii1-jj1], u[ijk+ii1], u[ijk+ii1+jj1]) * interp2(v[ijk    ], v[ijk+ii1]),
+                                     interp4(u[ijk+ii2-jj2], u[ijk+ii2-jj1], u[ijk+ii2], u[ijk+ii2+jj1]) * interp2(v[ijk    ], v[ijk+ii3]), dxi)
+
+                             - grad4(interp4(v[ijk-jj3], v[ijk-jj2], v[ijk-jj1], v[ijk    ]) * interp2(v[ijk-jj3], v[ijk    ]),
+                                     interp4(v[ijk-jj2], v[ijk-jj1], v[ijk    ], v[ijk+jj1]) * interp2(v[ijk-jj1], v[ijk    ]),
+                                     interp4(v[ijk-jj1], v[ijk    ], v[ijk+jj1], v[ijk+jj2]) * interp2(v[ijk    ], v[ijk+jj1]),
+                                     interp4(v[ijk    ], v[ijk+jj1], v[ijk+jj2], v[ijk+jj3]) * interp2(v[ijk    ], v[ijk+jj3]), dyi)
+
+                             - grad4x(interp4(w[ijk-jj2-kk1], w[ijk-jj1-kk1], w[ijk-kk1], w[ijk+jj1-kk1]) * interp2(v[ijk-kk3], v[ijk    ]),
+                                      interp4(w[ijk-jj2    ], w[ijk-jj1    ], w[ijk    ], w[ijk+jj1    ]) * interp2(v[ijk-kk1], v[ijk    ]),
+                                      interp4(w[ijk-jj2+kk1], w[ijk-jj1+kk1], w[ijk+kk1], w[ijk+jj1+kk1]) * interp2(v[ijk    ], v[ijk+kk1]),
+                                      interp4(w[ijk-jj2+kk2], w[ijk-jj1+kk2], w[ijk+kk2], w[ijk+jj1+kk2]) * interp2(v[ijk    ], v[ijk+kk3]))
+                               * dzi4[k];
+                }
+        }
+    }
 
     // top boundary
     for (int j=grid->jstart; j<grid->jend; ++j)
@@ -285,7 +300,7 @@ void Advec_4m::advec_v(double * restrict vt, double * restrict u, double * restr
         }
 }
 
-void Advec_4m::advec_w(double * restrict wt, double * restrict u, double * restrict v, double * restrict w, double * restrict dzhi4)
+void Advec_4m::advec_w(real * restrict wt, real * restrict u, real * restrict v, real * restrict w, real * restrict dzhi4)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -326,29 +341,36 @@ interp4       (w[ijk    ], w[ijk+kk1], w[ijk+kk2], w[ijk+kk3]) * interp4       (
      }
 
 */
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                wt[ijk] +=
-                         - grad4(interp4(u[ijk-ii1-kk2], u[ijk-ii1-kk1], u[ijk-ii1], u[ijk-ii1+kk1]) * interp2(w[ijk-ii3], w[ijk    ]),
-                                 interp4(u[ijk    -kk2], u[ijk    -kk1], u[ijk    ], u[ijk    +kk1]) * interp2(w[ijk-ii1], w[ijk    ]),
-                                 interp4(u[ijk+ii1-kk2], u[ijk+ii1-kk1], u[ijk+ii1], u[ijk+ii1+kk1]) * interp2(w[ijk    ], w[ijk+ii1]),
-                                 interp4(u[ijk+ii2-kk2], u[ijk+ii2-kk1], u[ijk+ii2], u[ijk+ii2+kk1]) * interp2(w[ijk    ], w[ijk+ii3]), dxi)
-            
-                         - grad4(interp4(v[ijk-jj1-kk2], v[ijk-jj1-kk1], v[ijk-jj1], v[ijk-jj1+kk1]) * interp2(w[ijk-jj3], w[ijk    ]),
-                                 interp4(v[ijk    -kk2], v[ijk    -kk1], v[ijk    ], v[ijk    +kk1]) * interp2(w[ijk-jj1], w[ijk    ]),
-                                 interp4(v[ijk+jj1-kk2], v[ijk+jj1-kk1], v[ijk+jj1], v[ijk+jj1+kk1]) * interp2(w[ijk    ], w[ijk+jj1]),
-                                 interp4(v[ijk+jj2-kk2], v[ijk+jj2-kk1], v[ijk+jj2], v[ijk+jj2+kk1]) * interp2(w[ijk    ], w[ijk+jj3]), dyi)
-            
-                         - grad4x(interp4(w[ijk-kk3], w[ijk-kk2], w[ijk-kk1], w[ijk    ]) * interp2(w[ijk-kk3], w[ijk    ]),
-                                  interp4(w[ijk-kk2], w[ijk-kk1], w[ijk    ], w[ijk+kk1]) * interp2(w[ijk-kk1], w[ijk    ]),
-                                  interp4(w[ijk-kk1], w[ijk    ], w[ijk+kk1], w[ijk+kk2]) * interp2(w[ijk    ], w[ijk+kk1]),
-                                  interp4(w[ijk    ], w[ijk+kk1], w[ijk+kk2], w[ijk+kk3]) * interp2(w[ijk    ], w[ijk+kk3]))
-                           * dzhi4[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    wt[ijk] +=
+                             - grad4(interp4(u[ijk-ii1-kk2], u[ijk-ii1-kk1], u[ijk-ii1], u[ijk-ii1+kk1]) * interp2(w[ijk-ii3], w[ijk    ]),
+                                     interp4(u[ijk    -kk2], u[ijk    -kk1], u[ijk    ], u[ijk    +kk1]) * interp2(w[ijk-ii1], w[ijk    ]),
+                                     interp4(u[ijk+ii1-kk2], u[ijk+ii1-kk1], u[ijk+ii1], u[ijk+ii1+kk1]) * interp2(w[ijk    ], w[ijk+ii1]),
+                                     interp4(u[ijk+ii2-kk2], u[ijk+ii2-kk1], u[ijk+ii2], u[ijk+ii2+kk1]) * interp2(w[ijk    ], w[ijk+ii3]), dxi)
+                
+                             - grad4(interp4(v[ijk-jj1-kk2], v[ijk-jj1-kk1], v[ijk-jj1], v[ijk-jj1+kk1]) * interp2(w[ijk-jj3], w[ijk    ]),
+                                     interp4(v[ijk    -kk2], v[ijk    -kk1], v[ijk    ], v[ijk    +kk1]) * interp2(w[ijk-jj1], w[ijk    ]),
+                                     interp4(v[ijk+jj1-kk2], v[ijk+jj1-kk1], v[ijk+jj1], v[ijk+jj1+kk1]) * interp2(w[ijk    ], w[ijk+jj1]),
+                                     interp4(v[ijk+jj2-kk2], v[ijk+jj2-kk1], v[ijk+jj2], v[ijk+jj2+kk1]) * interp2(w[ijk    ], w[ijk+jj3]), dyi)
+                
+                             - grad4x(interp4(w[ijk-kk3], w[ijk-kk2], w[ijk-kk1], w[ijk    ]) * interp2(w[ijk-kk3], w[ijk    ]),
+                                      interp4(w[ijk-kk2], w[ijk-kk1], w[ijk    ], w[ijk+kk1]) * interp2(w[ijk-kk1], w[ijk    ]),
+                                      interp4(w[ijk-kk1], w[ijk    ], w[ijk+kk1], w[ijk+kk2]) * interp2(w[ijk    ], w[ijk+kk1]),
+                                      interp4(w[ijk    ], w[ijk+kk1], w[ijk+kk2], w[ijk+kk3]) * interp2(w[ijk    ], w[ijk+kk3]))
+                               * dzhi4[k];
+                }
+        }
+    }
 
 /*
 // top boundary
@@ -377,7 +399,7 @@ interp4top(w[ijk-kk1], w[ijk    ], w[ijk+kk1], w[ijk+kk2]) * interp4top(w[ijk-kk
  */
 }
 
-void Advec_4m::advec_s(double * restrict st, double * restrict s, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
+void Advec_4m::advec_s(real * restrict st, real * restrict s, real * restrict u, real * restrict v, real * restrict w, real * restrict dzi4)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -419,29 +441,36 @@ void Advec_4m::advec_s(double * restrict st, double * restrict s, double * restr
                        * dzi4[kstart];
         }
 
-    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend-1; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                st[ijk] +=
-                         - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
-                                 u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
-                                 u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
-                                 u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
-
-                         - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
-                                 v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
-                                 v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
-                                 v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
-
-                         - grad4x(w[ijk-kk1] * interp2(s[ijk-kk3], s[ijk    ]),
-                                  w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
-                                  w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
-                                  w[ijk+kk2] * interp2(s[ijk    ], s[ijk+kk3])) 
-                           * dzi4[k];
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj1 + k*kk1;
+                    st[ijk] +=
+                             - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
+                                     u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
+                                     u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
+                                     u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
+
+                             - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
+                                     v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
+                                     v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
+                                     v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
+
+                             - grad4x(w[ijk-kk1] * interp2(s[ijk-kk3], s[ijk    ]),
+                                      w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
+                                      w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
+                                      w[ijk+kk2] * interp2(s[ijk    ], s[ijk+kk3])) 
+                               * dzi4[k];
+                }
+        }
+    }
 
     // top boundary
     for (int j=grid->jstart; j<grid->jend; ++j)
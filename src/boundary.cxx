@@ -58,7 +58,7 @@ Boundary::~Boundary()
     sbc.clear();
 
     // clean up time dependent data
-    for (std::map<std::string, double *>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
+    for (std::map<std::string, real *>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
         delete[] it->second;
 }
 
@@ -253,7 +253,7 @@ void Boundary::update_time_dependent()
     for (FieldMap::const_iterator it1=fields->sp.begin(); it1!=fields->sp.end(); ++it1)
     {
         std::string name = "sbot[" + it1->first + "]";
-        std::map<std::string, double *>::const_iterator it2 = timedepdata.find(name);
+        std::map<std::string, real *>::const_iterator it2 = timedepdata.find(name);
         if (it2 != timedepdata.end())
         {
             sbc[it1->first]->bot = fac0*it2->second[index0] + fac1*it2->second[index1];
@@ -367,9 +367,9 @@ void Boundary::exec_stats(Mask* m)
 namespace
 {
     template<int spatial_order>
-    void calc_slave_bc_bot(double* const restrict abot, double* const restrict agradbot, double* const restrict afluxbot,
-                           const double* const restrict a,
-                           const Grid* const grid, const double* const restrict dzhi,
+    void calc_slave_bc_bot(real* const restrict abot, real* const restrict agradbot, real* const restrict afluxbot,
+                           const real* const restrict a,
+                           const Grid* const grid, const real* const restrict dzhi,
                            const Boundary::Boundary_type boundary_type, const double visc)
     {
         const int jj = grid->icells;
@@ -480,7 +480,7 @@ Boundary* Boundary::factory(Master* masterin, Input* inputin, Model* modelin)
     }
 }
 
-void Boundary::set_bc(double* restrict a, double* restrict agrad, double* restrict aflux, Boundary_type sw, double aval, double visc, double offset)
+void Boundary::set_bc(real* restrict a, real* restrict agrad, real* restrict aflux, Boundary_type sw, double aval, double visc, double offset)
 {
     int ij,jj;
     jj = grid->icells;
@@ -520,8 +520,8 @@ void Boundary::set_bc(double* restrict a, double* restrict agrad, double* restri
 }
 
 // BOUNDARY CONDITIONS THAT CONTAIN A 2D PATTERN
-void Boundary::calc_ghost_cells_bot_2nd(double* restrict a, double* restrict dzh, Boundary_type boundary_type,
-                                        double* restrict abot, double* restrict agradbot)
+void Boundary::calc_ghost_cells_bot_2nd(real* restrict a, real* restrict dzh, Boundary_type boundary_type,
+                                        real* restrict abot, real* restrict agradbot)
 {
     int ij,ijk,jj,kk,kstart;
 
@@ -554,8 +554,8 @@ void Boundary::calc_ghost_cells_bot_2nd(double* restrict a, double* restrict dzh
     }
 }
 
-void Boundary::calc_ghost_cells_top_2nd(double* restrict a, double* restrict dzh, Boundary_type boundary_type,
-                                        double* restrict atop, double* restrict agradtop)
+void Boundary::calc_ghost_cells_top_2nd(real* restrict a, real* restrict dzh, Boundary_type boundary_type,
+                                        real* restrict atop, real* restrict agradtop)
 {
     int ij,ijk,jj,kk,kend;
 
@@ -588,8 +588,8 @@ void Boundary::calc_ghost_cells_top_2nd(double* restrict a, double* restrict dzh
     }
 }
 
-void Boundary::calc_ghost_cells_bot_4th(double* restrict a, double* restrict z, Boundary_type boundary_type,
-                                        double* restrict abot, double* restrict agradbot)
+void Boundary::calc_ghost_cells_bot_4th(real* restrict a, real* restrict z, Boundary_type boundary_type,
+                                        real* restrict abot, real* restrict agradbot)
 {
     int ij,ijk,jj,kk1,kk2,kstart;
 
@@ -627,8 +627,8 @@ void Boundary::calc_ghost_cells_bot_4th(double* restrict a, double* restrict z,
     }
 }
 
-void Boundary::calc_ghost_cells_top_4th(double* restrict a, double* restrict z, Boundary_type boundary_type,
-                                        double* restrict atop, double* restrict agradtop)
+void Boundary::calc_ghost_cells_top_4th(real* restrict a, real* restrict z, Boundary_type boundary_type,
+                                        real* restrict atop, real* restrict agradtop)
 {
     const int kend = grid->kend;
 
@@ -665,7 +665,7 @@ void Boundary::calc_ghost_cells_top_4th(double* restrict a, double* restrict z,
 }
 
 // BOUNDARY CONDITIONS FOR THE VERTICAL VELOCITY (NO PENETRATION)
-void Boundary::calc_ghost_cells_botw_cons_4th(double* restrict w)
+void Boundary::calc_ghost_cells_botw_cons_4th(real* restrict w)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
@@ -683,7 +683,7 @@ void Boundary::calc_ghost_cells_botw_cons_4th(double* restrict w)
         }
 }
 
-void Boundary::calc_ghost_cells_topw_cons_4th(double* restrict w)
+void Boundary::calc_ghost_cells_topw_cons_4th(real* restrict w)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
@@ -701,7 +701,7 @@ void Boundary::calc_ghost_cells_topw_cons_4th(double* restrict w)
         }
 }
 
-void Boundary::calc_ghost_cells_botw_4th(double* restrict w)
+void Boundary::calc_ghost_cells_botw_4th(real* restrict w)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
@@ -719,7 +719,7 @@ void Boundary::calc_ghost_cells_botw_4th(double* restrict w)
         }
 }
 
-void Boundary::calc_ghost_cells_topw_4th(double* restrict w)
+void Boundary::calc_ghost_cells_topw_4th(real* restrict w)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
@@ -186,9 +186,9 @@ void Boundary_surface::process_input(Input *inputin)
 
 void Boundary_surface::init_surface()
 {
-    obuk  = new double[grid->ijcells];
+    obuk  = new real[grid->ijcells];
     nobuk = new int   [grid->ijcells];
-    ustar = new double[grid->ijcells];
+    ustar = new real[grid->ijcells];
 
     stats = model->stats;
 
@@ -275,7 +275,7 @@ void Boundary_surface::init_solver()
     zL_sl = new float[nzL];
     f_sl  = new float[nzL];
 
-    double* zL_tmp = new double[nzL];
+    real* zL_tmp = new real[nzL];
 
     // Calculate the non-streched part between -5 to 10 z/L with 9/10 of the points,
     // and stretch up to -1e4 in the negative limit.
@@ -370,10 +370,10 @@ void Boundary_surface::update_slave_bcs()
     // the fields are computed by the surface model in update_bcs.
 }
 
-void Boundary_surface::stability(double* restrict ustar, double* restrict obuk, double* restrict bfluxbot,
-                                 double* restrict u    , double* restrict v   , double* restrict b       ,
-                                 double* restrict ubot , double* restrict vbot, double* restrict bbot    ,
-                                 double* restrict dutot, double* restrict z)
+void Boundary_surface::stability(real* restrict ustar, real* restrict obuk, real* restrict bfluxbot,
+                                 real* restrict u    , real* restrict v   , real* restrict b       ,
+                                 real* restrict ubot , real* restrict vbot, real* restrict bbot    ,
+                                 real* restrict dutot, real* restrict z)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -440,10 +440,10 @@ void Boundary_surface::stability(double* restrict ustar, double* restrict obuk,
     }
 }
 
-void Boundary_surface::stability_neutral(double* restrict ustar, double* restrict obuk,
-                                         double* restrict u    , double* restrict v   ,
-                                         double* restrict ubot , double* restrict vbot,
-                                         double* restrict dutot, double* restrict z)
+void Boundary_surface::stability_neutral(real* restrict ustar, real* restrict obuk,
+                                         real* restrict u    , real* restrict v   ,
+                                         real* restrict ubot , real* restrict vbot,
+                                         real* restrict dutot, real* restrict z)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -508,9 +508,9 @@ void Boundary_surface::stability_neutral(double* restrict ustar, double* restric
     }
 }
 
-void Boundary_surface::surfm(double* restrict ustar, double* restrict obuk, 
-                             double* restrict u, double* restrict ubot, double* restrict ugradbot, double* restrict ufluxbot, 
-                             double* restrict v, double* restrict vbot, double* restrict vgradbot, double* restrict vfluxbot, 
+void Boundary_surface::surfm(real* restrict ustar, real* restrict obuk, 
+                             real* restrict u, real* restrict ubot, real* restrict ugradbot, real* restrict ufluxbot, 
+                             real* restrict v, real* restrict vbot, real* restrict vgradbot, real* restrict vfluxbot, 
                              double zsl, int bcbot)
 {
     const int ii = 1;
@@ -603,8 +603,8 @@ ijk = i + j*jj + kstart*kk;
         }
 }
 
-void Boundary_surface::surfs(double* restrict ustar, double* restrict obuk, double* restrict var,
-                             double* restrict varbot, double* restrict vargradbot, double* restrict varfluxbot, 
+void Boundary_surface::surfs(real* restrict ustar, real* restrict obuk, real* restrict var,
+                             real* restrict varbot, real* restrict vargradbot, real* restrict varfluxbot, 
                              double zsl, int bcbot)
 {
     const int jj = grid->icells;
@@ -90,8 +90,8 @@ void Boundary_surface_bulk::init(Input *inputin)
         throw 1;
 
     // 2. Allocate the fields
-    obuk  = new double[grid->ijcells];
-    ustar = new double[grid->ijcells];
+    obuk  = new real[grid->ijcells];
+    ustar = new real[grid->ijcells];
 
     // Cross sections
     allowedcrossvars.push_back("ustar");
@@ -135,7 +135,7 @@ void Boundary_surface_bulk::set_values()
 }
 
 //#ifndef USECUDA
-void Boundary_surface_bulk::calculate_du(double* restrict dutot, double* restrict u, double* restrict v, double* restrict ubot, double* restrict vbot)
+void Boundary_surface_bulk::calculate_du(real* restrict dutot, real* restrict u, real* restrict v, real* restrict ubot, real* restrict vbot)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -159,11 +159,11 @@ void Boundary_surface_bulk::calculate_du(double* restrict dutot, double* restric
     grid->boundary_cyclic_2d(dutot);
 }
 
-void Boundary_surface_bulk::momentum_fluxgrad(double* restrict ufluxbot, double* restrict vfluxbot, 
-                                      double* restrict ugradbot, double* restrict vgradbot,
-                                      double* restrict u, double* restrict v, 
-                                      double* restrict ubot, double* restrict vbot, 
-                                      double* restrict dutot, const double Cm, const double zsl)
+void Boundary_surface_bulk::momentum_fluxgrad(real* restrict ufluxbot, real* restrict vfluxbot, 
+                                      real* restrict ugradbot, real* restrict vgradbot,
+                                      real* restrict u, real* restrict v, 
+                                      real* restrict ubot, real* restrict vbot, 
+                                      real* restrict dutot, const double Cm, const double zsl)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -197,8 +197,8 @@ void Boundary_surface_bulk::momentum_fluxgrad(double* restrict ufluxbot, double*
         }
 }
 
-void Boundary_surface_bulk::scalar_fluxgrad(double* restrict sfluxbot, double* restrict sgradbot, double* restrict s, double* restrict sbot,
-                                    double* restrict dutot, const double Cs, const double zsl) 
+void Boundary_surface_bulk::scalar_fluxgrad(real* restrict sfluxbot, real* restrict sgradbot, real* restrict s, real* restrict sbot,
+                                    real* restrict dutot, const double Cs, const double zsl) 
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -227,7 +227,7 @@ void Boundary_surface_bulk::scalar_fluxgrad(double* restrict sfluxbot, double* r
         }
 }
 
-void Boundary_surface_bulk::surface_scaling(double* restrict ustar, double* restrict obuk, double* restrict dutot, double* restrict bfluxbot, const double Cm)
+void Boundary_surface_bulk::surface_scaling(real* restrict ustar, real* restrict obuk, real* restrict dutot, real* restrict bfluxbot, const double Cm)
 {
     const int ii = 1;
     const int jj = grid->icells;
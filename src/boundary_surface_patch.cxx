@@ -183,7 +183,7 @@ void Boundary_surface_patch::get_surface_mask(Field3d* field)
         }
 }
 
-void Boundary_surface_patch::calc_patch(double* const restrict patch, const double* const restrict x, const double* const restrict y,
+void Boundary_surface_patch::calc_patch(real* const restrict patch, const real* const restrict x, const real* const restrict y,
                                         const int patch_dim, 
                                         const double patch_xh, const double patch_xr, const double patch_xi,
                                         const double patch_yh, const double patch_yr, const double patch_yi,
@@ -211,8 +211,8 @@ void Boundary_surface_patch::calc_patch(double* const restrict patch, const doub
         }
 }
 
-void Boundary_surface_patch::set_bc_patch(double* restrict a, double* restrict agrad, double* restrict aflux, 
-                                          double* restrict patch, const double patch_facl, const double patch_facr,
+void Boundary_surface_patch::set_bc_patch(real* restrict a, real* restrict agrad, real* restrict aflux, 
+                                          real* restrict patch, const double patch_facl, const double patch_facr,
                                           const int sw, const double aval, const double visc, const double offset)
 {
     const int jj = grid->icells;
@@ -65,8 +65,8 @@ Budget_2::~Budget_2()
 
 void Budget_2::init()
 {
-    umodel = new double[grid.kcells];
-    vmodel = new double[grid.kcells];
+    umodel = new real[grid.kcells];
+    vmodel = new real[grid.kcells];
 
     for (int k=0; k<grid.kcells; ++k)
     {
@@ -296,8 +296,8 @@ namespace
  * @param TO-DO
  */
 void Budget_2::calc_kinetic_energy(double* const restrict ke, double* const restrict tke,
-                                   const double* const restrict u, const double* const restrict v, const double* const restrict w,
-                                   const double* const restrict umodel, const double* const restrict vmodel,
+                                   const real* const restrict u, const real* const restrict v, const real* const restrict w,
+                                   const real* const restrict umodel, const real* const restrict vmodel,
                                    const double utrans, const double vtrans)
 {
     const int ii = 1;
@@ -362,10 +362,10 @@ void Budget_2::calc_advection_terms(double* const restrict u2_shear, double* con
                                     double* const restrict u2_turb,  double* const restrict v2_turb,
                                     double* const restrict w2_turb, double* const restrict tke_turb,
                                     double* const restrict uw_turb, double* const restrict vw_turb,
-                                    const double* const restrict u, const double* const restrict v, const double* const restrict w,
-                                    const double* const restrict umean, const double* const restrict vmean,
-                                    double* const restrict wx, double* const restrict wy,
-                                    const double* const restrict dzi, const double* const restrict dzhi)
+                                    const real* const restrict u, const real* const restrict v, const real* const restrict w,
+                                    const real* const restrict umean, const real* const restrict vmean,
+                                    real* const restrict wx, real* const restrict wy,
+                                    const real* const restrict dzi, const real* const restrict dzhi)
 {
     // Interpolate the vertical velocity to {xh,y,zh} (wx, below u) and {x,yh,zh} (wy, below v)
     const int wloc [3] = {0,0,1};
@@ -538,9 +538,9 @@ void Budget_2::calc_advection_terms(double* const restrict u2_shear, double* con
  */
 void Budget_2::calc_advection_terms_scalar(double* const restrict s2_shear, double* const restrict s2_turb,
                                            double* const restrict sw_shear, double* const restrict sw_turb,
-                                           const double* const restrict s, const double* const restrict w,
-                                           const double* const restrict smean,
-                                           const double* const restrict dzi, const double* const restrict dzhi)
+                                           const real* const restrict s, const real* const restrict w,
+                                           const real* const restrict smean,
+                                           const real* const restrict dzi, const real* const restrict dzhi)
 {
     const int jj = grid.icells;
     const int kk = grid.ijcells;
@@ -601,10 +601,10 @@ void Budget_2::calc_pressure_terms(double* const restrict w2_pres,  double* cons
                                    double* const restrict uw_pres,  double* const restrict vw_pres,
                                    double* const restrict u2_rdstr, double* const restrict v2_rdstr, double* const restrict w2_rdstr,
                                    double* const restrict uw_rdstr, double* const restrict vw_rdstr,
-                                   const double* const restrict u, const double* const restrict v,
-                                   const double* const restrict w, const double* const restrict p,
-                                   const double* const restrict umean, const double* const restrict vmean,
-                                   const double* const restrict dzi, const double* const restrict dzhi, const double dxi, const double dyi)
+                                   const real* const restrict u, const real* const restrict v,
+                                   const real* const restrict w, const real* const restrict p,
+                                   const real* const restrict umean, const real* const restrict vmean,
+                                   const real* const restrict dzi, const real* const restrict dzhi, const double dxi, const double dyi)
 {
     const int ii = 1;
     const int jj = grid.icells;
@@ -763,9 +763,9 @@ void Budget_2::calc_pressure_terms(double* const restrict w2_pres,  double* cons
  * @param TO-DO
  */
 void Budget_2::calc_pressure_terms_scalar(double* const restrict sw_pres, double* const restrict sw_rdstr,
-                                          const double* const restrict s, const double* const restrict p,
-                                          const double* const restrict smean, const double* const restrict pmean,
-                                          const double* const restrict dzi, const double* const restrict dzhi)
+                                          const real* const restrict s, const real* const restrict p,
+                                          const real* const restrict smean, const real* const restrict pmean,
+                                          const real* const restrict dzi, const real* const restrict dzhi)
 {
     const int jj = grid.icells;
     const int kk = grid.ijcells;
@@ -814,13 +814,13 @@ void Budget_2::calc_diffusion_terms_LES(double* const restrict u2_diss, double*
                                         double* const restrict u2_diff, double* const restrict v2_diff,
                                         double* const restrict w2_diff, double* const restrict tke_diff,
                                         double* const restrict uw_diff, double* const restrict vw_diff,
-                                        double* const restrict wz, double* const restrict evisch, double* const restrict wy,
-                                        const double* const restrict u, const double* const restrict v,
-                                        const double* const restrict w,
-                                        const double* const restrict ufluxbot, const double* const restrict vfluxbot,
-                                        const double* const restrict evisc,
-                                        const double* const restrict umean, const double* const restrict vmean,
-                                        const double* const restrict dzi, const double* const restrict dzhi,
+                                        real* const restrict wz, real* const restrict evisch, real* const restrict wy,
+                                        const real* const restrict u, const real* const restrict v,
+                                        const real* const restrict w,
+                                        const real* const restrict ufluxbot, const real* const restrict vfluxbot,
+                                        const real* const restrict evisc,
+                                        const real* const restrict umean, const real* const restrict vmean,
+                                        const real* const restrict dzi, const real* const restrict dzhi,
                                         const double dxi, const double dyi)
 {
     const int ii = 1;
@@ -1288,10 +1288,10 @@ void Budget_2::calc_diffusion_terms_DNS(double* const restrict u2_visc, double*
                                         double* const restrict w2_visc, double* const restrict tke_visc, double* const restrict uw_visc,
                                         double* const restrict u2_diss, double* const restrict v2_diss,
                                         double* const restrict w2_diss, double* const restrict tke_diss, double* const restrict uw_diss,
-                                        double* const restrict wz, double* const restrict wx, double* const restrict wy,
-                                        const double* const restrict u, const double* const restrict v,
-                                        const double* const restrict w, const double* const restrict umean, const double* const restrict vmean,
-                                        const double* const restrict dzi, const double* const restrict dzhi,
+                                        real* const restrict wz, real* const restrict wx, real* const restrict wy,
+                                        const real* const restrict u, const real* const restrict v,
+                                        const real* const restrict w, const real* const restrict umean, const real* const restrict vmean,
+                                        const real* const restrict dzi, const real* const restrict dzhi,
                                         const double dxi, const double dyi, const double visc)
 {
     // Interpolate the vertical velocity to {xh,y,zh} (wx, below u) and {x,yh,zh} (wy, below v)
@@ -1572,9 +1572,9 @@ void Budget_2::calc_diffusion_terms_DNS(double* const restrict u2_visc, double*
  */
 void Budget_2::calc_diffusion_terms_scalar_DNS(double* const restrict b2_visc, double* const restrict b2_diss,
                                                double* const restrict bw_visc, double* const restrict bw_diss,
-                                               const double* const restrict b, const double* const restrict w,
-                                               const double* const restrict bmean,
-                                               const double* const restrict dzi, const double* const restrict dzhi,
+                                               const real* const restrict b, const real* const restrict w,
+                                               const real* const restrict bmean,
+                                               const real* const restrict dzi, const real* const restrict dzhi,
                                                const double dxi, const double dyi, const double visc, const double diff)
 {
     const int ii = 1;
@@ -1686,10 +1686,10 @@ void Budget_2::calc_diffusion_terms_scalar_DNS(double* const restrict b2_visc, d
  */
 void Budget_2::calc_buoyancy_terms(double* const restrict w2_buoy, double* const restrict tke_buoy,
                                    double* const restrict uw_buoy, double* const restrict vw_buoy,
-                                   const double* const restrict u, const double* const restrict v,
-                                   const double* const restrict w, const double* const restrict b,
-                                   const double* const restrict umean, const double* const restrict vmean,
-                                   const double* const restrict bmean)
+                                   const real* const restrict u, const real* const restrict v,
+                                   const real* const restrict w, const real* const restrict b,
+                                   const real* const restrict umean, const real* const restrict vmean,
+                                   const real* const restrict bmean)
 {
     const int ii = 1;
     const int jj = grid.icells;
@@ -1759,8 +1759,8 @@ void Budget_2::calc_buoyancy_terms(double* const restrict w2_buoy, double* const
  * @param TO-DO
  */
 void Budget_2::calc_buoyancy_terms_scalar(double* const restrict sw_buoy,
-                                          const double* const restrict s, const double* const restrict b,
-                                          const double* const restrict smean, const double* const restrict bmean)
+                                          const real* const restrict s, const real* const restrict b,
+                                          const real* const restrict smean, const real* const restrict bmean)
 {
     const int jj = grid.icells;
     const int kk = grid.ijcells;
@@ -1792,8 +1792,8 @@ void Budget_2::calc_buoyancy_terms_scalar(double* const restrict sw_buoy,
  */
 void Budget_2::calc_coriolis_terms(double* const restrict u2_cor, double* const restrict v2_cor,
                                    double* const restrict uw_cor, double* const restrict vw_cor,
-                                   const double* const restrict u, const double* const restrict v, const double* const restrict w,
-                                   const double* const restrict umean, const double* const restrict vmean,
+                                   const real* const restrict u, const real* const restrict v, const real* const restrict w,
+                                   const real* const restrict umean, const real* const restrict vmean,
                                    const double fc)
 {
     const int ii = 1;
@@ -51,8 +51,8 @@ Budget_4::~Budget_4()
 
 void Budget_4::init()
 {
-    umodel = new double[grid.kcells];
-    vmodel = new double[grid.kcells];
+    umodel = new real[grid.kcells];
+    vmodel = new real[grid.kcells];
 
     for (int k=0; k<grid.kcells; ++k)
     {
@@ -202,7 +202,7 @@ void Budget_4::exec_stats(Mask* m)
         if (thermo.get_switch() != "0")
         {
             // calculate the sorted buoyancy profile, tmp1 still contains the buoyancy
-            stats.calc_sorted_prof(fields.atmp["tmp1"]->data, fields.atmp["tmp2"]->data, m->profs["bsort"].data);
+            stats.calc_sorted_prof(fields.atmp["tmp1"]->data, m->profs["bsort"].data);
 
             // calculate the potential energy back, tmp1 contains the buoyancy, tmp2 will contain height that the local buoyancy
             // will reach in the sorted profile
@@ -232,8 +232,8 @@ void Budget_4::exec_stats(Mask* m)
     }
 }
 
-void Budget_4::calc_ke(double* restrict u, double* restrict v, double* restrict w,
-                       double* restrict umodel, double* restrict vmodel,
+void Budget_4::calc_ke(real* restrict u, real* restrict v, real* restrict w,
+                       real* restrict umodel, real* restrict vmodel,
                        double utrans, double vtrans,
                        double* restrict ke, double* restrict tke)
 {
@@ -288,12 +288,12 @@ void Budget_4::calc_ke(double* restrict u, double* restrict v, double* restrict
     }
 }
 
-void Budget_4::calc_tke_budget_shear_turb(double* restrict u, double* restrict v, double* restrict w,
-                                          double* restrict wx, double* restrict wy,
-                                          double* restrict umean, double* restrict vmean,
+void Budget_4::calc_tke_budget_shear_turb(real* restrict u, real* restrict v, real* restrict w,
+                                          real* restrict wx, real* restrict wy,
+                                          real* restrict umean, real* restrict vmean,
                                           double* restrict u2_shear, double* restrict v2_shear, double* restrict tke_shear, double* restrict uw_shear,
                                           double* restrict u2_turb, double* restrict v2_turb, double* restrict w2_turb, double* restrict tke_turb, double* restrict uw_turb,
-                                          double* restrict dzi4, double* restrict dzhi4)
+                                          real* restrict dzi4, real* restrict dzhi4)
 {
     // 1. INTERPOLATE THE VERTICAL VELOCITY TO U AND V LOCATION
     const int wloc [3] = {0,0,1};
@@ -584,14 +584,14 @@ void Budget_4::calc_tke_budget_shear_turb(double* restrict u, double* restrict v
     }
 }
 
-void Budget_4::calc_tke_budget(double* restrict u, double* restrict v, double* restrict w, double* restrict p,
-                               double* restrict wz, double* restrict uz,
-                               double* restrict umean, double* restrict vmean,
+void Budget_4::calc_tke_budget(real* restrict u, real* restrict v, real* restrict w, real* restrict p,
+                               real* restrict wz, real* restrict uz,
+                               real* restrict umean, real* restrict vmean,
                                double* restrict u2_visc, double* restrict v2_visc, double* restrict w2_visc, double* restrict tke_visc, double* restrict uw_visc,
                                double* restrict u2_diss, double* restrict v2_diss, double* restrict w2_diss, double* restrict tke_diss, double* restrict uw_diss,
                                double* restrict w2_pres, double* restrict tke_pres, double* restrict uw_pres,
                                double* restrict u2_rdstr, double* restrict v2_rdstr, double* restrict w2_rdstr, double* restrict uw_rdstr,
-                               double* restrict dzi4, double* restrict dzhi4, double visc)
+                               real* restrict dzi4, real* restrict dzhi4, double visc)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -2047,8 +2047,8 @@ void Budget_4::calc_tke_budget(double* restrict u, double* restrict v, double* r
     }
 }
 
-void Budget_4::calc_tke_budget_buoy(double* restrict u, double* restrict w, double* restrict b,
-                                    double* restrict umean, double* restrict bmean,
+void Budget_4::calc_tke_budget_buoy(real* restrict u, real* restrict w, real* restrict b,
+                                    real* restrict umean, real* restrict bmean,
                                     double* restrict w2_buoy, double* restrict tke_buoy, double* restrict uw_buoy)
 {
     const int ii1 = 1;
@@ -2106,10 +2106,10 @@ void Budget_4::calc_tke_budget_buoy(double* restrict u, double* restrict w, doub
     }
 }
 
-void Budget_4::calc_b2_budget(double* restrict w, double* restrict b,
-                              double* restrict bmean,
+void Budget_4::calc_b2_budget(real* restrict w, real* restrict b,
+                              real* restrict bmean,
                               double* restrict b2_shear, double* restrict b2_turb, double* restrict b2_visc, double* restrict b2_diss,
-                              double* restrict dzi4, double* restrict dzhi4,
+                              real* restrict dzi4, real* restrict dzhi4,
                               const double visc)
 {
     const int ii1 = 1;
@@ -2415,11 +2415,11 @@ void Budget_4::calc_b2_budget(double* restrict w, double* restrict b,
 
 }
 
-void Budget_4::calc_bw_budget(double* restrict w, double* restrict p, double* restrict b, double* restrict bz,
-                              double* restrict pmean, double* restrict bmean,
+void Budget_4::calc_bw_budget(real* restrict w, real* restrict p, real* restrict b, real* restrict bz,
+                              real* restrict pmean, real* restrict bmean,
                               double* restrict bw_shear, double* restrict bw_turb, double* restrict bw_visc,
                               double* restrict bw_buoy, double* restrict bw_rdstr, double* restrict bw_diss, double* restrict bw_pres,
-                              double* restrict dzi4, double* restrict dzhi4,
+                              real* restrict dzi4, real* restrict dzhi4,
                               const double visc)
 {
     const int ii1 = 1;
@@ -2963,8 +2963,8 @@ void Budget_4::calc_bw_budget(double* restrict w, double* restrict p, double* re
     }
 }
 
-void Budget_4::calc_pe(double* restrict b, double* restrict zsort, double* restrict zsortbot, double* restrict zsorttop,
-                       double* restrict z,
+void Budget_4::calc_pe(real* restrict b, real* restrict zsort, real* restrict zsortbot, real* restrict zsorttop,
+                       real* restrict z,
                        double* restrict bsort,
                        double* restrict pe_total, double* restrict pe_avail, double* restrict pe_bg,
                        double* restrict zsortprof)
@@ -3092,7 +3092,7 @@ void Budget_4::calc_pe(double* restrict b, double* restrict zsort, double* restr
         }
 }
 
-double Budget_4::calc_zsort(double b, double* restrict bsort, double* restrict z, int k)
+double Budget_4::calc_zsort(double b, double* restrict bsort, real* restrict z, int k)
 {
     double zsortval;
     int ks = k;
@@ -3120,7 +3120,7 @@ double Budget_4::calc_zsort(double b, double* restrict bsort, double* restrict z
     return zsortval;
 }
 
-double Budget_4::calc_dzstardb(double b, double* restrict bsort, double* restrict z)
+double Budget_4::calc_dzstardb(double b, real* restrict bsort, real* restrict z)
 {
     // start the iteration below the grid to make sure not to miss values below the first full level
     int k = grid.kstart-1;
@@ -3155,9 +3155,9 @@ double Budget_4::calc_dzstardb(double b, double* restrict bsort, double* restric
 }
 
 
-void Budget_4::calc_pe_budget(double* restrict w, double* restrict b, double* restrict bz, double* restrict bztop,
+void Budget_4::calc_pe_budget(real* restrict w, real* restrict b, real* restrict bz, real* restrict bztop,
                               double* restrict pe_turb, double* restrict pe_visc, double* restrict pe_bous,
-                              double* restrict z, double* restrict zh, double* restrict dzi4, double* restrict dzhi4,
+                              real* restrict z, real* restrict zh, real* restrict dzi4, real* restrict dzhi4,
                               double visc)
 {
     const int jj1 = 1*grid.icells;
@@ -3359,11 +3359,11 @@ void Budget_4::calc_pe_budget(double* restrict w, double* restrict b, double* re
     }
 }
 
-// void Budget_4::calcBpeBudget(double* restrict w, double* restrict b,
-//                            double* restrict bz, double* restrict bzbot, double* restrict bztop,
-//                            double* restrict bpe_turb, double* restrict bpe_visc, double* restrict bpe_diss,
-//                            double* restrict bsort,
-//                            double* restrict z, double* restrict dzi4, double* restrict dzhi4,
+// void Budget_4::calcBpeBudget(real* restrict w, real* restrict b,
+//                            real* restrict bz, real* restrict bzbot, real* restrict bztop,
+//                            real* restrict bpe_turb, real* restrict bpe_visc, real* restrict bpe_diss,
+//                            real* restrict bsort,
+//                            real* restrict z, real* restrict dzi4, real* restrict dzhi4,
 //                            double visc)
 // {
 //   int ijk,ii1,ii2,ii3,jj1,jj2,jj3,kk1,kk2,kk3;
@@ -58,7 +58,7 @@ Buffer::Buffer(Model* modelin, Input* inputin)
 
 Buffer::~Buffer()
 {
-    for (std::map<std::string, double*>::const_iterator it=bufferprofs.begin(); it!=bufferprofs.end(); ++it)
+    for (std::map<std::string, real*>::const_iterator it=bufferprofs.begin(); it!=bufferprofs.end(); ++it)
         delete[] it->second;
 
     #ifdef USECUDA
@@ -72,13 +72,13 @@ void Buffer::init()
     {
         if (swupdate == "1")
         {
-            bufferprofs["w"] = new double[grid->kcells];
+            bufferprofs["w"] = new real[grid->kcells];
         }
         else
         {
             // Allocate the buffer arrays.
             for (FieldMap::const_iterator it=fields->ap.begin(); it!=fields->ap.end(); ++it)
-                bufferprofs[it->first] = new double[grid->kcells];
+                bufferprofs[it->first] = new real[grid->kcells];
         }
     }
 }
@@ -166,8 +166,8 @@ void Buffer::exec()
 }
 #endif
 
-void Buffer::buffer(double* const restrict at, const double* const restrict a, 
-                    const double* const restrict abuf, const double* const restrict z)
+void Buffer::buffer(real* const restrict at, const real* const restrict a, 
+                    const real* const restrict abuf, const real* const restrict z)
 { 
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -66,6 +66,17 @@ Cross::Cross(Model* modelin, Input* inputin)
         nerror += inputin->get_list(&xz, "cross", "xz", "");
         nerror += inputin->get_list(&yz, "cross", "yz", "");
         nerror += inputin->get_list(&xy, "cross", "xy", "");
+
+        // save every slice in its own binary file, or append all slices of a variable to one NetCDF file
+        nerror += inputin->get_item(&swformat, "cross", "swformat", "", "binary");
+        if (!(swformat == "binary" || swformat == "netcdf"))
+        {
+            master->print_error("\"%s\" is an illegal value for swformat\n", swformat.c_str());
+            ++nerror;
+        }
+
+        // read the optional error bounds for lossy compression, lossy NetCDF cross-sections need a library that can deflate in parallel
+        nerror += grid->get_error_bounds(bounds, inputin, "cross", crosslist, swformat);
     }
 
     if (nerror)
@@ -74,15 +85,36 @@ Cross::Cross(Model* modelin, Input* inputin)
 
 Cross::~Cross()
 {
+    // a destructor cannot throw, a failed close has been reported by the grid
+    for (std::map<std::string, Cross_file>::iterator it=crossfiles.begin(); it!=crossfiles.end(); ++it)
+    {
+        try
+        {
+            grid->close_cross_file(it->second);
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+// the NetCDF files are synchronized when the model flushes its output, not after every record
+void Cross::flush()
+{
+    for (std::map<std::string, Cross_file>::iterator it=crossfiles.begin(); it!=crossfiles.end(); ++it)
+        grid->sync_cross_file(it->second);
 }
 
 // check whether saving the slice was successful and print appropriate message
-int Cross::check_save(int error, char* filename)
+int Cross::check_save(int error, char* filename, Error_bound* bound)
 {
     master->print_message("Saving \"%s\" ... ", filename);
     if (error == 0)
     {
-        master->print_message("OK\n");
+        if (bound)
+            master->print_message("OK (maximum error %g)\n", bound->maxerror);
+        else
+            master->print_message("OK\n");
         return 0;
     }
     else
@@ -92,6 +124,81 @@ int Cross::check_save(int error, char* filename)
     }
 }
 
+Cross_file& Cross::get_cross_file(std::string name, std::string plane, const std::vector<int>& indices, const int* loc)
+{
+    // create the file at the first sampling time, the start time is part of the name to allow restarts
+    const std::string key = name + "." + plane;
+    std::map<std::string, Cross_file>::iterator it = crossfiles.find(key);
+    if (it == crossfiles.end())
+    {
+        char filename[256];
+        std::sprintf(filename, "%s.%s.%07d.nc", name.c_str(), plane.c_str(), model->timeloop->get_iotime());
+
+        // the file is stored before it is created, such that the destructor closes a partly defined file
+        it = crossfiles.insert(std::make_pair(key, Cross_file())).first;
+        grid->create_cross_file(it->second, filename, name, plane, indices, loc, get_bound(name) != 0);
+    }
+
+    grid->add_cross_record(it->second, model->timeloop->get_time());
+
+    return it->second;
+}
+
+int Cross::save_slices(real* restrict data, real* restrict tmp, std::string name, std::string plane,
+                       const std::vector<int>& indices, const int* loc)
+{
+    int nerror = 0;
+    char filename[256];
+    Error_bound* bound = get_bound(name);
+
+    if (indices.empty())
+        return 0;
+
+    if (swformat == "netcdf")
+    {
+        // a failing NetCDF call throws, so only the successful saves are reported
+        Cross_file& file = get_cross_file(name, plane, indices, loc);
+
+        // all slices are stored in the same record, in the order of the index list
+        for (int n=0; n<(int)indices.size(); ++n)
+        {
+            if (plane == "xz")
+                grid->save_xz_slice(data, tmp, file, indices[n], n, bound);
+            else if (plane == "yz")
+                grid->save_yz_slice(data, tmp, file, indices[n], n, bound);
+            else
+                grid->save_xy_slice(data, tmp, file, indices[n], n, bound);
+        }
+
+        std::sprintf(filename, "%s", file.filename.c_str());
+        nerror += check_save(0, filename, bound);
+    }
+    else
+    {
+        for (std::vector<int>::const_iterator it=indices.begin(); it!=indices.end(); ++it)
+        {
+            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), plane.c_str(), *it, model->timeloop->get_iotime());
+            if (plane == "xz")
+                nerror += check_save(grid->save_xz_slice(data, tmp, filename, *it, bound), filename, bound);
+            else if (plane == "yz")
+                nerror += check_save(grid->save_yz_slice(data, tmp, filename, *it, bound), filename, bound);
+            else
+                nerror += check_save(grid->save_xy_slice(data, tmp, filename, *it, bound), filename, bound);
+        }
+    }
+
+    return nerror;
+}
+
+Error_bound* Cross::get_bound(std::string name)
+{
+    std::map<std::string, Error_bound>::iterator it = bounds.find(name);
+    if (it == bounds.end() || it->second.type == "0")
+        return 0;
+
+    return &it->second;
+}
+
 void Cross::init(double ifactor)
 {
     if (swcross == "0")
@@ -287,80 +394,46 @@ bool Cross::do_cross()
         return false;
 }
 
-int Cross::cross_simple(double* restrict data, double* restrict tmp, std::string name)
+int Cross::cross_simple(real* restrict data, real* restrict tmp, std::string name)
 {
     int nerror = 0;
-    char filename[256];
 
-    // loop over the index arrays to save all xz cross sections
-    if (name == "v")
-    {
-        for (std::vector<int>::iterator it=jxzh.begin(); it<jxzh.end(); ++it)
-        {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xz", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_xz_slice(data, tmp, filename, *it), filename);    
-        }
-    }
-    else
-    {
-        for (std::vector<int>::iterator it=jxz.begin(); it<jxz.end(); ++it)
-        {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xz", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_xz_slice(data, tmp, filename, *it), filename);    
-        }
-    }
-    
-    // loop over the index arrays to save all yz cross sections
-    if (name == "u")
-    {
-        for (std::vector<int>::iterator it=ixzh.begin(); it<ixzh.end(); ++it)
-        {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "yz", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_yz_slice(data, tmp, filename, *it), filename);    
-        }
-    }
-    else
-    {
-        for (std::vector<int>::iterator it=ixz.begin(); it<ixz.end(); ++it)
-        {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "yz", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_yz_slice(data, tmp, filename, *it), filename);    
-        }
-    }
+    // the velocity components are located at the half levels in their own direction
+    const int loc[3] = {name == "u", name == "v", name == "w"};
 
-    if (name == "w")
-    {
-        // loop over the index arrays to save all xy cross sections
-        for (std::vector<int>::iterator it=kxyh.begin(); it<kxyh.end(); ++it)
-        {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xy", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_xy_slice(data, tmp, filename, *it), filename);
-        }
-    }
-    else
-    {
-        for (std::vector<int>::iterator it=kxy.begin(); it<kxy.end(); ++it)
-        {
-            std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xy", *it, model->timeloop->get_iotime());
-            nerror += check_save(grid->save_xy_slice(data, tmp, filename, *it), filename);
-        }
-    }
+    // save all xz, yz and xy cross sections, at the half levels for the velocity components
+    nerror += save_slices(data, tmp, name, "xz", (name == "v") ? jxzh : jxz, loc);
+    nerror += save_slices(data, tmp, name, "yz", (name == "u") ? ixzh : ixz, loc);
+    nerror += save_slices(data, tmp, name, "xy", (name == "w") ? kxyh : kxy, loc);
 
     return nerror;
 }
 
-int Cross::cross_plane(double* restrict data, double* restrict tmp, std::string name)
+int Cross::cross_plane(real* restrict data, real* restrict tmp, std::string name)
 {
     int nerror = 0;
     char filename[256];
+    Error_bound* bound = get_bound(name);
+
+    if (swformat == "netcdf")
+    {
+        const int loc[3] = {0, 0, 0};
+        Cross_file& file = get_cross_file(name, "xy", std::vector<int>(), loc);
+        grid->save_xy_slice(data, tmp, file, -1, 0, bound);
 
-    std::sprintf(filename, "%s.%s.%07d", name.c_str(), "xy", model->timeloop->get_iotime());
-    nerror += check_save(grid->save_xy_slice(data, tmp, filename), filename);
+        std::sprintf(filename, "%s", file.filename.c_str());
+        nerror += check_save(0, filename, bound);
+    }
+    else
+    {
+        std::sprintf(filename, "%s.%s.%07d", name.c_str(), "xy", model->timeloop->get_iotime());
+        nerror += check_save(grid->save_xy_slice(data, tmp, filename, -1, bound), filename, bound);
+    }
 
     return nerror;
-} 
+}
 
-int Cross::cross_lngrad(double* restrict a, double* restrict lngrad, double* restrict tmp, double* restrict dzi4, std::string name)
+int Cross::cross_lngrad(real* restrict a, real* restrict lngrad, real* restrict tmp, real* restrict dzi4, std::string name)
 {
     using namespace Finite_difference::O4;
 
@@ -381,7 +454,6 @@ int Cross::cross_lngrad(double* restrict a, double* restrict lngrad, double* res
     const double dyi = 1./grid->dy;
 
     int nerror = 0;
-    char filename[256];
 
     // calculate the log of the gradient
     // bottom
@@ -455,31 +527,16 @@ int Cross::cross_lngrad(double* restrict a, double* restrict lngrad, double* res
         }
 
 
-    // loop over the index arrays to save all xz cross sections
-    for (std::vector<int>::iterator it=jxz.begin(); it<jxz.end(); ++it)
-    {
-        std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xz", *it, model->timeloop->get_iotime());
-        nerror += check_save(grid->save_xz_slice(lngrad, tmp, filename, *it),filename);
-    }
-    
-    // loop over the index arrays to save all yz cross sections
-    for (std::vector<int>::iterator it=ixz.begin(); it<ixz.end(); ++it)
-    {
-        std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "yz", *it, model->timeloop->get_iotime());
-        nerror += check_save(grid->save_yz_slice(lngrad, tmp, filename, *it),filename);
-    }
-
-    // loop over the index arrays to save all xy cross sections
-    for (std::vector<int>::iterator it=kxy.begin(); it<kxy.end(); ++it)
-    {
-        std::sprintf(filename, "%s.%s.%05d.%07d", name.c_str(), "xy", *it, model->timeloop->get_iotime());
-        nerror += check_save(grid->save_xy_slice(lngrad, tmp, filename, *it),filename);
-    }
+    // save all xz, yz and xy cross sections
+    const int loc[3] = {0, 0, 0};
+    nerror += save_slices(lngrad, tmp, name, "xz", jxz, loc);
+    nerror += save_slices(lngrad, tmp, name, "yz", ixz, loc);
+    nerror += save_slices(lngrad, tmp, name, "xy", kxy, loc);
 
     return nerror;
 }
 
-int Cross::cross_path(double* restrict data, double* restrict tmp, double* restrict tmp1, std::string name)
+int Cross::cross_path(real* restrict data, real* restrict tmp, real* restrict tmp1, std::string name)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -523,7 +580,7 @@ int Cross::cross_path(double* restrict data, double* restrict tmp, double* restr
  * @param Direction Switch for bottom-up (Bottom_to_top) or top-down (Top_to_bottom) 
  * @param name String containing the output name of the cross-section 
  */
-int Cross::cross_height_threshold(double* restrict data, double* restrict height, double* restrict tmp1, double* restrict z, double threshold, Direction direction, std::string name)
+int Cross::cross_height_threshold(real* restrict data, real* restrict height, real* restrict tmp1, real* restrict z, double threshold, Direction direction, std::string name)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
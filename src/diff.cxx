@@ -29,6 +29,7 @@
 #include "defines.h"
 #include "constants.h"
 #include "model.h"
+#include "advec.h"
 
 // diffusion schemes
 #include "diff.h"
@@ -61,14 +62,35 @@ Diff* Diff::factory(Master* masterin, Input* inputin, Model* modelin, const std:
 {
     std::string swdiff;
     std::string swboundary;
+    std::string swfusedadvec;
 
     int nerror = 0;
     nerror += inputin->get_item(&swdiff, "diff", "swdiff", "", swspatialorder);
+    nerror += inputin->get_item(&swfusedadvec, "diff", "swfusedadvec", "", "0");
     // load the boundary switch as well in order to be able to check whether the surface model is used
     nerror += inputin->get_item(&swboundary, "boundary", "swboundary", "", "default");
     if (nerror)
         return 0;
 
+    // the fused advection-diffusion kernels only exist for 2nd order advection and smag2 diffusion on the CPU
+    if (swfusedadvec == "1")
+    {
+        #ifdef USECUDA
+        masterin->print_error("swfusedadvec=\"1\" is not supported for CUDA runs\n");
+        throw 1;
+        #endif
+        if (swdiff != "smag2" || modelin->advec->get_switch() != "2" || swspatialorder != "2")
+        {
+            masterin->print_error("swfusedadvec=\"1\" requires swdiff=\"smag2\", swadvec=\"2\" and swspatialorder=\"2\"\n");
+            throw 1;
+        }
+    }
+    else if (swfusedadvec != "0")
+    {
+        masterin->print_error("\"%s\" is an illegal value for swfusedadvec\n", swfusedadvec.c_str());
+        throw 1;
+    }
+
     if (swdiff == "0")
         return new Diff_disabled(modelin, inputin);
     else if (swdiff == "2")
@@ -73,7 +73,7 @@ void Diff_2::exec()
 }
 #endif
 
-void Diff_2::diff_c(double* restrict at, double* restrict a, double* restrict dzi, double* restrict dzhi, double visc)
+void Diff_2::diff_c(real* restrict at, real* restrict a, real* restrict dzi, real* restrict dzhi, double visc)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -82,23 +82,30 @@ void Diff_2::diff_c(double* restrict at, double* restrict a, double* restrict dz
     const double dxidxi = 1./(grid->dx * grid->dx);
     const double dyidyi = 1./(grid->dy * grid->dy);
 
-    for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart; k<grid->kend; k++)
+        {
+            for (int j=t->jstart; j<t->jend; j++)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                at[ijk] += visc * (
-                        + ( (a[ijk+ii] - a[ijk   ]) 
-                          - (a[ijk   ] - a[ijk-ii]) ) * dxidxi 
-                        + ( (a[ijk+jj] - a[ijk   ]) 
-                          - (a[ijk   ] - a[ijk-jj]) ) * dyidyi
-                        + ( (a[ijk+kk] - a[ijk   ]) * dzhi[k+1]
-                          - (a[ijk   ] - a[ijk-kk]) * dzhi[k]   ) * dzi[k] );
-            }
+                for (int i=t->istart; i<t->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    at[ijk] += visc * (
+                            + ( (a[ijk+ii] - a[ijk   ]) 
+                              - (a[ijk   ] - a[ijk-ii]) ) * dxidxi 
+                            + ( (a[ijk+jj] - a[ijk   ]) 
+                              - (a[ijk   ] - a[ijk-jj]) ) * dyidyi
+                            + ( (a[ijk+kk] - a[ijk   ]) * dzhi[k+1]
+                              - (a[ijk   ] - a[ijk-kk]) * dzhi[k]   ) * dzi[k] );
+                }
+        }
+    }
 }
 
-void Diff_2::diff_w(double* restrict wt, double* restrict w, double* restrict dzi, double* restrict dzhi, double visc)
+void Diff_2::diff_w(real* restrict wt, real* restrict w, real* restrict dzi, real* restrict dzhi, double visc)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -107,18 +114,25 @@ void Diff_2::diff_w(double* restrict wt, double* restrict w, double* restrict dz
     const double dxidxi = 1./(grid->dx*grid->dx);
     const double dyidyi = 1./(grid->dy*grid->dy);
 
-    for (int k=grid->kstart+1; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; k++)
+        {
+            for (int j=t->jstart; j<t->jend; j++)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                wt[ijk] += visc * (
-                        + ( (w[ijk+ii] - w[ijk   ]) 
-                          - (w[ijk   ] - w[ijk-ii]) ) * dxidxi 
-                        + ( (w[ijk+jj] - w[ijk   ]) 
-                          - (w[ijk   ] - w[ijk-jj]) ) * dyidyi
-                        + ( (w[ijk+kk] - w[ijk   ]) * dzi[k]
-                          - (w[ijk   ] - w[ijk-kk]) * dzi[k-1] ) * dzhi[k] );
-            }
+                for (int i=t->istart; i<t->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    wt[ijk] += visc * (
+                            + ( (w[ijk+ii] - w[ijk   ]) 
+                              - (w[ijk   ] - w[ijk-ii]) ) * dxidxi 
+                            + ( (w[ijk+jj] - w[ijk   ]) 
+                              - (w[ijk   ] - w[ijk-jj]) ) * dyidyi
+                            + ( (w[ijk+kk] - w[ijk   ]) * dzi[k]
+                              - (w[ijk   ] - w[ijk-kk]) * dzi[k-1] ) * dzhi[k] );
+                }
+        }
+    }
 }
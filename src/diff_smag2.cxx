@@ -33,10 +33,12 @@
 #include "thermo.h"
 #include "model.h"
 #include "monin_obukhov.h"
+#include "advec_2_functions.h"
 
 namespace
 {
     namespace most = Monin_obukhov;
+    using namespace Advec_2_functions;
 }
 
 Diff_smag_2::Diff_smag_2(Model* modelin, Input* inputin) : Diff(modelin, inputin)
@@ -47,12 +49,15 @@ Diff_smag_2::Diff_smag_2(Model* modelin, Input* inputin) : Diff(modelin, inputin
     mlen_g = 0;
     #endif
 
-    fields->init_diagnostic_field("evisc", "Eddy viscosity", "m2 s-1");
+    // A second instance of the scheme, such as the fused one of the benchmark, shares the eddy viscosity.
+    if (fields->sd.find("evisc") == fields->sd.end())
+        fields->init_diagnostic_field("evisc", "Eddy viscosity", "m2 s-1");
 
     int nerror = 0;
     nerror += inputin->get_item(&dnmax, "diff", "dnmax", "", 0.5  );
     nerror += inputin->get_item(&cs   , "diff", "cs"   , "", 0.23 );
     nerror += inputin->get_item(&tPr  , "diff", "tPr"  , "", 1./3.);
+    nerror += inputin->get_item(&swfusedadvec, "diff", "swfusedadvec", "", "0");
 
     if (nerror)
         throw 1;
@@ -148,12 +153,24 @@ void Diff_smag_2::exec()
 {
     if(model->boundary->get_switch() == "surface")
     {
-        diff_u<false>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh);
-        diff_v<false>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh);
-        diff_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->rhoref, fields->rhorefh);
+        if (swfusedadvec == "1")
+        {
+            diff_u<false, true>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh);
+            diff_v<false, true>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh);
+            diff_w<true>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->rhoref, fields->rhorefh);
+        }
+        else
+        {
+            diff_u<false, false>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh);
+            diff_v<false, false>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh);
+            diff_w<false>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->rhoref, fields->rhorefh);
+        }
 
         for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
             diff_c(it->second->data, fields->sp[it->first]->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
@@ -161,12 +178,24 @@ void Diff_smag_2::exec()
     }
     else
     {
-        diff_u<true>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh);
-        diff_v<true>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh);
-        diff_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->rhoref, fields->rhorefh);
+        if (swfusedadvec == "1")
+        {
+            diff_u<true, true>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh);
+            diff_v<true, true>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh);
+            diff_w<true>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->rhoref, fields->rhorefh);
+        }
+        else
+        {
+            diff_u<true, false>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh);
+            diff_v<true, false>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh);
+            diff_w<false>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                   fields->rhoref, fields->rhorefh);
+        }
 
         for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
             diff_c(it->second->data, fields->sp[it->first]->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
@@ -177,11 +206,11 @@ void Diff_smag_2::exec()
 #endif
 
 template <bool resolved_wall> 
-void Diff_smag_2::calc_strain2(double* restrict strain2,
-                               double* restrict u, double* restrict v, double* restrict w,
-                               double* restrict ufluxbot, double* restrict vfluxbot,
-                               double* restrict ustar, double* restrict obuk,
-                               double* restrict z, double* restrict dzi, double* restrict dzhi)
+void Diff_smag_2::calc_strain2(real* restrict strain2,
+                               real* restrict u, real* restrict v, real* restrict w,
+                               real* restrict ufluxbot, real* restrict vfluxbot,
+                               real* restrict ustar, real* restrict obuk,
+                               real* restrict z, real* restrict dzi, real* restrict dzhi)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -242,50 +271,57 @@ void Diff_smag_2::calc_strain2(double* restrict strain2,
             }
     }
 
-    for (int k=grid->kstart+k_offset; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                strain2[ijk] = 2.*(
-                               // du/dx + du/dx
-                               + std::pow((u[ijk+ii]-u[ijk])*dxi, 2)
-
-                               // dv/dy + dv/dy
-                               + std::pow((v[ijk+jj]-v[ijk])*dyi, 2)
-
-                               // dw/dz + dw/dz
-                               + std::pow((w[ijk+kk]-w[ijk])*dzi[k], 2)
-
-                               // du/dy + dv/dx
-                               + 0.125*std::pow((u[ijk      ]-u[ijk   -jj])*dyi  + (v[ijk      ]-v[ijk-ii   ])*dxi, 2)
-                               + 0.125*std::pow((u[ijk+ii   ]-u[ijk+ii-jj])*dyi  + (v[ijk+ii   ]-v[ijk      ])*dxi, 2)
-                               + 0.125*std::pow((u[ijk   +jj]-u[ijk      ])*dyi  + (v[ijk   +jj]-v[ijk-ii+jj])*dxi, 2)
-                               + 0.125*std::pow((u[ijk+ii+jj]-u[ijk+ii   ])*dyi  + (v[ijk+ii+jj]-v[ijk   +jj])*dxi, 2)
-
-                               // du/dz + dw/dx
-                               + 0.125*std::pow((u[ijk      ]-u[ijk   -kk])*dzhi[k  ] + (w[ijk      ]-w[ijk-ii   ])*dxi, 2)
-                               + 0.125*std::pow((u[ijk+ii   ]-u[ijk+ii-kk])*dzhi[k  ] + (w[ijk+ii   ]-w[ijk      ])*dxi, 2)
-                               + 0.125*std::pow((u[ijk   +kk]-u[ijk      ])*dzhi[k+1] + (w[ijk   +kk]-w[ijk-ii+kk])*dxi, 2)
-                               + 0.125*std::pow((u[ijk+ii+kk]-u[ijk+ii   ])*dzhi[k+1] + (w[ijk+ii+kk]-w[ijk   +kk])*dxi, 2)
-
-                               // dv/dz + dw/dy
-                               + 0.125*std::pow((v[ijk      ]-v[ijk   -kk])*dzhi[k  ] + (w[ijk      ]-w[ijk-jj   ])*dyi, 2)
-                               + 0.125*std::pow((v[ijk+jj   ]-v[ijk+jj-kk])*dzhi[k  ] + (w[ijk+jj   ]-w[ijk      ])*dyi, 2)
-                               + 0.125*std::pow((v[ijk   +kk]-v[ijk      ])*dzhi[k+1] + (w[ijk   +kk]-w[ijk-jj+kk])*dyi, 2)
-                               + 0.125*std::pow((v[ijk+jj+kk]-v[ijk+jj   ])*dzhi[k+1] + (w[ijk+jj+kk]-w[ijk   +kk])*dyi, 2) );
-
-                       // Add a small number to avoid zero divisions.
-                       strain2[ijk] += Constants::dsmall;
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+k_offset; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    strain2[ijk] = 2.*(
+                                   // du/dx + du/dx
+                                   + std::pow((u[ijk+ii]-u[ijk])*dxi, 2)
+
+                                   // dv/dy + dv/dy
+                                   + std::pow((v[ijk+jj]-v[ijk])*dyi, 2)
+
+                                   // dw/dz + dw/dz
+                                   + std::pow((w[ijk+kk]-w[ijk])*dzi[k], 2)
+
+                                   // du/dy + dv/dx
+                                   + 0.125*std::pow((u[ijk      ]-u[ijk   -jj])*dyi  + (v[ijk      ]-v[ijk-ii   ])*dxi, 2)
+                                   + 0.125*std::pow((u[ijk+ii   ]-u[ijk+ii-jj])*dyi  + (v[ijk+ii   ]-v[ijk      ])*dxi, 2)
+                                   + 0.125*std::pow((u[ijk   +jj]-u[ijk      ])*dyi  + (v[ijk   +jj]-v[ijk-ii+jj])*dxi, 2)
+                                   + 0.125*std::pow((u[ijk+ii+jj]-u[ijk+ii   ])*dyi  + (v[ijk+ii+jj]-v[ijk   +jj])*dxi, 2)
+
+                                   // du/dz + dw/dx
+                                   + 0.125*std::pow((u[ijk      ]-u[ijk   -kk])*dzhi[k  ] + (w[ijk      ]-w[ijk-ii   ])*dxi, 2)
+                                   + 0.125*std::pow((u[ijk+ii   ]-u[ijk+ii-kk])*dzhi[k  ] + (w[ijk+ii   ]-w[ijk      ])*dxi, 2)
+                                   + 0.125*std::pow((u[ijk   +kk]-u[ijk      ])*dzhi[k+1] + (w[ijk   +kk]-w[ijk-ii+kk])*dxi, 2)
+                                   + 0.125*std::pow((u[ijk+ii+kk]-u[ijk+ii   ])*dzhi[k+1] + (w[ijk+ii+kk]-w[ijk   +kk])*dxi, 2)
+
+                                   // dv/dz + dw/dy
+                                   + 0.125*std::pow((v[ijk      ]-v[ijk   -kk])*dzhi[k  ] + (w[ijk      ]-w[ijk-jj   ])*dyi, 2)
+                                   + 0.125*std::pow((v[ijk+jj   ]-v[ijk+jj-kk])*dzhi[k  ] + (w[ijk+jj   ]-w[ijk      ])*dyi, 2)
+                                   + 0.125*std::pow((v[ijk   +kk]-v[ijk      ])*dzhi[k+1] + (w[ijk   +kk]-w[ijk-jj+kk])*dyi, 2)
+                                   + 0.125*std::pow((v[ijk+jj+kk]-v[ijk+jj   ])*dzhi[k+1] + (w[ijk+jj+kk]-w[ijk   +kk])*dyi, 2) );
+
+                           // Add a small number to avoid zero divisions.
+                           strain2[ijk] += Constants::dsmall;
+                }
+        }
+    }
 }
 
-void Diff_smag_2::calc_evisc(double* restrict evisc,
-                             double* restrict u, double* restrict v, double* restrict w,  double* restrict N2,
-                             double* restrict ufluxbot, double* restrict vfluxbot, double* restrict bfluxbot,
-                             double* restrict ustar, double* restrict obuk,
-                             double* restrict z, double* restrict dz, double* restrict dzi,
+void Diff_smag_2::calc_evisc(real* restrict evisc,
+                             real* restrict u, real* restrict v, real* restrict w,  real* restrict N2,
+                             real* restrict ufluxbot, real* restrict vfluxbot, real* restrict bfluxbot,
+                             real* restrict ustar, real* restrict obuk,
+                             real* restrict z, real* restrict dz, real* restrict dzi,
                              const double z0m)
 {
     // Variables for the wall damping.
@@ -347,10 +383,10 @@ void Diff_smag_2::calc_evisc(double* restrict evisc,
 }
 
 template <bool resolved_wall>
-void Diff_smag_2::calc_evisc_neutral(double* restrict evisc,
-                                     double* restrict u, double* restrict v, double* restrict w,
-                                     double* restrict ufluxbot, double* restrict vfluxbot,
-                                     double* restrict z, double* restrict dz, const double z0m, const double mvisc)
+void Diff_smag_2::calc_evisc_neutral(real* restrict evisc,
+                                     real* restrict u, real* restrict v, real* restrict w,
+                                     real* restrict ufluxbot, real* restrict vfluxbot,
+                                     real* restrict z, real* restrict dz, const double z0m, const double mvisc)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -416,11 +452,13 @@ void Diff_smag_2::calc_evisc_neutral(double* restrict evisc,
 
 }
 
-template <bool resolved_wall>
-void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restrict v, double* restrict w,
-                         double* restrict dzi, double* restrict dzhi, double* restrict evisc,
-                         double* restrict fluxbot, double* restrict fluxtop,
-                         double* restrict rhoref, double* restrict rhorefh)
+// The momentum diffusion kernels add the 2nd order advection tendency first if with_advec is set,
+// such that the fused path is bitwise identical to calling Advec_2::exec() before Diff_smag_2::exec().
+template <bool resolved_wall, bool with_advec>
+void Diff_smag_2::diff_u(real* restrict ut, real* restrict u, real* restrict v, real* restrict w,
+                         real* restrict dzi, real* restrict dzhi, real* restrict evisc,
+                         real* restrict fluxbot, real* restrict fluxtop,
+                         real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -449,6 +487,8 @@ void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restri
                 evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
                 eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
 
+                if (with_advec)
+                    ut[ijk] += advec_u_2nd(u, v, w, rhoref, rhorefh, dzi, dxi, dyi, ijk, kstart, ii, jj, kk);
                 ut[ijk] +=
                          // du/dx + du/dx
                          + ( evisc[ijk   ]*(u[ijk+ii]-u[ijk   ])*dxi
@@ -472,6 +512,8 @@ void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restri
                 eviscs = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-jj] + evisc[ijk-ii   ] + evisc[ijk   ]);
                 evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
                 eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
+                if (with_advec)
+                    ut[ijk] += advec_u_2nd(u, v, w, rhoref, rhorefh, dzi, dxi, dyi, ijk, kend-1, ii, jj, kk);
                 ut[ijk] +=
                          // du/dx + du/dx
                          + ( evisc[ijk   ]*(u[ijk+ii]-u[ijk   ])*dxi
@@ -485,34 +527,43 @@ void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restri
             }
     }
 
-    for (int k=grid->kstart+k_offset; k<grid->kend-k_offset; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                eviscn = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+jj] + evisc[ijk+jj]);
-                eviscs = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-jj] + evisc[ijk-ii   ] + evisc[ijk   ]);
-                evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
-                eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
-                ut[ijk] +=
-                         // du/dx + du/dx
-                         + ( evisc[ijk   ]*(u[ijk+ii]-u[ijk   ])*dxi
-                           - evisc[ijk-ii]*(u[ijk   ]-u[ijk-ii])*dxi ) * 2.* dxi
-                         // du/dy + dv/dx
-                         + ( eviscn*((u[ijk+jj]-u[ijk   ])*dyi  + (v[ijk+jj]-v[ijk-ii+jj])*dxi)
-                           - eviscs*((u[ijk   ]-u[ijk-jj])*dyi  + (v[ijk   ]-v[ijk-ii   ])*dxi) ) * dyi
-                         // du/dz + dw/dx
-                         + ( rhorefh[k+1] * evisct*((u[ijk+kk]-u[ijk   ])* dzhi[k+1] + (w[ijk+kk]-w[ijk-ii+kk])*dxi)
-                           - rhorefh[k  ] * eviscb*((u[ijk   ]-u[ijk-kk])* dzhi[k  ] + (w[ijk   ]-w[ijk-ii   ])*dxi) ) / rhoref[k] * dzi[k];
-            }
+    #pragma omp parallel for private(eviscn, eviscs, evisct, eviscb)
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+k_offset; k<grid->kend-k_offset; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    eviscn = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+jj] + evisc[ijk+jj]);
+                    eviscs = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-jj] + evisc[ijk-ii   ] + evisc[ijk   ]);
+                    evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
+                    eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
+                    if (with_advec)
+                        ut[ijk] += advec_u_2nd(u, v, w, rhoref, rhorefh, dzi, dxi, dyi, ijk, k, ii, jj, kk);
+                    ut[ijk] +=
+                             // du/dx + du/dx
+                             + ( evisc[ijk   ]*(u[ijk+ii]-u[ijk   ])*dxi
+                               - evisc[ijk-ii]*(u[ijk   ]-u[ijk-ii])*dxi ) * 2.* dxi
+                             // du/dy + dv/dx
+                             + ( eviscn*((u[ijk+jj]-u[ijk   ])*dyi  + (v[ijk+jj]-v[ijk-ii+jj])*dxi)
+                               - eviscs*((u[ijk   ]-u[ijk-jj])*dyi  + (v[ijk   ]-v[ijk-ii   ])*dxi) ) * dyi
+                             // du/dz + dw/dx
+                             + ( rhorefh[k+1] * evisct*((u[ijk+kk]-u[ijk   ])* dzhi[k+1] + (w[ijk+kk]-w[ijk-ii+kk])*dxi)
+                               - rhorefh[k  ] * eviscb*((u[ijk   ]-u[ijk-kk])* dzhi[k  ] + (w[ijk   ]-w[ijk-ii   ])*dxi) ) / rhoref[k] * dzi[k];
+                }
+        }
+    }
 }
 
-template <bool resolved_wall>
-void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restrict v, double* restrict w,
-                         double* restrict dzi, double* restrict dzhi, double* restrict evisc,
-                         double* restrict fluxbot, double* restrict fluxtop,
-                         double* restrict rhoref, double* restrict rhorefh)
+template <bool resolved_wall, bool with_advec>
+void Diff_smag_2::diff_v(real* restrict vt, real* restrict u, real* restrict v, real* restrict w,
+                         real* restrict dzi, real* restrict dzhi, real* restrict evisc,
+                         real* restrict fluxbot, real* restrict fluxtop,
+                         real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -540,6 +591,8 @@ void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restri
                 eviscw = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-ii] + evisc[ijk   -jj] + evisc[ijk   ]);
                 evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
                 eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
+                if (with_advec)
+                    vt[ijk] += advec_v_2nd(u, v, w, rhoref, rhorefh, dzi, dxi, dyi, ijk, kstart, ii, jj, kk);
                 vt[ijk] +=
                          // dv/dx + du/dy
                          + ( evisce*((v[ijk+ii]-v[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-jj])*dyi)
@@ -563,6 +616,8 @@ void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restri
                 eviscw = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-ii] + evisc[ijk   -jj] + evisc[ijk   ]);
                 evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
                 eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
+                if (with_advec)
+                    vt[ijk] += advec_v_2nd(u, v, w, rhoref, rhorefh, dzi, dxi, dyi, ijk, kend-1, ii, jj, kk);
                 vt[ijk] +=
                          // dv/dx + du/dy
                          + ( evisce*((v[ijk+ii]-v[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-jj])*dyi)
@@ -576,32 +631,42 @@ void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restri
             }
     }
 
-    for (int k=grid->kstart+k_offset; k<grid->kend-k_offset; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                evisce = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+ii-jj] + evisc[ijk+ii]);
-                eviscw = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-ii] + evisc[ijk   -jj] + evisc[ijk   ]);
-                evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
-                eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
-                vt[ijk] +=
-                         // dv/dx + du/dy
-                         + ( evisce*((v[ijk+ii]-v[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-jj])*dyi)
-                           - eviscw*((v[ijk   ]-v[ijk-ii])*dxi + (u[ijk   ]-u[ijk   -jj])*dyi) ) * dxi
-                         // dv/dy + dv/dy
-                         + ( evisc[ijk   ]*(v[ijk+jj]-v[ijk   ])*dyi
-                           - evisc[ijk-jj]*(v[ijk   ]-v[ijk-jj])*dyi ) * 2.* dyi
-                         // dv/dz + dw/dy
-                         + ( rhorefh[k+1] * evisct*((v[ijk+kk]-v[ijk   ])*dzhi[k+1] + (w[ijk+kk]-w[ijk-jj+kk])*dyi)
-                           - rhorefh[k  ] * eviscb*((v[ijk   ]-v[ijk-kk])*dzhi[k  ] + (w[ijk   ]-w[ijk-jj   ])*dyi) ) / rhoref[k] * dzi[k];
-            }
+    #pragma omp parallel for private(evisce, eviscw, evisct, eviscb)
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+k_offset; k<grid->kend-k_offset; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    evisce = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+ii-jj] + evisc[ijk+ii]);
+                    eviscw = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-ii] + evisc[ijk   -jj] + evisc[ijk   ]);
+                    evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
+                    eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
+                    if (with_advec)
+                        vt[ijk] += advec_v_2nd(u, v, w, rhoref, rhorefh, dzi, dxi, dyi, ijk, k, ii, jj, kk);
+                    vt[ijk] +=
+                             // dv/dx + du/dy
+                             + ( evisce*((v[ijk+ii]-v[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-jj])*dyi)
+                               - eviscw*((v[ijk   ]-v[ijk-ii])*dxi + (u[ijk   ]-u[ijk   -jj])*dyi) ) * dxi
+                             // dv/dy + dv/dy
+                             + ( evisc[ijk   ]*(v[ijk+jj]-v[ijk   ])*dyi
+                               - evisc[ijk-jj]*(v[ijk   ]-v[ijk-jj])*dyi ) * 2.* dyi
+                             // dv/dz + dw/dy
+                             + ( rhorefh[k+1] * evisct*((v[ijk+kk]-v[ijk   ])*dzhi[k+1] + (w[ijk+kk]-w[ijk-jj+kk])*dyi)
+                               - rhorefh[k  ] * eviscb*((v[ijk   ]-v[ijk-kk])*dzhi[k  ] + (w[ijk   ]-w[ijk-jj   ])*dyi) ) / rhoref[k] * dzi[k];
+                }
+        }
+    }
 }
 
-void Diff_smag_2::diff_w(double* restrict wt, double* restrict u, double* restrict v, double* restrict w,
-                         double* restrict dzi, double* restrict dzhi, double* restrict evisc,
-                         double* restrict rhoref, double* restrict rhorefh)
+template <bool with_advec>
+void Diff_smag_2::diff_w(real* restrict wt, real* restrict u, real* restrict v, real* restrict w,
+                         real* restrict dzi, real* restrict dzhi, real* restrict evisc,
+                         real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -612,33 +677,42 @@ void Diff_smag_2::diff_w(double* restrict wt, double* restrict u, double* restri
 
     double evisce, eviscw, eviscn, eviscs;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                evisce = 0.25*(evisc[ijk   -kk] + evisc[ijk   ] + evisc[ijk+ii-kk] + evisc[ijk+ii]);
-                eviscw = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-ii] + evisc[ijk   -kk] + evisc[ijk   ]);
-                eviscn = 0.25*(evisc[ijk   -kk] + evisc[ijk   ] + evisc[ijk+jj-kk] + evisc[ijk+jj]);
-                eviscs = 0.25*(evisc[ijk-jj-kk] + evisc[ijk-jj] + evisc[ijk   -kk] + evisc[ijk   ]);
-                wt[ijk] +=
-                         // dw/dx + du/dz
-                         + ( evisce*((w[ijk+ii]-w[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-kk])*dzhi[k])
-                           - eviscw*((w[ijk   ]-w[ijk-ii])*dxi + (u[ijk   ]-u[ijk+  -kk])*dzhi[k]) ) * dxi
-                         // dw/dy + dv/dz
-                         + ( eviscn*((w[ijk+jj]-w[ijk   ])*dyi + (v[ijk+jj]-v[ijk+jj-kk])*dzhi[k])
-                           - eviscs*((w[ijk   ]-w[ijk-jj])*dyi + (v[ijk   ]-v[ijk+  -kk])*dzhi[k]) ) * dyi
-                         // dw/dz + dw/dz
-                         + ( rhoref[k  ] * evisc[ijk   ]*(w[ijk+kk]-w[ijk   ])*dzi[k  ]
-                           - rhoref[k-1] * evisc[ijk-kk]*(w[ijk   ]-w[ijk-kk])*dzi[k-1] ) / rhorefh[k] * 2.* dzhi[k];
-            }
+    #pragma omp parallel for private(evisce, eviscw, eviscn, eviscs)
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    evisce = 0.25*(evisc[ijk   -kk] + evisc[ijk   ] + evisc[ijk+ii-kk] + evisc[ijk+ii]);
+                    eviscw = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-ii] + evisc[ijk   -kk] + evisc[ijk   ]);
+                    eviscn = 0.25*(evisc[ijk   -kk] + evisc[ijk   ] + evisc[ijk+jj-kk] + evisc[ijk+jj]);
+                    eviscs = 0.25*(evisc[ijk-jj-kk] + evisc[ijk-jj] + evisc[ijk   -kk] + evisc[ijk   ]);
+                    if (with_advec)
+                        wt[ijk] += advec_w_2nd(u, v, w, rhoref, rhorefh, dzhi, dxi, dyi, ijk, k, ii, jj, kk);
+                    wt[ijk] +=
+                             // dw/dx + du/dz
+                             + ( evisce*((w[ijk+ii]-w[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-kk])*dzhi[k])
+                               - eviscw*((w[ijk   ]-w[ijk-ii])*dxi + (u[ijk   ]-u[ijk+  -kk])*dzhi[k]) ) * dxi
+                             // dw/dy + dv/dz
+                             + ( eviscn*((w[ijk+jj]-w[ijk   ])*dyi + (v[ijk+jj]-v[ijk+jj-kk])*dzhi[k])
+                               - eviscs*((w[ijk   ]-w[ijk-jj])*dyi + (v[ijk   ]-v[ijk+  -kk])*dzhi[k]) ) * dyi
+                             // dw/dz + dw/dz
+                             + ( rhoref[k  ] * evisc[ijk   ]*(w[ijk+kk]-w[ijk   ])*dzi[k  ]
+                               - rhoref[k-1] * evisc[ijk-kk]*(w[ijk   ]-w[ijk-kk])*dzi[k-1] ) / rhorefh[k] * 2.* dzhi[k];
+                }
+        }
+    }
 }
 
-void Diff_smag_2::diff_c(double* restrict at, double* restrict a,
-                         double* restrict dzi, double* restrict dzhi, double* restrict evisc,
-                         double* restrict fluxbot, double* restrict fluxtop, 
-                         double* restrict rhoref, double* restrict rhorefh, double tPr)
+void Diff_smag_2::diff_c(real* restrict at, real* restrict a,
+                         real* restrict dzi, real* restrict dzhi, real* restrict evisc,
+                         real* restrict fluxbot, real* restrict fluxtop, 
+                         real* restrict rhoref, real* restrict rhorefh, double tPr)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -674,27 +748,34 @@ void Diff_smag_2::diff_c(double* restrict at, double* restrict a,
                        + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
         }
 
-    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
-                eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
-                eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
-                eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
-                evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
-                eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
-
-                at[ijk] +=
-                         + ( evisce*(a[ijk+ii]-a[ijk   ]) 
-                           - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
-                         + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
-                           - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
-                         + ( rhorefh[k+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[k+1]
-                           - rhorefh[k  ] * eviscb*(a[ijk   ]-a[ijk-kk])*dzhi[k]  ) / rhoref[k] * dzi[k];
-            }
+    #pragma omp parallel for private(evisce, eviscw, eviscn, eviscs, evisct, eviscb)
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend-1; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
+                    eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
+                    eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
+                    eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
+                    evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
+                    eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
+
+                    at[ijk] +=
+                             + ( evisce*(a[ijk+ii]-a[ijk   ]) 
+                               - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
+                             + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
+                               - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
+                             + ( rhorefh[k+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[k+1]
+                               - rhorefh[k  ] * eviscb*(a[ijk   ]-a[ijk-kk])*dzhi[k]  ) / rhoref[k] * dzi[k];
+                }
+        }
+    }
 
     // top boundary
     for (int j=grid->jstart; j<grid->jend; ++j)
@@ -720,7 +801,7 @@ void Diff_smag_2::diff_c(double* restrict at, double* restrict a,
         }
 }
 
-double Diff_smag_2::calc_dnmul(double* restrict evisc, double* restrict dzi, double tPr)
+double Diff_smag_2::calc_dnmul(real* restrict evisc, real* restrict dzi, double tPr)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -732,6 +813,7 @@ double Diff_smag_2::calc_dnmul(double* restrict evisc, double* restrict dzi, dou
     double dnmul = 0;
 
     // get the maximum time step for diffusion
+    #pragma omp parallel for reduction(max:dnmul)
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
@@ -45,10 +45,31 @@ Dump::Dump(Model *modelin, Input *inputin)
     {  
         nerror += inputin->get_item(&sampletime, "dump", "sampletime", "");
         nerror += inputin->get_list(&dumplist ,  "dump", "dumplist" ,  "");
+        nerror += inputin->get_item(&swcompress, "dump", "swcompress", "", "0");
+        nerror += inputin->get_item(&swformat  , "dump", "swformat"  , "", "binary");
     }  
 
     if (nerror)
         throw 1;
+
+    if (swdump == "1" && !(swcompress == "0" || swcompress == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swcompress\n", swcompress.c_str());
+        throw 1;
+    }
+
+    if (swdump == "1" && !(swformat == "binary" || swformat == "netcdf"))
+    {
+        master->print_error("\"%s\" is an illegal value for swformat\n", swformat.c_str());
+        throw 1;
+    }
+
+    // read the optional error bounds for lossy compression, compressed NetCDF dumps need a library that can deflate in parallel
+    if (swdump == "1")
+        nerror += grid->get_error_bounds(bounds, inputin, "dump", dumplist, swformat, swcompress == "1");
+
+    if (nerror)
+        throw 1;
 }
 
 Dump::~Dump()
@@ -103,19 +124,40 @@ bool Dump::do_dump()
         return false;
 }
 
-void Dump::save_dump(double * restrict data, double * restrict tmp, std::string varname)
+void Dump::save_dump(real * restrict data, real * restrict tmp, std::string varname)
 {
     const double NoOffset = 0.;
     char filename[256];
 
-    std::sprintf(filename, "%s.%07d", varname.c_str(), model->timeloop->get_iotime());
+    if (swformat == "netcdf")
+        std::sprintf(filename, "%s.%07d.nc", varname.c_str(), model->timeloop->get_iotime());
+    else
+        std::sprintf(filename, "%s.%07d", varname.c_str(), model->timeloop->get_iotime());
     master->print_message("Saving \"%s\" ... ", filename);
 
-    if (grid->save_field3d(data, tmp, fields->atmp["tmp2"]->data, filename, NoOffset))
+    // a lossy dump is always compressed, because the rounded off bits only reduce the size after compression
+    Error_bound& bound = bounds[varname];
+    const bool lossy = (bound.type != "0");
+    const bool compress = (swcompress == "1" || lossy);
+
+    // the dumped diagnostic fields are located at the full levels
+    const int loc[3] = {0, 0, 0};
+
+    int nerror = 0;
+    if (swformat == "netcdf")
+        grid->save_field3d_netcdf(data, tmp, filename, varname, loc, model->timeloop->get_time(), compress, &bound);
+    else
+        nerror += grid->save_field3d(data, tmp, fields->atmp["tmp2"]->data, filename, NoOffset, compress, &bound);
+
+    if (nerror)
     {
         master->print_message("FAILED\n");
         throw 1;
     }  
+    else if (lossy)
+    {
+        master->print_message("OK (maximum error %g)\n", bound.maxerror);
+    }
     else
     {
         master->print_message("OK\n");
@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <iostream>
 #include <cmath>
+#include <new>
 #include "master.h"
 #include "grid.h"
 #include "field3d.h"
@@ -60,7 +61,7 @@ Field3d::Field3d(Grid* gridin, Master* masterin, std::string namein, std::string
 #ifndef USECUDA
 Field3d::~Field3d()
 {
-    delete[] data;
+    FFTW(free)(data);
     delete[] databot;
     delete[] datatop;
     delete[] datamean;
@@ -73,22 +74,25 @@ Field3d::~Field3d()
 int Field3d::init()
 {
     // Calculate the total field memory size
-    const long fieldMemorySize = (grid->ncells + 6*grid->ijcells + grid->kcells)*sizeof(double);
+    const long fieldMemorySize = (grid->ncells + 6*grid->ijcells + grid->kcells)*sizeof(real);
 
     // Keep track of the total memory in fields
     static long totalMemorySize = 0;
     try
     {
         totalMemorySize += fieldMemorySize;
-        // Allocate all fields belonging to the 3d field
-        data = new double[grid->ncells];
-        databot = new double[grid->ijcells];
-        datatop = new double[grid->ijcells];
-        datamean = new double[grid->kcells];
-        datagradbot = new double[grid->ijcells];
-        datagradtop = new double[grid->ijcells];
-        datafluxbot = new double[grid->ijcells];
-        datafluxtop = new double[grid->ijcells];
+        // Allocate all fields belonging to the 3d field, the 3d data is aligned as in FFTW3
+        // as the fourier transforms of the pressure solver are executed directly on the fields
+        data = FFTW(alloc_real)(grid->ncells);
+        if (data == 0)
+            throw std::bad_alloc();
+        databot = new real[grid->ijcells];
+        datatop = new real[grid->ijcells];
+        datamean = new real[grid->kcells];
+        datagradbot = new real[grid->ijcells];
+        datagradtop = new real[grid->ijcells];
+        datafluxbot = new real[grid->ijcells];
+        datafluxtop = new real[grid->ijcells];
     }
     catch (std::exception &e)
     {
@@ -31,6 +31,7 @@
 #include "defines.h"
 #include "finite_difference.h"
 #include "model.h"
+#include "timeloop.h"
 #include "stats.h"
 #include "cross.h"
 #include "dump.h"
@@ -43,12 +44,12 @@ Fields::Fields(Model *modelin, Input *inputin)
     master = model->master;
 
     calc_mean_profs = false;
+    saveerror = 0;
+    savetimefile = false;
 
     // Initialize the pointers.
     rhoref  = 0;
     rhorefh = 0;
-    umodel  = 0;
-    vmodel  = 0;
 
     // Initialize GPU pointers
     rhoref_g  = 0;
@@ -60,6 +61,9 @@ Fields::Fields(Model *modelin, Input *inputin)
     // obligatory parameters
     nerror += inputin->get_item(&visc, "fields", "visc", "");
 
+    // optional parameters
+    nerror += inputin->get_item(&swasyncsave, "fields", "swasyncsave", "", "0");
+
     // read the name of the passive scalars
     std::vector<std::string> slist;
     nerror += inputin->get_list(&slist, "fields", "slist", "");
@@ -74,6 +78,12 @@ Fields::Fields(Model *modelin, Input *inputin)
     if (nerror)
         throw 1;
 
+    if (!(swasyncsave == "0" || swasyncsave == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swasyncsave\n", swasyncsave.c_str());
+        throw 1;
+    }
+
     // initialize the basic set of fields
     init_momentum_field(u, ut, "u", "U velocity", "m s-1");
     init_momentum_field(v, vt, "v", "V velocity", "m s-1");
@@ -100,6 +110,10 @@ Fields::Fields(Model *modelin, Input *inputin)
 
 Fields::~Fields()
 {
+    // let a pending save finish before the fields are freed, its errors cannot be reported anymore
+    if (savethread.joinable())
+        savethread.join();
+
     // DEALLOCATE ALL THE FIELDS
     // deallocate the prognostic velocity fields
     for (FieldMap::iterator it=mp.begin(); it!=mp.end(); ++it)
@@ -128,8 +142,6 @@ Fields::~Fields()
     // delete the arrays
     delete[] rhoref;
     delete[] rhorefh;
-    delete[] umodel;
-    delete[] vmodel;
 
 #ifdef USECUDA
     clear_device();
@@ -181,8 +193,8 @@ void Fields::init()
         throw 1;
 
     // allocate the base density profiles
-    rhoref  = new double[grid->kcells];
-    rhorefh = new double[grid->kcells];
+    rhoref  = new real[grid->kcells];
+    rhorefh = new real[grid->kcells];
 
     // \TODO Define a reference density. Needs to be replaced once anelastic is there
     // BvS: Always init rhoref at 1 for situation with e.g. thermo=0? For anelastic, overwrite it.
@@ -192,17 +204,6 @@ void Fields::init()
         rhorefh[k] = 1.; 
     }
 
-    // allocate help arrays for statistics;
-    umodel = new double[grid->kcells];
-    vmodel = new double[grid->kcells];
-
-    // Initialize at zero
-    for (int k=0; k<grid->kcells; ++k)
-    {
-        umodel[k] = 0.;
-        vmodel[k] = 0.; 
-    }
-
     // Get global cross-list from cross.cxx
     std::vector<std::string> *crosslist_global = model->cross->get_crosslist(); 
 
@@ -279,9 +280,9 @@ void Fields::get_mask(Field3d *mfield, Field3d *mfieldh, Mask *m)
                        stats->nmask, stats->nmaskh, &stats->nmaskbot, w->data);
 }
 
-void Fields::calc_mask_wplus(double* restrict mask, double* restrict maskh, double* restrict maskbot,
+void Fields::calc_mask_wplus(real* restrict mask, real* restrict maskh, real* restrict maskbot,
         int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot,
-        double* restrict w)
+        real* restrict w)
 {
     int ijk,ij,jj,kk,kstart;
 
@@ -339,9 +340,9 @@ void Fields::calc_mask_wplus(double* restrict mask, double* restrict maskh, doub
     *nmaskbot = nmaskh[grid->kstart];
 }
 
-void Fields::calc_mask_wmin(double* restrict mask, double* restrict maskh, double* restrict maskbot,
+void Fields::calc_mask_wmin(real* restrict mask, real* restrict maskh, real* restrict maskbot,
         int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot,
-        double* restrict w)
+        real* restrict w)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -395,7 +396,7 @@ void Fields::calc_mask_wmin(double* restrict mask, double* restrict maskh, doubl
     *nmaskbot = nmaskh[grid->kstart];
 }
 
-void Fields::exec_stats(Mask *m)
+void Fields::exec_stats()
 {
     // define locations
     const int uloc[] = {1,0,0};
@@ -403,179 +404,62 @@ void Fields::exec_stats(Mask *m)
     const int wloc[] = {0,0,1};
     const int sloc[] = {0,0,0};
 
-    const int uwloc[] = {1,0,1};
-    const int vwloc[] = {0,1,1};
-
     const double NoOffset = 0.;
 
-    // save the area coverage of the mask
-    stats->calc_area(m->profs["area" ].data, sloc, stats->nmask );
-    stats->calc_area(m->profs["areah"].data, wloc, stats->nmaskh);
+    // save the area coverage of the selected masks
+    stats->calc_area("area" , sloc);
+    stats->calc_area("areah", wloc);
 
-    // start with the stats on the w location, to make the wmean known for the flux calculations
-    stats->calc_mean(m->profs["w"].data, w->data, NoOffset, wloc, atmp["tmp4"]->data, stats->nmaskh);
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(w->data, m->profs["w"].data, m->profs["w"+sn].data, n, wloc,
-                          atmp["tmp4"]->data, stats->nmaskh);
-    }
-
-    // calculate the stats on the u location
-    // interpolate the mask horizontally onto the u coordinate
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp3"]->data, sloc, uloc);
-    stats->calc_mean(m->profs["u"].data, u->data, grid->utrans, uloc, atmp["tmp1"]->data, stats->nmask);
-    stats->calc_mean(umodel            , u->data, NoOffset   , uloc, atmp["tmp1"]->data, stats->nmask);
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(u->data, umodel, m->profs["u"+sn].data, n, uloc,
-                          atmp["tmp1"]->data, stats->nmask);
-    }
-
-    // interpolate the mask on half level horizontally onto the u coordinate
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp4"]->data, wloc, uwloc);
-    if (grid->swspatialorder == "2")
-    {
-        stats->calc_grad_2nd(u->data, m->profs["ugrad"].data, grid->dzhi, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(u->data, umodel, w->data, m->profs["w"].data,
-                            m->profs["uw"].data, atmp["tmp2"]->data, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        if (model->diff->get_switch() == "smag2")
-            stats->calc_diff_2nd(u->data, w->data, sd["evisc"]->data,
-                                m->profs["udiff"].data, grid->dzhi,
-                                u->datafluxbot, u->datafluxtop, 1., uloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
-        else
-            stats->calc_diff_2nd(u->data, m->profs["udiff"].data, grid->dzhi, visc, uloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
+    // the sample is computed in two phases: first all means are staged and reduced at once,
+    // then the moments and fluxes that depend on them are staged for the next reduction
+    stats->calc_mean("w", w->data, NoOffset, wloc);
+    stats->calc_mean("u", u->data, grid->utrans, uloc);
+    stats->calc_mean("v", v->data, grid->vtrans, vloc);
+    for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        stats->calc_mean(it->first, it->second->data, NoOffset, sloc);
+    stats->calc_mean("p", sd["p"]->data, NoOffset, sloc);
+    if (model->diff->get_switch() == "smag2")
+        stats->calc_mean("evisc", sd["evisc"]->data, NoOffset, sloc);
 
-    }
-    else if (grid->swspatialorder == "4")
-    {
-        stats->calc_grad_4th(u->data, m->profs["ugrad"].data, grid->dzhi4, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_4th(u->data, w->data, m->profs["uw"].data, atmp["tmp2"]->data, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_diff_4th(u->data, m->profs["udiff"].data, grid->dzhi4, visc, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-    }
+    stats->reduce_profs();
 
-    // calculate the stats on the v location
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp3"]->data, sloc, vloc);
-    stats->calc_mean(m->profs["v"].data, v->data, grid->vtrans, vloc, atmp["tmp1"]->data, stats->nmask);
-    stats->calc_mean(vmodel            , v->data, NoOffset   , vloc, atmp["tmp1"]->data, stats->nmask);
-    for (int n=2; n<5; ++n)
+    // the diffusive fluxes follow from the eddy viscosity or from the gradient and the constant viscosity
+    real* evisc = 0;
+    double tPr = 1.;
+    if (model->diff->get_switch() == "smag2")
     {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(v->data, vmodel, m->profs["v"+sn].data, n, vloc,
-                          atmp["tmp1"]->data, stats->nmask);
+        evisc = sd["evisc"]->data;
+        tPr = static_cast<Diff_smag_2*>(model->diff)->tPr;
     }
 
-    // interpolate the mask on half level horizontally onto the u coordinate
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp4"]->data, wloc, vwloc);
-    if (grid->swspatialorder == "2")
-    {
-        stats->calc_grad_2nd(v->data, m->profs["vgrad"].data, grid->dzhi, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(v->data, vmodel, w->data, m->profs["w"].data,
-                            m->profs["vw"].data, atmp["tmp2"]->data, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        if (model->diff->get_switch() == "smag2")
-            stats->calc_diff_2nd(v->data, w->data, sd["evisc"]->data,
-                                m->profs["vdiff"].data, grid->dzhi,
-                                v->datafluxbot, v->datafluxtop, 1., vloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
-        else
-            stats->calc_diff_2nd(v->data, m->profs["vdiff"].data, grid->dzhi, visc, vloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
-
-    }
-    else if (grid->swspatialorder == "4")
-    {
-        stats->calc_grad_4th(v->data, m->profs["vgrad"].data, grid->dzhi4, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_4th(v->data, w->data, m->profs["vw"].data, atmp["tmp2"]->data, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_diff_4th(v->data, m->profs["vdiff"].data, grid->dzhi4, visc, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-    }
+    // the moments and fluxes of the velocity components are computed without the Galilean transformation
+    stats->calc_moments(w->data, "w", NoOffset, "w2", "w3", "w4", wloc);
+    stats->calc_moments_fluxes(u->data, "u", grid->utrans, "u2", "u3", "u4",
+                               w->data, atmp["tmp2"]->data, "uw", "ugrad", "udiff", visc,
+                               evisc, u->datafluxbot, u->datafluxtop, 1., uloc);
+    stats->calc_moments_fluxes(v->data, "v", grid->vtrans, "v2", "v3", "v4",
+                               w->data, atmp["tmp2"]->data, "vw", "vgrad", "vdiff", visc,
+                               evisc, v->datafluxbot, v->datafluxtop, 1., vloc);
 
     // calculate stats for the prognostic scalars
-    Diff_smag_2 *diffptr = static_cast<Diff_smag_2 *>(model->diff);
     for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
     {
-        stats->calc_mean(m->profs[it->first].data, it->second->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
-        for (int n=2; n<5; ++n)
-        {
-            std::stringstream ss;
-            ss << n;
-            std::string sn = ss.str();
-            stats->calc_moment(it->second->data, m->profs[it->first].data, m->profs[it->first+sn].data, n, sloc,
-                    atmp["tmp3"]->data, stats->nmask);
-        }
-        if (grid->swspatialorder == "2")
-        {
-            stats->calc_grad_2nd(it->second->data, m->profs[it->first+"grad"].data, grid->dzhi, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            stats->calc_flux_2nd(it->second->data, m->profs[it->first].data, w->data, m->profs["w"].data,
-                                m->profs[it->first+"w"].data, atmp["tmp1"]->data, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            if (model->diff->get_switch() == "smag2")
-                stats->calc_diff_2nd(it->second->data, w->data, sd["evisc"]->data,
-                                    m->profs[it->first+"diff"].data, grid->dzhi,
-                                    it->second->datafluxbot, it->second->datafluxtop, diffptr->tPr, sloc,
-                                    atmp["tmp4"]->data, stats->nmaskh);
-            else
-                stats->calc_diff_2nd(it->second->data, m->profs[it->first+"diff"].data, grid->dzhi, it->second->visc, sloc,
-                                    atmp["tmp4"]->data, stats->nmaskh);
-        }
-        else if (grid->swspatialorder == "4")
-        {
-            stats->calc_grad_4th(it->second->data, m->profs[it->first+"grad"].data, grid->dzhi4, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            stats->calc_flux_4th(it->second->data, w->data, m->profs[it->first+"w"].data, atmp["tmp1"]->data, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            stats->calc_diff_4th(it->second->data, m->profs[it->first+"diff"].data, grid->dzhi4, it->second->visc, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-        }
+        const std::string& name = it->first;
+        stats->calc_moments_fluxes(it->second->data, name, NoOffset, name+"2", name+"3", name+"4",
+                                   w->data, atmp["tmp1"]->data, name+"w", name+"grad", name+"diff", it->second->visc,
+                                   evisc, it->second->datafluxbot, it->second->datafluxtop, tPr, sloc);
     }
 
     // Calculate pressure statistics
-    stats->calc_mean(m->profs["p"].data, sd["p"]->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
-    stats->calc_moment(sd["p"]->data, m->profs["p"].data, m->profs["p2"].data, 2, sloc,
-                      atmp["tmp1"]->data, stats->nmask);
-    if (grid->swspatialorder == "2")
-    {
-        stats->calc_grad_2nd(sd["p"]->data, m->profs["pgrad"].data, grid->dzhi, sloc,
-                             atmp["tmp4"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(sd["p"]->data, m->profs["p"].data, w->data, m->profs["w"].data,
-                            m->profs["pw"].data, atmp["tmp1"]->data, sloc,
-                            atmp["tmp4"]->data, stats->nmaskh);
-    }
-    else if (grid->swspatialorder == "4")
-    {
-        stats->calc_grad_4th(sd["p"]->data, m->profs["pgrad"].data, grid->dzhi4, sloc,
-                             atmp["tmp4"]->data, stats->nmaskh);
-        stats->calc_flux_4th(sd["p"]->data, w->data, m->profs["pw"].data, atmp["tmp1"]->data, sloc,
-                             atmp["tmp4"]->data, stats->nmaskh);
-    }
+    stats->calc_moments_fluxes(sd["p"]->data, "p", NoOffset, "p2", "", "",
+                               w->data, atmp["tmp1"]->data, "pw", "pgrad", "", 0.,
+                               0, 0, 0, 0., sloc);
 
     // calculate the total fluxes
-    stats->add_fluxes(m->profs["uflux"].data, m->profs["uw"].data, m->profs["udiff"].data);
-    stats->add_fluxes(m->profs["vflux"].data, m->profs["vw"].data, m->profs["vdiff"].data);
+    stats->add_fluxes("uflux", "uw", "udiff");
+    stats->add_fluxes("vflux", "vw", "vdiff");
     for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-        stats->add_fluxes(m->profs[it->first+"flux"].data, m->profs[it->first+"w"].data, m->profs[it->first+"diff"].data);
-
-    if (model->diff->get_switch() == "smag2")
-        stats->calc_mean(m->profs["evisc"].data, sd["evisc"]->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
+        stats->add_fluxes(it->first+"flux", it->first+"w", it->first+"diff");
 }
 
 void Fields::set_calc_mean_profs(bool sw)
@@ -701,7 +585,7 @@ void Fields::create(Input *inputin)
         throw 1;
 }
 
-int Fields::randomize(Input* inputin, std::string fld, double* restrict data)
+int Fields::randomize(Input* inputin, std::string fld, real* restrict data)
 {
     int nerror = 0;
 
@@ -792,9 +676,9 @@ int Fields::add_vortex_pair(Input* inputin)
     return nerror;
 }
 
-int Fields::add_mean_prof(Input* inputin, std::string fld, double* restrict data, double offset)
+int Fields::add_mean_prof(Input* inputin, std::string fld, real* restrict data, double offset)
 {
-    double proftemp[grid->kmax];
+    real proftemp[grid->kmax];
 
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -819,6 +703,33 @@ void Fields::load(int n)
 
     int nerror = 0;
 
+    // load all fields from the restart container if it exists, otherwise from the files per field
+    char restartname[256];
+    std::sprintf(restartname, "restart.%07d", n);
+    if (grid->has_restart(restartname))
+    {
+        master->print_message("Loading \"%s\" ... ", restartname);
+
+        Restart_header header;
+        std::vector<std::string> names;
+        std::vector<real*> data;
+        for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
+        {
+            names.push_back(it->first);
+            data.push_back(it->second->data);
+        }
+
+        if (grid->read_restart_header(restartname, header) ||
+            grid->load_restart(restartname, header, names, data, atmp["tmp1"]->data, atmp["tmp2"]->data))
+        {
+            master->print_message("FAILED\n");
+            throw 1;
+        }
+        master->print_message("OK\n");
+
+        return;
+    }
+
     for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
     {
         // the offset is kept at zero, otherwise bitwise identical restarts is not possible
@@ -912,6 +823,139 @@ void Fields::save(int n)
     const double NoOffset = 0.;
 
     int nerror = 0;
+
+    // the restart container stores all prognostic fields and the time state in a single file
+    const bool container = (model->timeloop->get_restart_switch() == "container");
+    char restartname[256];
+    std::sprintf(restartname, "restart.%07d", n);
+
+    Restart_header header;
+    std::vector<real*> data;
+    if (container)
+    {
+        header.itime     = model->timeloop->get_itime();
+        header.idt       = model->timeloop->get_idt();
+        header.iteration = model->timeloop->get_iteration();
+        for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
+        {
+            header.names.push_back(it->first);
+            data.push_back(it->second->data);
+        }
+    }
+
+    // compressed restarts are always written synchronously, because the compression needs communication
+    const bool compress = (model->timeloop->get_compress_switch() == "1");
+
+    // in asynchronous mode, the fields are copied into the staging buffer and the files are written
+    // on a background thread while the time integration continues, only the next save has to wait
+    if (swasyncsave == "1" && master->mode == "run" && !compress)
+    {
+        wait_save();
+
+        const int nfield = grid->imax*grid->jmax*grid->kmax;
+        savebuffer.resize((size_t)ap.size()*nfield);
+        saveheader.clear();
+        saveblockfile.clear();
+        saveblockoffset.clear();
+
+        int nf = 0;
+        for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
+        {
+            // the offset is kept at zero, because otherwise bitwise identical restarts is not possible
+            real* staging = &savebuffer[(size_t)nf*nfield];
+            grid->stage_field3d(staging, it->second->data, atmp["tmp1"]->data, NoOffset);
+
+            if (container)
+            {
+                header.checksums.push_back(grid->calc_checksum(staging));
+                saveblockfile.push_back(0);
+                saveblockoffset.push_back(grid->get_restart_offset(header, nf));
+            }
+            else
+            {
+                char filename[256];
+                std::sprintf(filename, "%s.%07d", it->second->name.c_str(), n);
+                master->print_message("Staging \"%s\" ... ", filename);
+
+                // a failure is recorded, the other fields are staged such that all processes make the same calls
+                FILE* pFile = grid->create_field3d_file(filename);
+                if (pFile == NULL)
+                {
+                    master->print_message("FAILED\n");
+                    ++nerror;
+                }
+                else
+                {
+                    master->print_message("OK\n");
+                    savefiles.push_back(pFile);
+                    savenames.push_back(filename);
+                    saveblockfile.push_back(savefiles.size()-1);
+                    saveblockoffset.push_back(0);
+                }
+            }
+            ++nf;
+        }
+
+        if (container)
+        {
+            master->print_message("Staging \"%s\" ... ", restartname);
+
+            master->sum(&header.checksums[0], header.checksums.size());
+            if (master->mpiid == 0)
+                saveheader = grid->pack_restart_header(header);
+
+            FILE* pFile = grid->create_field3d_file(restartname);
+            if (pFile == NULL)
+            {
+                master->print_message("FAILED\n");
+                ++nerror;
+            }
+            else
+            {
+                master->print_message("OK\n");
+                savefiles.push_back(pFile);
+                savenames.push_back(restartname);
+            }
+        }
+
+        // all processes have to agree before any of them starts writing
+        master->sum(&nerror, 1);
+        if (nerror)
+        {
+            for (size_t nfile=0; nfile<savefiles.size(); ++nfile)
+                fclose(savefiles[nfile]);
+            savefiles.clear();
+            savenames.clear();
+            saveblockfile.clear();
+            throw 1;
+        }
+
+        // the time file marks the restart as complete, it is written once the fields are on disk
+        savetimefile  = true;
+        saveiotime    = n;
+        saveitime     = model->timeloop->get_itime();
+        saveidt       = model->timeloop->get_idt();
+        saveiteration = model->timeloop->get_iteration();
+
+        saveerror = 0;
+        savethread = std::thread(&Fields::write_staged_fields, this);
+
+        return;
+    }
+
+    if (container)
+    {
+        master->print_message("Saving \"%s\" ... ", restartname);
+        if (grid->save_restart(restartname, header, data, atmp["tmp1"]->data, atmp["tmp2"]->data))
+        {
+            master->print_message("FAILED\n");
+            throw 1;
+        }
+        master->print_message("OK\n");
+
+        return;
+    }
+
     for (FieldMap::const_iterator it=ap.begin(); it!=ap.end(); ++it)
     {
         char filename[256];
@@ -919,7 +963,7 @@ void Fields::save(int n)
         master->print_message("Saving \"%s\" ... ", filename);
 
         // the offset is kept at zero, because otherwise bitwise identical restarts is not possible
-        if (grid->save_field3d(it->second->data, atmp["tmp1"]->data, atmp["tmp2"]->data, filename, NoOffset))
+        if (grid->save_field3d(it->second->data, atmp["tmp1"]->data, atmp["tmp2"]->data, filename, NoOffset, compress))
         {
             master->print_message("FAILED\n");
             ++nerror;
@@ -932,6 +976,58 @@ void Fields::save(int n)
 
     if (nerror)
         throw 1;
+
+    // the time file marks the restart as complete, so it is written after the fields
+    model->timeloop->save(n);
+}
+
+void Fields::write_staged_fields()
+{
+    // this function runs on the background thread, so it does not communicate nor print
+    const size_t nfield = grid->imax*grid->jmax*grid->kmax;
+
+    // the header of a restart container is only present on the master process
+    if (!saveheader.empty() && !savefiles.empty())
+    {
+        if (fseek(savefiles[0], 0, SEEK_SET) || fwrite(&saveheader[0], 1, saveheader.size(), savefiles[0]) != saveheader.size())
+            ++saveerror;
+    }
+
+    for (size_t n=0; n<saveblockfile.size(); ++n)
+        saveerror += grid->write_field3d_file(savefiles[saveblockfile[n]], &savebuffer[n*nfield], saveblockoffset[n]);
+
+    for (size_t n=0; n<savefiles.size(); ++n)
+        if (fclose(savefiles[n]))
+            ++saveerror;
+}
+
+void Fields::wait_save()
+{
+    if (!savethread.joinable())
+        return;
+
+    savethread.join();
+
+    int nerror = saveerror;
+    master->sum(&nerror, 1);
+
+    for (std::vector<std::string>::const_iterator it=savenames.begin(); it!=savenames.end(); ++it)
+        master->print_message("Saving \"%s\" ... %s\n", it->c_str(), nerror ? "FAILED" : "OK");
+
+    savenames.clear();
+    savefiles.clear();
+
+    if (nerror)
+    {
+        savetimefile = false;
+        throw 1;
+    }
+
+    if (savetimefile)
+    {
+        savetimefile = false;
+        model->timeloop->save(saveiotime, saveitime, saveidt, saveiteration);
+    }
 }
 
 #ifndef USECUDA
@@ -960,13 +1056,14 @@ double Fields::check_mass()
 }
 #endif
 
-double Fields::calc_mass(double* restrict s, double* restrict dz)
+double Fields::calc_mass(real* restrict s, real* restrict dz)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
     double mass = 0;
 
+    #pragma omp parallel for reduction(+:mass)
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -983,7 +1080,7 @@ double Fields::calc_mass(double* restrict s, double* restrict dz)
     return mass;
 }
 
-double Fields::calc_momentum_2nd(double* restrict u, double* restrict v, double* restrict w, double* restrict dz)
+double Fields::calc_momentum_2nd(real* restrict u, real* restrict v, real* restrict w, real* restrict dz)
 {
     using Finite_difference::O2::interp2;
 
@@ -993,6 +1090,7 @@ double Fields::calc_momentum_2nd(double* restrict u, double* restrict v, double*
 
     double momentum = 0;
 
+    #pragma omp parallel for reduction(+:momentum)
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -1009,7 +1107,7 @@ double Fields::calc_momentum_2nd(double* restrict u, double* restrict v, double*
     return momentum;
 }
 
-double Fields::calc_tke_2nd(double* restrict u, double* restrict v, double* restrict w, double* restrict dz)
+double Fields::calc_tke_2nd(real* restrict u, real* restrict v, real* restrict w, real* restrict dz)
 {
     using Finite_difference::O2::interp2;
 
@@ -1019,6 +1117,7 @@ double Fields::calc_tke_2nd(double* restrict u, double* restrict v, double* rest
 
     double tke = 0;
 
+    #pragma omp parallel for reduction(+:tke)
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -106,7 +106,7 @@ Force::~Force()
     }
 
     // clean up time dependent data
-    for (std::map<std::string, double*>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
+    for (std::map<std::string, real*>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
         delete[] it->second;
 
 #ifdef USECUDA
@@ -118,18 +118,18 @@ void Force::init()
 {
     if (swlspres == "geo")
     {
-        ug = new double[grid->kcells];
-        vg = new double[grid->kcells];
+        ug = new real[grid->kcells];
+        vg = new real[grid->kcells];
     }
 
     if (swls == "1")
     {
         for (std::vector<std::string>::const_iterator it=lslist.begin(); it!=lslist.end(); ++it)
-            lsprofs[*it] = new double[grid->kcells];
+            lsprofs[*it] = new real[grid->kcells];
     }
 
     if (swwls == "1")
-        wls = new double[grid->kcells];
+        wls = new real[grid->kcells];
 }
 
 void Force::create(Input *inputin)
@@ -275,7 +275,7 @@ void Force::update_time_dependent_profs(const double fac0, const double fac1, co
     for (std::vector<std::string>::const_iterator it1=lslist.begin(); it1!=lslist.end(); ++it1)
     {
         std::string name = *it1 + "ls";
-        std::map<std::string, double*>::const_iterator it2 = timedepdata.find(name);
+        std::map<std::string, real*>::const_iterator it2 = timedepdata.find(name);
 
         // update the profile
         if (it2 != timedepdata.end())
@@ -285,8 +285,8 @@ void Force::update_time_dependent_profs(const double fac0, const double fac1, co
 }
 #endif
 
-void Force::calc_flux(double* const restrict ut, const double* const restrict u, 
-                      const double* const restrict dz, const double dt)
+void Force::calc_flux(real* const restrict ut, const real* const restrict u, 
+                      const real* const restrict dz, const double dt)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -296,6 +296,7 @@ void Force::calc_flux(double* const restrict ut, const double* const restrict u,
     double uavg  = 0.;
     double utavg = 0.;
 
+    #pragma omp parallel for reduction(+:uavg, utavg)
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -319,9 +320,9 @@ void Force::calc_flux(double* const restrict ut, const double* const restrict u,
         ut[n] += fbody;
 }
 
-void Force::calc_coriolis_2nd(double* const restrict ut, double* const restrict vt,
-                              const double* const restrict u , const double* const restrict v ,
-                              const double* const restrict ug, const double* const restrict vg)
+void Force::calc_coriolis_2nd(real* const restrict ut, real* const restrict vt,
+                              const real* const restrict u , const real* const restrict v ,
+                              const real* const restrict ug, const real* const restrict vg)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -330,6 +331,7 @@ void Force::calc_coriolis_2nd(double* const restrict ut, double* const restrict
     const double ugrid = grid->utrans;
     const double vgrid = grid->vtrans;
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -339,6 +341,7 @@ void Force::calc_coriolis_2nd(double* const restrict ut, double* const restrict
                 ut[ijk] += fc * (0.25*(v[ijk-ii] + v[ijk] + v[ijk-ii+jj] + v[ijk+jj]) + vgrid - vg[k]);
             }
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -349,9 +352,9 @@ void Force::calc_coriolis_2nd(double* const restrict ut, double* const restrict
             }
 }
 
-void Force::calc_coriolis_4th(double* const restrict ut, double* const restrict vt,
-                              const double* const restrict u , const double* const restrict v ,
-                              const double* const restrict ug, const double* const restrict vg)
+void Force::calc_coriolis_4th(real* const restrict ut, real* const restrict vt,
+                              const real* const restrict u , const real* const restrict v ,
+                              const real* const restrict ug, const real* const restrict vg)
 {
     using namespace Finite_difference::O4;
 
@@ -364,6 +367,7 @@ void Force::calc_coriolis_4th(double* const restrict ut, double* const restrict
     const double ugrid = grid->utrans;
     const double vgrid = grid->vtrans;
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -377,6 +381,7 @@ void Force::calc_coriolis_4th(double* const restrict ut, double* const restrict
                                 + vgrid - vg[k] );
             }
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -391,11 +396,12 @@ void Force::calc_coriolis_4th(double* const restrict ut, double* const restrict
             }
 }
 
-void Force::calc_large_scale_source(double* const restrict st, const double* const restrict sls)
+void Force::calc_large_scale_source(real* const restrict st, const real* const restrict sls)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -405,8 +411,8 @@ void Force::calc_large_scale_source(double* const restrict st, const double* con
             }
 }
 
-void Force::advec_wls_2nd(double* const restrict st, const double* const restrict s,
-                          const double* const restrict wls, const double* const dzhi)
+void Force::advec_wls_2nd(real* const restrict st, const real* const restrict s,
+                          const real* const restrict wls, const real* const dzhi)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -22,7 +22,12 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
+#include <algorithm>
+#include <stdint.h>
+#include <zlib.h>
+#include <netcdf.h>
 #include "master.h"
 #include "grid.h"
 #include "input.h"
@@ -40,7 +45,8 @@
  */
 Grid::Grid(Model *modelin, Input *inputin)
 {
-    master = modelin->master;
+    master   = modelin->master;
+    profiler = modelin->profiler;
 
     mpitypes  = false;
     fftwplan  = false;
@@ -69,10 +75,6 @@ Grid::Grid(Model *modelin, Input *inputin)
     dzi4_g  = 0;
     dzhi4_g = 0;
 
-    fftini  = 0;
-    fftouti = 0;
-    fftinj  = 0;
-    fftoutj = 0;
 
     int nerror = 0;
     nerror += inputin->get_item(&xsize, "grid", "xsize", "");
@@ -88,9 +90,51 @@ Grid::Grid(Model *modelin, Input *inputin)
 
     nerror += inputin->get_item(&swspatialorder, "grid", "swspatialorder", "");
 
+    // The tile sizes default to the full domain of the process.
+    nerror += inputin->get_item(&swtiling, "grid", "swtiling", "", "0");
+    nerror += inputin->get_item(&itile   , "grid", "itile"   , "", 0);
+    nerror += inputin->get_item(&jtile   , "grid", "jtile"   , "", 0);
+    nerror += inputin->get_item(&tile_ntime, "grid", "ntiletune", "", 3);
+
+    nerror += inputin->get_item(&swfftpipe , "grid", "swfftpipe" , "", "0");
+    nerror += inputin->get_item(&nfftchunks, "grid", "nfftchunks", "", 4);
+    nerror += inputin->get_item(&fftwplanner, "grid", "fftwplanner", "", "exhaustive");
+
     if (nerror)
         throw 1;
 
+    if (!(swtiling == "0" || swtiling == "1" || swtiling == "auto"))
+    {
+        master->print_error("\"%s\" is an illegal value for swtiling\n", swtiling.c_str());
+        throw 1;
+    }
+    tile_tuning = false;
+
+    if (!(swfftpipe == "0" || swfftpipe == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swfftpipe\n", swfftpipe.c_str());
+        throw 1;
+    }
+    if (nfftchunks < 1)
+    {
+        master->print_error("nfftchunks = %d, value should be at least 1\n", nfftchunks);
+        throw 1;
+    }
+    if (!(fftwplanner == "estimate" || fftwplanner == "measure" || fftwplanner == "patient" || fftwplanner == "exhaustive"))
+    {
+        master->print_error("\"%s\" is an illegal value for fftwplanner\n", fftwplanner.c_str());
+        throw 1;
+    }
+
+    if (fftwplanner == "estimate")
+        fftwflags = FFTW_ESTIMATE;
+    else if (fftwplanner == "measure")
+        fftwflags = FFTW_MEASURE;
+    else if (fftwplanner == "patient")
+        fftwflags = FFTW_PATIENT;
+    else
+        fftwflags = FFTW_EXHAUSTIVE;
+
     if (!(swspatialorder == "2" || swspatialorder == "4"))
     {
         master->print_error("\"%s\" is an illegal value for swspatialorder\n", swspatialorder.c_str());
@@ -119,10 +163,13 @@ Grid::~Grid()
 {
     if (fftwplan)
     {
-        fftw_destroy_plan(iplanf);
-        fftw_destroy_plan(iplanb);
-        fftw_destroy_plan(jplanf);
-        fftw_destroy_plan(jplanb);
+        for (unsigned int c=0; c<iplanf.size(); ++c)
+        {
+            FFTW(destroy_plan)(iplanf[c]);
+            FFTW(destroy_plan)(iplanb[c]);
+            FFTW(destroy_plan)(jplanf[c]);
+            FFTW(destroy_plan)(jplanb[c]);
+        }
     }
 
     delete[] x;
@@ -138,12 +185,7 @@ Grid::~Grid()
     delete[] dzi4;
     delete[] dzhi4;
 
-    fftw_free(fftini);
-    fftw_free(fftouti);
-    fftw_free(fftinj);
-    fftw_free(fftoutj);
-
-    fftw_cleanup();
+    FFTW(cleanup)();
 
 #ifdef USECUDA
     clear_device();
@@ -218,25 +260,32 @@ void Grid::init()
 
     check_ghost_cells();
 
+    init_tiling();
+
     // allocate all arrays
-    x     = new double[imax+2*igc];
-    xh    = new double[imax+2*igc];
-    y     = new double[jmax+2*jgc];
-    yh    = new double[jmax+2*jgc];
-    z     = new double[kmax+2*kgc];
-    zh    = new double[kmax+2*kgc];
-    dz    = new double[kmax+2*kgc];
-    dzh   = new double[kmax+2*kgc];
-    dzi   = new double[kmax+2*kgc];
-    dzhi  = new double[kmax+2*kgc];
-    dzi4  = new double[kmax+2*kgc];
-    dzhi4 = new double[kmax+2*kgc];
-
-    // allocate the data for the fourier transforms
-    fftini  = fftw_alloc_real(itot*jmax);
-    fftouti = fftw_alloc_real(itot*jmax);
-    fftinj  = fftw_alloc_real(jtot*iblock);
-    fftoutj = fftw_alloc_real(jtot*iblock);
+    x     = new real[imax+2*igc];
+    xh    = new real[imax+2*igc];
+    y     = new real[jmax+2*jgc];
+    yh    = new real[jmax+2*jgc];
+    z     = new real[kmax+2*kgc];
+    zh    = new real[kmax+2*kgc];
+    dz    = new real[kmax+2*kgc];
+    dzh   = new real[kmax+2*kgc];
+    dzi   = new real[kmax+2*kgc];
+    dzhi  = new real[kmax+2*kgc];
+    dzi4  = new real[kmax+2*kgc];
+    dzhi4 = new real[kmax+2*kgc];
+
+    // divide the vertical levels of the transposed fields over the chunks of the fourier
+    // transforms, only parallel runs split the transposes into more than one chunk
+#ifdef USEMPI
+    const int nchunks = (swfftpipe == "1") ? std::min(nfftchunks, kblock) : 1;
+#else
+    const int nchunks = 1;
+#endif
+    kchunks.resize(nchunks+1);
+    for (int n=0; n<nchunks+1; ++n)
+        kchunks[n] = (n*kblock)/nchunks;
 
     // initialize the communication functions
     init_mpi();
@@ -422,6 +471,120 @@ void Grid::check_ghost_cells()
     }
 }
 
+/**
+ * This function sets the tiles of the stencil kernels. In case of autotuning,
+ * the candidate tile shapes are stored and the first one is activated.
+ */
+void Grid::init_tiling()
+{
+    if (swtiling == "0")
+        set_tiles(imax, jmax);
+    else if (swtiling == "1")
+        set_tiles(itile > 0 ? itile : imax, jtile > 0 ? jtile : jmax);
+    else if (swtiling == "auto")
+    {
+        // Always keep the untiled domain as a candidate, such that tiling is only used if it is faster.
+        const int isizes[] = {imax, 128, 64, 32};
+        const int jsizes[] = {jmax, 32, 16, 8, 4};
+
+        for (int n=0; n<4; ++n)
+            for (int m=0; m<5; ++m)
+            {
+                const int ic = isizes[n];
+                const int jc = jsizes[m];
+                if ((n > 0 && ic >= imax) || (m > 0 && jc >= jmax))
+                    continue;
+
+                // Store the shape after narrowing, and time shapes that are narrowed to the same tiles once.
+                set_tiles(ic, jc);
+                bool duplicate = false;
+                for (unsigned int nc=0; nc<itile_candidates.size(); ++nc)
+                    if (itile_candidates[nc] == itile && jtile_candidates[nc] == jtile)
+                        duplicate = true;
+                if (duplicate)
+                    continue;
+
+                itile_candidates.push_back(itile);
+                jtile_candidates.push_back(jtile);
+            }
+
+        tile_times.assign(itile_candidates.size(), Constants::dhuge);
+        tile_icandidate = 0;
+        tile_itime = 0;
+        tile_tuning = (itile_candidates.size() > 1);
+
+        set_tiles(itile_candidates[0], jtile_candidates[0]);
+    }
+}
+
+/**
+ * This function splits the interior of the domain into tiles.
+ * @param itilein Number of grid cells in the x-direction of one tile.
+ * @param jtilein Number of grid cells in the y-direction of one tile.
+ */
+void Grid::set_tiles(const int itilein, const int jtilein)
+{
+    itile = std::min(std::max(itilein, 1), imax);
+    jtile = std::min(std::max(jtilein, 1), jmax);
+
+    // Each thread owns whole tiles, so the tiles are narrowed in the y-direction until all threads have work.
+    const int nitiles = (imax+itile-1)/itile;
+    while (jtile > 1 && nitiles*((jmax+jtile-1)/jtile) < master->nthreads)
+        --jtile;
+
+    tiles.clear();
+    for (int j=jstart; j<jend; j+=jtile)
+        for (int i=istart; i<iend; i+=itile)
+        {
+            Tile tile;
+            tile.istart = i;
+            tile.iend   = std::min(i+itile, iend);
+            tile.jstart = j;
+            tile.jend   = std::min(j+jtile, jend);
+            tiles.push_back(tile);
+        }
+}
+
+void Grid::start_tile_timer()
+{
+    if (tile_tuning)
+        tile_time_start = master->get_wall_clock_time();
+}
+
+/**
+ * This function stores the timing of the current tile shape. After all shapes
+ * are timed, the shape with the lowest time over all processes is selected.
+ */
+void Grid::stop_tile_timer()
+{
+    if (!tile_tuning)
+        return;
+
+    const double time = master->get_wall_clock_time() - tile_time_start;
+    tile_times[tile_icandidate] = std::min(tile_times[tile_icandidate], time);
+
+    if (++tile_itime < tile_ntime)
+        return;
+
+    tile_itime = 0;
+    ++tile_icandidate;
+
+    if (tile_icandidate < tile_times.size())
+    {
+        set_tiles(itile_candidates[tile_icandidate], jtile_candidates[tile_icandidate]);
+        return;
+    }
+
+    // Take the slowest process per tile shape, such that all processes select the same shape.
+    master->max(&tile_times[0], tile_times.size());
+
+    const int nbest = std::min_element(tile_times.begin(), tile_times.end()) - tile_times.begin();
+    set_tiles(itile_candidates[nbest], jtile_candidates[nbest]);
+    tile_tuning = false;
+
+    master->print_message("Selected tiles of %d x %d grid cells for the stencil kernels\n", itile, jtile);
+}
+
 /**
  * This function increases the number of ghost cells in case necessary.
  * @param igc Ghost cells in the x-direction.
@@ -447,7 +610,7 @@ void Grid::set_minimum_ghost_cells(const int igcin, const int jgcin, const int k
  * @param locx Integer containing the location of the input field,
  * where a value of 1 refers to the flux level.
  */
-void Grid::interpolate_2nd(double* const restrict out, const double* const restrict in, const int locin[3], const int locout[3])
+void Grid::interpolate_2nd(real* const restrict out, const real* const restrict in, const int locin[3], const int locout[3])
 {
     const int ii = 1;
     const int jj = icells;
@@ -458,6 +621,7 @@ void Grid::interpolate_2nd(double* const restrict out, const double* const restr
 
     // interpolate the field
     // \TODO add the vertical component
+    #pragma omp parallel for
     for (int k=0; k<kcells; ++k)
         for (int j=jstart; j<jend; ++j)
 #pragma ivdep
@@ -477,7 +641,7 @@ void Grid::interpolate_2nd(double* const restrict out, const double* const restr
  * @param locx Integer containing the location of the input field,
  * where a value of 1 refers to the flux level.
  */
-void Grid::interpolate_4th(double* restrict out, double* restrict in, const int locin[3], const int locout[3])
+void Grid::interpolate_4th(real* restrict out, real* restrict in, const int locin[3], const int locout[3])
 {
     using namespace Finite_difference::O4;
 
@@ -493,6 +657,7 @@ void Grid::interpolate_4th(double* restrict out, double* restrict in, const int
     const int jjh2 = 2*(locin[1]-locout[1])*jj;
 
     // \TODO add the vertical component
+    #pragma omp parallel for
     for (int k=0; k<kcells; ++k)
         for (int j=jstart; j<jend; ++j)
 #pragma ivdep
@@ -506,27 +671,806 @@ void Grid::interpolate_4th(double* restrict out, double* restrict in, const int
             }
 }
 
-void Grid::calc_mean(double* restrict prof, const double* restrict data, const int krange)
+void Grid::calc_mean(real* restrict prof, const real* restrict data, const int krange)
 {
     const int jj = icells;
     const int kk = ijcells;
 
+    // the sums are reduced in double precision, also if the fields are single precision
+    std::vector<double> sums(krange);
+
     for (int k=0; k<krange; ++k)
     {
-        prof[k] = 0.;
+        double prof_k = 0.;
         for (int j=jstart; j<jend; ++j)
 #pragma ivdep
             for (int i=istart; i<iend; ++i)
             {
                 const int ijk  = i + j*jj + k*kk;
-                prof[k] += data[ijk];
+                prof_k += data[ijk];
             }
+        sums[k] = prof_k;
     }
 
-    master->sum(prof, krange);
+    master->sum(&sums[0], krange);
 
     const double n = itot*jtot;
 
     for (int k=0; k<krange; ++k)
-        prof[k] /= n;
+        prof[k] = sums[k] / n;
+}
+
+namespace
+{
+    // Layout of the restart container header: an 8 character identifier, six integers, two
+    // unsigned longs and per field a name and a checksum. The field blocks start at a multiple
+    // of the alignment to keep the writes of the processes aligned to the file system blocks.
+    const char restart_id[8] = {'M','H','H','R','S','T','0','1'};
+    const int restart_namesize  = 64;
+    const int restart_fixedsize = 8 + 6*sizeof(int) + 2*sizeof(unsigned long);
+    const int restart_alignment = 4096;
+
+    int get_restart_header_size(const int nfields)
+    {
+        const int size = restart_fixedsize + nfields*(restart_namesize + sizeof(unsigned long));
+        return ((size + restart_alignment - 1) / restart_alignment) * restart_alignment;
+    }
+}
+
+std::vector<char> Grid::pack_restart_header(const Restart_header& header)
+{
+    const int nfields = header.names.size();
+    std::vector<char> buffer(get_restart_header_size(nfields), 0);
+
+    char* p = &buffer[0];
+    std::memcpy(p, restart_id, 8);
+    p += 8;
+
+    const int ints[6] = {(int)sizeof(real), itot, jtot, ktot, nfields, header.iteration};
+    std::memcpy(p, ints, sizeof(ints));
+    p += sizeof(ints);
+
+    const unsigned long times[2] = {header.itime, header.idt};
+    std::memcpy(p, times, sizeof(times));
+    p += sizeof(times);
+
+    for (int n=0; n<nfields; ++n)
+    {
+        std::strncpy(p, header.names[n].c_str(), restart_namesize-1);
+        p += restart_namesize;
+    }
+
+    std::memcpy(p, &header.checksums[0], nfields*sizeof(unsigned long));
+
+    return buffer;
+}
+
+int Grid::read_restart_header(char* filename, Restart_header& header)
+{
+    // the master process reads the header and broadcasts the raw bytes
+    int nerror = 0;
+    int size = 0;
+    std::vector<char> buffer;
+
+    if (master->mpiid == 0)
+    {
+        FILE* pFile = fopen(filename, "rb");
+        if (pFile == NULL)
+            ++nerror;
+        else
+        {
+            char fixed[restart_fixedsize];
+            int ints[6];
+            if (fread(fixed, 1, restart_fixedsize, pFile) != (size_t)restart_fixedsize || std::memcmp(fixed, restart_id, 8))
+            {
+                master->print_error("\"%s\" is not a restart container\n", filename);
+                ++nerror;
+            }
+            else
+            {
+                std::memcpy(ints, &fixed[8], sizeof(ints));
+                if (ints[0] != (int)sizeof(real) || ints[1] != itot || ints[2] != jtot || ints[3] != ktot)
+                {
+                    master->print_error("\"%s\" contains a %dx%dx%d grid with %d byte reals, expected %dx%dx%d with %d byte reals\n",
+                                        filename, ints[1], ints[2], ints[3], ints[0], itot, jtot, ktot, (int)sizeof(real));
+                    ++nerror;
+                }
+                else
+                {
+                    size = get_restart_header_size(ints[4]);
+                    buffer.resize(size);
+                    rewind(pFile);
+                    if (fread(&buffer[0], 1, size, pFile) != (size_t)size)
+                        ++nerror;
+                }
+            }
+            fclose(pFile);
+        }
+    }
+
+    master->broadcast(&nerror, 1);
+    if (nerror)
+        return nerror;
+
+    master->broadcast(&size, 1);
+    buffer.resize(size);
+    master->broadcast(&buffer[0], size);
+
+    const char* p = &buffer[8];
+    int ints[6];
+    std::memcpy(ints, p, sizeof(ints));
+    p += sizeof(ints);
+
+    unsigned long times[2];
+    std::memcpy(times, p, sizeof(times));
+    p += sizeof(times);
+
+    const int nfields = ints[4];
+    header.iteration = ints[5];
+    header.itime = times[0];
+    header.idt   = times[1];
+
+    header.names.clear();
+    for (int n=0; n<nfields; ++n)
+    {
+        header.names.push_back(std::string(p, strnlen(p, restart_namesize)));
+        p += restart_namesize;
+    }
+
+    header.checksums.resize(nfields);
+    std::memcpy(&header.checksums[0], p, nfields*sizeof(unsigned long));
+
+    return 0;
+}
+
+bool Grid::has_restart(char* filename)
+{
+    int exists = 0;
+    if (master->mpiid == 0)
+    {
+        FILE* pFile = fopen(filename, "rb");
+        if (pFile != NULL)
+        {
+            exists = 1;
+            fclose(pFile);
+        }
+    }
+    master->broadcast(&exists, 1);
+
+    return exists;
+}
+
+long Grid::get_restart_offset(const Restart_header& header, const int n)
+{
+    return get_restart_header_size(header.names.size()) + (long)n*itot*jtot*ktot*sizeof(real);
+}
+
+namespace
+{
+    // Layout of a compressed 3d field: an 8 character identifier, four integers and an index with
+    // the byte offset of every compressed row of the field in the x-direction plus the end of the file.
+    // The rows follow the index without gaps, but not necessarily in the order of the index.
+    const char compressed_id[8] = {'M','H','H','Z','3','D','0','1'};
+    const int compressed_fixedsize = 8 + 4*sizeof(int);
+}
+
+long Grid::get_compressed_header_size()
+{
+    return compressed_fixedsize + ((long)jtot*ktot + 1)*sizeof(unsigned long);
+}
+
+long Grid::get_compressed_index_offset()
+{
+    return compressed_fixedsize;
+}
+
+std::vector<char> Grid::pack_compressed_header()
+{
+    const int ints[4] = {(int)sizeof(real), itot, jtot, ktot};
+    std::vector<char> header(compressed_fixedsize);
+    std::memcpy(&header[0], compressed_id, 8);
+    std::memcpy(&header[8], ints, sizeof(ints));
+
+    return header;
+}
+
+int Grid::check_compressed_header(const std::vector<char>& header, char* filename)
+{
+    int ints[4];
+    std::memcpy(ints, &header[8], sizeof(ints));
+
+    if (std::memcmp(&header[0], compressed_id, 8) != 0)
+    {
+        master->print_error("\"%s\" is not a compressed 3d field\n", filename);
+        return 1;
+    }
+    if (ints[0] != (int)sizeof(real) || ints[1] != itot || ints[2] != jtot || ints[3] != ktot)
+    {
+        master->print_error("\"%s\" contains a %dx%dx%d field with %d byte reals, expected %dx%dx%d with %d byte reals\n",
+                            filename, ints[1], ints[2], ints[3], ints[0], itot, jtot, ktot, (int)sizeof(real));
+        return 1;
+    }
+
+    return 0;
+}
+
+void Grid::get_compressed_row_sizes(const unsigned long* restrict index, unsigned long* restrict sizes)
+{
+    const int nrowstot = jtot*ktot;
+
+    // a row ends where the next row in the file starts, the last one at the end of the file
+    std::vector<int> order(nrowstot);
+    for (int n=0; n<nrowstot; ++n)
+        order[n] = n;
+    std::sort(order.begin(), order.end(), [&](const int a, const int b) { return index[a] < index[b]; });
+
+    for (int n=0; n<nrowstot; ++n)
+    {
+        const unsigned long end = (n+1 < nrowstot) ? index[order[n+1]] : index[nrowstot];
+        sizes[order[n]] = end - index[order[n]];
+    }
+}
+
+bool Grid::is_compressed_field3d(char* filename)
+{
+    int compressed = 0;
+    if (master->mpiid == 0)
+    {
+        FILE* pFile = fopen(filename, "rb");
+        if (pFile != NULL)
+        {
+            char id[8];
+            if (fread(id, 1, 8, pFile) == 8 && std::memcmp(id, compressed_id, 8) == 0)
+                compressed = 1;
+            fclose(pFile);
+        }
+    }
+    master->broadcast(&compressed, 1);
+
+    return compressed;
+}
+
+int Grid::check_field3d_size(char* filename)
+{
+    // an uncompressed 3d field has no header, so a field of another precision or size is detected by the file size,
+    // which is broadcast as a double that holds the size exactly
+    const double npoints = (double)itot*jtot*ktot;
+    double size = -1.;
+    if (master->mpiid == 0)
+    {
+        FILE* pFile = fopen(filename, "rb");
+        if (pFile != NULL)
+        {
+            if (fseek(pFile, 0, SEEK_END) == 0)
+                size = ftell(pFile);
+            fclose(pFile);
+        }
+    }
+    master->broadcast(&size, 1);
+
+    if (size == npoints*sizeof(real))
+        return 0;
+
+    const int othersize = (sizeof(real) == 4) ? 8 : 4;
+    if (size == npoints*othersize)
+        master->print_error("\"%s\" contains a field with %d byte reals, the model uses %d byte reals\n",
+                            filename, othersize, (int)sizeof(real));
+    else if (size >= 0.)
+        master->print_error("\"%s\" has %.0f bytes, expected %.0f bytes for a %dx%dx%d field with %d byte reals\n",
+                            filename, size, npoints*sizeof(real), itot, jtot, ktot, (int)sizeof(real));
+    return 1;
+}
+
+int Grid::compress_rows(std::vector<unsigned char>& buffer, std::vector<unsigned long>& sizes,
+                        const real* restrict data, const int nrows)
+{
+    const int nbytes = sizeof(real);
+    const uLong rowsize = itot*nbytes;
+    const uLong bound = compressBound(rowsize);
+
+    std::vector<unsigned char> rows((size_t)nrows*bound);
+    sizes.resize(nrows);
+
+    int nerror = 0;
+
+    #pragma omp parallel for reduction(+:nerror)
+    for (int n=0; n<nrows; ++n)
+    {
+        // shuffle the bytes, such that the slowly varying exponents end up next to each other
+        std::vector<unsigned char> shuffled(rowsize);
+        const unsigned char* row = reinterpret_cast<const unsigned char*>(&data[(size_t)n*itot]);
+        for (int b=0; b<nbytes; ++b)
+            for (int i=0; i<itot; ++i)
+                shuffled[b*itot + i] = row[i*nbytes + b];
+
+        uLongf size = bound;
+        if (compress2(&rows[(size_t)n*bound], &size, &shuffled[0], rowsize, Z_BEST_SPEED) != Z_OK)
+            ++nerror;
+        sizes[n] = size;
+    }
+
+    // concatenate the compressed rows
+    unsigned long total = 0;
+    for (int n=0; n<nrows; ++n)
+        total += sizes[n];
+
+    buffer.resize(total);
+    unsigned long pos = 0;
+    for (int n=0; n<nrows; ++n)
+    {
+        std::memcpy(&buffer[pos], &rows[(size_t)n*bound], sizes[n]);
+        pos += sizes[n];
+    }
+
+    return nerror;
+}
+
+int Grid::decompress_rows(real* restrict data, const unsigned char* restrict buffer, const unsigned long* restrict starts,
+                          const unsigned long* restrict sizes, const int nrows)
+{
+    const int nbytes = sizeof(real);
+    const uLong rowsize = itot*nbytes;
+
+    int nerror = 0;
+
+    #pragma omp parallel for reduction(+:nerror)
+    for (int n=0; n<nrows; ++n)
+    {
+        std::vector<unsigned char> shuffled(rowsize);
+        uLongf size = rowsize;
+        if (uncompress(&shuffled[0], &size, &buffer[starts[n]], sizes[n]) != Z_OK || size != rowsize)
+        {
+            ++nerror;
+            continue;
+        }
+
+        unsigned char* row = reinterpret_cast<unsigned char*>(&data[(size_t)n*itot]);
+        for (int b=0; b<nbytes; ++b)
+            for (int i=0; i<itot; ++i)
+                row[i*nbytes + b] = shuffled[b*itot + i];
+    }
+
+    return nerror;
+}
+
+namespace
+{
+    // Unsigned integer with the same size as the floating point type and the number of mantissa bits.
+    template<int> struct Real_bits;
+    template<> struct Real_bits<4> { typedef uint32_t type; static const int nmantissa = 23; static const int nexponent = 8;  };
+    template<> struct Real_bits<8> { typedef uint64_t type; static const int nmantissa = 52; static const int nexponent = 11; };
+}
+
+double Grid::round_field(real* restrict data, const int n, const Error_bound& bound)
+{
+    typedef Real_bits<sizeof(real)>::type bits_type;
+    const int nmantissa = Real_bits<sizeof(real)>::nmantissa;
+    const bits_type expmask = (((bits_type)1 << Real_bits<sizeof(real)>::nexponent) - 1) << nmantissa;
+
+    // rounding to the nearest value with k mantissa bits gives an error of at most 2^(e-k-1) for
+    // a value in [2^e, 2^(e+1)), which sets the number of bits to keep for a relative error bound
+    // directly and for an absolute bound as a function of the exponent
+    const bool relative = (bound.type == "rel");
+    const double log2error = std::log(bound.error)/std::log(2.);
+    const int keeprel = std::max(0, (int)std::ceil(-1. - log2error));
+
+    double maxerror = 0.;
+
+    #pragma omp parallel for reduction(max:maxerror)
+    for (int n0=0; n0<n; ++n0)
+    {
+        bits_type bits;
+        std::memcpy(&bits, &data[n0], sizeof(real));
+
+        // skip infinities and NaNs, whose exponent bits are all set
+        if ((bits & expmask) == expmask)
+            continue;
+
+        const real value = data[n0];
+        int keep;
+        if (relative)
+            keep = keeprel;
+        else
+        {
+            if (std::abs(value) <= bound.error)
+            {
+                maxerror = std::max(maxerror, (double)std::abs(value));
+                data[n0] = 0.;
+                continue;
+            }
+            keep = std::max(0, (int)std::ceil(std::ilogb(value) - 1 - log2error));
+        }
+
+        const int drop = nmantissa - keep;
+        if (drop <= 0)
+            continue;
+
+        // round half away from zero, a carry into the exponent gives the correct rounded value
+        bits += (bits_type)1 << (drop-1);
+        bits &= ~(((bits_type)1 << drop) - 1);
+        if ((bits & expmask) == expmask)
+            continue;
+        std::memcpy(&data[n0], &bits, sizeof(real));
+
+        maxerror = std::max(maxerror, (double)std::abs(data[n0] - value));
+    }
+
+    return maxerror;
+}
+
+int Grid::get_error_bounds(std::map<std::string, Error_bound>& bounds, Input* inputin, std::string group,
+                           const std::vector<std::string>& names, std::string swformat, bool compress)
+{
+    int nerror = 0;
+
+    // read the optional error bounds for lossy compression, which can be set per variable as swlossy[name]
+    for (std::vector<std::string>::const_iterator it=names.begin(); it!=names.end(); ++it)
+    {
+        Error_bound bound;
+        nerror += inputin->get_item(&bound.type, group, "swlossy", *it, "0");
+        if (bound.type != "0")
+            nerror += inputin->get_item(&bound.error, group, "lossyerror", *it);
+
+        if (!(bound.type == "0" || bound.type == "abs" || bound.type == "rel"))
+        {
+            master->print_error("\"%s\" is an illegal value for swlossy[%s]\n", bound.type.c_str(), it->c_str());
+            ++nerror;
+        }
+        else if (bound.type != "0" && !(bound.error > 0.))
+        {
+            master->print_error("lossyerror[%s] has to be larger than zero\n", it->c_str());
+            ++nerror;
+        }
+
+        bounds[*it] = bound;
+    }
+
+    // lossy output is always deflated, in NetCDF format this needs a library that can deflate in parallel
+    bool deflate = compress;
+    for (std::map<std::string, Error_bound>::const_iterator it=bounds.begin(); it!=bounds.end(); ++it)
+        if (it->second.type != "0")
+            deflate = true;
+
+    if (swformat == "netcdf" && deflate && !has_netcdf_deflate())
+    {
+        master->print_error("compressed NetCDF %s output needs NetCDF >= 4.7.4 with HDF5 >= 1.10.3 in parallel runs, use swformat=binary\n", group.c_str());
+        ++nerror;
+    }
+
+    return nerror;
+}
+
+void Grid::stage_xz_slice(real* restrict tmp, real* restrict data, const int jslice)
+{
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int kkb = imax;
+
+    for (int k=0; k<kmax; k++)
+#pragma ivdep
+        for (int i=0; i<imax; i++)
+        {
+            // take the modulus of jslice and jmax to have the right offset within proc
+            const int ijk  = i+igc + ((jslice%jmax)+jgc)*jj + (k+kgc)*kk;
+            const int ijkb = i + k*kkb;
+            tmp[ijkb] = data[ijk];
+        }
+}
+
+void Grid::stage_yz_slice(real* restrict tmp, real* restrict data, const int islice)
+{
+    const int jj  = icells;
+    const int kk  = ijcells;
+    const int kkb = jmax;
+
+    for (int k=0; k<kmax; k++)
+#pragma ivdep
+        for (int j=0; j<jmax; j++)
+        {
+            // take the modulus of islice and imax to have the right offset within proc
+            const int ijk  = (islice%imax)+igc + (j+jgc)*jj + (k+kgc)*kk;
+            const int ijkb = j + k*kkb;
+            tmp[ijkb] = data[ijk];
+        }
+}
+
+void Grid::stage_xy_slice(real* restrict tmp, real* restrict data, int kslice)
+{
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+
+    // Subtract the ghost cells in case of a pure 2d plane that does not have ghost cells.
+    if (kslice == -1)
+        kslice = -kgc;
+
+    for (int j=0; j<jmax; j++)
+#pragma ivdep
+        for (int i=0; i<imax; i++)
+        {
+            const int ijk  = i+igc + (j+jgc)*jj + (kslice+kgc)*kk;
+            const int ijkb = i + j*jjb;
+            tmp[ijkb] = data[ijk];
+        }
+}
+
+void Grid::round_slice(real* restrict tmp, const int count, const bool contains, Error_bound* bound)
+{
+    if (!bound || bound->type == "0")
+        return;
+
+    // round off the bits below the error bound before writing, only the processes with the slice count
+    bound->maxerror = contains ? round_field(tmp, count, *bound) : 0.;
+    master->max(&bound->maxerror, 1);
+}
+
+void Grid::calc_global_coords(std::vector<double>& xs, std::vector<double>& ys, std::vector<double>& zs, const int* loc)
+{
+    // the coordinates over the whole domain at the full or half levels, depending on the location
+    xs.resize(itot);
+    ys.resize(jtot);
+    zs.resize(kmax);
+
+    for (int i=0; i<itot; ++i)
+        xs[i] = loc[0] ? i*dx : (i+0.5)*dx;
+    for (int j=0; j<jtot; ++j)
+        ys[j] = loc[1] ? j*dy : (j+0.5)*dy;
+    for (int k=0; k<kmax; ++k)
+        zs[k] = loc[2] ? zh[k+kgc] : z[k+kgc];
+}
+
+void Grid::nc_check(const int status, const char* filename)
+{
+    if (status == NC_NOERR)
+        return;
+
+    master->print_error("NetCDF error in \"%s\": %s\n", filename, nc_strerror(status));
+    throw 1;
+}
+
+void Grid::create_cross_file(Cross_file& file, char* filename, std::string name, std::string plane,
+                             const std::vector<int>& indices, const int* loc, bool deflate)
+{
+    file.filename = filename;
+    file.nrecord  = 0;
+
+    create_netcdf_file(filename, &file.ncid);
+    define_cross_file(file, name, plane, indices, loc, deflate);
+
+    // the unlimited dimension can only be extended collectively
+    set_netcdf_collective(file.ncid, file.timeid, filename);
+    set_netcdf_collective(file.ncid, file.varid , filename);
+}
+
+void Grid::define_cross_file(Cross_file& file, std::string name, std::string plane,
+                             const std::vector<int>& indices, const int* loc, const bool deflate)
+{
+    const char* filename = file.filename.c_str();
+
+    std::vector<double> xs, ys, zs;
+    calc_global_coords(xs, ys, zs, loc);
+
+    const std::string xname = loc[0] ? "xh" : "x";
+    const std::string yname = loc[1] ? "yh" : "y";
+    const std::string zname = loc[2] ? "zh" : "z";
+
+    // the dimensions after time, the first one holds the positions of the slices
+    std::vector<std::string> dimnames;
+    std::vector<std::vector<double> > dimvalues;
+    std::vector<double> positions;
+
+    if (plane == "xz")
+    {
+        for (std::vector<int>::const_iterator it=indices.begin(); it!=indices.end(); ++it)
+            positions.push_back(ys[*it]);
+        dimnames.push_back(yname); dimvalues.push_back(positions);
+        dimnames.push_back(zname); dimvalues.push_back(zs);
+        dimnames.push_back(xname); dimvalues.push_back(xs);
+    }
+    else if (plane == "yz")
+    {
+        for (std::vector<int>::const_iterator it=indices.begin(); it!=indices.end(); ++it)
+            positions.push_back(xs[*it]);
+        dimnames.push_back(xname); dimvalues.push_back(positions);
+        dimnames.push_back(zname); dimvalues.push_back(zs);
+        dimnames.push_back(yname); dimvalues.push_back(ys);
+    }
+    else
+    {
+        // a 2d plane without ghost cells has no vertical position
+        if (!indices.empty())
+        {
+            for (std::vector<int>::const_iterator it=indices.begin(); it!=indices.end(); ++it)
+                positions.push_back(zs[*it]);
+            dimnames.push_back(zname); dimvalues.push_back(positions);
+        }
+        dimnames.push_back(yname); dimvalues.push_back(ys);
+        dimnames.push_back(xname); dimvalues.push_back(xs);
+    }
+
+    const int ndims = dimnames.size()+1;
+    std::vector<int> dimids(ndims), coordids(ndims-1);
+
+    nc_check(nc_def_dim(file.ncid, "time", NC_UNLIMITED, &dimids[0]), filename);
+    nc_check(nc_def_var(file.ncid, "time", NC_DOUBLE, 1, &dimids[0], &file.timeid), filename);
+    const std::string timeunits = "Seconds since start of experiment";
+    nc_check(nc_put_att_text(file.ncid, file.timeid, "units", timeunits.size(), timeunits.c_str()), filename);
+
+    for (int n=1; n<ndims; ++n)
+    {
+        nc_check(nc_def_dim(file.ncid, dimnames[n-1].c_str(), dimvalues[n-1].size(), &dimids[n]), filename);
+        nc_check(nc_def_var(file.ncid, dimnames[n-1].c_str(), NC_DOUBLE, 1, &dimids[n], &coordids[n-1]), filename);
+    }
+
+    // store every slice of every time in its own chunk
+    std::vector<size_t> chunks(ndims, 1);
+    chunks[ndims-1] = dimvalues[ndims-2].size();
+    chunks[ndims-2] = dimvalues[ndims-3].size();
+
+    const nc_type type = (sizeof(real) == 4) ? NC_FLOAT : NC_DOUBLE;
+    nc_check(nc_def_var(file.ncid, name.c_str(), type, ndims, &dimids[0], &file.varid), filename);
+    nc_check(nc_def_var_chunking(file.ncid, file.varid, NC_CHUNKED, &chunks[0]), filename);
+
+    // the shuffle filter and deflate remove the bits that are rounded off by a lossy error bound
+    if (deflate)
+        nc_check(nc_def_var_deflate(file.ncid, file.varid, 1, 1, 1), filename);
+
+    nc_check(nc_enddef(file.ncid), filename);
+
+    // the coordinates are provided by the master process only, but all processes make the same calls,
+    // such that an error is raised everywhere
+    for (int n=1; n<ndims; ++n)
+    {
+        const size_t start = 0;
+        const size_t count = (master->mpiid == 0) ? dimvalues[n-1].size() : 0;
+        nc_check(nc_put_vara_double(file.ncid, coordids[n-1], &start, &count, &dimvalues[n-1][0]), filename);
+    }
+}
+
+void Grid::add_cross_record(Cross_file& file, const double time)
+{
+    // the time is extended collectively, but only the master process provides the value
+    const size_t start = file.nrecord;
+    const size_t count = (master->mpiid == 0) ? 1 : 0;
+    nc_check(nc_put_vara_double(file.ncid, file.timeid, &start, &count, &time), file.filename.c_str());
+    ++file.nrecord;
+}
+
+void Grid::sync_cross_file(Cross_file& file)
+{
+    if (file.ncid == -1)
+        return;
+
+    nc_check(nc_sync(file.ncid), file.filename.c_str());
+}
+
+void Grid::close_cross_file(Cross_file& file)
+{
+    if (file.ncid == -1)
+        return;
+
+    const int ncid = file.ncid;
+    file.ncid = -1;
+    nc_check(nc_close(ncid), file.filename.c_str());
+}
+
+void Grid::put_cross_slice(Cross_file& file, real* restrict tmp, const size_t* start, const size_t* count)
+{
+    nc_check(nc_put_vara(file.ncid, file.varid, start, count, tmp), file.filename.c_str());
+}
+
+void Grid::save_xz_slice(real* restrict data, real* restrict tmp, Cross_file& file, int jslice, int n, Error_bound* bound)
+{
+    const bool contains = (master->mpicoordy == jslice/jmax);
+
+    stage_xz_slice(tmp, data, jslice);
+    round_slice(tmp, imax*kmax, contains, bound);
+
+    // only the processes that contain the slice write data, but all take part in the collective write
+    const size_t start[4] = {(size_t)file.nrecord-1, (size_t)n, 0, (size_t)master->mpicoordx*imax};
+    const size_t count[4] = {1, 1, (size_t)(contains ? kmax : 0), (size_t)(contains ? imax : 0)};
+
+    put_cross_slice(file, tmp, start, count);
+}
+
+void Grid::save_yz_slice(real* restrict data, real* restrict tmp, Cross_file& file, int islice, int n, Error_bound* bound)
+{
+    const bool contains = (master->mpicoordx == islice/imax);
+
+    stage_yz_slice(tmp, data, islice);
+    round_slice(tmp, jmax*kmax, contains, bound);
+
+    // only the processes that contain the slice write data, but all take part in the collective write
+    const size_t start[4] = {(size_t)file.nrecord-1, (size_t)n, 0, (size_t)master->mpicoordy*jmax};
+    const size_t count[4] = {1, 1, (size_t)(contains ? kmax : 0), (size_t)(contains ? jmax : 0)};
+
+    put_cross_slice(file, tmp, start, count);
+}
+
+void Grid::save_xy_slice(real* restrict data, real* restrict tmp, Cross_file& file, int kslice, int n, Error_bound* bound)
+{
+    stage_xy_slice(tmp, data, kslice);
+    round_slice(tmp, imax*jmax, true, bound);
+
+    // a 2d plane has no dimension for the vertical position of the slice
+    const size_t record = file.nrecord-1;
+    if (kslice == -1)
+    {
+        const size_t start[3] = {record, (size_t)master->mpicoordy*jmax, (size_t)master->mpicoordx*imax};
+        const size_t count[3] = {1, (size_t)jmax, (size_t)imax};
+        put_cross_slice(file, tmp, start, count);
+    }
+    else
+    {
+        const size_t start[4] = {record, (size_t)n, (size_t)master->mpicoordy*jmax, (size_t)master->mpicoordx*imax};
+        const size_t count[4] = {1, 1, (size_t)jmax, (size_t)imax};
+        put_cross_slice(file, tmp, start, count);
+    }
+}
+
+void Grid::save_field3d_netcdf(real* restrict data, real* restrict tmp, char* filename, std::string name,
+                               const int* loc, const double time, const bool deflate, Error_bound* bound)
+{
+    int ncid;
+    create_netcdf_file(filename, &ncid);
+
+    std::vector<double> xs, ys, zs;
+    calc_global_coords(xs, ys, zs, loc);
+
+    const char* dimnames[3] = {loc[2] ? "zh" : "z", loc[1] ? "yh" : "y", loc[0] ? "xh" : "x"};
+    const std::vector<double>* dimvalues[3] = {&zs, &ys, &xs};
+
+    int dimids[3], coordids[3], timeid, varid;
+    for (int n=0; n<3; ++n)
+    {
+        nc_check(nc_def_dim(ncid, dimnames[n], dimvalues[n]->size(), &dimids[n]), filename);
+        nc_check(nc_def_var(ncid, dimnames[n], NC_DOUBLE, 1, &dimids[n], &coordids[n]), filename);
+    }
+    nc_check(nc_def_var(ncid, "time", NC_DOUBLE, 0, 0, &timeid), filename);
+
+    // every chunk holds the part of one horizontal plane of one process, which gives parallel writes
+    // without shared chunks and lets a reader get one xy plane or a subdomain without the full field
+    const size_t chunks[3] = {1, (size_t)jmax, (size_t)imax};
+    const nc_type type = (sizeof(real) == 4) ? NC_FLOAT : NC_DOUBLE;
+    nc_check(nc_def_var(ncid, name.c_str(), type, 3, dimids, &varid), filename);
+    nc_check(nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunks), filename);
+    if (deflate)
+        nc_check(nc_def_var_deflate(ncid, varid, 1, 1, 1), filename);
+
+    nc_check(nc_enddef(ncid), filename);
+    set_netcdf_collective(ncid, varid, filename);
+
+    // the coordinates are provided by the master process only, the time is the same on all processes,
+    // all processes make the same calls, such that an error is raised everywhere
+    for (int n=0; n<3; ++n)
+    {
+        const size_t start = 0;
+        const size_t count = (master->mpiid == 0) ? dimvalues[n]->size() : 0;
+        nc_check(nc_put_vara_double(ncid, coordids[n], &start, &count, &(*dimvalues[n])[0]), filename);
+    }
+    nc_check(nc_put_var_double(ncid, timeid, &time), filename);
+
+    // extract the data from the 3d field without the ghost cells
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
+
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
+            {
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                tmp[ijkb] = data[ijk];
+            }
+
+    round_slice(tmp, imax*jmax*kmax, true, bound);
+
+    const size_t start[3] = {0, (size_t)master->mpicoordy*jmax, (size_t)master->mpicoordx*imax};
+    const size_t count[3] = {(size_t)kmax, (size_t)jmax, (size_t)imax};
+    nc_check(nc_put_vara(ncid, varid, start, count, tmp), filename);
+
+    nc_check(nc_close(ncid), filename);
 }
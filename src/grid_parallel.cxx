@@ -23,8 +23,12 @@
 #ifdef USEMPI
 #include <fftw3.h>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <netcdf_par.h>
 #include "master.h"
 #include "grid.h"
+#include "profiler.h"
 #include "defines.h"
 
 // MPI functions
@@ -37,69 +41,119 @@ void Grid::init_mpi()
     datacount  = jcells*kcells;
     datablock  = igc;
     datastride = icells;
-    MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &eastwestedge);
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &eastwestedge);
     MPI_Type_commit(&eastwestedge);
 
     // north south
     datacount  = kcells;
     datablock  = icells*jgc;
     datastride = icells*jcells;
-    MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &northsouthedge);
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &northsouthedge);
     MPI_Type_commit(&northsouthedge);
 
     // east west 2d
     datacount  = jcells;
     datablock  = igc;
     datastride = icells;
-    MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &eastwestedge2d);
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &eastwestedge2d);
     MPI_Type_commit(&eastwestedge2d);
 
     // north south 2d
     datacount  = 1;
     datablock  = icells*jgc;
     datastride = icells*jcells;
-    MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &northsouthedge2d);
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &northsouthedge2d);
     MPI_Type_commit(&northsouthedge2d);
 
     // transposez
     datacount = imax*jmax*kblock;
-    MPI_Type_contiguous(datacount, MPI_DOUBLE, &transposez);
+    MPI_Type_contiguous(datacount, mpi_fp_type, &transposez);
     MPI_Type_commit(&transposez);
 
     // transposez iblock/jblock/kblock
     datacount = iblock*jblock*kblock;
-    MPI_Type_contiguous(datacount, MPI_DOUBLE, &transposez2);
+    MPI_Type_contiguous(datacount, mpi_fp_type, &transposez2);
     MPI_Type_commit(&transposez2);
 
     // transposex imax
     datacount  = jmax*kblock;
     datablock  = imax;
     datastride = itot;
-    MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &transposex);
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &transposex);
     MPI_Type_commit(&transposex);
 
     // transposex iblock
     datacount  = jmax*kblock;
     datablock  = iblock;
     datastride = itot;
-    MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &transposex2);
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &transposex2);
     MPI_Type_commit(&transposex2);
 
     // transposey
     datacount  = kblock;
     datablock  = iblock*jmax;
     datastride = iblock*jtot;
-    MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &transposey);
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &transposey);
     MPI_Type_commit(&transposey);
 
     // transposey2
     datacount  = kblock;
     datablock  = iblock*jblock;
     datastride = iblock*jtot;
-    MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &transposey2);
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &transposey2);
     MPI_Type_commit(&transposey2);
 
-    // file saving and loading, take C-ordering into account
+    // single vertical levels of the transpose blocks for the pipelined transposes,
+    // the extent of the strided types is set to the size of one level of the full array
+    MPI_Datatype leveltype;
+
+    // transposezk
+    datacount = imax*jmax;
+    MPI_Type_contiguous(datacount, mpi_fp_type, &transposezk);
+    MPI_Type_commit(&transposezk);
+
+    // transposezk2
+    datacount = iblock*jblock;
+    MPI_Type_contiguous(datacount, mpi_fp_type, &transposezk2);
+    MPI_Type_commit(&transposezk2);
+
+    // transposexk
+    datacount  = jmax;
+    datablock  = imax;
+    datastride = itot;
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &leveltype);
+    MPI_Type_create_resized(leveltype, 0, itot*jmax*sizeof(real), &transposexk);
+    MPI_Type_commit(&transposexk);
+    MPI_Type_free(&leveltype);
+
+    // transposexk2
+    datacount  = jmax;
+    datablock  = iblock;
+    datastride = itot;
+    MPI_Type_vector(datacount, datablock, datastride, mpi_fp_type, &leveltype);
+    MPI_Type_create_resized(leveltype, 0, itot*jmax*sizeof(real), &transposexk2);
+    MPI_Type_commit(&transposexk2);
+    MPI_Type_free(&leveltype);
+
+    // transposeyk
+    datacount = iblock*jmax;
+    MPI_Type_contiguous(datacount, mpi_fp_type, &leveltype);
+    MPI_Type_create_resized(leveltype, 0, iblock*jtot*sizeof(real), &transposeyk);
+    MPI_Type_commit(&transposeyk);
+    MPI_Type_free(&leveltype);
+
+    // transposeyk2
+    datacount = iblock*jblock;
+    MPI_Type_contiguous(datacount, mpi_fp_type, &leveltype);
+    MPI_Type_create_resized(leveltype, 0, iblock*jtot*sizeof(real), &transposeyk2);
+    MPI_Type_commit(&transposeyk2);
+    MPI_Type_free(&leveltype);
+
+    // allocate the requests of the pipelined transposes
+    const int nchunks = kchunks.size()-1;
+    chunkreqs = new MPI_Request[nchunks*2*std::max(master->npx, master->npy)];
+
+    // saving of the grid, which is stored in double precision, take C-ordering into account
     int totsizei  = itot;
     int subsizei  = imax;
     int substarti = master->mpicoordx*imax;
@@ -119,28 +173,28 @@ void Grid::init_mpi()
     int totsize [3] = {kmax  , jtot, itot};
     int subsize [3] = {kblock, jmax, itot};
     int substart[3] = {master->mpicoordx*kblock, master->mpicoordy*jmax, 0};
-    MPI_Type_create_subarray(3, totsize, subsize, substart, MPI_ORDER_C, MPI_DOUBLE, &subarray);
+    MPI_Type_create_subarray(3, totsize, subsize, substart, MPI_ORDER_C, mpi_fp_type, &subarray);
     MPI_Type_commit(&subarray);
 
     // save mpitype for a xz-slice for cross section processing
     int totxzsize [2] = {kmax, itot};
     int subxzsize [2] = {kmax, imax};
     int subxzstart[2] = {0, master->mpicoordx*imax};
-    MPI_Type_create_subarray(2, totxzsize, subxzsize, subxzstart, MPI_ORDER_C, MPI_DOUBLE, &subxzslice);
+    MPI_Type_create_subarray(2, totxzsize, subxzsize, subxzstart, MPI_ORDER_C, mpi_fp_type, &subxzslice);
     MPI_Type_commit(&subxzslice);
     
     // save mpitype for a yz-slice for cross section processing
     int totyzsize [2] = {kmax, jtot};
     int subyzsize [2] = {kmax, jmax};
     int subyzstart[2] = {0, master->mpicoordy*jmax};
-    MPI_Type_create_subarray(2, totyzsize, subyzsize, subyzstart, MPI_ORDER_C, MPI_DOUBLE, &subyzslice);
+    MPI_Type_create_subarray(2, totyzsize, subyzsize, subyzstart, MPI_ORDER_C, mpi_fp_type, &subyzslice);
     MPI_Type_commit(&subyzslice);
 
     // save mpitype for a xy-slice for cross section processing
     int totxysize [2] = {jtot, itot};
     int subxysize [2] = {jmax, imax};
     int subxystart[2] = {master->mpicoordy*jmax, master->mpicoordx*imax};
-    MPI_Type_create_subarray(2, totxysize, subxysize, subxystart, MPI_ORDER_C, MPI_DOUBLE, &subxyslice);
+    MPI_Type_create_subarray(2, totxysize, subxysize, subxystart, MPI_ORDER_C, mpi_fp_type, &subxyslice);
     MPI_Type_commit(&subxyslice);
 
     // allocate the array for the profiles
@@ -163,6 +217,12 @@ void Grid::exit_mpi()
         MPI_Type_free(&transposex2);
         MPI_Type_free(&transposey);
         MPI_Type_free(&transposey2);
+        MPI_Type_free(&transposezk);
+        MPI_Type_free(&transposezk2);
+        MPI_Type_free(&transposexk);
+        MPI_Type_free(&transposexk2);
+        MPI_Type_free(&transposeyk);
+        MPI_Type_free(&transposeyk2);
         MPI_Type_free(&subi);
         MPI_Type_free(&subj);
         MPI_Type_free(&subarray);
@@ -171,11 +231,14 @@ void Grid::exit_mpi()
         MPI_Type_free(&subxyslice);
 
         delete[] profl;
+        delete[] chunkreqs;
     }
 }
 
-void Grid::boundary_cyclic(double* restrict data, Edge edge)
+void Grid::boundary_cyclic(real* restrict data, Edge edge)
 {
+    profiler->start("boundary_cyclic");
+
     const int ncount = 1;
 
     if (edge == East_west_edge || edge == Both_edges)
@@ -240,10 +303,14 @@ void Grid::boundary_cyclic(double* restrict data, Edge edge)
                     }
         }
     }
+
+    profiler->stop("boundary_cyclic");
 }
 
-void Grid::boundary_cyclic_2d(double* restrict data)
+void Grid::boundary_cyclic_2d(real* restrict data)
 {
+    profiler->start("boundary_cyclic");
+
     int ncount = 1;
 
     // communicate east-west edges
@@ -301,10 +368,14 @@ void Grid::boundary_cyclic_2d(double* restrict data)
                 data[ijsouth] = data[ijref];
             }
     }
+
+    profiler->stop("boundary_cyclic");
 }
 
-void Grid::transpose_zx(double* restrict ar, double* restrict as)
+void Grid::transpose_zx(real* restrict ar, real* restrict as)
 {
+    profiler->start("transpose");
+
     const int ncount = 1;
     const int tag = 1;
 
@@ -324,10 +395,14 @@ void Grid::transpose_zx(double* restrict ar, double* restrict as)
         master->reqsn++;
     }
     master->wait_all();
+
+    profiler->stop("transpose");
 }
 
-void Grid::transpose_xz(double* restrict ar, double* restrict as)
+void Grid::transpose_xz(real* restrict ar, real* restrict as)
 {
+    profiler->start("transpose");
+
     const int ncount = 1;
     const int tag = 1;
 
@@ -347,10 +422,14 @@ void Grid::transpose_xz(double* restrict ar, double* restrict as)
         master->reqsn++;
     }
     master->wait_all();
+
+    profiler->stop("transpose");
 }
 
-void Grid::transpose_xy(double* restrict ar, double* restrict as)
+void Grid::transpose_xy(real* restrict ar, real* restrict as)
 {
+    profiler->start("transpose");
+
     const int ncount = 1;
     const int tag = 1;
 
@@ -370,10 +449,14 @@ void Grid::transpose_xy(double* restrict ar, double* restrict as)
         master->reqsn++;
     }
     master->wait_all();
+
+    profiler->stop("transpose");
 }
 
-void Grid::transpose_yx(double* restrict ar, double* restrict as)
+void Grid::transpose_yx(real* restrict ar, real* restrict as)
 {
+    profiler->start("transpose");
+
     const int ncount = 1;
     const int tag = 1;
 
@@ -393,10 +476,14 @@ void Grid::transpose_yx(double* restrict ar, double* restrict as)
         master->reqsn++;
     }
     master->wait_all();
+
+    profiler->stop("transpose");
 }
 
-void Grid::transpose_yz(double* restrict ar, double* restrict as)
+void Grid::transpose_yz(real* restrict ar, real* restrict as)
 {
+    profiler->start("transpose");
+
     const int ncount = 1;
     const int tag = 1;
 
@@ -416,10 +503,14 @@ void Grid::transpose_yz(double* restrict ar, double* restrict as)
         master->reqsn++;
     }
     master->wait_all();
+
+    profiler->stop("transpose");
 }
 
-void Grid::transpose_zy(double* restrict ar, double* restrict as)
+void Grid::transpose_zy(real* restrict ar, real* restrict as)
 {
+    profiler->start("transpose");
+
     const int ncount = 1;
     const int tag = 1;
 
@@ -439,6 +530,49 @@ void Grid::transpose_zy(double* restrict ar, double* restrict as)
         master->reqsn++;
     }
     master->wait_all();
+
+    profiler->stop("transpose");
+}
+
+void Grid::start_transpose_chunks(real* restrict ar, real* restrict as, MPI_Comm comm, const int np,
+                                  MPI_Datatype sendtype, const int sendoffset, const int sendkk,
+                                  MPI_Datatype recvtype, const int recvoffset, const int recvkk)
+{
+    profiler->start("transpose");
+
+    const int nchunks = kchunks.size()-1;
+
+    // post the communication of all chunks at once, the chunks are distinguished by their tag
+    for (int c=0; c<nchunks; ++c)
+    {
+        const int kstart = kchunks[c];
+        const int ncount = kchunks[c+1] - kchunks[c];
+        const int tag = c+1;
+
+        MPI_Request* reqs = &chunkreqs[c*2*np];
+
+        for (int n=0; n<np; n++)
+        {
+            // determine where to fetch the data and where to store it
+            const int ijks = n*sendoffset + kstart*sendkk;
+            const int ijkr = n*recvoffset + kstart*recvkk;
+
+            // send and receive the data
+            MPI_Isend(&as[ijks], ncount, sendtype, n, tag, comm, &reqs[2*n  ]);
+            MPI_Irecv(&ar[ijkr], ncount, recvtype, n, tag, comm, &reqs[2*n+1]);
+        }
+    }
+
+    profiler->stop("transpose");
+}
+
+void Grid::wait_transpose_chunk(const int c, const int np)
+{
+    profiler->start("transpose");
+
+    MPI_Waitall(2*np, &chunkreqs[c*2*np], MPI_STATUSES_IGNORE);
+
+    profiler->stop("transpose");
 }
 
 void Grid::get_max(double *var)
@@ -485,27 +619,33 @@ void Grid::save()
     MPI_Offset fileoff = 0; // the offset within the file (header size)
     char name[] = "native";
 
+    // the grid is always stored in double precision, independent of the precision of the model
+    const std::vector<double> xd (&x [istart], &x [istart]+imax);
+    const std::vector<double> xhd(&xh[istart], &xh[istart]+imax);
+    const std::vector<double> yd (&y [jstart], &y [jstart]+jmax);
+    const std::vector<double> yhd(&yh[jstart], &yh[jstart]+jmax);
+
     MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subi, name, MPI_INFO_NULL);
     if (master->mpicoordy == 0)
-        MPI_File_write(fh, &x[istart], imax, MPI_DOUBLE, MPI_STATUS_IGNORE);
+        MPI_File_write(fh, &xd[0], imax, MPI_DOUBLE, MPI_STATUS_IGNORE);
     MPI_Barrier(master->commxy);
     fileoff += itot*sizeof(double);
 
     MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subi, name, MPI_INFO_NULL);
     if (master->mpicoordy == 0)
-        MPI_File_write(fh, &xh[istart], imax, MPI_DOUBLE, MPI_STATUS_IGNORE);
+        MPI_File_write(fh, &xhd[0], imax, MPI_DOUBLE, MPI_STATUS_IGNORE);
     MPI_Barrier(master->commxy);
     fileoff += itot*sizeof(double);
 
     MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subj, name, MPI_INFO_NULL);
     if (master->mpicoordx == 0)
-        MPI_File_write(fh, &y[jstart], jmax, MPI_DOUBLE, MPI_STATUS_IGNORE);
+        MPI_File_write(fh, &yd[0], jmax, MPI_DOUBLE, MPI_STATUS_IGNORE);
     MPI_Barrier(master->commxy);
     fileoff += jtot*sizeof(double);
 
     MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subj, name, MPI_INFO_NULL);
     if (master->mpicoordx == 0)
-        MPI_File_write(fh, &yh[jstart], jmax, MPI_DOUBLE, MPI_STATUS_IGNORE);
+        MPI_File_write(fh, &yhd[0], jmax, MPI_DOUBLE, MPI_STATUS_IGNORE);
     MPI_Barrier(master->commxy);
 
     MPI_File_sync(fh);
@@ -516,8 +656,10 @@ void Grid::save()
     {
         FILE *pFile;
         pFile = fopen(filename, "ab");
-        fwrite(&z [kstart], sizeof(double), kmax, pFile);
-        fwrite(&zh[kstart], sizeof(double), kmax, pFile);
+        const std::vector<double> zd (&z [kstart], &z [kstart]+kmax);
+        const std::vector<double> zhd(&zh[kstart], &zh[kstart]+kmax);
+        fwrite(&zd [0], sizeof(double), kmax, pFile);
+        fwrite(&zhd[0], sizeof(double), kmax, pFile);
         fclose(pFile);
     }
 
@@ -525,28 +667,7 @@ void Grid::save()
     master->print_message("OK\n");
 
     // SAVE THE FFTW PLAN IN ORDER TO ENSURE BITWISE IDENTICAL RESTARTS
-    // use the FFTW3 many interface in order to reduce function call overhead
-    int rank = 1;
-    int ni[] = {itot};
-    int nj[] = {jtot};
-    int istride = 1;
-    int jstride = iblock;
-    int idist = itot;
-    int jdist = 1;
-
-    fftw_r2r_kind kindf[] = {FFTW_R2HC};
-    fftw_r2r_kind kindb[] = {FFTW_HC2R};
-
-    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindf, FFTW_EXHAUSTIVE);
-    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindb, FFTW_EXHAUSTIVE);
-    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindf, FFTW_EXHAUSTIVE);
-    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindb, FFTW_EXHAUSTIVE);
-
-    fftwplan = true;
+    create_fftw_plans();
 
     if (master->mpiid == 0)
     {
@@ -555,7 +676,7 @@ void Grid::save()
 
         master->print_message("Saving \"%s\" ... ", filename);
 
-        int n = fftw_export_wisdom_to_filename(filename);
+        int n = FFTW(export_wisdom_to_filename)(filename);
         if (n == 0)
         {
             master->print_error("\"%s\" cannot be saved\n", filename);
@@ -585,11 +706,16 @@ void Grid::load()
         }
         else
         {
+            // the grid is stored in double precision
+            std::vector<double> zd(kmax), zhd(kmax);
             int n = (2*itot+2*jtot)*sizeof(double);
             fseek(pFile, n, SEEK_SET);
-            fread(&z [kstart], sizeof(double), kmax, pFile);
-            fread(&zh[kstart], sizeof(double), kmax, pFile);
+            fread(&zd [0], sizeof(double), kmax, pFile);
+            fread(&zhd[0], sizeof(double), kmax, pFile);
             fclose(pFile);
+
+            std::copy(zd .begin(), zd .end(), &z [kstart]);
+            std::copy(zhd.begin(), zhd.end(), &zh[kstart]);
         }
     }
 
@@ -614,7 +740,7 @@ void Grid::load()
 
     master->print_message("Loading \"%s\" ... ", filename);
 
-    int n = fftw_import_wisdom_from_filename(filename);
+    int n = FFTW(import_wisdom_from_filename)(filename);
     if (n == 0)
     {
         master->print_message("FAILED\n");
@@ -623,31 +749,13 @@ void Grid::load()
     else
         master->print_message("OK\n");
 
-    // use the FFTW3 many interface in order to reduce function call overhead
-    int rank = 1;
-    int ni[] = {itot};
-    int nj[] = {jtot};
-    int istride = 1;
-    int jstride = iblock;
-    int idist = itot;
-    int jdist = 1;
-    fftw_r2r_kind kindf[] = {FFTW_R2HC};
-    fftw_r2r_kind kindb[] = {FFTW_HC2R};
-    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindf, FFTW_EXHAUSTIVE);
-    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindb, FFTW_EXHAUSTIVE);
-    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindf, FFTW_EXHAUSTIVE);
-    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindb, FFTW_EXHAUSTIVE);
-
-    fftwplan = true;
+    create_fftw_plans();
 
-    fftw_forget_wisdom();
+    FFTW(forget_wisdom)();
 }
 
-int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+int Grid::save_field3d(real* restrict data, real* restrict tmp1, real* restrict tmp2, char* filename, double offset,
+                       bool compress, Error_bound* bound)
 {
     // save the data in transposed order to have large chunks of contiguous disk space
     // MPI-IO is not stable on Juqueen and supermuc otherwise
@@ -672,6 +780,15 @@ int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* res
 
     transpose_zx(tmp2, tmp1);
 
+    if (bound && bound->type != "0")
+    {
+        bound->maxerror = round_field(tmp2, imax*jmax*kmax, *bound);
+        master->max(&bound->maxerror, 1);
+    }
+
+    if (compress)
+        return save_field3d_compressed(tmp2, filename);
+
     MPI_File fh;
     if (MPI_File_open(master->commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &fh))
         return 1;
@@ -680,10 +797,10 @@ int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* res
     MPI_Offset fileoff = 0; // the offset within the file (header size)
     char name[] = "native";
 
-    if (MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subarray, name, MPI_INFO_NULL))
+    if (MPI_File_set_view(fh, fileoff, mpi_fp_type, subarray, name, MPI_INFO_NULL))
         return 1;
 
-    if (MPI_File_write_all(fh, tmp2, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
+    if (MPI_File_write_all(fh, tmp2, count, mpi_fp_type, MPI_STATUS_IGNORE))
         return 1;
 
     if (MPI_File_close(&fh))
@@ -692,30 +809,241 @@ int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* res
     return 0;
 }
 
-int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+void Grid::stage_field3d(real* restrict staging, real* restrict data, real* restrict tmp1, double offset)
 {
-    // save the data in transposed order to have large chunks of contiguous disk space
-    // MPI-IO is not stable on Juqueen and supermuc otherwise
+    // extract the data from the 3d field without the ghost cells
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
+
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
+            {
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                tmp1[ijkb] = data[ijk] + offset;
+            }
+
+    // transpose to the file order that is used by save_field3d
+    transpose_zx(staging, tmp1);
+}
+
+FILE* Grid::create_field3d_file(char* filename)
+{
+    // create the file on the master process only, to fail if it exists, then open it everywhere
+    int nerror = 0;
+    if (master->mpiid == 0)
+    {
+        FILE* pFile = fopen(filename, "wbx");
+        if (pFile == NULL)
+            ++nerror;
+        else
+            fclose(pFile);
+    }
+    master->broadcast(&nerror, 1);
+    if (nerror)
+        return NULL;
+
+    FILE* pFile = fopen(filename, "r+b");
+    nerror = (pFile == NULL);
+    master->sum(&nerror, 1);
+    if (nerror)
+    {
+        if (pFile != NULL)
+            fclose(pFile);
+        return NULL;
+    }
+
+    return pFile;
+}
+
+int Grid::write_field3d_file(FILE* pFile, real* restrict staging, long offset)
+{
+    // every process owns jmax full rows of the x-direction for kblock levels of the file,
+    // which are contiguous on disk per level, see the subarray type of save_field3d
+    int nerror = 0;
+    const size_t count = itot*jmax;
+
+    for (int k=0; k<kblock; k++)
+    {
+        const long fileoff = offset + ((long)(master->mpicoordx*kblock + k)*jtot + master->mpicoordy*jmax)*itot*sizeof(real);
+        if (fseek(pFile, fileoff, SEEK_SET))
+            ++nerror;
+        else if (fwrite(&staging[k*count], sizeof(real), count, pFile) != count)
+            ++nerror;
+    }
+
+    return nerror;
+}
+
+unsigned long Grid::calc_checksum(const real* restrict staging)
+{
+    // weigh every value with its position in the file, such that the sum over the processes
+    // does not depend on the decomposition, while swapped or shifted data is detected
+    unsigned long checksum = 0;
+
+    for (int k=0; k<kblock; k++)
+        for (int j=0; j<jmax; j++)
+        {
+            const unsigned long ijfile = ((unsigned long)(master->mpicoordx*kblock + k)*jtot + master->mpicoordy*jmax + j)*itot;
+            for (int i=0; i<itot; i++)
+            {
+                const int ijk = i + j*itot + k*itot*jmax;
+                unsigned long bits = 0;
+                std::memcpy(&bits, &staging[ijk], sizeof(real));
+                checksum += (bits + 1) * (2*(ijfile + i) + 1);
+            }
+        }
+
+    return checksum;
+}
+
+int Grid::save_restart(char* filename, Restart_header& header, const std::vector<real*>& data,
+                       real* restrict tmp1, real* restrict tmp2)
+{
+    const int nfields = data.size();
+    const int count = imax*jmax*kmax;
+    char name[] = "native";
 
-    // read the file
     MPI_File fh;
-    if (MPI_File_open(master->commxy, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh))
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &fh))
         return 1;
 
-    // select noncontiguous part of 3d array to store the selected data
-    MPI_Offset fileoff = 0; // the offset within the file (header size)
-    char name[] = "native";
-    MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subarray, name, MPI_INFO_NULL);
+    int nerror = 0;
+    header.checksums.resize(nfields);
 
-    // extract the data from the 3d field without the ghost cells
-    int count = imax*jmax*kmax;
+    // write the fields as contiguous blocks after the header
+    for (int n=0; n<nfields; ++n)
+    {
+        stage_field3d(tmp2, data[n], tmp1, 0.);
+        header.checksums[n] = calc_checksum(tmp2);
 
-    if (MPI_File_read_all(fh, tmp1, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
-        return 1;
+        MPI_Offset fileoff = get_restart_offset(header, n);
+        if (MPI_File_set_view(fh, fileoff, mpi_fp_type, subarray, name, MPI_INFO_NULL))
+            ++nerror;
+        else if (MPI_File_write_all(fh, tmp2, count, mpi_fp_type, MPI_STATUS_IGNORE))
+            ++nerror;
+    }
+
+    // write the header last, as it contains the checksums over all processes
+    master->sum(&header.checksums[0], nfields);
+
+    if (MPI_File_set_view(fh, 0, MPI_BYTE, MPI_BYTE, name, MPI_INFO_NULL))
+        ++nerror;
+    else if (master->mpiid == 0)
+    {
+        std::vector<char> buffer = pack_restart_header(header);
+        if (MPI_File_write_at(fh, 0, &buffer[0], buffer.size(), MPI_BYTE, MPI_STATUS_IGNORE))
+            ++nerror;
+    }
 
     if (MPI_File_close(&fh))
+        ++nerror;
+
+    master->sum(&nerror, 1);
+
+    return nerror;
+}
+
+int Grid::load_restart(char* filename, const Restart_header& header, const std::vector<std::string>& names,
+                       const std::vector<real*>& data, real* restrict tmp1, real* restrict tmp2)
+{
+    const int count = imax*jmax*kmax;
+    char name[] = "native";
+
+    MPI_File fh;
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh))
         return 1;
 
+    int nerror = 0;
+
+    for (size_t n=0; n<names.size(); ++n)
+    {
+        const int nh = std::find(header.names.begin(), header.names.end(), names[n]) - header.names.begin();
+        if (nh == (int)header.names.size())
+        {
+            master->print_error("field %s is not in \"%s\"\n", names[n].c_str(), filename);
+            ++nerror;
+            break;
+        }
+
+        MPI_Offset fileoff = get_restart_offset(header, nh);
+        if (MPI_File_set_view(fh, fileoff, mpi_fp_type, subarray, name, MPI_INFO_NULL))
+            ++nerror;
+        else if (MPI_File_read_all(fh, tmp1, count, mpi_fp_type, MPI_STATUS_IGNORE))
+            ++nerror;
+
+        unsigned long checksum = calc_checksum(tmp1);
+        master->sum(&checksum, 1);
+        if (checksum != header.checksums[nh])
+        {
+            master->print_error("checksum of field %s in \"%s\" does not match\n", names[n].c_str(), filename);
+            ++nerror;
+        }
+
+        // transpose back and put the data in the 3d field with ghost cells
+        transpose_xz(tmp2, tmp1);
+
+        const int jj  = icells;
+        const int kk  = icells*jcells;
+        const int jjb = imax;
+        const int kkb = imax*jmax;
+
+        for (int k=0; k<kmax; k++)
+            for (int j=0; j<jmax; j++)
+#pragma ivdep
+                for (int i=0; i<imax; i++)
+                {
+                    const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                    const int ijkb = i + j*jjb + k*kkb;
+                    data[n][ijk] = tmp2[ijkb];
+                }
+    }
+
+    if (MPI_File_close(&fh))
+        ++nerror;
+
+    return nerror;
+}
+
+int Grid::load_field3d(real* restrict data, real* restrict tmp1, real* restrict tmp2, char* filename, double offset)
+{
+    // save the data in transposed order to have large chunks of contiguous disk space
+    // MPI-IO is not stable on Juqueen and supermuc otherwise
+
+    if (is_compressed_field3d(filename))
+    {
+        if (load_field3d_compressed(tmp1, filename))
+            return 1;
+    }
+    else
+    {
+        if (check_field3d_size(filename))
+            return 1;
+
+        // read the file
+        MPI_File fh;
+        if (MPI_File_open(master->commxy, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh))
+            return 1;
+
+        // select noncontiguous part of 3d array to store the selected data
+        MPI_Offset fileoff = 0; // the offset within the file (header size)
+        char name[] = "native";
+        MPI_File_set_view(fh, fileoff, mpi_fp_type, subarray, name, MPI_INFO_NULL);
+
+        // extract the data from the 3d field without the ghost cells
+        int count = imax*jmax*kmax;
+
+        if (MPI_File_read_all(fh, tmp1, count, mpi_fp_type, MPI_STATUS_IGNORE))
+            return 1;
+
+        if (MPI_File_close(&fh))
+            return 1;
+    }
+
     // transpose the data back
     transpose_xz(tmp2, tmp1);
 
@@ -737,152 +1065,336 @@ int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* res
     return 0;
 }
 
-void Grid::fft_forward(double* restrict data,   double* restrict tmp1,
-                       double* restrict fftini, double* restrict fftouti,
-                       double* restrict fftinj, double* restrict fftoutj)
+int Grid::save_field3d_compressed(real* restrict staged, char* filename)
 {
-    // transpose the pressure field
-    transpose_zx(tmp1,data);
+    // every process compresses its rows of the transposed field in the x-direction
+    const int nrows = jmax*kblock;
+    const int nrowstot = jtot*ktot;
+
+    std::vector<unsigned char> buffer;
+    std::vector<unsigned long> sizes;
+    int nerror = compress_rows(buffer, sizes, staged, nrows);
+    master->sum(&nerror, 1);
+    if (nerror)
+        return 1;
 
-    int kk = itot*jmax;
+    // every process writes its rows as one block, behind the blocks of the processes with a lower rank
+    unsigned long nbytes = buffer.size();
+    unsigned long blockoff = 0;
+    MPI_Exscan(&nbytes, &blockoff, 1, MPI_UNSIGNED_LONG, MPI_SUM, master->commxy);
+    if (master->mpiid == 0)
+        blockoff = 0;
+    blockoff += get_compressed_header_size();
 
-    // process the fourier transforms slice by slice
-    for (int k=0; k<kblock; k++)
+    // the file offsets of the local rows and the end of the block are gathered on the master process for the index
+    std::vector<unsigned long> offsets(nrows+1);
+    offsets[0] = blockoff;
+    for (int n=0; n<nrows; ++n)
+        offsets[n+1] = offsets[n] + sizes[n];
+
+    std::vector<unsigned long> alloffsets;
+    if (master->mpiid == 0)
+        alloffsets.resize((size_t)master->nprocs*(nrows+1));
+    MPI_Gather(&offsets[0], nrows+1, MPI_UNSIGNED_LONG, alloffsets.data(), nrows+1, MPI_UNSIGNED_LONG, 0, master->commxy);
+
+    std::vector<unsigned long> index;
+    if (master->mpiid == 0)
     {
-#pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
+        index.resize(nrowstot+1, 0);
+        for (int p=0; p<master->nprocs; ++p)
         {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftini[ij] = tmp1[ijk];
+            int coords[2];
+            MPI_Cart_coords(master->commxy, p, 2, coords);
+            const unsigned long* poffsets = &alloffsets[(size_t)p*(nrows+1)];
+            for (int k=0; k<kblock; k++)
+                for (int j=0; j<jmax; j++)
+                    index[(coords[1]*kblock + k)*jtot + coords[0]*jmax + j] = poffsets[k*jmax + j];
+            index[nrowstot] = std::max(index[nrowstot], poffsets[nrows]);
         }
+    }
 
-        fftw_execute(iplanf);
+    MPI_File fh;
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &fh))
+        return 1;
 
-#pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            tmp1[ijk] = fftouti[ij];
-        }
+    if (MPI_File_write_at_all(fh, blockoff, &buffer[0], nbytes, MPI_BYTE, MPI_STATUS_IGNORE))
+        ++nerror;
+
+    // the master process writes the header with the index
+    if (master->mpiid == 0)
+    {
+        std::vector<char> header = pack_compressed_header();
+        if (MPI_File_write_at(fh, 0, &header[0], header.size(), MPI_BYTE, MPI_STATUS_IGNORE))
+            ++nerror;
+        else if (MPI_File_write_at(fh, get_compressed_index_offset(), &index[0], nrowstot+1, MPI_UNSIGNED_LONG, MPI_STATUS_IGNORE))
+            ++nerror;
     }
 
-    // transpose again
-    transpose_xy(data,tmp1);
+    if (MPI_File_close(&fh))
+        ++nerror;
 
-    kk = iblock*jtot;
+    master->sum(&nerror, 1);
 
-    // do the second fourier transform
-    for (int k=0; k<kblock; k++)
+    return nerror;
+}
+
+int Grid::load_field3d_compressed(real* restrict staged, char* filename)
+{
+    const int nrows = jmax*kblock;
+    const int nrowstot = jtot*ktot;
+
+    MPI_File fh;
+    if (MPI_File_open(master->commxy, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh))
+        return 1;
+
+    // the master process reads the header and the index
+    int nerror = 0;
+    std::vector<unsigned long> index(nrowstot+1);
+    if (master->mpiid == 0)
     {
-#pragma ivdep
-        for (int n=0; n<iblock*jtot; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftinj[ij] = data[ijk];
-        }
+        std::vector<char> header(get_compressed_index_offset());
+        if (MPI_File_read_at(fh, 0, &header[0], header.size(), MPI_BYTE, MPI_STATUS_IGNORE))
+            ++nerror;
+        else if (check_compressed_header(header, filename))
+            ++nerror;
+        else if (MPI_File_read_at(fh, get_compressed_index_offset(), &index[0], nrowstot+1, MPI_UNSIGNED_LONG, MPI_STATUS_IGNORE))
+            ++nerror;
+    }
+    master->broadcast(&nerror, 1);
+    if (nerror)
+    {
+        MPI_File_close(&fh);
+        return 1;
+    }
+    master->broadcast(&index[0], nrowstot+1);
 
-        fftw_execute(jplanf);
+    std::vector<unsigned long> allsizes(nrowstot);
+    get_compressed_row_sizes(&index[0], &allsizes[0]);
 
-#pragma ivdep
-        for (int n=0; n<iblock*jtot; n++)
+    // read the local rows collectively, in the order of the file, as the displacements of a file view
+    // have to increase, and keep the start of every row in the buffer
+    std::vector<int> rows(nrows);
+    std::vector<unsigned long> sizes(nrows);
+    for (int k=0; k<kblock; k++)
+        for (int j=0; j<jmax; j++)
         {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            // shift to use p in pressure solver
-            tmp1[ijk] = fftoutj[ij];
+            const int n = k*jmax + j;
+            rows [n] = (master->mpicoordx*kblock + k)*jtot + master->mpicoordy*jmax + j;
+            sizes[n] = allsizes[rows[n]];
         }
+
+    std::vector<int> order(nrows);
+    for (int n=0; n<nrows; ++n)
+        order[n] = n;
+    std::sort(order.begin(), order.end(), [&](const int a, const int b) { return index[rows[a]] < index[rows[b]]; });
+
+    std::vector<int> blocklengths(nrows);
+    std::vector<MPI_Aint> displacements(nrows);
+    std::vector<unsigned long> starts(nrows);
+    unsigned long total = 0;
+    for (int m=0; m<nrows; ++m)
+    {
+        const int n = order[m];
+        blocklengths [m] = sizes[n];
+        displacements[m] = index[rows[n]];
+        starts[n] = total;
+        total += sizes[n];
     }
 
-    // transpose back to original orientation
-    transpose_yz(data,tmp1);
+    MPI_Datatype rowtype;
+    MPI_Type_create_hindexed(nrows, &blocklengths[0], &displacements[0], MPI_BYTE, &rowtype);
+    MPI_Type_commit(&rowtype);
+
+    std::vector<unsigned char> buffer(total);
+    char name[] = "native";
+    if (MPI_File_set_view(fh, 0, MPI_BYTE, rowtype, name, MPI_INFO_NULL))
+        ++nerror;
+    else if (MPI_File_read_all(fh, &buffer[0], total, MPI_BYTE, MPI_STATUS_IGNORE))
+        ++nerror;
+
+    if (MPI_File_close(&fh))
+        ++nerror;
+
+    MPI_Type_free(&rowtype);
+
+    if (!nerror)
+        nerror += decompress_rows(staged, &buffer[0], &starts[0], &sizes[0], nrows);
+
+    master->sum(&nerror, 1);
+
+    return nerror;
 }
 
-void Grid::fft_backward(double* restrict data,   double* restrict tmp1,
-                        double* restrict fftini, double* restrict fftouti,
-                        double* restrict fftinj, double* restrict fftoutj)
+void Grid::create_fftw_plans()
 {
-    // transpose back to y
-    transpose_zy(tmp1, data);
+    const int nchunks = kchunks.size()-1;
 
-    int kk = iblock*jtot;
+    iplanf.resize(nchunks);
+    iplanb.resize(nchunks);
+    jplanf.resize(nchunks);
+    jplanb.resize(nchunks);
 
-    // transform the second transform back
-    for (int k=0; k<kblock; k++)
+    // the plans are made on help arrays of the size of the transposed fields, the fields are
+    // allocated with the same alignment, so the plans can be executed directly on the fields
+    real* in  = FFTW(alloc_real)(itot*jmax*kblock);
+    real* out = FFTW(alloc_real)(itot*jmax*kblock);
+
+    FFTW(r2r_kind) kindf[] = {FFTW_R2HC};
+    FFTW(r2r_kind) kindb[] = {FFTW_HC2R};
+
+    int ni[] = {itot};
+    const int istride = 1;
+    const int idist = itot;
+
+    for (int c=0; c<nchunks; ++c)
     {
-#pragma ivdep
-        for (int n=0; n<iblock*jtot; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftinj[ij] = tmp1[ijk];
-        }
+        const int ijk = kchunks[c]*itot*jmax;
+        const int nk  = kchunks[c+1] - kchunks[c];
+
+        // the x-transforms run in place over all rows of the chunk
+        iplanf[c] = FFTW(plan_many_r2r)(1, ni, jmax*nk, &in[ijk], ni, istride, idist,
+                                        &in[ijk], ni, istride, idist, kindf, fftwflags);
+        iplanb[c] = FFTW(plan_many_r2r)(1, ni, jmax*nk, &in[ijk], ni, istride, idist,
+                                        &in[ijk], ni, istride, idist, kindb, fftwflags);
+
+        // the y-transforms are strided, batch them over the x-direction and the levels of the chunk,
+        // the forward transform writes into a second array that is transposed back afterwards
+        FFTW(iodim) jdims[] = { {jtot, iblock, iblock} };
+        FFTW(iodim) jhowmany[] = { {iblock, 1, 1}, {nk, iblock*jtot, iblock*jtot} };
+        jplanf[c] = FFTW(plan_guru_r2r)(1, jdims, 2, jhowmany, &in[ijk], &out[ijk], kindf, fftwflags);
+        jplanb[c] = FFTW(plan_guru_r2r)(1, jdims, 2, jhowmany, &in[ijk], &in[ijk], kindb, fftwflags);
+    }
 
-        fftw_execute(jplanb);
+    FFTW(free)(in);
+    FFTW(free)(out);
 
-#pragma ivdep
-        for (int n=0; n<iblock*jtot; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            data[ijk] = fftoutj[ij] / jtot;
-        }
+    fftwplan = true;
+}
+
+void Grid::fft_forward(real* restrict data, real* restrict tmp1, bool ztranspose)
+{
+    profiler->start("fft");
+
+    // in pipelined mode the transposes are split into chunks in the vertical and the
+    // fourier transforms of a chunk start as soon as it has arrived
+    const bool pipe = (kchunks.size() > 2);
+    const int nchunks = kchunks.size()-1;
+
+    // transpose the pressure field
+    if (pipe)
+        start_transpose_chunks(tmp1, data, master->commx, master->npx,
+                               transposezk, kblock*imax*jmax, imax*jmax,
+                               transposexk, imax, itot*jmax);
+    else
+        transpose_zx(tmp1,data);
+
+    // process the fourier transforms in place, chunk by chunk
+    for (int c=0; c<nchunks; ++c)
+    {
+        if (pipe)
+            wait_transpose_chunk(c, master->npx);
+
+        const int ijk = kchunks[c]*itot*jmax;
+        FFTW(execute_r2r)(iplanf[c], &tmp1[ijk], &tmp1[ijk]);
+    }
+
+    // transpose again
+    if (pipe)
+        start_transpose_chunks(data, tmp1, master->commy, master->npy,
+                               transposexk2, iblock, itot*jmax,
+                               transposeyk, iblock*jmax, iblock*jtot);
+    else
+        transpose_xy(data,tmp1);
+
+    // do the second fourier transform, the levels of a chunk occupy the same part of tmp1
+    // in x and y-orientation, thus the result can be stored once the chunk has been sent
+    for (int c=0; c<nchunks; ++c)
+    {
+        if (pipe)
+            wait_transpose_chunk(c, master->npy);
+
+        const int ijk = kchunks[c]*iblock*jtot;
+        FFTW(execute_r2r)(jplanf[c], &data[ijk], &tmp1[ijk]);
+    }
+
+    // transpose back to original orientation, unless the vertical solver works on the
+    // y-orientation with the vertical distributed over the processes in the x-direction
+    if (ztranspose)
+        transpose_yz(data,tmp1);
+
+    profiler->stop("fft");
+}
+
+void Grid::fft_backward(real* restrict data, real* restrict tmp1, bool ztranspose)
+{
+    profiler->start("fft");
+
+    // in pipelined mode the transposes are split into chunks in the vertical and the
+    // fourier transforms of a chunk start as soon as it has arrived
+    const bool pipe = (kchunks.size() > 2);
+    const int nchunks = kchunks.size()-1;
+
+    // transpose back to y, unless the input is already in y-orientation
+    if (ztranspose)
+    {
+        if (pipe)
+            start_transpose_chunks(tmp1, data, master->commx, master->npx,
+                                   transposezk2, kblock*iblock*jblock, iblock*jblock,
+                                   transposeyk2, jblock*iblock, iblock*jtot);
+        else
+            transpose_zy(tmp1, data);
+    }
+
+    // transform the second transform back, in place because data is still being sent
+    for (int c=0; c<nchunks; ++c)
+    {
+        if (pipe && ztranspose)
+            wait_transpose_chunk(c, master->npx);
+
+        const int ijk = kchunks[c]*iblock*jtot;
+        FFTW(execute_r2r)(jplanb[c], &tmp1[ijk], &tmp1[ijk]);
     }
 
     // transpose back to x
-    transpose_yx(tmp1, data);
+    if (pipe)
+        start_transpose_chunks(data, tmp1, master->commy, master->npy,
+                               transposeyk, iblock*jmax, iblock*jtot,
+                               transposexk2, iblock, itot*jmax);
+    else
+        transpose_yx(data, tmp1);
 
-    kk = itot*jmax;
+    const int kk = itot*jmax;
+    const double fftnorm = 1./(itot*jtot);
 
-    // transform the first transform back
-    for (int k=0; k<kblock; k++)
+    // transform the first transform back and normalize both transforms at once
+    for (int c=0; c<nchunks; ++c)
     {
-#pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftini[ij] = tmp1[ijk];
-        }
+        if (pipe)
+            wait_transpose_chunk(c, master->npy);
 
-        fftw_execute(iplanb);
+        const int ijk = kchunks[c]*kk;
+        FFTW(execute_r2r)(iplanb[c], &data[ijk], &data[ijk]);
 
 #pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            // swap array here to avoid unnecessary 3d loop
-            data[ijk] = fftouti[ij] / itot;
-        }
+        for (int n=kchunks[c]*kk; n<kchunks[c+1]*kk; n++)
+            data[n] *= fftnorm;
     }
 
     // and transpose back...
     transpose_xz(tmp1, data);
+
+    profiler->stop("fft");
 }
 
-int Grid::save_xz_slice(double* restrict data, double* restrict tmp, char* filename, int jslice)
+int Grid::save_xz_slice(real* restrict data, real* restrict tmp, char* filename, int jslice, Error_bound* bound)
 {
     // extract the data from the 3d field without the ghost cells
     int nerror=0;
 
-    const int jj  = icells;
-    const int kk  = icells*jcells;
-    const int kkb = imax;
-
     int count = imax*kmax;
 
-    for (int k=0; k<kmax; k++)
-#pragma ivdep
-        for (int i=0; i<imax; i++)
-        {
-            // take the modulus of jslice and jmax to have the right offset within proc
-            const int ijk  = i+igc + ((jslice%jmax)+jgc)*jj + (k+kgc)*kk;
-            const int ijkb = i + k*kkb;
-            tmp[ijkb] = data[ijk];
-        }
+    stage_xz_slice(tmp, data, jslice);
+    round_slice(tmp, count, master->mpicoordy == jslice/jmax, bound);
 
     if (master->mpicoordy == jslice/jmax)
     {
@@ -895,12 +1407,12 @@ int Grid::save_xz_slice(double* restrict data, double* restrict tmp, char* filen
         char name[] = "native";
 
         if (!nerror)
-            if (MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subxzslice, name, MPI_INFO_NULL))
+            if (MPI_File_set_view(fh, fileoff, mpi_fp_type, subxzslice, name, MPI_INFO_NULL))
                 ++nerror;
 
         // only write at the procs that contain the slice
         if (!nerror)
-            if (MPI_File_write_all(fh, tmp, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
+            if (MPI_File_write_all(fh, tmp, count, mpi_fp_type, MPI_STATUS_IGNORE))
                 ++nerror;
 
         if (!nerror)
@@ -919,28 +1431,15 @@ int Grid::save_xz_slice(double* restrict data, double* restrict tmp, char* filen
     return nerror;
 }
 
-int Grid::save_yz_slice(double* restrict data, double* restrict tmp, char* filename, int islice)
+int Grid::save_yz_slice(real* restrict data, real* restrict tmp, char* filename, int islice, Error_bound* bound)
 {
     // extract the data from the 3d field without the ghost cells
     int nerror=0;
 
-    const int jj = icells;
-    const int kk = ijcells;
-
-    const int kkb = jmax;
-
     int count = jmax*kmax;
 
-    // Strip off the ghost cells
-    for (int k=0; k<kmax; k++)
-        #pragma ivdep
-        for (int j=0; j<jmax; j++)
-        {
-            // take the modulus of jslice and jmax to have the right offset within proc
-            const int ijk  = (islice%imax)+igc + (j+jgc)*jj + (k+kgc)*kk;
-            const int ijkb = j + k*kkb;
-            tmp[ijkb] = data[ijk];
-        }
+    stage_yz_slice(tmp, data, islice);
+    round_slice(tmp, count, master->mpicoordx == islice/imax, bound);
 
     if (master->mpicoordx == islice/imax)
     {
@@ -953,12 +1452,12 @@ int Grid::save_yz_slice(double* restrict data, double* restrict tmp, char* filen
         char name[] = "native";
 
         if (!nerror)
-            if (MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subyzslice, name, MPI_INFO_NULL))
+            if (MPI_File_set_view(fh, fileoff, mpi_fp_type, subyzslice, name, MPI_INFO_NULL))
                 ++nerror;
 
         // only write at the procs that contain the slice
         if (!nerror)
-            if (MPI_File_write_all(fh, tmp, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
+            if (MPI_File_write_all(fh, tmp, count, mpi_fp_type, MPI_STATUS_IGNORE))
                 ++nerror;
 
         if (!nerror)
@@ -977,28 +1476,13 @@ int Grid::save_yz_slice(double* restrict data, double* restrict tmp, char* filen
     return nerror;
 }
 
-int Grid::save_xy_slice(double* restrict data, double* restrict tmp, char* filename, int kslice)
+int Grid::save_xy_slice(real* restrict data, real* restrict tmp, char* filename, int kslice, Error_bound* bound)
 {
     // extract the data from the 3d field without the ghost cells
-    const int jj  = icells;
-    const int kk  = icells*jcells;
-    const int jjb = imax;
-
-    // Subtract the ghost cells in case of a pure 2d plane that does not have ghost cells.
-    if (kslice == -1)
-        kslice = -kgc;
-
     int count = imax*jmax;
 
-    for (int j=0; j<jmax; j++)
-#pragma ivdep
-        for (int i=0; i<imax; i++)
-        {
-            // take the modulus of jslice and jmax to have the right offset within proc
-            const int ijk  = i+igc + (j+jgc)*jj + (kslice+kgc)*kk;
-            const int ijkb = i + j*jjb;
-            tmp[ijkb] = data[ijk];
-        }
+    stage_xy_slice(tmp, data, kslice);
+    round_slice(tmp, count, true, bound);
 
     MPI_File fh;
     if (MPI_File_open(master->commxy, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY | MPI_MODE_EXCL, MPI_INFO_NULL, &fh))
@@ -1008,11 +1492,11 @@ int Grid::save_xy_slice(double* restrict data, double* restrict tmp, char* filen
     MPI_Offset fileoff = 0; // the offset within the file (header size)
     char name[] = "native";
 
-    if (MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subxyslice, name, MPI_INFO_NULL))
+    if (MPI_File_set_view(fh, fileoff, mpi_fp_type, subxyslice, name, MPI_INFO_NULL))
         return 1;
 
     // only write at the procs that contain the slice
-    if (MPI_File_write_all(fh, tmp, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
+    if (MPI_File_write_all(fh, tmp, count, mpi_fp_type, MPI_STATUS_IGNORE))
         return 1;
 
     MPI_File_sync(fh);
@@ -1025,7 +1509,33 @@ int Grid::save_xy_slice(double* restrict data, double* restrict tmp, char* filen
     return 0;
 }
 
-int Grid::load_xy_slice(double* restrict data, double* restrict tmp, char* filename, int kslice)
+void Grid::create_netcdf_file(char* filename, int* ncid)
+{
+    // all processes open the file, to write the fields in parallel with collective HDF5 I/O
+    nc_check(nc_create_par(filename, NC_NETCDF4 | NC_MPIIO | NC_NOCLOBBER, master->commxy, MPI_INFO_NULL, ncid), filename);
+}
+
+void Grid::set_netcdf_collective(int ncid, int varid, char* filename)
+{
+    nc_check(nc_var_par_access(ncid, varid, NC_COLLECTIVE), filename);
+}
+
+bool Grid::has_netcdf_deflate()
+{
+    // parallel writes of deflated variables need NetCDF 4.7.4 or newer built on HDF5 1.10.3 or newer,
+    // which CMake detects at build time (NETCDF_PAR_DEFLATE), the version of the linked library is
+    // checked as well, because an older shared library fails at the first collective write
+    #ifdef NETCDF_PAR_DEFLATE
+    int major = 0, minor = 0, patch = 0;
+    if (std::sscanf(nc_inq_libvers(), "%d.%d.%d", &major, &minor, &patch) < 2)
+        return false;
+    return major > 4 || (major == 4 && (minor > 7 || (minor == 7 && patch >= 4)));
+    #else
+    return false;
+    #endif
+}
+
+int Grid::load_xy_slice(real* restrict data, real* restrict tmp, char* filename, int kslice)
 {
     // extract the data from the 3d field without the ghost cells
     const int jj  = icells;
@@ -1046,11 +1556,11 @@ int Grid::load_xy_slice(double* restrict data, double* restrict tmp, char* filen
     MPI_Offset fileoff = 0; // the offset within the file (header size)
     char name[] = "native";
 
-    if (MPI_File_set_view(fh, fileoff, MPI_DOUBLE, subxyslice, name, MPI_INFO_NULL))
+    if (MPI_File_set_view(fh, fileoff, mpi_fp_type, subxyslice, name, MPI_INFO_NULL))
         return 1;
 
     // only write at the procs that contain the slice
-    if (MPI_File_read_all(fh, tmp, count, MPI_DOUBLE, MPI_STATUS_IGNORE))
+    if (MPI_File_read_all(fh, tmp, count, mpi_fp_type, MPI_STATUS_IGNORE))
         return 1;
 
     if (MPI_File_close(&fh))
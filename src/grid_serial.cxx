@@ -23,8 +23,12 @@
 #ifndef USEMPI
 #include <fftw3.h>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <netcdf.h>
 #include "master.h"
 #include "grid.h"
+#include "profiler.h"
 #include "defines.h"
 
 // MPI functions
@@ -37,8 +41,10 @@ void Grid::exit_mpi()
 {
 }
 
-void Grid::boundary_cyclic(double* restrict data, Edge edge)
+void Grid::boundary_cyclic(real* restrict data, Edge edge)
 {
+    profiler->start("boundary_cyclic");
+
     const int jj = icells;
     const int kk = icells*jcells;
 
@@ -108,10 +114,14 @@ void Grid::boundary_cyclic(double* restrict data, Edge edge)
                     }
         }
     }
+
+    profiler->stop("boundary_cyclic");
 }
 
-void Grid::boundary_cyclic_2d(double* restrict data)
+void Grid::boundary_cyclic_2d(real* restrict data)
 {
+    profiler->start("boundary_cyclic");
+
     const int jj = icells;
 
     // first, east west boundaries
@@ -169,9 +179,11 @@ void Grid::boundary_cyclic_2d(double* restrict data)
                 data[ijsouth] = data[ijref];
             }
     }
+
+    profiler->stop("boundary_cyclic");
 }
 
-void Grid::transpose_zx(double* restrict ar, double* restrict as)
+void Grid::transpose_zx(real* restrict ar, real* restrict as)
 {
     const int jj = imax;
     const int kk = imax*jmax;
@@ -186,7 +198,7 @@ void Grid::transpose_zx(double* restrict ar, double* restrict as)
             }
 }
 
-void Grid::transpose_xz(double* restrict ar, double* restrict as)
+void Grid::transpose_xz(real* restrict ar, real* restrict as)
 {
     const int jj = imax;
     const int kk = imax*jmax;
@@ -201,7 +213,7 @@ void Grid::transpose_xz(double* restrict ar, double* restrict as)
             }
 }
 
-void Grid::transpose_xy(double* restrict ar, double* restrict as)
+void Grid::transpose_xy(real* restrict ar, real* restrict as)
 {
     const int jj = imax;
     const int kk = imax*jmax;
@@ -216,7 +228,7 @@ void Grid::transpose_xy(double* restrict ar, double* restrict as)
             }
 }
 
-void Grid::transpose_yx(double* restrict ar, double* restrict as)
+void Grid::transpose_yx(real* restrict ar, real* restrict as)
 {
     const int jj = imax;
     const int kk = imax*jmax;
@@ -231,7 +243,7 @@ void Grid::transpose_yx(double* restrict ar, double* restrict as)
             }
 }
 
-void Grid::transpose_yz(double* restrict ar, double* restrict as)
+void Grid::transpose_yz(real* restrict ar, real* restrict as)
 {
     const int jj = imax;
     const int kk = imax*jmax;
@@ -246,7 +258,7 @@ void Grid::transpose_yz(double* restrict ar, double* restrict as)
             }
 }
 
-void Grid::transpose_zy(double* restrict ar, double* restrict as)
+void Grid::transpose_zy(real* restrict ar, real* restrict as)
 {
     const int jj = imax;
     const int kk = imax*jmax;
@@ -295,35 +307,24 @@ void Grid::save()
     else
         master->print_message("OK\n");
 
-    fwrite(&x [istart], sizeof(double), itot, pFile);
-    fwrite(&xh[istart], sizeof(double), itot, pFile);
-    fwrite(&y [jstart], sizeof(double), jtot, pFile);
-    fwrite(&yh[jstart], sizeof(double), jtot, pFile);
-    fwrite(&z [kstart], sizeof(double), ktot, pFile);
-    fwrite(&zh[kstart], sizeof(double), ktot, pFile);
+    // the grid is always stored in double precision, independent of the precision of the model
+    const std::vector<double> xd (&x [istart], &x [istart]+itot);
+    const std::vector<double> xhd(&xh[istart], &xh[istart]+itot);
+    const std::vector<double> yd (&y [jstart], &y [jstart]+jtot);
+    const std::vector<double> yhd(&yh[jstart], &yh[jstart]+jtot);
+    const std::vector<double> zd (&z [kstart], &z [kstart]+ktot);
+    const std::vector<double> zhd(&zh[kstart], &zh[kstart]+ktot);
+
+    fwrite(&xd [0], sizeof(double), itot, pFile);
+    fwrite(&xhd[0], sizeof(double), itot, pFile);
+    fwrite(&yd [0], sizeof(double), jtot, pFile);
+    fwrite(&yhd[0], sizeof(double), jtot, pFile);
+    fwrite(&zd [0], sizeof(double), ktot, pFile);
+    fwrite(&zhd[0], sizeof(double), ktot, pFile);
     fclose(pFile);
 
     // SAVE THE FFTW PLAN IN ORDER TO ENSURE BITWISE IDENTICAL RESTARTS
-    // use the FFTW3 many interface in order to reduce function call overhead
-    int rank = 1;
-    int ni[] = {itot};
-    int nj[] = {jtot};
-    int istride = 1;
-    int jstride = iblock;
-    int idist = itot;
-    int jdist = 1;
-    fftw_r2r_kind kindf[] = {FFTW_R2HC};
-    fftw_r2r_kind kindb[] = {FFTW_HC2R};
-    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindf, FFTW_EXHAUSTIVE);
-    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-                                fftouti, ni, istride, idist, kindb, FFTW_EXHAUSTIVE);
-    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindf, FFTW_EXHAUSTIVE);
-    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-                                fftoutj, nj, jstride, jdist, kindb, FFTW_EXHAUSTIVE);
-
-    fftwplan = true;
+    create_fftw_plans();
 
     if (master->mpiid == 0)
     {
@@ -332,7 +333,7 @@ void Grid::save()
 
         master->print_message("Saving \"%s\" ... ", filename);
 
-        int n = fftw_export_wisdom_to_filename(filename);
+        int n = FFTW(export_wisdom_to_filename)(filename);
         if (n == 0)
         {
             master->print_message("FAILED\n");
@@ -360,14 +361,23 @@ void Grid::load()
     else
         master->print_message("OK\n");
 
-    fread(&x [istart], sizeof(double), itot, pFile);
-    fread(&xh[istart], sizeof(double), itot, pFile);
-    fread(&y [jstart], sizeof(double), jtot, pFile);
-    fread(&yh[jstart], sizeof(double), jtot, pFile);
-    fread(&z [kstart], sizeof(double), ktot, pFile);
-    fread(&zh[kstart], sizeof(double), ktot, pFile);
+    // the grid is stored in double precision
+    std::vector<double> xd(itot), xhd(itot), yd(jtot), yhd(jtot), zd(ktot), zhd(ktot);
+    fread(&xd [0], sizeof(double), itot, pFile);
+    fread(&xhd[0], sizeof(double), itot, pFile);
+    fread(&yd [0], sizeof(double), jtot, pFile);
+    fread(&yhd[0], sizeof(double), jtot, pFile);
+    fread(&zd [0], sizeof(double), ktot, pFile);
+    fread(&zhd[0], sizeof(double), ktot, pFile);
     fclose(pFile);
 
+    std::copy(xd .begin(), xd .end(), &x [istart]);
+    std::copy(xhd.begin(), xhd.end(), &xh[istart]);
+    std::copy(yd .begin(), yd .end(), &y [jstart]);
+    std::copy(yhd.begin(), yhd.end(), &yh[jstart]);
+    std::copy(zd .begin(), zd .end(), &z [kstart]);
+    std::copy(zhd.begin(), zhd.end(), &zh[kstart]);
+
     // calculate the missing coordinates
     calculate();
 
@@ -376,7 +386,7 @@ void Grid::load()
 
     master->print_message("Loading \"%s\" ... ", filename);
 
-    int n = fftw_import_wisdom_from_filename(filename);
+    int n = FFTW(import_wisdom_from_filename)(filename);
     if (n == 0)
     {
         master->print_message("FAILED\n");
@@ -385,32 +395,36 @@ void Grid::load()
     else
         master->print_message("OK\n");
 
-    // use the FFTW3 many interface in order to reduce function call overhead
-    int rank = 1;
-    int ni[] = {itot};
-    int nj[] = {jtot};
-    int istride = 1;
-    int jstride = iblock;
-    int idist = itot;
-    int jdist = 1;
-    fftw_r2r_kind kindf[] = {FFTW_R2HC};
-    fftw_r2r_kind kindb[] = {FFTW_HC2R};
-    iplanf = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-            fftouti, ni, istride, idist, kindf, FFTW_EXHAUSTIVE);
-    iplanb = fftw_plan_many_r2r(rank, ni, jmax, fftini, ni, istride, idist,
-            fftouti, ni, istride, idist, kindb, FFTW_EXHAUSTIVE);
-    jplanf = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-            fftoutj, nj, jstride, jdist, kindf, FFTW_EXHAUSTIVE);
-    jplanb = fftw_plan_many_r2r(rank, nj, iblock, fftinj, nj, jstride, jdist,
-            fftoutj, nj, jstride, jdist, kindb, FFTW_EXHAUSTIVE);
-
-    fftwplan = true;
+    create_fftw_plans();
 
-    fftw_forget_wisdom();
+    FFTW(forget_wisdom)();
 }
 
-int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+int Grid::save_field3d(real* restrict data, real* restrict tmp1, real* restrict tmp2, char* filename, double offset,
+                       bool compress, Error_bound* bound)
 {
+    const bool lossy = (bound && bound->type != "0");
+
+    if (compress || lossy)
+    {
+        stage_field3d(tmp2, data, tmp1, offset);
+
+        if (lossy)
+            bound->maxerror = round_field(tmp2, imax*jmax*kmax, *bound);
+
+        if (compress)
+            return save_field3d_compressed(tmp2, filename);
+
+        FILE *pFile = create_field3d_file(filename);
+        if (pFile == NULL)
+            return 1;
+
+        const int nerror = write_field3d_file(pFile, tmp2, 0);
+        fclose(pFile);
+
+        return nerror;
+    }
+
     FILE *pFile;
     pFile = fopen(filename, "wbx");
 
@@ -434,7 +448,7 @@ int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* res
         for (int j=jstart; j<jend; j++)
         {
             const int ijk = istart + j*jj + k*kk;
-            fwrite(&tmp1[ijk], sizeof(double), imax, pFile);
+            fwrite(&tmp1[ijk], sizeof(real), imax, pFile);
         }
 
     fclose(pFile);
@@ -442,8 +456,172 @@ int Grid::save_field3d(double* restrict data, double* restrict tmp1, double* res
     return 0;
 }
 
-int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* restrict tmp2, char* filename, double offset)
+void Grid::stage_field3d(real* restrict staging, real* restrict data, real* restrict tmp1, double offset)
+{
+    // extract the data from the 3d field without the ghost cells
+    const int jj  = icells;
+    const int kk  = icells*jcells;
+    const int jjb = imax;
+    const int kkb = imax*jmax;
+
+    for (int k=0; k<kmax; k++)
+        for (int j=0; j<jmax; j++)
+#pragma ivdep
+            for (int i=0; i<imax; i++)
+            {
+                const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                const int ijkb = i + j*jjb + k*kkb;
+                staging[ijkb] = data[ijk] + offset;
+            }
+}
+
+FILE* Grid::create_field3d_file(char* filename)
+{
+    return fopen(filename, "wbx");
+}
+
+int Grid::write_field3d_file(FILE* pFile, real* restrict staging, long offset)
+{
+    int nerror = 0;
+    const size_t count = imax*jmax*kmax;
+
+    if (fseek(pFile, offset, SEEK_SET))
+        ++nerror;
+    else if (fwrite(staging, sizeof(real), count, pFile) != count)
+        ++nerror;
+
+    return nerror;
+}
+
+unsigned long Grid::calc_checksum(const real* restrict staging)
+{
+    // weigh every value with its position in the file to detect swapped or shifted data
+    unsigned long checksum = 0;
+    const unsigned long count = imax*jmax*kmax;
+
+    for (unsigned long n=0; n<count; n++)
+    {
+        unsigned long bits = 0;
+        std::memcpy(&bits, &staging[n], sizeof(real));
+        checksum += (bits + 1) * (2*n + 1);
+    }
+
+    return checksum;
+}
+
+int Grid::save_restart(char* filename, Restart_header& header, const std::vector<real*>& data,
+                       real* restrict tmp1, real* restrict tmp2)
+{
+    FILE* pFile = fopen(filename, "wbx");
+    if (pFile == NULL)
+        return 1;
+
+    const int nfields = data.size();
+    int nerror = 0;
+    header.checksums.resize(nfields);
+
+    // write the fields as contiguous blocks after the header
+    for (int n=0; n<nfields; ++n)
+    {
+        stage_field3d(tmp2, data[n], tmp1, 0.);
+        header.checksums[n] = calc_checksum(tmp2);
+        nerror += write_field3d_file(pFile, tmp2, get_restart_offset(header, n));
+    }
+
+    // write the header last, as it contains the checksums
+    std::vector<char> buffer = pack_restart_header(header);
+    rewind(pFile);
+    if (fwrite(&buffer[0], 1, buffer.size(), pFile) != buffer.size())
+        ++nerror;
+
+    if (fclose(pFile))
+        ++nerror;
+
+    return nerror;
+}
+
+int Grid::load_restart(char* filename, const Restart_header& header, const std::vector<std::string>& names,
+                       const std::vector<real*>& data, real* restrict tmp1, real* restrict tmp2)
 {
+    FILE* pFile = fopen(filename, "rb");
+    if (pFile == NULL)
+        return 1;
+
+    const size_t count = imax*jmax*kmax;
+    int nerror = 0;
+
+    for (size_t n=0; n<names.size(); ++n)
+    {
+        const int nh = std::find(header.names.begin(), header.names.end(), names[n]) - header.names.begin();
+        if (nh == (int)header.names.size())
+        {
+            master->print_error("field %s is not in \"%s\"\n", names[n].c_str(), filename);
+            ++nerror;
+            break;
+        }
+
+        if (fseek(pFile, get_restart_offset(header, nh), SEEK_SET) || fread(tmp1, sizeof(real), count, pFile) != count)
+        {
+            ++nerror;
+            break;
+        }
+
+        if (calc_checksum(tmp1) != header.checksums[nh])
+        {
+            master->print_error("checksum of field %s in \"%s\" does not match\n", names[n].c_str(), filename);
+            ++nerror;
+        }
+
+        const int jj  = icells;
+        const int kk  = icells*jcells;
+        const int jjb = imax;
+        const int kkb = imax*jmax;
+
+        for (int k=0; k<kmax; k++)
+            for (int j=0; j<jmax; j++)
+#pragma ivdep
+                for (int i=0; i<imax; i++)
+                {
+                    const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                    const int ijkb = i + j*jjb + k*kkb;
+                    data[n][ijk] = tmp1[ijkb];
+                }
+    }
+
+    fclose(pFile);
+
+    return nerror;
+}
+
+int Grid::load_field3d(real* restrict data, real* restrict tmp1, real* restrict tmp2, char* filename, double offset)
+{
+    if (is_compressed_field3d(filename))
+    {
+        if (load_field3d_compressed(tmp2, filename))
+            return 1;
+
+        // remove the offset and put the staged data back in the 3d field
+        const int jj  = icells;
+        const int kk  = icells*jcells;
+        const int jjb = imax;
+        const int kkb = imax*jmax;
+
+        for (int k=0; k<kmax; k++)
+            for (int j=0; j<jmax; j++)
+#pragma ivdep
+                for (int i=0; i<imax; i++)
+                {
+                    const int ijk  = i+igc + (j+jgc)*jj + (k+kgc)*kk;
+                    const int ijkb = i + j*jjb + k*kkb;
+                    data[ijk] = tmp2[ijkb] - offset;
+                }
+
+        return 0;
+    }
+
+    if (check_field3d_size(filename))
+        return 1;
+
     FILE *pFile;
     pFile = fopen(filename, "rb");
 
@@ -458,7 +636,7 @@ int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* res
         for (int j=jstart; j<jend; j++)
         {
             const int ijk = istart + j*jj + k*kk;
-            fread(&tmp1[ijk], sizeof(double), imax, pFile);
+            fread(&tmp1[ijk], sizeof(real), imax, pFile);
         }
 
     fclose(pFile);
@@ -475,211 +653,257 @@ int Grid::load_field3d(double* restrict data, double* restrict tmp1, double* res
     return 0;
 }
 
-void Grid::fft_forward(double* restrict data,   double* restrict tmp1,
-                       double* restrict fftini, double* restrict fftouti,
-                       double* restrict fftinj, double* restrict fftoutj)
+int Grid::save_field3d_compressed(real* restrict staged, char* filename)
 {
-    int kk = itot*jmax;
+    const int nrows = jmax*kmax;
 
-    // process the fourier transforms slice by slice
-    for (int k=0; k<kblock; k++)
+    std::vector<unsigned char> buffer;
+    std::vector<unsigned long> sizes;
+    if (compress_rows(buffer, sizes, staged, nrows))
+        return 1;
+
+    // convert the sizes of the rows into file offsets
+    std::vector<unsigned long> index(nrows+1);
+    unsigned long fileoff = get_compressed_header_size();
+    for (int n=0; n<nrows; ++n)
     {
-#pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftini[ij] = data[ijk];
-        }
+        index[n] = fileoff;
+        fileoff += sizes[n];
+    }
+    index[nrows] = fileoff;
 
-        fftw_execute(iplanf);
+    FILE *pFile;
+    pFile = fopen(filename, "wbx");
 
-#pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            data[ijk] = fftouti[ij];
-        }
-    }
+    if (pFile == NULL)
+        return 1;
 
-    kk = iblock*jtot;
+    int nerror = 0;
+    std::vector<char> header = pack_compressed_header();
+    if (fwrite(&header[0], 1, header.size(), pFile) != header.size())
+        ++nerror;
+    else if (fwrite(&index[0], sizeof(unsigned long), nrows+1, pFile) != (size_t)(nrows+1))
+        ++nerror;
+    else if (fwrite(&buffer[0], 1, buffer.size(), pFile) != buffer.size())
+        ++nerror;
 
-    // do the second fourier transform
-    for (int k=0; k<kblock; k++)
-    {
-#pragma ivdep
-        for (int n=0; n<iblock*jtot; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftinj[ij] = data[ijk];
-        }
+    fclose(pFile);
 
-        fftw_execute(jplanf);
+    return nerror;
+}
 
-#pragma ivdep
-        for (int n=0; n<iblock*jtot; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            // shift to use p in pressure solver
-            data[ijk] = fftoutj[ij];
-        }
+int Grid::load_field3d_compressed(real* restrict staged, char* filename)
+{
+    const int nrows = jmax*kmax;
+
+    FILE *pFile;
+    pFile = fopen(filename, "rb");
+
+    if (pFile == NULL)
+        return 1;
+
+    int nerror = 0;
+    std::vector<char> header(get_compressed_index_offset());
+    std::vector<unsigned long> index(nrows+1);
+    if (fread(&header[0], 1, header.size(), pFile) != header.size())
+        ++nerror;
+    else if (check_compressed_header(header, filename))
+        ++nerror;
+    else if (fread(&index[0], sizeof(unsigned long), nrows+1, pFile) != (size_t)(nrows+1))
+        ++nerror;
+
+    // the rows follow the index, in the order in which they were written
+    const unsigned long headersize = get_compressed_header_size();
+    std::vector<unsigned long> starts(nrows);
+    std::vector<unsigned long> sizes(nrows);
+    std::vector<unsigned char> buffer;
+    if (!nerror)
+    {
+        get_compressed_row_sizes(&index[0], &sizes[0]);
+        for (int n=0; n<nrows; ++n)
+            starts[n] = index[n] - headersize;
+
+        buffer.resize(index[nrows] - headersize);
+        if (fread(&buffer[0], 1, buffer.size(), pFile) != buffer.size())
+            ++nerror;
     }
+
+    fclose(pFile);
+
+    if (!nerror)
+        nerror += decompress_rows(staged, &buffer[0], &starts[0], &sizes[0], nrows);
+
+    return nerror;
 }
 
-void Grid::fft_backward(double* restrict data,   double* restrict tmp1,
-                        double* restrict fftini, double* restrict fftouti,
-                        double* restrict fftinj, double* restrict fftoutj)
+void Grid::create_fftw_plans()
 {
-    int kk = iblock*jtot;
+    const int nchunks = kchunks.size()-1;
 
-    // transform the second transform back
-    for (int k=0; k<kblock; k++)
+    iplanf.resize(nchunks);
+    iplanb.resize(nchunks);
+    jplanf.resize(nchunks);
+    jplanb.resize(nchunks);
+
+    // the plans are made on help arrays of the size of the fields without ghost cells, the fields are
+    // allocated with the same alignment, so the plans can be executed directly on the fields
+    real* in  = FFTW(alloc_real)(itot*jmax*kblock);
+    real* out = FFTW(alloc_real)(itot*jmax*kblock);
+
+    FFTW(r2r_kind) kindf[] = {FFTW_R2HC};
+    FFTW(r2r_kind) kindb[] = {FFTW_HC2R};
+
+    int ni[] = {itot};
+    const int istride = 1;
+    const int idist = itot;
+
+    for (int c=0; c<nchunks; ++c)
     {
-#pragma ivdep
-        for (int n=0; n<iblock*jtot; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftinj[ij] = data[ijk];
-        }
+        const int ijk = kchunks[c]*itot*jmax;
+        const int nk  = kchunks[c+1] - kchunks[c];
+
+        // the x-transforms run over all rows of the chunk, the backward transform
+        // writes into a second array that contains the output of the pressure solver
+        iplanf[c] = FFTW(plan_many_r2r)(1, ni, jmax*nk, &in[ijk], ni, istride, idist,
+                                        &in[ijk], ni, istride, idist, kindf, fftwflags);
+        iplanb[c] = FFTW(plan_many_r2r)(1, ni, jmax*nk, &in[ijk], ni, istride, idist,
+                                        &out[ijk], ni, istride, idist, kindb, fftwflags);
+
+        // the y-transforms are strided, batch them over the x-direction and the levels of the chunk
+        FFTW(iodim) jdims[] = { {jtot, iblock, iblock} };
+        FFTW(iodim) jhowmany[] = { {iblock, 1, 1}, {nk, iblock*jtot, iblock*jtot} };
+        jplanf[c] = FFTW(plan_guru_r2r)(1, jdims, 2, jhowmany, &in[ijk], &in[ijk], kindf, fftwflags);
+        jplanb[c] = FFTW(plan_guru_r2r)(1, jdims, 2, jhowmany, &in[ijk], &in[ijk], kindb, fftwflags);
+    }
 
-        fftw_execute(jplanb);
+    FFTW(free)(in);
+    FFTW(free)(out);
 
-#pragma ivdep
-        for (int n=0; n<iblock*jtot; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            data[ijk] = fftoutj[ij] / jtot;
-        }
+    fftwplan = true;
+}
+
+void Grid::fft_forward(real* restrict data, real* restrict tmp1, bool ztranspose)
+{
+    profiler->start("fft");
+
+    // process the fourier transforms in place, batched over all levels
+    for (unsigned int c=0; c<kchunks.size()-1; ++c)
+    {
+        const int ijk = kchunks[c]*itot*jmax;
+        FFTW(execute_r2r)(iplanf[c], &data[ijk], &data[ijk]);
+    }
+
+    // do the second fourier transform
+    for (unsigned int c=0; c<kchunks.size()-1; ++c)
+    {
+        const int ijk = kchunks[c]*iblock*jtot;
+        FFTW(execute_r2r)(jplanf[c], &data[ijk], &data[ijk]);
     }
 
-    kk = itot*jmax;
+    profiler->stop("fft");
+}
 
-    // transform the first transform back
-    for (int k=0; k<kblock; k++)
+void Grid::fft_backward(real* restrict data, real* restrict tmp1, bool ztranspose)
+{
+    profiler->start("fft");
+
+    // transform the second transform back
+    for (unsigned int c=0; c<kchunks.size()-1; ++c)
     {
-#pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            fftini[ij] = data[ijk];
-        }
+        const int ijk = kchunks[c]*iblock*jtot;
+        FFTW(execute_r2r)(jplanb[c], &data[ijk], &data[ijk]);
+    }
 
-        fftw_execute(iplanb);
+    const int kk = itot*jmax;
+    const double fftnorm = 1./(itot*jtot);
+
+    // transform the first transform back into tmp1 and normalize both transforms at once
+    for (unsigned int c=0; c<kchunks.size()-1; ++c)
+    {
+        const int ijk = kchunks[c]*kk;
+        FFTW(execute_r2r)(iplanb[c], &data[ijk], &tmp1[ijk]);
 
 #pragma ivdep
-        for (int n=0; n<itot*jmax; n++)
-        {
-            const int ij  = n;
-            const int ijk = n + k*kk;
-            // swap array here to avoid unnecessary 3d loop
-            tmp1[ijk] = fftouti[ij] / itot;
-        }
+        for (int n=kchunks[c]*kk; n<kchunks[c+1]*kk; n++)
+            tmp1[n] *= fftnorm;
     }
+
+    profiler->stop("fft");
 }
 
-int Grid::save_xz_slice(double* restrict data, double* restrict tmp, char* filename, int jslice)
+int Grid::save_xz_slice(real* restrict data, real* restrict tmp, char* filename, int jslice, Error_bound* bound)
 {
     // extract the data from the 3d field without the ghost cells
-    const int jj  = icells;
-    const int kk  = icells*jcells;
-    const int kkb = imax;
-
     const int count = imax*kmax;
 
-    for (int k=0; k<kmax; k++)
-#pragma ivdep
-        for (int i=0; i<imax; i++)
-        {
-            // take the modulus of jslice and jmax to have the right offset within proc
-            const int ijk  = i+igc + (jslice+jgc)*jj + (k+kgc)*kk;
-            const int ijkb = i + k*kkb;
-            tmp[ijkb] = data[ijk];
-        }
+    stage_xz_slice(tmp, data, jslice);
+    round_slice(tmp, count, true, bound);
 
     FILE *pFile;
     pFile = fopen(filename, "wbx");
     if (pFile == NULL)
         return 1;
 
-    fwrite(tmp, sizeof(double), count, pFile);
+    fwrite(tmp, sizeof(real), count, pFile);
     fclose(pFile);
 
     return 0;
 }
 
-int Grid::save_yz_slice(double* restrict data, double* restrict tmp, char* filename, int islice)
+int Grid::save_yz_slice(real* restrict data, real* restrict tmp, char* filename, int islice, Error_bound* bound)
 {
-    // Extract the data from the 3d field without the ghost cells
-    const int jj = icells;
-    const int kk = ijcells;
-
-    const int kkb = jmax;
-
-    int count = jmax*kmax;
+    // extract the data from the 3d field without the ghost cells
+    const int count = jmax*kmax;
 
-    // Strip off the ghost cells
-    for (int k=0; k<kmax; k++)
-        #pragma ivdep
-        for (int j=0; j<jmax; j++)
-        {
-            // take the modulus of jslice and jmax to have the right offset within proc
-            const int ijk  = (islice%imax)+igc + (j+jgc)*jj + (k+kgc)*kk;
-            const int ijkb = j + k*kkb;
-            tmp[ijkb] = data[ijk];
-        }
+    stage_yz_slice(tmp, data, islice);
+    round_slice(tmp, count, true, bound);
 
     FILE *pFile;
     pFile = fopen(filename, "wbx");
     if (pFile == NULL)
         return 1;
 
-    fwrite(tmp, sizeof(double), count, pFile);
+    fwrite(tmp, sizeof(real), count, pFile);
     fclose(pFile);
 
     return 0;
 }
 
-int Grid::save_xy_slice(double* restrict data, double* restrict tmp, char* filename, int kslice)
+int Grid::save_xy_slice(real* restrict data, real* restrict tmp, char* filename, int kslice, Error_bound* bound)
 {
     // extract the data from the 3d field without the ghost cells
-    const int jj  = icells;
-    const int kk  = icells*jcells;
-    const int jjb = imax;
-
     const int count = imax*jmax;
 
-    // Subtract the ghost cells in case of a pure 2d plane that does not have ghost cells.
-    if (kslice == -1)
-        kslice = -kgc;
-
-    for (int j=0; j<jmax; j++)
-#pragma ivdep
-        for (int i=0; i<imax; i++)
-        {
-            // take the modulus of jslice and jmax to have the right offset within proc
-            const int ijk  = i+igc + (j+jgc)*jj + (kslice+kgc)*kk;
-            const int ijkb = i + j*jjb;
-            tmp[ijkb] = data[ijk];
-        }
+    stage_xy_slice(tmp, data, kslice);
+    round_slice(tmp, count, true, bound);
 
     FILE *pFile;
     pFile = fopen(filename, "wbx");
     if (pFile == NULL)
         return 1;
 
-    fwrite(tmp, sizeof(double), count, pFile);
+    fwrite(tmp, sizeof(real), count, pFile);
     fclose(pFile);
 
     return 0;
 }
 
-int Grid::load_xy_slice(double* restrict data, double* restrict tmp, char* filename, int kslice)
+void Grid::create_netcdf_file(char* filename, int* ncid)
+{
+    nc_check(nc_create(filename, NC_NETCDF4 | NC_NOCLOBBER, ncid), filename);
+}
+
+void Grid::set_netcdf_collective(int ncid, int varid, char* filename)
+{
+}
+
+bool Grid::has_netcdf_deflate()
+{
+    // every NetCDF-4 library deflates the variables of a file that is written by a single process
+    return true;
+}
+
+int Grid::load_xy_slice(real* restrict data, real* restrict tmp, char* filename, int kslice)
 {
     const int count = imax*jmax;
 
@@ -688,7 +912,7 @@ int Grid::load_xy_slice(double* restrict data, double* restrict tmp, char* filen
     if (pFile == NULL)
         return 1;
 
-    fread(tmp, sizeof(double), count, pFile);
+    fread(tmp, sizeof(real), count, pFile);
     fclose(pFile);
 
     // Subtract the ghost cells in case of a pure 2d plane that does not have ghost cells.
@@ -33,10 +33,14 @@
 #include <sstream>
 
 // Public functions
-Input::Input(Master* masterin)
+Input::Input(Master* masterin, bool readfiles)
 {
     master = masterin;
 
+    // Leave the input empty in case it is filled with set_item and set_prof.
+    if (!readfiles)
+        return;
+
     const bool required = false;
     const bool optional = true;
 
@@ -59,6 +63,21 @@ void Input::clear()
     proflist.clear();
 }
 
+void Input::set_item(std::string cat, std::string item, std::string el, std::string value)
+{
+    if (el.empty())
+        el = "default";
+
+    // Items that are set multiple times are overwritten.
+    inputlist[cat][item][el].data   = value;
+    inputlist[cat][item][el].isused = false;
+}
+
+void Input::set_prof(std::string varname, const std::vector<double>& prof)
+{
+    proflist[varname] = prof;
+}
+
 // Private functions
 int Input::read_ini_file()
 {
@@ -878,7 +897,7 @@ int Input::check_list(std::vector<double>* value, std::string cat, std::string i
     return 0;
 }
 
-int Input::get_prof(double* data, std::string varname, int kmaxin)
+int Input::get_prof(real* data, std::string varname, int kmaxin)
 {
     Data_map::const_iterator it = proflist.find(varname);
 
@@ -906,7 +925,7 @@ int Input::get_prof(double* data, std::string varname, int kmaxin)
     return 0;
 }
 
-int Input::get_time(double** data, std::vector<double>* time, std::string varname)
+int Input::get_time(real** data, std::vector<double>* time, std::string varname)
 {
     // first get the time list
     Data_map::const_iterator it = timelist.find("t");
@@ -929,7 +948,7 @@ int Input::get_time(double** data, std::vector<double>* time, std::string varnam
             return 1;
         }
         // allocate the data
-        *data = new double[timesize];
+        *data = new real[timesize];
         for (unsigned int n=0; n<timesize; ++n)
             (*data)[n] = (it->second)[n];
     }
@@ -942,7 +961,7 @@ int Input::get_time(double** data, std::vector<double>* time, std::string varnam
     return 0;
 }
 
-int Input::get_time_prof(double** timeprof, std::vector<double>* timelist, std::string varname, int kmaxin)
+int Input::get_time_prof(real** timeprof, std::vector<double>* timelist, std::string varname, int kmaxin)
 {
     // container for the raw data
     Data_map rawdata;
@@ -959,7 +978,7 @@ int Input::get_time_prof(double** timeprof, std::vector<double>* timelist, std::
     rawdata.erase("z");
 
     // allocate the 2d array containing the profiles
-    *timeprof = new double[rawdata.size()*kmaxin];
+    *timeprof = new real[rawdata.size()*kmaxin];
 
     // first process the headers in order to get the time series
     int timecount = 0;
@@ -22,6 +22,9 @@
 
 #include <cstdarg>
 #include <cstdio>
+#ifdef USEOPENMP
+#include <omp.h>
+#endif
 #include "master.h"
 
 void Master::print_message(const char *format, ...)
@@ -77,3 +80,26 @@ bool Master::at_wall_clock_limit()
     else
         return false;
 }
+
+void Master::init_threads(Input* inputin)
+{
+    if (inputin->get_item(&nthreads, "master", "nthreads", "", 1))
+        throw 1;
+
+    if (nthreads < 1)
+    {
+        print_error("nthreads = %d has to be at least 1\n", nthreads);
+        throw 1;
+    }
+
+#ifdef USEOPENMP
+    omp_set_num_threads(nthreads);
+    print_message("Using %d threads per process\n", nthreads);
+#else
+    if (nthreads > 1)
+    {
+        print_warning("nthreads = %d is ignored, code is compiled without OpenMP\n", nthreads);
+        nthreads = 1;
+    }
+#endif
+}
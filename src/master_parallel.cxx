@@ -54,10 +54,17 @@ Master::~Master()
 
 void Master::start(int argc, char *argv[])
 {
-    // initialize the MPI
+    // initialize the MPI, only the master thread communicates in threaded runs
+#ifdef USEOPENMP
+    int provided;
+    int n = MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &provided);
+    if (check_error(n))
+        throw 1;
+#else
     int n = MPI_Init(NULL, NULL);
     if (check_error(n))
         throw 1;
+#endif
 
     wall_clock_start = get_wall_clock_time();
 
@@ -116,6 +123,8 @@ void Master::init(Input *inputin)
     if (nerror)
         throw 1;
 
+    init_threads(inputin);
+
     wall_clock_end = wall_clock_start + 3600.*wall_clock_limit;
 
     if (nprocs != npx*npy)
@@ -248,6 +257,11 @@ void Master::sum(double *var, int datasize)
     MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_DOUBLE, MPI_SUM, commxy);
 }
 
+void Master::sum(unsigned long *var, int datasize)
+{
+    MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_UNSIGNED_LONG, MPI_SUM, commxy);
+}
+
 void Master::max(double *var, int datasize)
 {
     MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_DOUBLE, MPI_MAX, commxy);
@@ -257,4 +271,26 @@ void Master::min(double *var, int datasize)
 {
     MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_DOUBLE, MPI_MIN, commxy);
 }
+
+void Master::allgather_x(real *sendbuf, real *recvbuf, int datasize)
+{
+    MPI_Allgather(sendbuf, datasize, mpi_fp_type, recvbuf, datasize, mpi_fp_type, commx);
+}
+
+#ifdef FLOAT_SINGLE
+void Master::broadcast(float *data, int datasize)
+{
+    MPI_Bcast(data, datasize, MPI_FLOAT, 0, commxy);
+}
+
+void Master::max(float *var, int datasize)
+{
+    MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_FLOAT, MPI_MAX, commxy);
+}
+
+void Master::min(float *var, int datasize)
+{
+    MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_FLOAT, MPI_MIN, commxy);
+}
+#endif
 #endif
@@ -87,6 +87,8 @@ void Master::init(Input *inputin)
     if (nerror)
         throw 1;
 
+    init_threads(inputin);
+
     wall_clock_end = wall_clock_start + 3600.*wall_clock_limit;
 
     if (nprocs != npx*npy)
@@ -139,6 +141,10 @@ void Master::sum(double *var, int datasize)
 {
 }
 
+void Master::sum(unsigned long *var, int datasize)
+{
+}
+
 void Master::max(double *var, int datasize)
 {
 }
@@ -146,4 +152,24 @@ void Master::max(double *var, int datasize)
 void Master::min(double *var, int datasize)
 {
 }
+
+void Master::allgather_x(real *sendbuf, real *recvbuf, int datasize)
+{
+    for (int n=0; n<datasize; ++n)
+        recvbuf[n] = sendbuf[n];
+}
+
+#ifdef FLOAT_SINGLE
+void Master::broadcast(float *data, int datasize)
+{
+}
+
+void Master::max(float *var, int datasize)
+{
+}
+
+void Master::min(float *var, int datasize)
+{
+}
+#endif
 #endif
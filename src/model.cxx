@@ -40,6 +40,7 @@
 #include "cross.h"
 #include "dump.h"
 #include "budget.h"
+#include "profiler.h"
 
 #ifdef USECUDA
 #include <cuda_runtime_api.h>
@@ -66,8 +67,13 @@ Model::Model(Master *masterin, Input *inputin)
     dump   = 0;
     budget = 0;
 
+    profiler = 0;
+
     try
     {
+        // Create the profiler first, as the other classes time their components.
+        profiler = new Profiler(this, input);
+
         // Create an instance of the Grid class.
         grid = new Grid(this, input);
 
@@ -144,6 +150,8 @@ void Model::delete_objects()
     delete boundary;
     delete fields;
     delete grid;
+
+    delete profiler;
 }
 
 // In the destructor the deletion of all class instances is triggered.
@@ -210,10 +218,9 @@ void Model::save()
     grid  ->create(input);
     fields->create(input);
 
-    // Save the initialized data to disk for the run mode.
-    grid    ->save();
-    fields  ->save(timeloop->get_iotime());
-    timeloop->save(timeloop->get_iotime());
+    // Save the initialized data to disk for the run mode, the fields write the time file once they are on disk.
+    grid  ->save();
+    fields->save(timeloop->get_iotime());
 }
 
 void Model::exec()
@@ -259,26 +266,44 @@ void Model::exec()
         // Determine the time step.
         set_time_step();
 
+        // Time the stencil kernels in case the tile shapes are autotuned.
+        grid->start_tile_timer();
+
         // Calculate the advection tendency.
+        profiler->start("advec");
         boundary->set_ghost_cells_w(Boundary::Conservation_type);
         advec->exec();
         boundary->set_ghost_cells_w(Boundary::Normal_type);
+        profiler->stop("advec");
 
         // Calculate the diffusion tendency.
+        profiler->start("diff");
         diff->exec();
+        profiler->stop("diff");
+
+        grid->stop_tile_timer();
 
         // Calculate the thermodynamics and the buoyancy tendency.
+        profiler->start("thermo");
         thermo->exec();
+        profiler->stop("thermo");
+
         // Calculate the tendency due to damping in the buffer layer.
+        profiler->start("buffer");
         buffer->exec();
+        profiler->stop("buffer");
 
         // Apply the large scale forcings. Keep this one always right before the pressure.
+        profiler->start("force");
         force->exec(timeloop->get_sub_time_step());
+        profiler->stop("force");
 
         // Solve the poisson equation for pressure.
+        profiler->start("pres");
         boundary->set_ghost_cells_w(Boundary::Conservation_type);
         pres->exec(timeloop->get_sub_time_step());
         boundary->set_ghost_cells_w(Boundary::Normal_type);
+        profiler->stop("pres");
 
         // Allow only for statistics when not in substep and not directly after restart.
         if (timeloop->is_stats_step())
@@ -295,47 +320,33 @@ void Model::exec()
             // Do the statistics.
             if (stats->doStats())
             {
-                // Always process the default mask (the full field)
-                stats->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks["default"]);
-                calc_stats("default");
-
-                // Work through the potential masks for the statistics.
-                for (std::vector<std::string>::const_iterator it=masklist.begin(); it!=masklist.end(); ++it)
-                {
-                    if (*it == "wplus" || *it == "wmin")
-                    {
-                        fields->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[*it]);
-                        calc_stats(*it);
-                    }
-                    else if (*it == "ql" || *it == "qlcore")
-                    {
-                        thermo->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[*it]);
-                        calc_stats(*it);
-                    }
-                    else if (*it == "patch_high" || *it == "patch_low")
-                    {
-                        boundary->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[*it]);
-                        calc_stats(*it);
-                    }
-                }
+                profiler->start("stats");
+
+                calc_stats();
 
                 // Store the stats data.
                 stats->exec(timeloop->get_iteration(), timeloop->get_time(), timeloop->get_itime());
+
+                profiler->stop("stats");
             }
 
             // Save the selected cross sections to disk, cross sections are handled on CPU.
             if (cross->do_cross())
             {
+                profiler->start("cross");
                 fields  ->exec_cross();
                 thermo  ->exec_cross();
                 boundary->exec_cross();
+                profiler->stop("cross");
             }
 
             // Save the 3d dumps to disk
             if (dump->do_dump())
             {
+                profiler->start("dump");
                 fields->exec_dump();
                 thermo->exec_dump();
+                profiler->stop("dump");
             }
         }
 
@@ -347,7 +358,9 @@ void Model::exec()
         if (master->mode == "run")
         {
             // Integrate in time.
+            profiler->start("timeloop");
             timeloop->exec();
+            profiler->stop("timeloop");
 
             // Increase the time with the time step.
             timeloop->step_time();
@@ -355,14 +368,21 @@ void Model::exec()
             // Save the data for restarts.
             if (timeloop->do_save())
             {
+                profiler->start("save");
+
                 #ifdef USECUDA
                 fields  ->backward_device();
                 boundary->backward_device();
                 #endif
 
-                // Save data to disk.
-                timeloop->save(timeloop->get_iotime());
-                fields  ->save(timeloop->get_iotime());
+                // Save data to disk, the fields write the time file once they are on disk.
+                fields->save(timeloop->get_iotime());
+
+                // Write the buffered statistics and cross-sections, such that they are complete up to the restart.
+                stats->flush();
+                cross->flush();
+
+                profiler->stop("save");
             }
         }
 
@@ -386,19 +406,33 @@ void Model::exec()
         force   ->update_time_dependent();
 
         // Set the boundary conditions.
+        profiler->start("boundary");
         boundary->exec();
+        profiler->stop("boundary");
 
         // Calculate the field means, in case needed.
         fields->exec();
 
         // Get the viscosity to be used in diffusion.
+        profiler->start("viscosity");
         diff->exec_viscosity();
+        profiler->stop("viscosity");
 
         // Write status information to disk.
         print_status();
 
     } // End time loop.
 
+    // Complete the restart files that are still being written in the background.
+    fields->wait_save();
+
+    // Write the statistics and cross-sections that are still buffered.
+    stats->flush();
+    cross->flush();
+
+    // Write the timings of the model components.
+    profiler->save(timeloop->get_iteration(), timeloop->get_time());
+
     #ifdef USECUDA
     // At the end of the run, copy the data back from the GPU.
     fields  ->backward_device();
@@ -425,13 +459,54 @@ void Model::set_time_step()
     timeloop->set_time_step();
 }
 
-// Calculate the statistics for all classes that have a statistics function.
-void Model::calc_stats(std::string maskname)
+// Compute the mask with the given name into tmp3 and tmp4, returns false for an unknown mask.
+bool Model::get_mask(std::string maskname)
 {
-    fields  ->exec_stats(&stats->masks[maskname]);
-    thermo  ->exec_stats(&stats->masks[maskname]);
-    budget  ->exec_stats(&stats->masks[maskname]);
-    boundary->exec_stats(&stats->masks[maskname]);
+    if (maskname == "wplus" || maskname == "wmin")
+        fields->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[maskname]);
+    else if (maskname == "ql" || maskname == "qlcore")
+        thermo->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[maskname]);
+    else if (maskname == "patch_high" || maskname == "patch_low")
+        boundary->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[maskname]);
+    else
+        return false;
+
+    return true;
+}
+
+// Calculate the statistics for all classes that have a statistics function. The masks are stored
+// as bits per grid point, such that the fields statistics can accumulate all masks in one sweep. The
+// other classes process the masks one by one, as they are restored from the bits.
+void Model::calc_stats()
+{
+    stats->clear_masks();
+
+    // Always process the default mask (the full field)
+    stats->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks["default"]);
+    stats->store_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks["default"]);
+
+    // Work through the potential masks for the statistics.
+    for (std::vector<std::string>::const_iterator it=masklist.begin(); it!=masklist.end(); ++it)
+    {
+        if (get_mask(*it))
+            stats->store_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[*it]);
+    }
+
+    if (stats->do_multimask())
+    {
+        stats->select_masks(0, stats->get_nmasks());
+        fields->exec_stats();
+    }
+
+    for (int n=0; n<stats->get_nmasks(); ++n)
+    {
+        Mask* m = stats->load_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], n);
+        if (!stats->do_multimask())
+            fields->exec_stats();
+        thermo  ->exec_stats(m);
+        budget  ->exec_stats(m);
+        boundary->exec_stats(m);
+    }
 }
 
 // Print the status information to the .out file.
@@ -485,6 +560,9 @@ void Model::print_status()
         if (master->mpiid == 0)
             std::fprintf(dnsout, "%8d %11.3E %10.4f %11.3E %8.4f %8.4f %11.3E %16.8E %16.8E %16.8E\n",
                     iter, time, cputime, dt, cfl, dn, div, mom, tke, mass);
+
+        // Write the timings of the model components up to now.
+        profiler->exec(iter, time);
     }
 
     if (timeloop->is_finished())
@@ -28,6 +28,7 @@
 #include "grid.h"
 #include "fields.h"
 #include "pres_2.h"
+#include "tdma_functions.h"
 #include "defines.h"
 #include "model.h"
 
@@ -39,6 +40,29 @@ Pres_2::Pres_2(Model* modelin, Input* inputin) : Pres(modelin, inputin)
     bmati  = 0;
     bmatj  = 0;
 
+    work3d_r = 0;
+    tdmasend = 0;
+    tdmarecv = 0;
+
+    int nerror = 0;
+    nerror += inputin->get_item(&swtdma, "pres", "swtdma", "", "serial");
+    if (nerror)
+        throw 1;
+
+    if (!(swtdma == "serial" || swtdma == "partitioned"))
+    {
+        master->print_error("\"%s\" is an illegal value for swtdma\n", swtdma.c_str());
+        throw 1;
+    }
+
+#ifdef USECUDA
+    if (swtdma == "partitioned")
+    {
+        master->print_error("swtdma = partitioned is not supported in CUDA runs\n");
+        throw 1;
+    }
+#endif
+
 #ifdef USECUDA
     a_g = 0;
     c_g = 0;
@@ -54,6 +78,10 @@ Pres_2::~Pres_2()
     delete[] c;
     delete[] work2d;
 
+    delete[] work3d_r;
+    delete[] tdmasend;
+    delete[] tdmarecv;
+
     delete[] bmati;
     delete[] bmatj;
 
@@ -74,8 +102,7 @@ void Pres_2::exec(double dt)
 
     // solve the system
     solve(fields->sd["p"]->data, fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data,
-          grid->dz, fields->rhoref,
-          grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
+          grid->dz, fields->rhoref);
 
     // get the pressure tendencies from the pressure field
     output(fields->ut->data, fields->vt->data, fields->wt->data, 
@@ -99,13 +126,33 @@ void Pres_2::init()
     const int jmax = grid->jmax;
     const int kmax = grid->kmax;
 
-    bmati = new double[itot];
-    bmatj = new double[jtot];
+    bmati = new real[itot];
+    bmatj = new real[jtot];
 
-    a = new double[kmax];
-    c = new double[kmax];
+    a = new real[kmax];
+    c = new real[kmax];
 
-    work2d = new double[imax*jmax];
+    // the partitioned solver works on the y-orientation of the transposes, in which
+    // each process in the x-direction holds kblock levels of iblock*jtot columns
+    if (swtdma == "partitioned" && master->npx > 1)
+    {
+        const int iblock = grid->iblock;
+        const int kblock = grid->kblock;
+
+        work2d = new real[iblock*jtot];
+
+        if (kblock < 2)
+        {
+            master->print_error("swtdma = partitioned requires at least two levels per process, kblock = %d\n", kblock);
+            throw 1;
+        }
+
+        work3d_r = new real[iblock*jtot*kblock];
+        tdmasend = new real[7*iblock*jtot];
+        tdmarecv = new real[7*iblock*jtot*master->npx];
+    }
+    else
+        work2d = new real[imax*jmax];
 }
 
 void Pres_2::set_values()
@@ -141,10 +188,10 @@ void Pres_2::set_values()
     }
 }
 
-void Pres_2::input(double* restrict p, 
-                   double* restrict u , double* restrict v , double* restrict w ,
-                   double* restrict ut, double* restrict vt, double* restrict wt,
-                   double* restrict dzi, double* restrict rhoref, double* restrict rhorefh,
+void Pres_2::input(real* restrict p, 
+                   real* restrict u , real* restrict v , real* restrict w ,
+                   real* restrict ut, real* restrict vt, real* restrict wt,
+                   real* restrict dzi, real* restrict rhoref, real* restrict rhorefh,
                    double dt)
 {
     const int ii = 1;
@@ -167,6 +214,7 @@ void Pres_2::input(double* restrict p,
     grid->boundary_cyclic(vt, North_south_edge);
 
     // write pressure as a 3d array without ghost cells
+    #pragma omp parallel for
     for (int k=0; k<grid->kmax; k++)
         for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
@@ -181,10 +229,8 @@ void Pres_2::input(double* restrict p,
             }
 }
 
-void Pres_2::solve(double* restrict p, double* restrict work3d, double* restrict b,
-                   double* restrict dz, double* restrict rhoref,
-                   double* restrict fftini, double* restrict fftouti, 
-                   double* restrict fftinj, double* restrict fftoutj)
+void Pres_2::solve(real* restrict p, real* restrict work3d, real* restrict b,
+                   real* restrict dz, real* restrict rhoref)
 {
     const int imax   = grid->imax;
     const int jmax   = grid->jmax;
@@ -198,55 +244,62 @@ void Pres_2::solve(double* restrict p, double* restrict work3d, double* restrict
     int i,j,k,jj,kk,ijk;
     int iindex,jindex;
 
-    grid->fft_forward(p, work3d, fftini, fftouti, fftinj, fftoutj);
+    // with a single process in the x-direction the columns are always complete
+    if (swtdma == "partitioned" && master->npx > 1)
+        solve_partitioned(p, work3d, b, dz, rhoref);
+    else
+    {
+        grid->fft_forward(p, work3d);
 
-    jj = iblock;
-    kk = iblock*jblock;
+        jj = iblock;
+        kk = iblock*jblock;
 
-    //for (int i=0; i<itot*jtot; ++i)
-    //  printf("%i %e\n",i,p[i]);
-    //exit(1);
+        //for (int i=0; i<itot*jtot; ++i)
+        //  printf("%i %e\n",i,p[i]);
+        //exit(1);
+
+        // solve the tridiagonal system
+        // create vectors that go into the tridiagonal matrix solver
+        #pragma omp parallel for private(i, j, iindex, jindex, ijk)
+        for (k=0; k<kmax; k++)
+            for (j=0; j<jblock; j++)
+#pragma ivdep
+                for (i=0; i<iblock; i++)
+                {
+                    // swap the mpicoords, because domain is turned 90 degrees to avoid two mpi transposes
+                    iindex = master->mpicoordy * iblock + i;
+                    jindex = master->mpicoordx * jblock + j;
+
+                    ijk  = i + j*jj + k*kk;
+                    b[ijk] = dz[k+kgc]*dz[k+kgc] * rhoref[k+kgc]*(bmati[iindex]+bmatj[jindex]) - (a[k]+c[k]);
+                    p[ijk] = dz[k+kgc]*dz[k+kgc] * p[ijk];
+                }
 
-    // solve the tridiagonal system
-    // create vectors that go into the tridiagonal matrix solver
-    for (k=0; k<kmax; k++)
         for (j=0; j<jblock; j++)
 #pragma ivdep
             for (i=0; i<iblock; i++)
             {
-                // swap the mpicoords, because domain is turned 90 degrees to avoid two mpi transposes
                 iindex = master->mpicoordy * iblock + i;
                 jindex = master->mpicoordx * jblock + j;
 
-                ijk  = i + j*jj + k*kk;
-                b[ijk] = dz[k+kgc]*dz[k+kgc] * rhoref[k+kgc]*(bmati[iindex]+bmatj[jindex]) - (a[k]+c[k]);
-                p[ijk] = dz[k+kgc]*dz[k+kgc] * p[ijk];
+                // substitute BC's
+                ijk = i + j*jj;
+                b[ijk] += a[0];
+
+                // for wave number 0, which contains average, set pressure at top to zero
+                ijk  = i + j*jj + (kmax-1)*kk;
+                if (iindex == 0 && jindex == 0)
+                    b[ijk] -= c[kmax-1];
+                // set dp/dz at top to zero
+                else
+                    b[ijk] += c[kmax-1];
             }
 
-    for (j=0; j<jblock; j++)
-#pragma ivdep
-        for (i=0; i<iblock; i++)
-        {
-            iindex = master->mpicoordy * iblock + i;
-            jindex = master->mpicoordx * jblock + j;
-
-            // substitute BC's
-            ijk = i + j*jj;
-            b[ijk] += a[0];
-
-            // for wave number 0, which contains average, set pressure at top to zero
-            ijk  = i + j*jj + (kmax-1)*kk;
-            if (iindex == 0 && jindex == 0)
-                b[ijk] -= c[kmax-1];
-            // set dp/dz at top to zero
-            else
-                b[ijk] += c[kmax-1];
-        }
-
-    // call tdma solver
-    tdma(a, b, c, p, work2d, work3d);
+        // call tdma solver
+        tdma(a, b, c, p, work2d, work3d);
 
-    grid->fft_backward(p, work3d, fftini, fftouti, fftinj, fftoutj);
+        grid->fft_backward(p, work3d);
+    }
 
     jj = imax;
     kk = imax*jmax;
@@ -256,6 +309,7 @@ void Pres_2::solve(double* restrict p, double* restrict work3d, double* restrict
     kkp = grid->ijcells;
 
     // put the pressure back onto the original grid including ghost cells
+    #pragma omp parallel for private(ijkp, ijk)
     for (int k=0; k<grid->kmax; k++)
         for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
@@ -280,8 +334,74 @@ void Pres_2::solve(double* restrict p, double* restrict work3d, double* restrict
     grid->boundary_cyclic(p);
 }
 
-void Pres_2::output(double* restrict ut, double* restrict vt, double* restrict wt, 
-                    double* restrict p , double* restrict dzhi)
+void Pres_2::solve_partitioned(real* restrict p, real* restrict work3d, real* restrict b,
+                               real* restrict dz, real* restrict rhoref)
+{
+    const int kmax   = grid->kmax;
+    const int jtot   = grid->jtot;
+    const int iblock = grid->iblock;
+    const int kblock = grid->kblock;
+    const int kgc    = grid->kgc;
+
+    // keep the transformed field in y-orientation, the columns of iblock*jtot wave numbers
+    // are complete in the horizontal, but the vertical is split over the processes in x
+    grid->fft_forward(p, work3d, false);
+
+    const int jj = iblock;
+    const int kk = iblock*jtot;
+    const int kofs = master->mpicoordx*kblock;
+
+    // create vectors that go into the tridiagonal matrix solver
+    #pragma omp parallel for
+    for (int k=0; k<kblock; k++)
+        for (int j=0; j<jtot; j++)
+#pragma ivdep
+            for (int i=0; i<iblock; i++)
+            {
+                const int iindex = master->mpicoordy * iblock + i;
+                const int jindex = j;
+                const int kindex = kofs + k;
+
+                const int ijk = i + j*jj + k*kk;
+                b[ijk] = dz[kindex+kgc]*dz[kindex+kgc] * rhoref[kindex+kgc]*(bmati[iindex]+bmatj[jindex]) - (a[kindex]+c[kindex]);
+                work3d[ijk] = dz[kindex+kgc]*dz[kindex+kgc] * work3d[ijk];
+            }
+
+    // substitute BC's on the processes that hold the bottom and the top level
+    if (master->mpicoordx == 0)
+        for (int j=0; j<jtot; j++)
+#pragma ivdep
+            for (int i=0; i<iblock; i++)
+            {
+                const int ijk = i + j*jj;
+                b[ijk] += a[0];
+            }
+
+    if (master->mpicoordx == master->npx-1)
+        for (int j=0; j<jtot; j++)
+#pragma ivdep
+            for (int i=0; i<iblock; i++)
+            {
+                const int iindex = master->mpicoordy * iblock + i;
+                const int jindex = j;
+
+                // for wave number 0, which contains average, set pressure at top to zero
+                const int ijk = i + j*jj + (kblock-1)*kk;
+                if (iindex == 0 && jindex == 0)
+                    b[ijk] -= c[kmax-1];
+                // set dp/dz at top to zero
+                else
+                    b[ijk] += c[kmax-1];
+            }
+
+    // call the partitioned tdma solver, p is free to be used as work array
+    tdma_partitioned(a, b, c, work3d, p, work3d_r);
+
+    grid->fft_backward(p, work3d, false);
+}
+
+void Pres_2::output(real* restrict ut, real* restrict vt, real* restrict wt, 
+                    real* restrict p , real* restrict dzhi)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -290,6 +410,7 @@ void Pres_2::output(double* restrict ut, double* restrict vt, double* restrict w
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -302,79 +423,58 @@ void Pres_2::output(double* restrict ut, double* restrict vt, double* restrict w
             }
 }
 
-// tridiagonal matrix solver, taken from Numerical Recipes, Press
-void Pres_2::tdma(double* restrict a, double* restrict b, double* restrict c, 
-                  double* restrict p, double* restrict work2d, double* restrict work3d)
+void Pres_2::tdma(real* restrict a, real* restrict b, real* restrict c, 
+                  real* restrict p, real* restrict work2d, real* restrict work3d)
+{
+    const int iblock = grid->iblock;
+    const int jblock = grid->jblock;
+    const int kmax   = grid->kmax;
+
+    const int jj = iblock;
+    const int ncol = iblock*jblock;
+
+    // The columns are independent, so thread over j and keep the k-recurrence inside.
+    #pragma omp parallel for
+    for (int j=0; j<jblock; j++)
+        Tdma_functions::tdma(a, b, c, p, work2d, work3d, j*jj, (j+1)*jj, ncol, kmax);
+}
 
+// Partitioned tridiagonal solver for columns of which the vertical is split over the processes in the
+// x-direction, each process is a partition of kblock levels. The reduced systems are gathered and solved
+// on every process.
+void Pres_2::tdma_partitioned(real* restrict a, real* restrict b, real* restrict c,
+                              real* restrict p, real* restrict work3d_l, real* restrict work3d_r)
 {
-    int i,j,k,jj,kk,ijk,ij;
-    int iblock,jblock,kmax;
+    const int iblock = grid->iblock;
+    const int jtot   = grid->jtot;
+    const int kblock = grid->kblock;
+    const int npx    = master->npx;
+    const int mpicoordx = master->mpicoordx;
 
-    iblock = grid->iblock;
-    jblock = grid->jblock;
-    kmax = grid->kmax;
+    const int jj = iblock;
+    const int ncol = iblock*jtot;
 
-    jj = iblock;
-    kk = iblock*jblock;
+    // global index of the first level
+    const int kofs = mpicoordx*kblock;
 
-    for (j=0;j<jblock;j++)
-#pragma ivdep
-        for (i=0;i<iblock;i++)
-        {
-            ij = i + j*jj;
-            work2d[ij] = b[ij];
-        }
+    #pragma omp parallel for
+    for (int j=0; j<jtot; j++)
+        Tdma_functions::solve_partition(a, b, c, p, work2d, work3d_l, work3d_r, tdmasend, j*jj, (j+1)*jj, ncol,
+                                        kofs, kblock, mpicoordx > 0, mpicoordx < npx-1);
 
-    for (j=0;j<jblock;j++)
-#pragma ivdep
-        for (i=0;i<iblock;i++)
-        {
-            ij = i + j*jj;
-            p[ij] /= work2d[ij];
-        }
+    master->allgather_x(tdmasend, tdmarecv, 7*ncol);
 
-    for (k=1; k<kmax; k++)
+    #pragma omp parallel for
+    for (int j=0; j<jtot; j++)
     {
-        for (j=0;j<jblock;j++)
-#pragma ivdep
-            for (i=0;i<iblock;i++)
-            {
-                ij  = i + j*jj;
-                ijk = i + j*jj + k*kk;
-                work3d[ijk] = c[k-1] / work2d[ij];
-            }
-        for (j=0;j<jblock;j++)
-#pragma ivdep
-            for (i=0;i<iblock;i++)
-            {
-                ij  = i + j*jj;
-                ijk = i + j*jj + k*kk;
-                work2d[ij] = b[ijk] - a[k]*work3d[ijk];
-            }
-        for (j=0;j<jblock;j++)
-#pragma ivdep
-            for (i=0;i<iblock;i++)
-            {
-                ij  = i + j*jj;
-                ijk = i + j*jj + k*kk;
-                p[ijk] -= a[k]*p[ijk-kk];
-                p[ijk] /= work2d[ij];
-            }
+        Tdma_functions::solve_reduced(tdmarecv, work2d, j*jj, (j+1)*jj, ncol, npx);
+        Tdma_functions::substitute_separators(p, work3d_l, work3d_r, tdmarecv, j*jj, (j+1)*jj, ncol, kblock, mpicoordx);
     }
-
-    for (k=kmax-2; k>=0; k--)
-        for (j=0;j<jblock;j++)
-#pragma ivdep
-            for (i=0;i<iblock;i++)
-            {
-                ijk = i + j*jj + k*kk;
-                p[ijk] -= work3d[ijk+kk]*p[ijk+kk];
-            }
 }
 
 #ifndef USECUDA
-double Pres_2::calc_divergence(double* restrict u, double* restrict v, double* restrict w, double* restrict dzi,
-                               double* restrict rhoref, double* restrict rhorefh)
+double Pres_2::calc_divergence(real* restrict u, real* restrict v, real* restrict w, real* restrict dzi,
+                               real* restrict rhoref, real* restrict rhorefh)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -386,6 +486,7 @@ double Pres_2::calc_divergence(double* restrict u, double* restrict v, double* r
     double div    = 0.;
     double divmax = 0.;
 
+    #pragma omp parallel for private(div) reduction(max:divmax)
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
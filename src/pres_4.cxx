@@ -113,8 +113,8 @@ void Pres_4::exec(double dt)
        reads in case jblock does not divide by 4. */
     const int jslice = 1;
 
-    double *tmp2 = fields->atmp["tmp2"]->data;
-    double *tmp3 = fields->atmp["tmp3"]->data;
+    real *tmp2 = fields->atmp["tmp2"]->data;
+    real *tmp3 = fields->atmp["tmp3"]->data;
 
     const int ns = grid->iblock*jslice*(grid->kmax+4);
 
@@ -143,16 +143,16 @@ double Pres_4::check_divergence()
 
 void Pres_4::init()
 {
-    bmati = new double[grid->itot];
-    bmatj = new double[grid->jtot];
-
-    m1 = new double[grid->kmax];
-    m2 = new double[grid->kmax];
-    m3 = new double[grid->kmax];
-    m4 = new double[grid->kmax];
-    m5 = new double[grid->kmax];
-    m6 = new double[grid->kmax];
-    m7 = new double[grid->kmax];
+    bmati = new real[grid->itot];
+    bmatj = new real[grid->jtot];
+
+    m1 = new real[grid->kmax];
+    m2 = new real[grid->kmax];
+    m3 = new real[grid->kmax];
+    m4 = new real[grid->kmax];
+    m5 = new real[grid->kmax];
+    m6 = new real[grid->kmax];
+    m7 = new real[grid->kmax];
 }
 
 void Pres_4::set_values()
@@ -186,7 +186,7 @@ void Pres_4::set_values()
     for (int i=itot/2+1; i<itot; i++)
         bmati[i] = bmati[itot-i];
 
-    double *dzi4, *dzhi4;
+    real *dzi4, *dzhi4;
     dzi4  = grid->dzi4;
     dzhi4 = grid->dzhi4;
 
@@ -228,10 +228,10 @@ void Pres_4::set_values()
 }
 
 template<bool dim3>
-void Pres_4::input(double* restrict p, 
-                   double* restrict u , double* restrict v , double* restrict w ,
-                   double* restrict ut, double* restrict vt, double* restrict wt,
-                   double* restrict dzi4, double dt)
+void Pres_4::input(real* restrict p, 
+                   real* restrict u , real* restrict v , real* restrict w ,
+                   real* restrict ut, real* restrict vt, real* restrict wt,
+                   real* restrict dzi4, double dt)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -274,6 +274,7 @@ void Pres_4::input(double* restrict p,
             wt[ijk+kk1] = -wt[ijk-kk1];
         }
 
+    #pragma omp parallel for
     for (int k=0; k<grid->kmax; k++)
         for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
@@ -288,12 +289,12 @@ void Pres_4::input(double* restrict p,
             }
 }
 
-void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict dz,
-                   double* restrict m1, double* restrict m2, double* restrict m3, double* restrict m4,
-                   double* restrict m5, double* restrict m6, double* restrict m7,
-                   double* restrict m1temp, double* restrict m2temp, double* restrict m3temp, double* restrict m4temp,
-                   double* restrict m5temp, double* restrict m6temp, double* restrict m7temp, double* restrict ptemp,
-                   double* restrict bmati, double* restrict bmatj,
+void Pres_4::solve(real* restrict p, real* restrict work3d, real* restrict dz,
+                   real* restrict m1, real* restrict m2, real* restrict m3, real* restrict m4,
+                   real* restrict m5, real* restrict m6, real* restrict m7,
+                   real* restrict m1temp, real* restrict m2temp, real* restrict m3temp, real* restrict m4temp,
+                   real* restrict m5temp, real* restrict m6temp, real* restrict m7temp, real* restrict ptemp,
+                   real* restrict bmati, real* restrict bmatj,
                    const int jslice)
 {
     const int imax   = grid->imax;
@@ -305,7 +306,7 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
     const int jgc    = grid->jgc;
     const int kgc    = grid->kgc;
 
-    grid->fft_forward(p, work3d, grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
+    grid->fft_forward(p, work3d);
 
     int jj,kk,ik,ijk;
     int iindex,jindex;
@@ -356,6 +357,7 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
                 ptemp [ik+kki1] =  0.;
             }
 
+        #pragma omp parallel for private(iindex, jindex, ijk, ik)
         for (int k=0; k<kmax; ++k)
             for (int j=0; j<jslice; ++j)
             {
@@ -438,6 +440,7 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
         hdma(m1temp, m2temp, m3temp, m4temp, m5temp, m6temp, m7temp, ptemp, jslice);
 
         // Put back the solution.
+        #pragma omp parallel for
         for (int k=0; k<kmax; ++k)
             for (int j=0; j<jslice; ++j)
 #pragma ivdep
@@ -449,7 +452,7 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
                 }
     }
 
-    grid->fft_backward(p, work3d, grid->fftini, grid->fftouti, grid->fftinj, grid->fftoutj);
+    grid->fft_backward(p, work3d);
 
     // Put the pressure back onto the original grid including ghost cells.
     jj = imax;
@@ -460,6 +463,7 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
     kkp1 = 1*grid->ijcells;
     kkp2 = 2*grid->ijcells;
 
+    #pragma omp parallel for private(ijkp, ijk)
     for (int k=0; k<grid->kmax; k++)
         for (int j=0; j<grid->jmax; j++)
 #pragma ivdep
@@ -495,8 +499,8 @@ void Pres_4::solve(double* restrict p, double* restrict work3d, double* restrict
 }
 
 template<bool dim3>
-void Pres_4::output(double* restrict ut, double* restrict vt, double* restrict wt, 
-                    double* restrict p , double* restrict dzhi4)
+void Pres_4::output(real* restrict ut, real* restrict vt, real* restrict wt, 
+                    real* restrict p , real* restrict dzhi4)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -520,6 +524,7 @@ void Pres_4::output(double* restrict ut, double* restrict vt, double* restrict w
                 vt[ijk] -= (cg0*p[ijk-jj2] + cg1*p[ijk-jj1] + cg2*p[ijk] + cg3*p[ijk+jj1]) * cgi*dyi;
         }
 
+    #pragma omp parallel for
     for (int k=grid->kstart+1; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -533,8 +538,8 @@ void Pres_4::output(double* restrict ut, double* restrict vt, double* restrict w
             }
 }
 
-void Pres_4::hdma(double* restrict m1, double* restrict m2, double* restrict m3, double* restrict m4,
-                  double* restrict m5, double* restrict m6, double* restrict m7, double* restrict p,
+void Pres_4::hdma(real* restrict m1, real* restrict m2, real* restrict m3, real* restrict m4,
+                  real* restrict m5, real* restrict m6, real* restrict m7, real* restrict p,
                   const int jslice)
 {
     const int kmax   = grid->kmax;
@@ -688,7 +693,7 @@ void Pres_4::hdma(double* restrict m1, double* restrict m2, double* restrict m3,
             }
 }
 
-double Pres_4::calc_divergence(double* restrict u, double* restrict v, double* restrict w, double* restrict dzi4)
+double Pres_4::calc_divergence(real* restrict u, real* restrict v, real* restrict w, real* restrict dzi4)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -703,6 +708,7 @@ double Pres_4::calc_divergence(double* restrict u, double* restrict v, double* r
     double div, divmax;
     divmax = 0;
 
+    #pragma omp parallel for private(div) reduction(max:divmax)
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
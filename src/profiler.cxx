@@ -0,0 +1,175 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2015 Chiel van Heerwaarden
+ * Copyright (c) 2011-2015 Thijs Heus
+ * Copyright (c) 2014-2015 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <vector>
+#include "master.h"
+#include "input.h"
+#include "model.h"
+#include "profiler.h"
+
+Profiler::Profiler(Model* modelin, Input* inputin)
+{
+    master = modelin->master;
+
+    int nerror = 0;
+    nerror += inputin->get_item(&swprofiler, "profiler", "swprofiler", "", "0");
+    if (swprofiler == "1")
+        nerror += inputin->get_item(&swperiodic, "profiler", "swperiodic", "", "0");
+
+    if (nerror)
+        throw 1;
+
+    if (!(swprofiler == "0" || swprofiler == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swprofiler\n", swprofiler.c_str());
+        throw 1;
+    }
+
+    wall_clock_start = master->get_wall_clock_time();
+}
+
+Profiler::~Profiler()
+{
+}
+
+void Profiler::start(const std::string& name)
+{
+    if (swprofiler == "0")
+        return;
+
+    // timers are created at their first use, at which all members are set to zero
+    timers[name].start = master->get_wall_clock_time();
+}
+
+void Profiler::stop(const std::string& name)
+{
+    if (swprofiler == "0")
+        return;
+
+    Timer& timer = timers[name];
+    timer.total += master->get_wall_clock_time() - timer.start;
+    ++timer.ncalls;
+}
+
+void Profiler::count(const std::string& name, long n)
+{
+    if (swprofiler == "0")
+        return;
+
+    // counters are created at their first use, at which all members are set to zero
+    Counter& counter = counters[name];
+    counter.total += n;
+    ++counter.ncalls;
+}
+
+void Profiler::exec(int iteration, double time)
+{
+    if (swprofiler == "0" || swperiodic == "0")
+        return;
+
+    char filename[256];
+    std::sprintf(filename, "%s.profile.%07d.json", master->simname.c_str(), iteration);
+    write_report(filename, iteration, time);
+}
+
+void Profiler::save(int iteration, double time)
+{
+    if (swprofiler == "0")
+        return;
+
+    std::string filename = master->simname + ".profile.json";
+    write_report(filename, iteration, time);
+}
+
+void Profiler::write_report(const std::string& filename, int iteration, double time)
+{
+    // the timers are stored in a sorted map, thus all processes have them in the same order
+    const int ntimers = timers.size() + 1;
+
+    std::vector<double> tmin(ntimers);
+    std::vector<double> tmax(ntimers);
+    std::vector<double> tsum(ntimers);
+
+    // the first entry contains the total wall clock time of the run
+    tmin[0] = master->get_wall_clock_time() - wall_clock_start;
+
+    int n = 1;
+    for (std::map<std::string, Timer>::const_iterator it=timers.begin(); it!=timers.end(); ++it, ++n)
+        tmin[n] = it->second.total;
+
+    tmax = tmin;
+    tsum = tmin;
+
+    master->min(&tmin[0], ntimers);
+    master->max(&tmax[0], ntimers);
+    master->sum(&tsum[0], ntimers);
+
+    if (master->mpiid != 0)
+        return;
+
+    FILE* pFile = std::fopen(filename.c_str(), "w");
+    if (pFile == NULL)
+    {
+        master->print_warning("\"%s\" cannot be written\n", filename.c_str());
+        return;
+    }
+
+    std::fprintf(pFile, "{\n");
+    std::fprintf(pFile, "    \"iteration\": %d,\n", iteration);
+    std::fprintf(pFile, "    \"time\": %.6E,\n", time);
+    std::fprintf(pFile, "    \"nprocs\": %d,\n", master->nprocs);
+    std::fprintf(pFile, "    \"nthreads\": %d,\n", master->nthreads);
+    std::fprintf(pFile, "    \"total\": {\"min\": %.6E, \"max\": %.6E, \"mean\": %.6E},\n",
+                 tmin[0], tmax[0], tsum[0]/master->nprocs);
+    std::fprintf(pFile, "    \"timers\": {");
+
+    n = 1;
+    for (std::map<std::string, Timer>::const_iterator it=timers.begin(); it!=timers.end(); ++it, ++n)
+    {
+        const double tmean = tsum[n]/master->nprocs;
+        std::fprintf(pFile, "%s\n        \"%s\": {\"calls\": %ld, \"min\": %.6E, \"max\": %.6E, \"mean\": %.6E, \"imbalance\": %.4f}",
+                     n == 1 ? "" : ",", it->first.c_str(), it->second.ncalls,
+                     tmin[n], tmax[n], tmean, tmean > 0. ? tmax[n]/tmean : 1.);
+    }
+
+    std::fprintf(pFile, "\n    }");
+
+    // the counters are identical on all processes, thus they are not reduced
+    if (!counters.empty())
+    {
+        std::fprintf(pFile, ",\n    \"counters\": {");
+
+        n = 1;
+        for (std::map<std::string, Counter>::const_iterator it=counters.begin(); it!=counters.end(); ++it, ++n)
+        {
+            const double mean = it->second.ncalls > 0 ? (double)it->second.total/it->second.ncalls : 0.;
+            std::fprintf(pFile, "%s\n        \"%s\": {\"calls\": %ld, \"total\": %ld, \"mean\": %.2f}",
+                         n == 1 ? "" : ",", it->first.c_str(), it->second.ncalls, it->second.total, mean);
+        }
+
+        std::fprintf(pFile, "\n    }");
+    }
+
+    std::fprintf(pFile, "\n}\n");
+    std::fclose(pFile);
+}
@@ -21,6 +21,7 @@
  */
 
 #include <cstdio>
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <iostream>
@@ -36,6 +37,7 @@
 #include "model.h"
 #include "diff_smag2.h"
 #include "timeloop.h"
+#include "profiler.h"
 
 #include <netcdf>       // C++
 #include <netcdf.h>     // C, for sync() using older netCDF-C++ versions
@@ -51,11 +53,24 @@ Stats::Stats(Model* modelin, Input* inputin)
     nmask  = 0;
     nmaskh = 0;
 
+    nstats  = 0;
+    nbuffer = 0;
+
+    nreductions = 0;
+    nimmediate  = 0;
+
+    mask_begin = 0;
+    mask_end   = 0;
+
     int nerror = 0;
     nerror += inputin->get_item(&swstats, "stats", "swstats", "", "0");
 
     if (swstats == "1")
+    {
         nerror += inputin->get_item(&sampletime, "stats", "sampletime", "");
+        nerror += inputin->get_item(&flushinterval, "stats", "flushinterval", "", 1);
+        nerror += inputin->get_item(&swmultimask, "stats", "swmultimask", "", "0");
+    }
 
     if (!(swstats == "0" || swstats == "1"))
     {
@@ -63,12 +78,35 @@ Stats::Stats(Model* modelin, Input* inputin)
         master->print_error("\"%s\" is an illegal value for swstats\n", swstats.c_str());
     }
 
+    if (swstats == "1" && !(swmultimask == "0" || swmultimask == "1"))
+    {
+        ++nerror;
+        master->print_error("\"%s\" is an illegal value for swmultimask\n", swmultimask.c_str());
+    }
+
+    if (swstats == "1" && flushinterval < 1)
+    {
+        ++nerror;
+        master->print_error("flushinterval has to be at least 1\n");
+    }
+
     if (nerror)
         throw 1;
 }
 
 Stats::~Stats()
 {
+    // The model flushes the buffers at the end of the run. If it stopped on an error, the samples that are
+    // still in the buffers are written here. A destructor cannot throw, so a failed write is only reported.
+    try
+    {
+        flush();
+    }
+    catch(NcException& e)
+    {
+        master->print_error("NetCDF exception: %s\n",e.what());
+    }
+
     delete[] nmask;
     delete[] nmaskh;
 
@@ -97,7 +135,8 @@ void Stats::init(double ifactor)
     nmaskh = new int[grid->kcells];
 
     // set the number of stats to zero
-    nstats = 0;
+    nstats  = 0;
+    nbuffer = 0;
 }
 
 void Stats::create(int n)
@@ -206,10 +245,19 @@ void Stats::exec(int iteration, double time, unsigned long itime)
 {
     // This function is only called when stats are enabled no need for swstats check.
 
+    // finalize the profiles of all masks, whose reduction has been deferred
+    reduce_profs();
+
     // check if time for execution
     if (itime % isampletime != 0)
         return;
 
+    // report the number of deferred and immediate reductions of this sample to the profiler
+    model->profiler->count("stats_reductions", nreductions);
+    model->profiler->count("stats_immediate_reductions", nimmediate);
+    nreductions = 0;
+    nimmediate  = 0;
+
     // write message in case stats is triggered
     master->print_message("Saving stats for time %f\n", model->timeloop->get_time());
 
@@ -218,25 +266,66 @@ void Stats::exec(int iteration, double time, unsigned long itime)
         // shortcut
         Mask* m = &it->second;
 
-        // put the data into the NetCDF file
+        // append the data to the buffers, which are written to the NetCDF file in one go
+        if (master->mpiid == 0)
+        {
+            m->t_buffer   .push_back(time     );
+            m->iter_buffer.push_back(iteration);
+
+            for (Prof_map::iterator it=m->profs.begin(); it!=m->profs.end(); ++it)
+            {
+                const size_t nlevels = it->second.ncvar.getDim(1).getSize();
+                it->second.buffer.insert(it->second.buffer.end(), &it->second.data[grid->kstart], &it->second.data[grid->kstart+nlevels]);
+            }
+
+            for (Time_series_map::iterator it=m->tseries.begin(); it!=m->tseries.end(); ++it)
+                it->second.buffer.push_back(it->second.data);
+        }
+    }
+
+    ++nstats;
+    ++nbuffer;
+
+    if (nbuffer >= flushinterval)
+        flush();
+}
+
+void Stats::flush()
+{
+    if (swstats == "0" || nbuffer == 0)
+        return;
+
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
+    {
+        // shortcut
+        Mask* m = &it->second;
+
+        // write all buffered samples with one hyperslab per variable
         if (master->mpiid == 0)
         {
-            const std::vector<size_t> time_index = {static_cast<size_t>(nstats)};
+            const std::vector<size_t> time_index = {static_cast<size_t>(nstats-nbuffer)};
+            const std::vector<size_t> time_size  = {static_cast<size_t>(nbuffer)};
 
-            m->t_var   .putVar(time_index, &time     );
-            m->iter_var.putVar(time_index, &iteration);
+            m->t_var   .putVar(time_index, time_size, &m->t_buffer   [0]);
+            m->iter_var.putVar(time_index, time_size, &m->iter_buffer[0]);
+            m->t_buffer   .clear();
+            m->iter_buffer.clear();
 
-            const std::vector<size_t> time_height_index = {static_cast<size_t>(nstats), 0};
-            std::vector<size_t> time_height_size  = {1, 0};
+            const std::vector<size_t> time_height_index = {static_cast<size_t>(nstats-nbuffer), 0};
+            std::vector<size_t> time_height_size  = {static_cast<size_t>(nbuffer), 0};
 
-            for (Prof_map::const_iterator it=m->profs.begin(); it!=m->profs.end(); ++it)
+            for (Prof_map::iterator it=m->profs.begin(); it!=m->profs.end(); ++it)
             {
-                time_height_size[1] = m->profs[it->first].ncvar.getDim(1).getSize();
-                m->profs[it->first].ncvar.putVar(time_height_index, time_height_size, &m->profs[it->first].data[grid->kstart]);
+                time_height_size[1] = it->second.ncvar.getDim(1).getSize();
+                it->second.ncvar.putVar(time_height_index, time_height_size, &it->second.buffer[0]);
+                it->second.buffer.clear();
             }
 
-            for (Time_series_map::const_iterator it=m->tseries.begin(); it!=m->tseries.end(); ++it)
-                m->tseries[it->first].ncvar.putVar(time_index, &m->tseries[it->first].data);
+            for (Time_series_map::iterator it=m->tseries.begin(); it!=m->tseries.end(); ++it)
+            {
+                it->second.ncvar.putVar(time_index, time_size, &it->second.buffer[0]);
+                it->second.buffer.clear();
+            }
 
             // Synchronize the NetCDF file
             // BvS: only the last netCDF4-c++ includes the NcFile->sync()
@@ -246,7 +335,7 @@ void Stats::exec(int iteration, double time, unsigned long itime)
         }
     }
 
-    ++nstats;
+    nbuffer = 0;
 }
 
 std::string Stats::get_switch()
@@ -297,7 +386,7 @@ void Stats::add_prof(std::string name, std::string longname, std::string unit, s
     }
 }
 
-void Stats::add_fixed_prof(std::string name, std::string longname, std::string unit, std::string zloc, double* restrict prof)
+void Stats::add_fixed_prof(std::string name, std::string longname, std::string unit, std::string zloc, real* restrict prof)
 {
     // add the profile to all files
     for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
@@ -360,76 +449,128 @@ void Stats::get_mask(Field3d* mfield, Field3d* mfieldh, Mask* m)
               nmask, nmaskh, &nmaskbot);
 }
 
-// COMPUTATIONAL KERNELS BELOW
-void Stats::calc_mask(double* restrict mask, double* restrict maskh, double* restrict maskbot,
-                      int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot)
+bool Stats::do_multimask()
 {
-    int ijtot = grid->itot*grid->jtot;
+    return swmultimask == "1";
+}
 
-    // set all the mask values to 1
-    for (int n=0; n<grid->ncells; ++n)
-        mask[n] = 1.;
+void Stats::clear_masks()
+{
+    multimasks.clear();
+    multinmask   .clear();
+    multinmaskh  .clear();
+    multinmaskbot.clear();
 
-    for (int n=0; n<grid->ncells; ++n)
-        maskh[n] = 1.;
+    mask_begin = 0;
+    mask_end   = 0;
+}
 
-    for (int n=0; n<grid->ijcells; ++n)
-        maskbot[n] = 1.;
+void Stats::store_mask(Field3d* mfield, Field3d* mfieldh, Mask* m)
+{
+    const int n = multimasks.size();
 
-    for (int k=0; k<grid->kcells; ++k)
+    if (n == max_masks)
     {
-        nmask [k] = ijtot;
-        nmaskh[k] = ijtot;
+        master->print_error("the number of masks in a multi-mask sweep is limited to %d\n", max_masks);
+        throw 1;
     }
-    *nmaskbot = ijtot;
-}
 
-void Stats::calc_area(double* restrict area, const int loc[3], int* restrict nmask)
-{
-    const int ijtot = grid->itot*grid->jtot;
+    // the first mask resets the bits
+    if (n == 0)
+    {
+        maskbits   .assign(grid->ncells , 0);
+        maskbitsh  .assign(grid->ncells , 0);
+        maskbitsbot.assign(grid->ijcells, 0);
+    }
 
-    for (int k=grid->kstart; k<grid->kend+loc[2]; k++)
+    const unsigned char bit = 1 << n;
+
+    // the ghost cells are included, as the masks are interpolated onto the staggered locations
+    for (int ijk=0; ijk<grid->ncells; ++ijk)
     {
-        if (nmask[k] > nthres)
-            area[k] = (double)(nmask[k]) / (double)ijtot;
-        else
-            area[k] = 0.;
+        if (mfield->data[ijk] > 0.5)
+            maskbits[ijk] |= bit;
+        if (mfieldh->data[ijk] > 0.5)
+            maskbitsh[ijk] |= bit;
     }
+
+    for (int ij=0; ij<grid->ijcells; ++ij)
+        if (mfieldh->databot[ij] > 0.5)
+            maskbitsbot[ij] |= bit;
+
+    multimasks.push_back(m);
+    multinmask .insert(multinmask .end(), nmask , nmask +grid->kcells);
+    multinmaskh.insert(multinmaskh.end(), nmaskh, nmaskh+grid->kcells);
+    multinmaskbot.push_back(nmaskbot);
+
+    // the kernels process all stored masks, unless a selection is made
+    select_masks(0, multimasks.size());
 }
 
-void Stats::calc_mean(double* const restrict prof, const double* const restrict data,
-                      const double offset, const int loc[3],
-                      const double* const restrict mask, const int * const restrict nmask)
+Mask* Stats::load_mask(Field3d* mfield, Field3d* mfieldh, const int n)
 {
-    const int jj = grid->icells;
-    const int kk = grid->ijcells;
+    const unsigned char bit = 1 << n;
 
-    for (int k=1; k<grid->kcells; k++)
+    for (int ijk=0; ijk<grid->ncells; ++ijk)
     {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk  = i + j*jj + k*kk;
-                prof[k] += mask[ijk]*(data[ijk] + offset);
-            }
+        mfield ->data[ijk] = (maskbits [ijk] & bit) ? 1. : 0.;
+        mfieldh->data[ijk] = (maskbitsh[ijk] & bit) ? 1. : 0.;
     }
 
-    master->sum(prof, grid->kcells);
+    for (int ij=0; ij<grid->ijcells; ++ij)
+        mfieldh->databot[ij] = (maskbitsbot[ij] & bit) ? 1. : 0.;
 
-    for (int k=1; k<grid->kcells; k++)
+    for (int k=0; k<grid->kcells; ++k)
     {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
+        nmask [k] = multinmask [n*grid->kcells+k];
+        nmaskh[k] = multinmaskh[n*grid->kcells+k];
+    }
+    nmaskbot = multinmaskbot[n];
+
+    // the kernels process the restored mask only
+    select_masks(n, n+1);
+
+    return multimasks[n];
+}
+
+int Stats::get_nmasks()
+{
+    return multimasks.size();
+}
+
+void Stats::select_masks(const int nbegin, const int nend)
+{
+    mask_begin = nbegin;
+    mask_end   = nend;
+}
+
+// COMPUTATIONAL KERNELS BELOW
+void Stats::calc_mask(real* restrict mask, real* restrict maskh, real* restrict maskbot,
+                      int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot)
+{
+    int ijtot = grid->itot*grid->jtot;
+
+    // set all the mask values to 1
+    for (int n=0; n<grid->ncells; ++n)
+        mask[n] = 1.;
+
+    for (int n=0; n<grid->ncells; ++n)
+        maskh[n] = 1.;
+
+    for (int n=0; n<grid->ijcells; ++n)
+        maskbot[n] = 1.;
+
+    for (int k=0; k<grid->kcells; ++k)
+    {
+        nmask [k] = ijtot;
+        nmaskh[k] = ijtot;
     }
+    *nmaskbot = ijtot;
 }
 
-void Stats::calc_mean2d(double* const restrict mean, const double* const restrict data,
+void Stats::calc_mean2d(double* const restrict mean, const real* const restrict data,
                         const double offset,
-                        const double* const restrict mask, const int * const restrict nmask)
+                        const real* const restrict mask, const int * const restrict nmask)
 {
     const int jj = grid->icells;
 
@@ -444,13 +585,14 @@ void Stats::calc_mean2d(double* const restrict mean, const double* const restric
                 *mean += mask[ij]*(data[ij] + offset);
             }
         master->sum(mean,1);
+        ++nimmediate;
         *mean /= (double)*nmask;
     }
     else
         *mean = NC_FILL_DOUBLE;
 }
 
-void Stats::calc_sorted_prof(double* restrict data, double* restrict bin, double* restrict prof)
+void Stats::calc_sorted_prof(real* restrict data, double* restrict prof)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -461,6 +603,7 @@ void Stats::calc_sorted_prof(double* restrict data, double* restrict bin, double
     double maxval = -Constants::dhuge;
 
     // first, get min and max
+    #pragma omp parallel for reduction(min:minval) reduction(max:maxval)
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -501,9 +644,8 @@ void Stats::calc_sorted_prof(double* restrict data, double* restrict bin, double
         minval -= 0.5*dbin;
         maxval += 0.5*dbin;
 
-        // set the bin array to zero
-        for (int n=0; n<bins; ++n)
-            bin[n] = 0;
+        // the bins are summed over all processes, so they are kept in double precision
+        std::vector<double> bin(bins, 0.);
 
         // calculate the division factor of one equivalent height unit
         // (the total volume saved is itot*jtot*zsize)
@@ -524,7 +666,7 @@ void Stats::calc_sorted_prof(double* restrict data, double* restrict bin, double
         }
 
         // get the bin count
-        master->sum(bin, bins);
+        master->sum(&bin[0], bins);
 
         // set the starting values of the loop
         int index = 0;
@@ -576,460 +718,477 @@ void Stats::calc_sorted_prof(double* restrict data, double* restrict bin, double
 }
 
 // \TODO the count function assumes that the variable to count is at the mask location
-void Stats::calc_count(double* restrict data, double* restrict prof, double threshold,
-                       double* restrict mask, int* restrict nmask)
+void Stats::calc_count(real* restrict data, double* restrict prof, double threshold,
+                       real* restrict mask, int* restrict nmask)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
+    double* restrict sums = stage_prof(prof, nmask, 0);
+
+    #pragma omp parallel for
     for (int k=0; k<grid->kcells; ++k)
     {
-        prof[k] = 0.;
+        double prof_k = 0.;
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
             {
                 const int ijk = i + j*jj + k*kk;
                 if (data[ijk] > threshold)
-                    prof[k] += mask[ijk]*1.;
+                    prof_k += mask[ijk]*1.;
             }
+        sums[k] = prof_k;
     }
+}
 
-    master->sum(prof, grid->kcells);
+double* Stats::stage_prof(double* prof, const int* nmask, const int kbegin)
+{
+    // the deque keeps the sums of the earlier profiles in place, so the pointers that are handed out remain valid
+    pending_profs.push_back(Pending_prof());
 
-    for (int k=0; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    Pending_prof& p = pending_profs.back();
+    p.prof   = prof;
+    p.kbegin = kbegin;
+    // store a copy of the number of points, as the next mask overwrites them
+    p.nmask.assign(nmask, nmask+grid->kcells);
+    p.sums.assign(grid->kcells, 0.);
+
+    return &p.sums[0];
 }
 
-void Stats::calc_moment(double* restrict data, double* restrict datamean, double* restrict prof, double power, const int loc[3],
-                        double* restrict mask, int* restrict nmask)
+void Stats::reduce_profs()
 {
-    const int jj = grid->icells;
-    const int kk = grid->ijcells;
+    if (pending_profs.empty() && pending_fluxes.empty())
+        return;
+
+    const int kcells = grid->kcells;
 
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
+    // reduce the local sums of all staged profiles of all masks in one call
+    if (!pending_profs.empty())
     {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                prof[k] += mask[ijk]*std::pow(data[ijk]-datamean[k], power);
-            }
+        partials.resize(pending_profs.size()*kcells);
+        for (size_t n=0; n<pending_profs.size(); ++n)
+            std::copy(pending_profs[n].sums.begin(), pending_profs[n].sums.end(), &partials[n*kcells]);
+
+        master->sum(&partials[0], partials.size());
+        ++nreductions;
     }
 
-    master->sum(prof, grid->kcells);
+    for (size_t n=0; n<pending_profs.size(); ++n)
+    {
+        const Pending_prof& p = pending_profs[n];
+        const double* restrict sums = &partials[n*kcells];
+        for (int k=p.kbegin; k<kcells; ++k)
+        {
+            if (p.nmask[k] > nthres)
+                p.prof[k] = sums[k] / (double)(p.nmask[k]);
+            else
+                p.prof[k] = NC_FILL_DOUBLE;
+        }
+    }
 
-    for (int k=1; k<grid->kcells; k++)
+    for (std::vector<Pending_flux>::const_iterator it=pending_fluxes.begin(); it!=pending_fluxes.end(); ++it)
     {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
+        for (int k=grid->kstart; k<grid->kend+1; ++k)
+        {
+            if (it->turb[k] == NC_FILL_DOUBLE || it->diff[k] == NC_FILL_DOUBLE)
+                it->flux[k] = NC_FILL_DOUBLE;
+            else
+                it->flux[k] = it->turb[k] + it->diff[k];
+        }
     }
+
+    pending_profs.clear();
+    pending_fluxes.clear();
 }
 
-void Stats::calc_flux_2nd(double* restrict data, double* restrict datamean, double* restrict w, double* restrict wmean,
-                          double* restrict prof, double* restrict tmp1, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+/**
+ * This function calculates the total domain integrated path of variable data over maskbot
+ */
+void Stats::calc_path(real* restrict data, real* restrict maskbot, int* restrict nmaskbot, double* restrict path)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const int kstart = grid->kstart;
 
-    // set a pointer to the field that contains w, either interpolated or the original
-    double* restrict calcw = w;
-
-    // define the locations
-    const int wloc [3] = {0,0,1};
-    const int uwloc[3] = {1,0,1};
-    const int vwloc[3] = {0,1,1};
+    *path = 0.;
 
-    if (loc[0] == 1)
-    {
-        grid->interpolate_2nd(tmp1, w, wloc, uwloc);
-        calcw = tmp1;
-    }
-    else if (loc[1] == 1)
+    if (*nmaskbot > nthres)
     {
-        grid->interpolate_2nd(tmp1, w, wloc, vwloc);
-        calcw = tmp1;
+        // Integrate liquid water
+        for (int j=grid->jstart; j<grid->jend; j++)
+            for (int i=grid->istart; i<grid->iend; i++)
+            {
+                const int ij = i + j*jj;
+                if (maskbot[ij] == 1)
+                    for (int k=kstart; k<grid->kend; k++)
+                    {
+                        const int ijk = i + j*jj + k*kk;
+                        *path += fields->rhoref[k] * data[ijk] * grid->dz[k];
+                    }
+            }
+        *path /= (double)*nmaskbot;
+        master->sum(path, 1);
+        ++nimmediate;
     }
+    else
+        *path = NC_FILL_DOUBLE;
+}
 
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
+/**
+ * This function calculates the vertical projected cover of variable data over maskbot
+ */
+void Stats::calc_cover(real* restrict data, real* restrict maskbot, int* restrict nmaskbot, double* restrict cover, double threshold)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int kstart = grid->kstart;
+
+    *cover = 0.;
+
+    if (*nmaskbot > nthres)
     {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+        // Per column, check if cloud present
+        for (int j=grid->jstart; j<grid->jend; j++)
+            for (int i=grid->istart; i<grid->iend; i++)
             {
-                const int ijk  = i + j*jj + k*kk;
-                prof[k] += mask[ijk]*(0.5*(data[ijk-kk]+data[ijk])-0.5*(datamean[k-1]+datamean[k]))*(calcw[ijk]-wmean[k]);
-                // prof[k] += mask[ijk]*0.5*(data[ijk-kk]+data[ijk])*calcw[ijk];
+                const int ij = i + j*jj;
+                if (maskbot[ij] == 1)
+                    for (int k=kstart; k<grid->kend; k++)
+                    {
+                        const int ijk = i + j*jj + k*kk;
+                        if (data[ijk]>threshold)
+                        {
+                            *cover += 1.;
+                            break;
+                        }
+                    }
             }
+        *cover /= (double)*nmaskbot;
+        master->sum(cover,1);
+        ++nimmediate;
     }
+    else
+        *cover = NC_FILL_DOUBLE;
+}
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; ++k)
+// MULTI-MASK KERNELS BELOW
+// These kernels accumulate the profiles of the selected masks in a single sweep over the field, the
+// statistics of a single mask are the case in which one mask is selected. The mask of a staggered
+// location is the average of the bits of the two neighbouring cells, which equals the horizontal
+// interpolation of the mask field onto that location.
+namespace
+{
+    inline double mask_weight(const unsigned char b0, const unsigned char b1, const int n)
     {
-        if (nmask[k] > nthres && datamean[k-1] != NC_FILL_DOUBLE && datamean[k] != NC_FILL_DOUBLE)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
+        return 0.5*( ((b0 >> n) & 1) + ((b1 >> n) & 1) );
     }
 }
 
-void Stats::calc_flux_4th(double* restrict data, double* restrict w, double* restrict prof, double* restrict tmp1, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+const unsigned char* Stats::get_mask_bits(const int loc[3])
 {
-    using namespace Finite_difference::O4;
-
-    const int jj  = 1*grid->icells;
-    const int kk1 = 1*grid->ijcells;
-    const int kk2 = 2*grid->ijcells;
-
-    // set a pointer to the field that contains w, either interpolated or the original
-    double* restrict calcw = w;
+    return (loc[2] == 1) ? &maskbitsh[0] : &maskbits[0];
+}
 
-    // define the locations
-    const int wloc [3] = {0,0,1};
-    const int uwloc[3] = {1,0,1};
-    const int vwloc[3] = {0,1,1};
+const int* Stats::get_mask_counts(const int loc[3])
+{
+    return (loc[2] == 1) ? &multinmaskh[0] : &multinmask[0];
+}
 
+int Stats::get_mask_shift(const int loc[3])
+{
+    // offset of the neighbouring cell with which the mask is averaged on a staggered location
     if (loc[0] == 1)
-    {
-        grid->interpolate_4th(tmp1, w, wloc, uwloc);
-        calcw = tmp1;
-    }
+        return 1;
     else if (loc[1] == 1)
-    {
-        grid->interpolate_4th(tmp1, w, wloc, vwloc);
-        calcw = tmp1;
-    }
+        return grid->icells;
+    else
+        return 0;
+}
 
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                prof[k] += mask[ijk]*(ci0*data[ijk-kk2] + ci1*data[ijk-kk1] + ci2*data[ijk] + ci3*data[ijk+kk1])*calcw[ijk];
-            }
-    }
+void Stats::calc_area(std::string name, const int loc[3])
+{
+    const int ijtot = grid->itot*grid->jtot;
 
-    master->sum(prof, grid->kcells);
+    const int* restrict counts = get_mask_counts(loc);
 
-    for (int k=1; k<grid->kcells; k++)
+    for (int n=mask_begin; n<mask_end; ++n)
     {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
+        double* restrict area = multimasks[n]->profs[name].data;
+        const int* restrict nmask = &counts[n*grid->kcells];
+        for (int k=grid->kstart; k<grid->kend+loc[2]; k++)
+        {
+            if (nmask[k] > nthres)
+                area[k] = (double)(nmask[k]) / (double)ijtot;
+            else
+                area[k] = 0.;
+        }
     }
 }
 
-void Stats::calc_grad_2nd(double* restrict data, double* restrict prof, double* restrict dzhi, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+void Stats::calc_mean(std::string name, real* restrict data, const double offset, const int loc[3])
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+
+    const unsigned char* restrict bits = get_mask_bits(loc);
+    const int* restrict counts = get_mask_counts(loc);
+    const int shift = get_mask_shift(loc);
+
+    // the mean is staged, the kernels that need it have to wait for the next reduction
+    std::vector<double*> sums(max_masks);
+    for (int n=mask_begin; n<mask_end; ++n)
+        sums[n] = stage_prof(multimasks[n]->profs[name].data, &counts[n*kcells], 1);
 
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
+    #pragma omp parallel for
+    for (int k=1; k<kcells; ++k)
     {
-        prof[k] = 0.;
+        double prof_k[max_masks] = {0.};
         for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
             {
                 const int ijk = i + j*jj + k*kk;
-                prof[k] += mask[ijk]*(data[ijk]-data[ijk-kk])*dzhi[k];
+                const double val = data[ijk] + offset;
+                for (int n=mask_begin; n<mask_end; ++n)
+                    prof_k[n] += mask_weight(bits[ijk], bits[ijk-shift], n)*val;
             }
+        for (int n=mask_begin; n<mask_end; ++n)
+            sums[n][k] = prof_k[n];
     }
+}
 
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+void Stats::calc_moments(real* restrict data, std::string meanname, const double offset,
+                         std::string name2, std::string name3, std::string name4, const int loc[3])
+{
+    calc_moments_fluxes(data, meanname, offset, name2, name3, name4,
+                        0, 0, "", "", "", 0., 0, 0, 0, 0., loc);
 }
 
-void Stats::calc_grad_4th(double* restrict data, double* restrict prof, double* restrict dzhi4, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+void Stats::calc_moments_fluxes(real* restrict data, std::string meanname, const double offset,
+                                std::string name2, std::string name3, std::string name4,
+                                real* restrict w, real* restrict tmp1, std::string fluxname,
+                                std::string gradname, std::string diffname, const double visc,
+                                real* restrict evisc, real* restrict fluxbot, real* restrict fluxtop,
+                                const double tPr, const int loc[3])
 {
     using namespace Finite_difference::O4;
 
+    const int ii  = 1;
     const int jj  = 1*grid->icells;
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
+    const int kstart = grid->kstart;
+    const int kend = grid->kend;
+    const int kcells = grid->kcells;
 
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                prof[k] += mask[ijk]*(cg0*data[ijk-kk2] + cg1*data[ijk-kk1] + cg2*data[ijk] + cg3*data[ijk+kk1])*dzhi4[k];
-            }
-    }
+    const double dxi = 1./grid->dx;
+    const double dyi = 1./grid->dy;
+
+    const bool is4th = grid->swspatialorder == "4";
+    const bool have_flux = !fluxname.empty();
+    const bool have_grad = !gradname.empty();
+    // the eddy viscosity gives the diffusive flux per grid point in the 2nd order statistics,
+    // otherwise the diffusive flux follows from the gradient and the constant viscosity
+    const bool have_smagdiff = evisc && !diffname.empty() && !is4th;
+
+    real* restrict dzhi = is4th ? grid->dzhi4 : grid->dzhi;
 
-    master->sum(prof, grid->kcells);
+    // the moments are located at the location of the data, the fluxes and the gradient at the half level
+    const int mloc[3] = {loc[0], loc[1], 1};
+    const unsigned char* restrict bits  = get_mask_bits(loc);
+    const unsigned char* restrict bitsh = get_mask_bits(mloc);
+    const int* restrict counts  = get_mask_counts(loc);
+    const int* restrict countsh = get_mask_counts(mloc);
+    const int shift = get_mask_shift(loc);
 
-    for (int k=1; k<grid->kcells; k++)
+    // set a pointer to the field that contains w, either interpolated or the original
+    real* restrict calcw = w;
+
+    if (have_flux && (loc[0] == 1 || loc[1] == 1))
     {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
+        const int wloc [3] = {0,0,1};
+        const int uwloc[3] = {1,0,1};
+        const int vwloc[3] = {0,1,1};
+
+        if (is4th)
+            grid->interpolate_4th(tmp1, w, wloc, (loc[0] == 1) ? uwloc : vwloc);
         else
-            prof[k] = NC_FILL_DOUBLE;
+            grid->interpolate_2nd(tmp1, w, wloc, (loc[0] == 1) ? uwloc : vwloc);
+        calcw = tmp1;
     }
-}
 
-void Stats::calc_diff_4th(double* restrict data, double* restrict prof, double* restrict dzhi4, double visc, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
-{
-    using namespace Finite_difference::O4;
+    // the mean includes the offset, the fluctuations are computed from the data without it
+    std::vector<double*> means(max_masks), wmeans(max_masks);
+    std::vector<double*> sums2(max_masks), sums3(max_masks), sums4(max_masks);
+    std::vector<double*> sumsflux(max_masks), sumsgrad(max_masks), sumsdiff(max_masks);
+    for (int n=mask_begin; n<mask_end; ++n)
+    {
+        Mask* m = multimasks[n];
+        const int* nmask  = &counts [n*kcells];
+        const int* nmaskh = &countsh[n*kcells];
+
+        means[n] = m->profs[meanname].data;
+        sums2[n] = stage_prof(m->profs[name2].data, nmask, 1);
+        sums3[n] = name3.empty() ? 0 : stage_prof(m->profs[name3].data, nmask, 1);
+        sums4[n] = name4.empty() ? 0 : stage_prof(m->profs[name4].data, nmask, 1);
+
+        if (have_flux && is4th)
+            sumsflux[n] = stage_prof(m->profs[fluxname].data, nmaskh, 1);
+        else if (have_flux)
+        {
+            wmeans[n] = m->profs["w"].data;
 
-    const int jj  = 1*grid->icells;
-    const int kk1 = 1*grid->ijcells;
-    const int kk2 = 2*grid->ijcells;
+            // flag the levels at which one of the means is undefined as empty
+            std::vector<int> nvalid(nmaskh, nmaskh+kcells);
+            for (int k=1; k<kcells; ++k)
+                if (means[n][k-1] == NC_FILL_DOUBLE || means[n][k] == NC_FILL_DOUBLE)
+                    nvalid[k] = 0;
 
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                prof[k] -= mask[ijk]*visc*(cg0*data[ijk-kk2] + cg1*data[ijk-kk1] + cg2*data[ijk] + cg3*data[ijk+kk1])*dzhi4[k];
-            }
-    }
+            sumsflux[n] = stage_prof(m->profs[fluxname].data, &nvalid[0], 1);
+        }
 
-    master->sum(prof, grid->kcells);
+        if (have_grad)
+            sumsgrad[n] = stage_prof(m->profs[gradname].data, nmaskh, 1);
+        if (have_smagdiff)
+            sumsdiff[n] = stage_prof(m->profs[diffname].data, nmaskh, 1);
+    }
 
-    for (int k=1; k<grid->kcells; k++)
+    // the moments are computed up to the top of their location, the fluxes include the top wall
+    #pragma omp parallel for
+    for (int k=kstart; k<kend+1; ++k)
     {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
-}
+        const bool do_moments = k < kend+loc[2];
 
-void Stats::calc_diff_2nd(double* restrict data, double* restrict prof, double* restrict dzhi, double visc, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
-{
-    const int jj = grid->icells;
-    const int kk = grid->ijcells;
+        double m2[max_masks] = {0.};
+        double m3[max_masks] = {0.};
+        double m4[max_masks] = {0.};
+        double flux_k[max_masks] = {0.};
+        double grad_k[max_masks] = {0.};
+        double diff_k[max_masks] = {0.};
 
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
         for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
             {
-                const int ijk = i + j*jj + k*kk;
-                prof[k] -= mask[ijk]*visc*(data[ijk] - data[ijk-kk])*dzhi[k];
-            }
-    }
-
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
-}
-
+                const int ij  = i + j*jj;
+                const int ijk = i + j*jj + k*kk1;
 
-void Stats::calc_diff_2nd(double* restrict data, double* restrict w, double* restrict evisc,
-                          double* restrict prof, double* restrict dzhi,
-                          double* restrict fluxbot, double* restrict fluxtop, double tPr, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
-{
-    const int ii = 1;
-    const int jj = grid->icells;
-    const int kk = grid->ijcells;
-    const int kstart = grid->kstart;
-    const int kend = grid->kend;
+                if (do_moments)
+                    for (int n=mask_begin; n<mask_end; ++n)
+                    {
+                        const double wgt = mask_weight(bits[ijk], bits[ijk-shift], n);
+                        if (wgt == 0.)
+                            continue;
+                        const double d  = data[ijk] + offset - means[n][k];
+                        const double d2 = wgt*d*d;
+                        m2[n] += d2;
+                        m3[n] += d2*d;
+                        m4[n] += d2*d*d;
+                    }
 
-    const double dxi = 1./grid->dx;
-    const double dyi = 1./grid->dy;
+                if (!have_flux && !have_grad && !have_smagdiff)
+                    continue;
 
-    // bottom boundary
-    prof[kstart] = 0.;
-    for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
-        {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kstart*kk;
-            prof[kstart] += mask[ijk]*fluxbot[ij];
-        }
+                double grad = 0.;
+                if (have_grad)
+                {
+                    if (is4th)
+                        grad = (cg0*data[ijk-kk2] + cg1*data[ijk-kk1] + cg2*data[ijk] + cg3*data[ijk+kk1])*dzhi[k];
+                    else
+                        grad = (data[ijk]-data[ijk-kk1])*dzhi[k];
+                }
 
-    // calculate the interior
-    if (loc[0] == 1)
-    {
-        for (int k=grid->kstart+1; k<grid->kend; ++k)
-        {
-            prof[k] = 0.;
-            for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-                for (int i=grid->istart; i<grid->iend; ++i)
+                // the 4th order flux is the total flux, the 2nd order flux is computed from the fluctuations
+                double datah = 0.;
+                if (have_flux)
                 {
-                    const int ijk  = i + j*jj + k*kk;
-                    // evisc * (du/dz + dw/dx)
-                    const double eviscu = 0.25*(evisc[ijk-ii-kk]+evisc[ijk-ii]+evisc[ijk-kk]+evisc[ijk]);
-                    prof[k] += -mask[ijk]*eviscu*( (data[ijk]-data[ijk-kk])*dzhi[k] + (w[ijk]-w[ijk-ii])*dxi );
+                    if (is4th)
+                        datah = (ci0*data[ijk-kk2] + ci1*data[ijk-kk1] + ci2*data[ijk] + ci3*data[ijk+kk1])*calcw[ijk];
+                    else
+                        datah = 0.5*(data[ijk-kk1]+data[ijk]) + offset;
                 }
-        }
-    }
-    else if (loc[1] == 1)
-    {
-        for (int k=grid->kstart+1; k<grid->kend; ++k)
-        {
-            prof[k] = 0.;
-            for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-                for (int i=grid->istart; i<grid->iend; ++i)
+
+                // the fluxes at the walls are prescribed by the boundary conditions
+                double diff = 0.;
+                if (have_smagdiff)
                 {
-                    const int ijk = i + j*jj + k*kk;
-                    // evisc * (dv/dz + dw/dy)
-                    const double eviscv = 0.25*(evisc[ijk-jj-kk]+evisc[ijk-jj]+evisc[ijk-kk]+evisc[ijk]);
-                    prof[k] += -mask[ijk]*eviscv*( (data[ijk]-data[ijk-kk])*dzhi[k] + (w[ijk]-w[ijk-jj])*dyi );
+                    if (k == kstart)
+                        diff = fluxbot[ij];
+                    else if (k == kend)
+                        diff = fluxtop[ij];
+                    else if (loc[0] == 1)
+                    {
+                        // evisc * (du/dz + dw/dx)
+                        const double eviscu = 0.25*(evisc[ijk-ii-kk1]+evisc[ijk-ii]+evisc[ijk-kk1]+evisc[ijk]);
+                        diff = -eviscu*( (data[ijk]-data[ijk-kk1])*dzhi[k] + (w[ijk]-w[ijk-ii])*dxi );
+                    }
+                    else if (loc[1] == 1)
+                    {
+                        // evisc * (dv/dz + dw/dy)
+                        const double eviscv = 0.25*(evisc[ijk-jj-kk1]+evisc[ijk-jj]+evisc[ijk-kk1]+evisc[ijk]);
+                        diff = -eviscv*( (data[ijk]-data[ijk-kk1])*dzhi[k] + (w[ijk]-w[ijk-jj])*dyi );
+                    }
+                    else
+                    {
+                        const double eviscs = 0.5*(evisc[ijk-kk1]+evisc[ijk])/tPr;
+                        diff = -eviscs*(data[ijk]-data[ijk-kk1])*dzhi[k];
+                    }
                 }
-        }
-    }
-    else
-    {
-        for (int k=grid->kstart+1; k<grid->kend; ++k)
-        {
-            prof[k] = 0.;
-            for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-                for (int i=grid->istart; i<grid->iend; ++i)
+
+                for (int n=mask_begin; n<mask_end; ++n)
                 {
-                    const int ijk = i + j*jj + k*kk;
-                    const double eviscs = 0.5*(evisc[ijk-kk]+evisc[ijk])/tPr;
-                    prof[k] += -mask[ijk]*eviscs*(data[ijk]-data[ijk-kk])*dzhi[k];
+                    const double wgt = mask_weight(bitsh[ijk], bitsh[ijk-shift], n);
+                    if (wgt == 0.)
+                        continue;
+                    grad_k[n] += wgt*grad;
+                    diff_k[n] += wgt*diff;
+                    if (have_flux)
+                    {
+                        if (is4th)
+                            flux_k[n] += wgt*datah;
+                        else
+                            flux_k[n] += wgt*(datah-0.5*(means[n][k-1]+means[n][k]))*(calcw[ijk]-wmeans[n][k]);
+                    }
                 }
-        }
-    }
+            }
 
-    // top boundary
-    prof[kend] = 0.;
-    for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=mask_begin; n<mask_end; ++n)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kend*kk;
-            prof[kend] += mask[ijk]*fluxtop[ij];
-        }
-
-    master->sum(prof, grid->kcells);
-
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
-}
-
-void Stats::add_fluxes(double* restrict flux, double* restrict turb, double* restrict diff)
-{
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        if (turb[k] == NC_FILL_DOUBLE || diff[k] == NC_FILL_DOUBLE)
-            flux[k] = NC_FILL_DOUBLE;
-        else
-            flux[k] = turb[k] + diff[k];
-    }
-}
-
-/**
- * This function calculates the total domain integrated path of variable data over maskbot
- */
-void Stats::calc_path(double* restrict data, double* restrict maskbot, int* restrict nmaskbot, double* restrict path)
-{
-    const int jj = grid->icells;
-    const int kk = grid->ijcells;
-    const int kstart = grid->kstart;
-
-    *path = 0.;
-
-    if (*nmaskbot > nthres)
-    {
-        // Integrate liquid water
-        for (int j=grid->jstart; j<grid->jend; j++)
-            for (int i=grid->istart; i<grid->iend; i++)
+            if (do_moments)
             {
-                const int ij = i + j*jj;
-                if (maskbot[ij] == 1)
-                    for (int k=kstart; k<grid->kend; k++)
-                    {
-                        const int ijk = i + j*jj + k*kk;
-                        *path += fields->rhoref[k] * data[ijk] * grid->dz[k];
-                    }
+                sums2[n][k] = m2[n];
+                if (sums3[n])
+                    sums3[n][k] = m3[n];
+                if (sums4[n])
+                    sums4[n][k] = m4[n];
             }
-        *path /= (double)*nmaskbot;
-        master->sum(path, 1);
+            if (have_flux)
+                sumsflux[n][k] = flux_k[n];
+            if (have_grad)
+                sumsgrad[n][k] = grad_k[n];
+            if (have_smagdiff)
+                sumsdiff[n][k] = diff_k[n];
+        }
     }
-    else
-        *path = NC_FILL_DOUBLE;
+
+    // with a constant viscosity the diffusive flux follows from the gradient
+    if (have_grad && !have_smagdiff && !diffname.empty())
+        for (int n=mask_begin; n<mask_end; ++n)
+        {
+            double* restrict sums = stage_prof(multimasks[n]->profs[diffname].data, &countsh[n*kcells], 1);
+            for (int k=1; k<kcells; ++k)
+                sums[k] = -visc*sumsgrad[n][k];
+        }
 }
 
-/**
- * This function calculates the vertical projected cover of variable data over maskbot
- */
-void Stats::calc_cover(double* restrict data, double* restrict maskbot, int* restrict nmaskbot, double* restrict cover, double threshold)
+void Stats::add_fluxes(std::string fluxname, std::string turbname, std::string diffname)
 {
-    const int jj = grid->icells;
-    const int kk = grid->ijcells;
-    const int kstart = grid->kstart;
-
-    *cover = 0.;
-
-    if (*nmaskbot > nthres)
+    // the total flux is computed once the turbulent and diffusive fluxes are reduced
+    for (int n=mask_begin; n<mask_end; ++n)
     {
-        // Per column, check if cloud present
-        for (int j=grid->jstart; j<grid->jend; j++)
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ij = i + j*jj;
-                if (maskbot[ij] == 1)
-                    for (int k=kstart; k<grid->kend; k++)
-                    {
-                        const int ijk = i + j*jj + k*kk;
-                        if (data[ijk]>threshold)
-                        {
-                            *cover += 1.;
-                            break;
-                        }
-                    }
-            }
-        *cover /= (double)*nmaskbot;
-        master->sum(cover,1);
+        Mask* m = multimasks[n];
+        Pending_flux f = {m->profs[fluxname].data, m->profs[turbname].data, m->profs[diffname].data};
+        pending_fluxes.push_back(f);
     }
-    else
-        *cover = NC_FILL_DOUBLE;
 }
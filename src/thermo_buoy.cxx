@@ -135,14 +135,14 @@ bool Thermo_buoy::check_field_exists(std::string name)
         return false;
 }
 
-void Thermo_buoy::calc_buoyancy(double* restrict b, double* restrict bin)
+void Thermo_buoy::calc_buoyancy(real* restrict b, real* restrict bin)
 {
     for (int n=0; n<grid->ncells; ++n)
         b[n] = bin[n];
 }
 
-void Thermo_buoy::calc_buoyancy_bot(double* restrict b  , double* restrict bbot,
-                                    double* restrict bin, double* restrict binbot)
+void Thermo_buoy::calc_buoyancy_bot(real* restrict b  , real* restrict bbot,
+                                    real* restrict bin, real* restrict binbot)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -159,7 +159,7 @@ void Thermo_buoy::calc_buoyancy_bot(double* restrict b  , double* restrict bbot,
         }
 }
 
-void Thermo_buoy::calc_buoyancy_fluxbot(double* restrict bfluxbot, double* restrict binfluxbot)
+void Thermo_buoy::calc_buoyancy_fluxbot(real* restrict bfluxbot, real* restrict binfluxbot)
 {
     const int jj = grid->icells;
 
@@ -172,22 +172,29 @@ void Thermo_buoy::calc_buoyancy_fluxbot(double* restrict bfluxbot, double* restr
         }
 }
 
-void Thermo_buoy::calc_buoyancy_tend_2nd(double* restrict wt, double* restrict b)
+void Thermo_buoy::calc_buoyancy_tend_2nd(real* restrict wt, real* restrict b)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                wt[ijk] += interp2(b[ijk-kk], b[ijk]);
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    wt[ijk] += interp2(b[ijk-kk], b[ijk]);
+                }
+        }
+    }
 }
 
-void Thermo_buoy::calc_buoyancy_tend_u_2nd(double* restrict ut, double* restrict b)
+void Thermo_buoy::calc_buoyancy_tend_u_2nd(real* restrict ut, real* restrict b)
 {
     const int ii1 = 1;
     const int jj  = grid->icells;
@@ -195,34 +202,48 @@ void Thermo_buoy::calc_buoyancy_tend_u_2nd(double* restrict ut, double* restrict
 
     const double sinalpha = std::sin(this->alpha);
     
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                ut[ijk] += sinalpha * interp2(b[ijk-ii1], b[ijk]);
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    ut[ijk] += sinalpha * interp2(b[ijk-ii1], b[ijk]);
+                }
+        }
+    }
 }
 
-void Thermo_buoy::calc_buoyancy_tend_w_2nd(double* restrict wt, double* restrict b)
+void Thermo_buoy::calc_buoyancy_tend_w_2nd(real* restrict wt, real* restrict b)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
 
     const double cosalpha = std::cos(this->alpha);
     
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                wt[ijk] += cosalpha * interp2(b[ijk-kk1], b[ijk]);
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    wt[ijk] += cosalpha * interp2(b[ijk-kk1], b[ijk]);
+                }
+        }
+    }
 }
 
-void Thermo_buoy::calc_buoyancy_tend_b_2nd(double* restrict bt, double* restrict u, double* restrict w)
+void Thermo_buoy::calc_buoyancy_tend_b_2nd(real* restrict bt, real* restrict u, real* restrict w)
 {
     const int ii1 = 1;
     const int jj  = 1*grid->icells;
@@ -233,34 +254,48 @@ void Thermo_buoy::calc_buoyancy_tend_b_2nd(double* restrict bt, double* restrict
     const double n2 = this->n2;
     const double utrans = grid->utrans;
     
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                bt[ijk] -= n2 * ( sinalpha * (interp2(u[ijk], u[ijk+ii1]) + utrans)
-                                + cosalpha *  interp2(w[ijk], w[ijk+kk1]) );
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    bt[ijk] -= n2 * ( sinalpha * (interp2(u[ijk], u[ijk+ii1]) + utrans)
+                                    + cosalpha *  interp2(w[ijk], w[ijk+kk1]) );
+                }
+        }
+    }
 }                                                  
 
-void Thermo_buoy::calc_buoyancy_tend_4th(double* restrict wt, double* restrict b)
+void Thermo_buoy::calc_buoyancy_tend_4th(real* restrict wt, real* restrict b)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                wt[ijk] += interp4(b[ijk-kk2], b[ijk-kk1], b[ijk], b[ijk+kk1]);
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    wt[ijk] += interp4(b[ijk-kk2], b[ijk-kk1], b[ijk], b[ijk+kk1]);
+                }
+        }
+    }
 }
 
-void Thermo_buoy::calc_buoyancy_tend_u_4th(double* restrict ut, double* restrict b)
+void Thermo_buoy::calc_buoyancy_tend_u_4th(real* restrict ut, real* restrict b)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -269,17 +304,24 @@ void Thermo_buoy::calc_buoyancy_tend_u_4th(double* restrict ut, double* restrict
 
     const double sinalpha = std::sin(this->alpha);
     
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                ut[ijk] += sinalpha * interp4(b[ijk-ii2], b[ijk-ii1], b[ijk], b[ijk+ii1]);
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    ut[ijk] += sinalpha * interp4(b[ijk-ii2], b[ijk-ii1], b[ijk], b[ijk+ii1]);
+                }
+        }
+    }
 }
 
-void Thermo_buoy::calc_buoyancy_tend_w_4th(double* restrict wt, double* restrict b)
+void Thermo_buoy::calc_buoyancy_tend_w_4th(real* restrict wt, real* restrict b)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
@@ -287,17 +329,24 @@ void Thermo_buoy::calc_buoyancy_tend_w_4th(double* restrict wt, double* restrict
 
     const double cosalpha = std::cos(this->alpha);
     
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                wt[ijk] += cosalpha * interp4(b[ijk-kk2], b[ijk-kk1], b[ijk], b[ijk+kk1]);
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    wt[ijk] += cosalpha * interp4(b[ijk-kk2], b[ijk-kk1], b[ijk], b[ijk+kk1]);
+                }
+        }
+    }
 }
 
-void Thermo_buoy::calc_buoyancy_tend_b_4th(double* restrict bt, double* restrict u, double* restrict w)
+void Thermo_buoy::calc_buoyancy_tend_b_4th(real* restrict bt, real* restrict u, real* restrict w)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -310,13 +359,20 @@ void Thermo_buoy::calc_buoyancy_tend_b_4th(double* restrict bt, double* restrict
     const double n2 = this->n2;
     const double utrans = grid->utrans;
     
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                bt[ijk] -= n2 * ( sinalpha * (interp4(u[ijk-ii1], u[ijk], u[ijk+ii1], u[ijk+ii2]) + utrans)
-                                + cosalpha *  interp4(w[ijk-kk1], w[ijk], w[ijk+kk1], w[ijk+kk2]) );
-            }
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    bt[ijk] -= n2 * ( sinalpha * (interp4(u[ijk-ii1], u[ijk], u[ijk+ii1], u[ijk+ii2]) + utrans)
+                                    + cosalpha *  interp4(w[ijk-kk1], w[ijk], w[ijk+kk1], w[ijk+kk2]) );
+                }
+        }
+    }
 }
@@ -114,12 +114,12 @@ void Thermo_dry::init()
     stats = model->stats;
 
     // fields for Boussinesq and anelastic solver
-    thref   = new double[grid->kcells];
-    threfh  = new double[grid->kcells];
-    pref    = new double[grid->kcells];
-    prefh   = new double[grid->kcells];
-    exnref  = new double[grid->kcells];
-    exnrefh = new double[grid->kcells];
+    thref   = new real[grid->kcells];
+    threfh  = new real[grid->kcells];
+    pref    = new real[grid->kcells];
+    prefh   = new real[grid->kcells];
+    exnref  = new real[grid->kcells];
+    exnrefh = new real[grid->kcells];
 
     init_cross();
     init_dump(); 
@@ -180,63 +180,28 @@ void Thermo_dry::exec_stats(Mask *m)
     // define the location
     const int sloc[] = {0,0,0};
 
-    // calculate the mean
-    stats->calc_mean(m->profs["b"].data, fields->atmp["tmp1"]->data, NoOffset, sloc,
-                     fields->atmp["tmp3"]->data, stats->nmask);
+    // calculate the mean, which the moments and fluxes need after its reduction
+    stats->calc_mean("b", fields->atmp["tmp1"]->data, NoOffset, sloc);
+    stats->reduce_profs();
 
-    // calculate the moments
-    for (int n=2; n<5; ++n)
+    // calculate the moments and the turbulent and diffusive fluxes, the diffusivity of buoyancy is taken from temperature
+    real* evisc = 0;
+    double tPr = 1.;
+    if (model->diff->get_switch() == "smag2")
     {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(fields->atmp["tmp1"]->data, m->profs["b"].data, m->profs["b"+sn].data, n, sloc,
-                           fields->atmp["tmp3"]->data, stats->nmask);
+        evisc = fields->sd["evisc"]->data;
+        tPr = static_cast<Diff_smag_2*>(model->diff)->tPr;
     }
 
-    // calculate the gradients
-    if (grid->swspatialorder == "2")
-        stats->calc_grad_2nd(fields->atmp["tmp1"]->data, m->profs["bgrad"].data, grid->dzhi, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-    else if (grid->swspatialorder == "4")
-        stats->calc_grad_4th(fields->atmp["tmp1"]->data, m->profs["bgrad"].data, grid->dzhi4, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-
-    // calculate turbulent fluxes
-    if (grid->swspatialorder == "2")
-        stats->calc_flux_2nd(fields->atmp["tmp1"]->data, m->profs["b"].data, fields->w->data, m->profs["w"].data,
-                             m->profs["bw"].data, fields->atmp["tmp2"]->data, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-    else if (grid->swspatialorder == "4")
-        stats->calc_flux_4th(fields->atmp["tmp1"]->data, fields->w->data, m->profs["bw"].data, fields->atmp["tmp2"]->data, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-
-    // calculate diffusive fluxes
-    if (grid->swspatialorder == "2")
-    {
-        if (model->diff->get_switch() == "smag2")
-        {
-            Diff_smag_2* diffptr = static_cast<Diff_smag_2*>(model->diff);
-            stats->calc_diff_2nd(fields->atmp["tmp1"]->data, fields->w->data, fields->sd["evisc"]->data,
-                                 m->profs["bdiff"].data, grid->dzhi,
-                                 fields->atmp["tmp1"]->datafluxbot, fields->atmp["tmp1"]->datafluxtop, diffptr->tPr, sloc,
-                                 fields->atmp["tmp4"]->data, stats->nmaskh);
-        }
-        else
-            stats->calc_diff_2nd(fields->atmp["tmp1"]->data, m->profs["bdiff"].data, grid->dzhi, fields->sp["th"]->visc, sloc,
-                                 fields->atmp["tmp4"]->data, stats->nmaskh);
-    }
-    else if (grid->swspatialorder == "4")
-    {
-        stats->calc_diff_4th(fields->atmp["tmp1"]->data, m->profs["bdiff"].data, grid->dzhi4, fields->sp["th"]->visc, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-    }
+    stats->calc_moments_fluxes(fields->atmp["tmp1"]->data, "b", NoOffset, "b2", "b3", "b4",
+                               fields->w->data, fields->atmp["tmp2"]->data, "bw", "bgrad", "bdiff", fields->sp["th"]->visc,
+                               evisc, fields->atmp["tmp1"]->datafluxbot, fields->atmp["tmp1"]->datafluxtop, tPr, sloc);
 
     // calculate the total fluxes
-    stats->add_fluxes(m->profs["bflux"].data, m->profs["bw"].data, m->profs["bdiff"].data);
+    stats->add_fluxes("bflux", "bw", "bdiff");
 
     // calculate the sorted buoyancy profile
-    //stats->calc_sorted_prof(fields->sd["tmp1"]->data, fields->sd["tmp2"]->data, m->profs["bsort"].data);
+    //stats->calc_sorted_prof(fields->sd["tmp1"]->data, m->profs["bsort"].data);
 }
 
 void Thermo_dry::exec_cross()
@@ -345,26 +310,34 @@ double Thermo_dry::get_buoyancy_diffusivity()
     return fields->sp["th"]->visc; 
 }
 
-void Thermo_dry::calc_buoyancy(double* restrict b, double* restrict th, double* restrict thref)
+void Thermo_dry::calc_buoyancy(real* restrict b, real* restrict th, real* restrict thref)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    for (int k=0; k<grid->kcells; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=0; k<grid->kcells; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                b[ijk] = grav/thref[k] * (th[ijk] - thref[k]);
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    b[ijk] = grav/thref[k] * (th[ijk] - thref[k]);
+                }
+        }
+    }
 }
 
-void Thermo_dry::calc_N2(double* restrict N2, double* restrict th, double* restrict dzi, double* restrict thref)
+void Thermo_dry::calc_N2(real* restrict N2, real* restrict th, real* restrict dzi, real* restrict thref)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
@@ -375,9 +348,9 @@ void Thermo_dry::calc_N2(double* restrict N2, double* restrict th, double* restr
             }
 }
 
-void Thermo_dry::calc_buoyancy_bot(double* restrict b , double* restrict bbot,
-                                   double* restrict th, double* restrict thbot,
-                                   double* restrict thref, double* restrict threfh)
+void Thermo_dry::calc_buoyancy_bot(real* restrict b , real* restrict bbot,
+                                   real* restrict th, real* restrict thbot,
+                                   real* restrict thref, real* restrict threfh)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -394,7 +367,7 @@ void Thermo_dry::calc_buoyancy_bot(double* restrict b , double* restrict bbot,
         }
 }
 
-void Thermo_dry::calc_buoyancy_fluxbot(double* restrict bfluxbot, double* restrict thfluxbot, double* restrict threfh)
+void Thermo_dry::calc_buoyancy_fluxbot(real* restrict bfluxbot, real* restrict thfluxbot, real* restrict threfh)
 {
     const int jj = grid->icells;
     const int kstart = grid->kstart;
@@ -408,44 +381,58 @@ void Thermo_dry::calc_buoyancy_fluxbot(double* restrict bfluxbot, double* restri
         }
 }
 
-void Thermo_dry::calc_buoyancy_tend_2nd(double* restrict wt, double* restrict th, double* restrict threfh)
+void Thermo_dry::calc_buoyancy_tend_2nd(real* restrict wt, real* restrict th, real* restrict threfh)
 {
     using namespace Finite_difference::O2;
 
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                wt[ijk] += grav/threfh[k] * (interp2(th[ijk-kk], th[ijk]) - threfh[k]);
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    wt[ijk] += grav/threfh[k] * (interp2(th[ijk-kk], th[ijk]) - threfh[k]);
+                }
+        }
+    }
 }
 
-void Thermo_dry::calc_buoyancy_tend_4th(double* restrict wt, double* restrict th, double* restrict threfh)
+void Thermo_dry::calc_buoyancy_tend_4th(real* restrict wt, real* restrict th, real* restrict threfh)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
+    {
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        {
+            for (int j=t->jstart; j<t->jend; ++j)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                wt[ijk] += grav/threfh[k] * (interp4(th[ijk-kk2], th[ijk-kk1], th[ijk], th[ijk+kk1]) - threfh[k]);
-            }
+                for (int i=t->istart; i<t->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    wt[ijk] += grav/threfh[k] * (interp4(th[ijk-kk2], th[ijk-kk1], th[ijk], th[ijk+kk1]) - threfh[k]);
+                }
+        }
+    }
 }
 
 // Initialize the base state for the anelastic solver
-void Thermo_dry::calc_base_state(double* restrict rhoref, double* restrict rhorefh,
-                                 double* restrict pref,   double* restrict prefh,
-                                 double* restrict exnref, double* restrict exnrefh,
-                                 double* restrict thref,  double* restrict threfh,
+void Thermo_dry::calc_base_state(real* restrict rhoref, real* restrict rhorefh,
+                                 real* restrict pref,   real* restrict prefh,
+                                 real* restrict exnref, real* restrict exnrefh,
+                                 real* restrict thref,  real* restrict threfh,
                                  const double pbot)
 {
     const int kstart = grid->kstart;
@@ -38,29 +38,6 @@ namespace
     using namespace Finite_difference::O4;
     using namespace Thermo_moist_functions;
 
-    __device__ double sat_adjust_g(const double s, const double qt,
-                                   const double p, const double exn)
-    {
-        double tl = s * exn;  // Liquid water temperature
-
-        // Calculate if q-qs(Tl) <= 0. If so, return 0. Else continue with saturation adjustment
-        if(qt-qsat(p, tl) <= 0)
-            return 0.;
-
-        int niter = 0; //, nitermax = 5;
-        double ql, tnr_old = 1.e9, tnr, qs;
-        tnr = tl;
-        while (fabs(tnr-tnr_old)/tnr_old> 1e-5)// && niter < nitermax)
-        {
-            ++niter;
-            tnr_old = tnr;
-            qs = qsat(p,tnr);
-            tnr = tnr - (tnr+(Lv/cp)*qs-tl-(Lv/cp)*qt)/(1+(pow(Lv,2)*qs)/ (Rv*cp*pow(tnr,2)));
-        }
-        ql = fmax(0.,qt-qs);
-        return ql;
-    }
-
     __global__ 
     void calc_buoyancy_tend_2nd_g(double* __restrict__ wt, double* __restrict__ th, double* __restrict__ qt,
                                   double* __restrict__ thvrefh, double* __restrict__ exnh, double* __restrict__ ph,  
@@ -79,7 +56,7 @@ namespace
             // Half level temperature and moisture content
             const double thh = 0.5 * (th[ijk-kk] + th[ijk]);         // Half level liq. water pot. temp.
             const double qth = 0.5 * (qt[ijk-kk] + qt[ijk]);         // Half level specific hum.
-            const double ql  = sat_adjust_g(thh, qth, ph[k], exnh[k]); // Half level liquid water content
+            const double ql  = sat_adjust(thh, qth, ph[k], exnh[k]); // Half level liquid water content
 
             // Calculate tendency
             if (ql > 0) 
@@ -104,7 +81,7 @@ namespace
         if (i < iend && j < jend && k < kcells)
         {
             const int ijk   = i + j*jj + k*kk;
-            const double ql = sat_adjust_g(th[ijk], qt[ijk], p[k], exn[k]);
+            const double ql = sat_adjust(th[ijk], qt[ijk], p[k], exn[k]);
 
             if (ql > 0)
                 b[ijk] = buoyancy(exn[k], th[ijk], qt[ijk], ql, thvref[k]);
@@ -184,7 +161,7 @@ namespace
         if (i < iend && j < jend && k < kend)
         {
             const int ijk = i + j*jj + k*kk;
-            ql[ijk] = sat_adjust_g(th[ijk], qt[ijk], p[k], exn[k]);
+            ql[ijk] = sat_adjust(th[ijk], qt[ijk], p[k], exn[k]);
         }
     }
 
@@ -216,7 +193,7 @@ namespace
 
         // Calculate surface (half=kstart) values
         exh[kstart]   = exner_g(pbot);
-        ql            = sat_adjust_g(ssurf,qtsurf,pbot,exh[kstart]); 
+        ql            = sat_adjust(ssurf,qtsurf,pbot,exh[kstart]); 
         thvh[kstart]  = (ssurf + Lv*ql/(cp*exh[kstart])) * (1. - (1. - Rv/Rd)*qtsurf - Rv/Rd*ql);
         prefh[kstart] = pbot;
         rhoh[kstart]  = pbot / (Rd * exh[kstart] * thvh[kstart]);
@@ -228,7 +205,7 @@ namespace
         {
             // 1. Calculate values at full level below zh[k] 
             ex[k-1]  = exner_g(pref[k-1]);
-            ql       = sat_adjust_g(thlmean[k-1],qtmean[k-1],pref[k-1],ex[k-1]); 
+            ql       = sat_adjust(thlmean[k-1],qtmean[k-1],pref[k-1],ex[k-1]); 
             thv[k-1] = (thlmean[k-1] + Lv*ql/(cp*ex[k-1])) * (1. - (1. - Rv/Rd)*qtmean[k-1] - Rv/Rd*ql); 
             rho[k-1] = pref[k-1] / (Rd * ex[k-1] * thv[k-1]);
 
@@ -248,7 +225,7 @@ namespace
             }
 
             exh[k]   = exner_g(prefh[k]);
-            qli      = sat_adjust_g(si,qti,prefh[k],exh[k]);
+            qli      = sat_adjust(si,qti,prefh[k],exh[k]);
             thvh[k]  = (si + Lv*qli/(cp*exh[k])) * (1. - (1. - Rv/Rd)*qti - Rv/Rd*qli); 
             rhoh[k]  = prefh[k] / (Rd * exh[k] * thvh[k]); 
 
@@ -296,7 +273,7 @@ namespace
         }
 
         // Calculate surface (half=kstart) values
-        ql            = sat_adjust_g(ssurf,qtsurf,pbot,exh[kstart]); 
+        ql            = sat_adjust(ssurf,qtsurf,pbot,exh[kstart]); 
         thvh          = (ssurf + Lv*ql/(cp*exh[kstart])) * (1. - (1. - Rv/Rd)*qtsurf - Rv/Rd*ql);
         prefh[kstart] = pbot;
 
@@ -307,7 +284,7 @@ namespace
         {
             // 1. Calculate values at full level below zh[k] 
             ex[k-1]  = exner_g(pref[k-1]);
-            ql       = sat_adjust_g(thlmean[k-1],qtmean[k-1],pref[k-1],ex[k-1]); 
+            ql       = sat_adjust(thlmean[k-1],qtmean[k-1],pref[k-1],ex[k-1]); 
             thv      = (thlmean[k-1] + Lv*ql/(cp*ex[k-1])) * (1. - (1. - Rv/Rd)*qtmean[k-1] - Rv/Rd*ql); 
 
             // 2. Calculate half level pressure at zh[k] using values at z[k-1]
@@ -326,7 +303,7 @@ namespace
             }
 
             exh[k]   = exner_g(prefh[k]);
-            qli      = sat_adjust_g(si,qti,prefh[k],exh[k]);
+            qli      = sat_adjust(si,qti,prefh[k],exh[k]);
             thvh     = (si + Lv*qli/(cp*exh[k])) * (1. - (1. - Rv/Rd)*qti - Rv/Rd*qli); 
 
             // 4. Calculate full level pressure at z[k]
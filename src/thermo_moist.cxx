@@ -26,6 +26,9 @@
 #include <sstream>
 #include <algorithm>
 #include <netcdf>
+#ifdef USEOPENMP
+#include <omp.h>
+#endif
 #include "grid.h"
 #include "fields.h"
 #include "thermo_moist.h"
@@ -39,70 +42,23 @@
 #include "cross.h"
 #include "dump.h"
 #include "thermo_moist_functions.h"
+#include "rain_functions.h"
 #include "timeloop.h"
 
 using Finite_difference::O2::interp2;
 using Finite_difference::O4::interp4;
 using namespace Constants;
 using namespace Thermo_moist_functions;
+using namespace Rain_functions;
 
 namespace
 {
     // Settings for now here for convenience....
-    const double pi      = std::acos(-1.);
     const double Nc0     = 70e6;     // Fixed cloud droplet number
     const double K_t     = 2.5e-2;   // Conductivity of heat [J/(sKm)]
     const double D_v     = 3.e-5;    // Diffusivity of water vapor [m2/s]
-    const double rho_w   = 1.e3;     // Density water
     const double rho_0   = 1.225;    // SB06, p48
-    const double pirhow  = pi * rho_w / 6.;
-    const double mc_min  = 4.2e-15;  // Min mean mass of cloud droplet
-    const double mc_max  = 2.6e-10;  // Max mean mass of cloud droplet
-    const double mr_min  = mc_max;   // Min mean mass of precipitation drop
-    const double mr_max  = 3e-6;     // Max mean mass of precipitation drop // as in UCLA-LES
     const double ql_min  = 1.e-6;    // Min cloud liquid water for which calculations are performed 
-    const double qr_min  = 1.e-15;   // Min rain liquid water for which calculations are performed 
-
-    // Rational tanh approximation  
-    inline double tanh2(const double x)
-    {
-        return x * (27 + x * x) / (27 + 9 * x * x);
-    }
-
-    // Given rain water content (qr), number density (nr) and density (rho)
-    // calculate mean mass of rain drop
-    inline double calc_rain_mass(const double qr, const double nr, const double rho)
-    {
-        //double mr = rho * qr / (nr + dsmall);
-        double mr = rho * qr / std::max(nr, 1.);
-        mr        = std::min(std::max(mr, mr_min), mr_max);
-        return mr;
-    }
-
-    // Given mean mass rain drop, calculate mean diameter
-    inline double calc_rain_diameter(const double mr)
-    {
-        return pow(mr/pirhow, 1./3.);
-    }
-
-    // Shape parameter mu_r
-    inline double calc_mu_r(const double dr)
-    {
-        //return 1./3.; // SB06
-        //return 10. * (1. + tanh(1200 * (dr - 0.0015))); // SS08 (Milbrandt&Yau, 2005) -> similar as UCLA
-        return 10. * (1. + tanh2(1200 * (dr - 0.0015))); // SS08 (Milbrandt&Yau, 2005) -> similar as UCLA
-    }
-
-    // Slope parameter lambda_r
-    inline double calc_lambda_r(const double mur, const double dr)
-    {
-        return pow((mur+3)*(mur+2)*(mur+1), 1./3.) / dr;
-    }
-
-    inline double minmod(const double a, const double b)
-    {
-        return copysign(1., a) * std::max(0., std::min(std::abs(a), copysign(1., a)*b));
-    }
 
     inline double min3(const double a, const double b, const double c)
     {
@@ -119,10 +75,11 @@ namespace
 namespace mp2d
 {
     // Calculate microphysics properties which are used in multiple routines
-    void prepare_microphysics_slice(double* const restrict rain_mass, double* const restrict rain_diameter,
-                                    double* const restrict mu_r, double* const restrict lambda_r,
-                                    const double* const restrict qr, const double* const restrict nr,
-                                    const double* const restrict rho, 
+    // With rain_table set, the drop size distribution is interpolated from the lookup tables
+    void prepare_microphysics_slice(real* const restrict rain_mass, real* const restrict rain_diameter,
+                                    real* const restrict mu_r, real* const restrict lambda_r,
+                                    const real* const restrict qr, const real* const restrict nr,
+                                    const real* const restrict rho, const double* const restrict rain_table,
                                     const int istart, const int iend,
                                     const int kstart, const int kend,
                                     const int icells, const int ijcells, const int j)
@@ -135,7 +92,15 @@ namespace mp2d
                 const int ijk = i + j*icells + k*ijcells;
                 const int ik  = i + k*icells;
 
-                if(qr[ijk] > qr_min)
+                if(qr[ijk] > qr_min && rain_table)
+                {
+                    rain_mass[ik]     = calc_rain_mass(qr[ijk], nr[ijk], rho[k]); 
+                    const double index = calc_rain_table_index(rain_mass[ik]);
+                    rain_diameter[ik] = interp_rain_table(rain_table, Dr_column,      index);
+                    mu_r[ik]          = interp_rain_table(rain_table, Mur_column,     index);
+                    lambda_r[ik]      = interp_rain_table(rain_table, Lambdar_column, index);
+                }
+                else if(qr[ijk] > qr_min)
                 {
                     rain_mass[ik]     = calc_rain_mass(qr[ijk], nr[ijk], rho[k]); 
                     rain_diameter[ik] = calc_rain_diameter(rain_mass[ik]);
@@ -153,12 +118,12 @@ namespace mp2d
     }
 
     // Evaporation: evaporation of rain drops in unsaturated environment
-    void evaporation(double* const restrict qrt, double* const restrict nrt,
-                     double* const restrict qtt, double* const restrict thlt,
-                     const double* const restrict qr, const double* const restrict nr,
-                     const double* const restrict ql, const double* const restrict qt, const double* const restrict thl, 
-                     const double* const restrict rho, const double* const restrict exner, const double* const restrict p,
-                     const double* const restrict rain_mass, const double* const restrict rain_diameter,
+    void evaporation(real* const restrict qrt, real* const restrict nrt,
+                     real* const restrict qtt, real* const restrict thlt,
+                     const real* const restrict qr, const real* const restrict nr,
+                     const real* const restrict ql, const real* const restrict qt, const real* const restrict thl, 
+                     const real* const restrict rho, const real* const restrict exner, const real* const restrict p,
+                     const real* const restrict rain_mass, const real* const restrict rain_diameter,
                      const int istart, const int jstart, const int kstart,
                      const int iend,   const int jend,   const int kend,
                      const int jj, const int kk, const int j)
@@ -194,9 +159,9 @@ namespace mp2d
     }
 
     // Selfcollection & breakup: growth of raindrops by mutual (rain-rain) coagulation, and breakup by collisions
-    void selfcollection_breakup(double* const restrict nrt, const double* const restrict qr, const double* const restrict nr, const double* const restrict rho,
-                                const double* const restrict rain_mass, const double* const restrict rain_diameter,
-                                const double* const restrict lambda_r,
+    void selfcollection_breakup(real* const restrict nrt, const real* const restrict qr, const real* const restrict nr, const real* const restrict rho,
+                                const real* const restrict rain_mass, const real* const restrict rain_diameter,
+                                const real* const restrict lambda_r,
                                 const int istart, const int jstart, const int kstart,
                                 const int iend,   const int jend,   const int kend,
                                 const int jj, const int kk, const int j)
@@ -241,194 +206,28 @@ namespace mp2d
             }
     }
 
-    // Sedimentation from Stevens and Seifert (2008)
-    void sedimentation_ss08(double* const restrict qrt, double* const restrict nrt, 
-                            double* const restrict tmpxz1, double* const restrict tmpxz2,
-                            double* const restrict tmpxz3, double* const restrict tmpxz4,
-                            double* const restrict tmpxz5, double* const restrict tmpxz6,
-                            const double* const restrict mu_r, const double* const restrict lambda_r,
-                            const double* const restrict qr, const double* const restrict nr, 
-                            const double* const restrict rho, const double* const restrict dzi,
-                            const double* const restrict dz, const double dt,
-                            const int istart, const int jstart, const int kstart,
-                            const int iend,   const int jend,   const int kend,
-                            const int icells, const int kcells, const int ijcells, const int j)
-    {
-        const double w_max = 9.65; // 9.65=UCLA, 20=SS08, appendix A
-        const double a_R = 9.65;   // SB06, p51
-        const double c_R = 600;    // SB06, p51
-        const double Dv  = 25.0e-6;
-        const double b_R = a_R * exp(c_R*Dv); // UCLA-LES
-
-        const int ikcells = icells * kcells;
-
-        const int kk3d = ijcells;
-        const int kk2d = icells;
-
-        // 1. Calculate sedimentation velocity at cell center
-        double* restrict w_qr = tmpxz1;
-        double* restrict w_nr = tmpxz2;
-
-        for (int k=kstart; k<kend; k++)
-        {
-            const double rho_n = pow(1.2 / rho[k], 0.5);
-            #pragma ivdep
-            for (int i=istart; i<iend; i++)
-            {
-                const int ijk = i + j*icells + k*ijcells;
-                const int ik  = i + k*icells;
-              
-                if(qr[ijk] > qr_min)
-                {
-                    // SS08:
-                    w_qr[ik] = std::min(w_max, std::max(0.1, rho_n * a_R - b_R * pow(1. + c_R/lambda_r[ik], -1.*(mu_r[ik]+4))));
-                    w_nr[ik] = std::min(w_max, std::max(0.1, rho_n * a_R - b_R * pow(1. + c_R/lambda_r[ik], -1.*(mu_r[ik]+1))));
-                }
-                else
-                {
-                    w_qr[ik] = 0.;
-                    w_nr[ik] = 0.;
-                }
-            }
-        }
-
-        // 1.1 Set one ghost cell to zero
-        for (int i=istart; i<iend; i++)
-        {
-            const int ik1  = i + (kstart-1)*icells;
-            const int ik2  = i + (kend    )*icells;
-            w_qr[ik1] = w_qr[ik1+kk2d];
-            w_nr[ik1] = w_nr[ik1+kk2d];
-            w_qr[ik2] = 0;
-            w_nr[ik2] = 0;
-        } 
-
-         // 2. Calculate CFL number using interpolated sedimentation velocity
-        double* restrict c_qr = tmpxz3;
-        double* restrict c_nr = tmpxz4;
-
-        for (int k=kstart; k<kend; k++)
-            #pragma ivdep
-            for (int i=istart; i<iend; i++)
-            {
-                const int ik  = i + k*icells;
-                c_qr[ik] = 0.25 * (w_qr[ik-kk2d] + 2.*w_qr[ik] + w_qr[ik+kk2d]) * dzi[k] * dt; 
-                c_nr[ik] = 0.25 * (w_nr[ik-kk2d] + 2.*w_nr[ik] + w_nr[ik+kk2d]) * dzi[k] * dt; 
-            }
-
-        // 3. Calculate slopes
-        double* restrict slope_qr = tmpxz1;
-        double* restrict slope_nr = tmpxz2;
-
-        for (int k=kstart; k<kend; k++)
-            #pragma ivdep
-            for (int i=istart; i<iend; i++)
-            {
-                const int ijk = i + j*icells + k*ijcells;
-                const int ik  = i + k*icells;
-
-                slope_qr[ik] = minmod(qr[ijk]-qr[ijk-kk3d], qr[ijk+kk3d]-qr[ijk]);
-                slope_nr[ik] = minmod(nr[ijk]-nr[ijk-kk3d], nr[ijk+kk3d]-nr[ijk]);
-            }
-
-        // Calculate flux
-        double* restrict flux_qr = tmpxz5;
-        double* restrict flux_nr = tmpxz6;
-
-        // Set the fluxes at the top of the domain (kend) to zero
-        for (int i=istart; i<iend; i++)
-        {
-            const int ik  = i + kend*icells;
-            flux_qr[ik] = 0;
-            flux_nr[ik] = 0;
-        } 
-
-        for (int k=kend-1; k>kstart-1; k--)
-            #pragma ivdep
-            for (int i=istart; i<iend; i++)
-            {    
-                const int ijk = i + j*icells + k*ijcells;
-                const int ik  = i + k*icells;
-
-                int kk;
-                double ftot, dzz, cc;
-
-                // q_rain
-                kk    = k;  // current grid level
-                ftot  = 0;  // cumulative 'flux' (kg m-2) 
-                dzz   = 0;  // distance from zh[k]
-                cc    = std::min(1., c_qr[ik]);
-                while (cc > 0 && kk < kend)
-                {
-                    const int ikk  = i + kk*icells;
-                    const int ijkk = i + j*icells + kk*ijcells;
-
-                    ftot  += rho[kk] * (qr[ijkk] + 0.5 * slope_qr[ikk] * (1.-cc)) * cc * dz[kk];
-
-                    dzz   += dz[kk];
-                    kk    += 1;
-                    cc     = std::min(1., c_qr[ikk] - dzz*dzi[kk]);
-                }
-
-                // Given flux at top, limit bottom flux such that the total rain content stays >= 0.
-                ftot = std::min(ftot, rho[k] * dz[k] * qr[ijk] - flux_qr[ik+icells] * dt);
-                flux_qr[ik] = -ftot / dt;
-
-                // number density
-                kk    = k;  // current grid level
-                ftot  = 0;  // cumulative 'flux'
-                dzz   = 0;  // distance from zh[k]
-                cc    = std::min(1., c_nr[ik]);
-                while (cc > 0 && kk < kend)
-                {    
-                    const int ikk  = i + kk*icells;
-                    const int ijkk = i + j*icells + kk*ijcells;
-
-                    ftot += rho[kk] * (nr[ijkk] + 0.5 * slope_nr[ikk] * (1.-cc)) * cc * dz[kk];
-
-                    dzz   += dz[kk];
-                    kk    += 1;
-                    cc     = std::min(1., c_nr[ikk] - dzz*dzi[k]);
-                }
-
-                // Given flux at top, limit bottom flux such that the number density stays >= 0.
-                ftot = std::min(ftot, rho[k] * dz[k] * nr[ijk] - flux_nr[ik+icells] * dt);
-                flux_nr[ik] = -ftot / dt;
-            }
-
-        // Calculate tendency
-        for (int k=kstart; k<kend; k++)
-            #pragma ivdep
-            for (int i=istart; i<iend; i++)
-            {    
-                const int ijk = i + j*icells + k*ijcells;
-                const int ik  = i + k*icells;
-
-                qrt[ijk] += -(flux_qr[ik+kk2d] - flux_qr[ik]) / rho[k] * dzi[k]; 
-                nrt[ijk] += -(flux_nr[ik+kk2d] - flux_nr[ik]) / rho[k] * dzi[k]; 
-            }
-    }
 }
 
 namespace mp
 {
     // Remove negative values from 3D field
-    void remove_neg_values(double* const restrict field,
+    void remove_neg_values(real* const restrict field,
                            const int istart, const int jstart, const int kstart,
                            const int iend,   const int jend,   const int kend,
                            const int jj, const int kk)
     {
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
                 for (int i=istart; i<iend; i++)
                 {
                     const int ijk = i + j*jj + k*kk;
-                    field[ijk] = std::max(0., field[ijk]);
+                    field[ijk] = std::max(real(0.), field[ijk]);
                 }
     }
 
-    void zero(double* const restrict field, const int ncells)
+    void zero(real* const restrict field, const int ncells)
     {
         for (int n=0; n<ncells; ++n)
             field[n] = 0.;
@@ -436,10 +235,10 @@ namespace mp
 
 
     // Autoconversion: formation of rain drop by coagulating cloud droplets
-    void autoconversion(double* const restrict qrt, double* const restrict nrt,
-                        double* const restrict qtt, double* const restrict thlt,
-                        const double* const restrict qr,  const double* const restrict ql, 
-                        const double* const restrict rho, const double* const restrict exner,
+    void autoconversion(real* const restrict qrt, real* const restrict nrt,
+                        real* const restrict qtt, real* const restrict thlt,
+                        const real* const restrict qr,  const real* const restrict ql, 
+                        const real* const restrict rho, const real* const restrict exner,
                         const int istart, const int jstart, const int kstart,
                         const int iend,   const int jend,   const int kend,
                         const int jj, const int kk)
@@ -449,6 +248,7 @@ namespace mp
         const double nu_c   = 1;             // SB06, Table 1., same as UCLA-LES
         const double kccxs  = k_cc / (20. * x_star) * (nu_c+2)*(nu_c+4) / pow(nu_c+1, 2); 
 
+        // called per xz-slice by the threads, so not threaded itself
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -473,17 +273,18 @@ namespace mp
     }
 
     // Evaporation: evaporation of rain drops in unsaturated environment
-    void evaporation(double* const restrict qrt, double* const restrict nrt,
-                     double* const restrict qtt, double* const restrict thlt,
-                     const double* const restrict qr, const double* const restrict nr,
-                     const double* const restrict ql, const double* const restrict qt, const double* const restrict thl, 
-                     const double* const restrict rho, const double* const restrict exner, const double* const restrict p,
+    void evaporation(real* const restrict qrt, real* const restrict nrt,
+                     real* const restrict qtt, real* const restrict thlt,
+                     const real* const restrict qr, const real* const restrict nr,
+                     const real* const restrict ql, const real* const restrict qt, const real* const restrict thl, 
+                     const real* const restrict rho, const real* const restrict exner, const real* const restrict p,
                      const int istart, const int jstart, const int kstart,
                      const int iend,   const int jend,   const int kend,
                      const int jj, const int kk)
     {
         const double lambda_evap = 1.; // 1.0 in UCLA, 0.7 in DALES
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -513,15 +314,16 @@ namespace mp
     }
 
     // Accreation: growth of raindrops collecting cloud droplets
-    void accretion(double* const restrict qrt, double* const restrict qtt, double* const restrict thlt,
-                   const double* const restrict qr,  const double* const restrict ql, 
-                   const double* const restrict rho, const double* const restrict exner,
+    void accretion(real* const restrict qrt, real* const restrict qtt, real* const restrict thlt,
+                   const real* const restrict qr,  const real* const restrict ql, 
+                   const real* const restrict rho, const real* const restrict exner,
                    const int istart, const int jstart, const int kstart,
                    const int iend,   const int jend,   const int kend,
                    const int jj, const int kk)
     {
         const double k_cr  = 5.25; // SB06, p49
 
+        // called per xz-slice by the threads, so not threaded itself
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -543,7 +345,7 @@ namespace mp
 
 
     // Selfcollection & breakup: growth of raindrops by mutual (rain-rain) coagulation, and breakup by collisions
-    void selfcollection_breakup(double* const restrict nrt, const double* const restrict qr, const double* const restrict nr, const double* const restrict rho,
+    void selfcollection_breakup(real* const restrict nrt, const real* const restrict qr, const real* const restrict nr, const real* const restrict rho,
                                 const int istart, const int jstart, const int kstart,
                                 const int iend,   const int jend,   const int kend,
                                 const int jj, const int kk)
@@ -554,6 +356,7 @@ namespace mp
         const double k_br1    = 1.0e3;  // SB06, p50, for 0.35e-3 <= Dr <= D_eq
         const double k_br2    = 2.3e3;  // SB06, p50, for Dr > D_eq
 
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -588,203 +391,19 @@ namespace mp
                 }
     }
 
-    // Sedimentation from Stevens and Seifert (2008)
-    void sedimentation_ss08(double* const restrict qrt, double* const restrict nrt, 
-                            double* const restrict tmp1, double* const restrict tmp2,
-                            const double* const restrict qr, const double* const restrict nr, 
-                            const double* const restrict rho, const double* const restrict dzi,
-                            const double* const restrict dz, const double dt,
-                            const int istart, const int jstart, const int kstart,
-                            const int iend,   const int jend,   const int kend,
-                            const int icells, const int kcells, const int ijcells)
-    {
-        const double w_max = 9.65; // 9.65=UCLA, 20=SS08, appendix A
-        const double a_R = 9.65;   // SB06, p51
-        const double c_R = 600;    // SB06, p51
-        const double Dv  = 25.0e-6;
-        const double b_R = a_R * exp(c_R*Dv); // UCLA-LES
-
-        const int ikcells = icells * kcells;
-
-        for (int j=jstart; j<jend; ++j)
-        {
-            // 1. Calculate sedimentation velocity at cell center
-            double* restrict w_qr = &tmp1[0*ikcells];
-            double* restrict w_nr = &tmp1[1*ikcells];
-
-            for (int k=kstart; k<kend; k++)
-            {
-                const double rho_n = pow(1.2 / rho[k], 0.5);
-                #pragma ivdep
-                for (int i=istart; i<iend; i++)
-                {
-                    const int ijk = i + j*icells + k*ijcells;
-                    const int ik  = i + k*icells;
-                  
-                    if(qr[ijk] > qr_min)
-                    {
-                        // Calculate mean rain drop mass and diameter
-                        const double mr      = calc_rain_mass(qr[ijk], nr[ijk], rho[k]);
-                        const double dr      = calc_rain_diameter(mr);
-                        const double mur     = calc_mu_r(dr);
-                        const double lambdar = calc_lambda_r(mur, dr);
-              
-                        // SS08:
-                        w_qr[ik] = std::min(w_max, std::max(0.1, rho_n * a_R - b_R * pow(1. + c_R/lambdar, -1.*(mur+4))));
-                        w_nr[ik] = std::min(w_max, std::max(0.1, rho_n * a_R - b_R * pow(1. + c_R/lambdar, -1.*(mur+1))));
-                    }
-                    else
-                    {
-                        w_qr[ik] = 0.;
-                        w_nr[ik] = 0.;
-                    }
-                }
-            }
-
-            // 1.1 Set one ghost cell to zero
-            for (int i=istart; i<iend; i++)
-            {
-                const int ik1  = i + (kstart-1)*icells;
-                const int ik2  = i + (kend    )*icells;
-                w_qr[ik1] = w_qr[ik1+icells];
-                w_nr[ik1] = w_nr[ik1+icells];
-                w_qr[ik2] = 0;
-                w_nr[ik2] = 0;
-            } 
-
-             // 2. Calculate CFL number using interpolated sedimentation velocity
-            double* restrict c_qr = &tmp1[2*ikcells];
-            double* restrict c_nr = &tmp2[0*ikcells];
-
-            for (int k=kstart; k<kend; k++)
-                #pragma ivdep
-                for (int i=istart; i<iend; i++)
-                {
-                    const int ik  = i + k*icells;
-                    c_qr[ik] = 0.25 * (w_qr[ik-icells] + 2.*w_qr[ik] + w_qr[ik+icells]) * dzi[k] * dt; 
-                    c_nr[ik] = 0.25 * (w_nr[ik-icells] + 2.*w_nr[ik] + w_nr[ik+icells]) * dzi[k] * dt; 
-                }
-
-            // 3. Calculate slopes with slope limiter to prevent forming new maxima/minima using slopes
-            double* restrict slope_qr = &tmp1[0*ikcells];
-            double* restrict slope_nr = &tmp1[1*ikcells];
-
-            // Dissable slope limiter near surface, i.e. assume that e.g. qr[kstart]-qr[kstart-1] == qr[kstart+1]-qr[kstart] 
-            for (int i=istart; i<iend; ++i)
-            {
-                const int ijk = i + j*icells + kstart*ijcells;
-                const int ik  = i + kstart*icells;
-
-                slope_qr[ik] = qr[ijk+ijcells] - qr[ijk];
-                slope_nr[ik] = nr[ijk+ijcells] - nr[ijk];
-            }
-
-            for (int k=kstart+1; k<kend; k++)
-                #pragma ivdep
-                for (int i=istart; i<iend; i++)
-                {
-                    const int ijk = i + j*icells + k*ijcells;
-                    const int ik  = i + k*icells;
-
-                    slope_qr[ik] = minmod(qr[ijk]-qr[ijk-ijcells], qr[ijk+ijcells]-qr[ijk]);
-                    slope_nr[ik] = minmod(nr[ijk]-nr[ijk-ijcells], nr[ijk+ijcells]-nr[ijk]);
-                }
-
-            // Calculate flux
-            double* restrict flux_qr = &tmp2[1*ikcells];
-            double* restrict flux_nr = &tmp2[2*ikcells];
-
-            // Set the fluxes at the top of the domain (kend) to zero
-            for (int i=istart; i<iend; i++)
-            {
-                const int ik  = i + kend*icells;
-                flux_qr[ik] = 0;
-                flux_nr[ik] = 0;
-            } 
-
-            for (int k=kend-1; k>kstart-1; k--)
-                #pragma ivdep
-                for (int i=istart; i<iend; i++)
-                {    
-                    const int ijk = i + j*icells + k*ijcells;
-                    const int ik  = i + k*icells;
-
-                    int kk;
-                    double ftot, dzz, cc;
-
-                    // q_rain
-                    kk    = k;  // current grid level
-                    ftot  = 0;  // cumulative 'flux' (kg m-2) 
-                    dzz   = 0;  // distance from zh[k]
-                    cc    = std::min(1., c_qr[ik]);
-                    while (cc > 0 && kk < kend)
-                    {
-                        const int ikk  = i + kk*icells;
-                        const int ijkk = i + j*icells + kk*ijcells;
-                        
-                        ftot += rho[kk] * (qr[ijkk] + 0.5 * slope_qr[ikk] * (1.-cc)) * cc * dz[kk];
-                        
-                        dzz   += dz[kk];
-                        kk    += 1;
-                        cc     = std::min(1., c_qr[ikk] - dzz*dzi[kk]);
-                    }
-
-                    // Given flux at top, limit bottom flux such that the total rain content stays >= 0.
-                    ftot = std::min(ftot, rho[k] * dz[k] * qr[ijk] - flux_qr[ik+icells] * dt - dsmall);
-                    flux_qr[ik] = -ftot / dt;
-
-                    // number density
-                    kk    = k;  // current grid level
-                    ftot  = 0;  // cumulative 'flux'
-                    dzz   = 0;  // distance from zh[k]
-                    cc    = std::min(1., c_nr[ik]);
-                    while (cc > 0 && kk < kend)
-                    {    
-                        const int ikk  = i + kk*icells;
-                        const int ijkk = i + j*icells + kk*ijcells;
-            
-                        ftot += rho[kk] * (nr[ijkk] + 0.5 * slope_nr[ikk] * (1.-cc)) * cc * dz[kk];
-
-                        dzz   += dz[kk];
-                        kk    += 1;
-                        cc     = std::min(1., c_nr[ikk] - dzz*dzi[kk]);
-                    }
-
-                    // Given flux at top, limit bottom flux such that the number density stays >= 0.
-                    ftot = std::min(ftot, rho[k] * dz[k] * nr[ijk] - flux_nr[ik+icells] * dt - dsmall);
-                    flux_nr[ik] = -ftot / dt;
-                }
-
-            // Calculate tendency
-            for (int k=kstart; k<kend; k++)
-                #pragma ivdep
-                for (int i=istart; i<iend; i++)
-                {    
-                    const int ijk = i + j*icells + k*ijcells;
-                    const int ik  = i + k*icells;
-
-                    qrt[ijk] += -(flux_qr[ik+icells] - flux_qr[ik]) / rho[k] * dzi[k]; 
-                    nrt[ijk] += -(flux_nr[ik+icells] - flux_nr[ik]) / rho[k] * dzi[k]; 
-                }
-        }
-    }
-
     // Calculate maximum sedimentation velocity
-    double calc_max_sedimentation_cfl(double* const restrict w_qr,
-                                      const double* const restrict qr, const double* const restrict nr, 
-                                      const double* const restrict rho, const double* const restrict dzi,
+    double calc_max_sedimentation_cfl(real* const restrict w_qr,
+                                      const real* const restrict qr, const real* const restrict nr, 
+                                      const real* const restrict rho, const real* const restrict dzi,
                                       const double dt,
                                       const int istart, const int jstart, const int kstart,
                                       const int iend,   const int jend,   const int kend,
                                       const int icells, const int ijcells)
     {
         const double w_max = 9.65; // 9.65=UCLA, 20=SS08, appendix A
-        const double a_R = 9.65;   // SB06, p51
-        const double c_R = 600;    // SB06, p51
-        const double Dv  = 25.0e-6;
-        const double b_R = a_R * exp(c_R*Dv); // UCLA-LES
 
         // Calculate sedimentation velocity at cell centre
+        #pragma omp parallel for
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -810,6 +429,7 @@ namespace mp
 
         // Calculate maximum CFL based on interpolated velocity
         double cfl_max = 1e-5;
+        #pragma omp parallel for reduction(max:cfl_max)
         for (int k=kstart; k<kend; k++)
             for (int j=jstart; j<jend; j++)
                 #pragma ivdep
@@ -841,6 +461,11 @@ Thermo_moist::Thermo_moist(Model* modelin, Input* inputin) : Thermo(modelin, inp
     pref    = 0;
     prefh   = 0;
 
+    qlcache  = 0;
+    ql_valid = false;
+
+    rain_table = 0;
+
     thvref_g  = 0;
     thvrefh_g = 0;
     exnref_g  = 0;
@@ -865,6 +490,20 @@ Thermo_moist::Thermo_moist(Model* modelin, Input* inputin) : Thermo(modelin, inp
         nerror += inputin->get_item(&swmicrobudget, "thermo", "swmicrobudget", "", "0");
         nerror += inputin->get_item(&swmicrobudget, "thermo", "swmicrobudget", "", "0");
         nerror += inputin->get_item(&cflmax_micro,  "thermo", "cflmax_micro",  "", 2.);
+        nerror += inputin->get_item(&swmicrosubstep, "thermo", "swmicrosubstep", "", "0");
+        nerror += inputin->get_item(&swmicrolookup,  "thermo", "swmicrolookup",  "", "0");
+
+        if (!(swmicrosubstep == "0" || swmicrosubstep == "1"))
+        {
+            master->print_error("\"%s\" is an illegal value for swmicrosubstep\n", swmicrosubstep.c_str());
+            throw 1;
+        }
+
+        if (!(swmicrolookup == "0" || swmicrolookup == "1"))
+        {
+            master->print_error("\"%s\" is an illegal value for swmicrolookup\n", swmicrolookup.c_str());
+            throw 1;
+        }
 
         // The microphysics requires three additional tmp fields
         const int n_tmp = 7;
@@ -935,6 +574,8 @@ Thermo_moist::~Thermo_moist()
     delete[] exnrefh;
     delete[] pref;
     delete[] prefh;
+    delete[] qlcache;
+    delete[] rain_table;
 
     #ifdef USECUDA
     clear_device();
@@ -945,14 +586,15 @@ void Thermo_moist::init()
 {
     stats = model->stats;
 
-    thl0    = new double[grid->kcells];
-    qt0     = new double[grid->kcells];
-    thvref  = new double[grid->kcells];
-    thvrefh = new double[grid->kcells];
-    exnref  = new double[grid->kcells];
-    exnrefh = new double[grid->kcells];
-    pref    = new double[grid->kcells];
-    prefh   = new double[grid->kcells];
+    thl0    = new real[grid->kcells];
+    qt0     = new real[grid->kcells];
+    thvref  = new real[grid->kcells];
+    thvrefh = new real[grid->kcells];
+    exnref  = new real[grid->kcells];
+    exnrefh = new real[grid->kcells];
+    pref    = new real[grid->kcells];
+    prefh   = new real[grid->kcells];
+    qlcache = new real[grid->ncells];
 
     for (int k=0; k<grid->kcells; ++k)
     {
@@ -966,10 +608,32 @@ void Thermo_moist::init()
         prefh  [k] = 0.;
     }
 
+    if (swmicro == "2mom_warm" && swmicrolookup == "1")
+        init_rain_tables();
+
+    if (swmicro == "2mom_warm")
+        microslices.resize((size_t)master->nthreads*nmicroslices*grid->icells*grid->kcells);
+
     init_cross();
     init_dump();
 }
 
+real* Thermo_moist::get_micro_slices()
+{
+#ifdef USEOPENMP
+    const int thread = omp_get_thread_num();
+#else
+    const int thread = 0;
+#endif
+    return &microslices[(size_t)thread*nmicroslices*grid->icells*grid->kcells];
+}
+
+void Thermo_moist::init_rain_tables()
+{
+    rain_table = new double[Rain_table_ncolumns*nrain_table];
+    calc_rain_tables(rain_table);
+}
+
 void Thermo_moist::create(Input* inputin)
 {
     const int kstart = grid->kstart;
@@ -1027,11 +691,14 @@ void Thermo_moist::exec()
     const int kcells = grid->kcells;
 
     // Re-calculate hydrostatic pressure and exner, pass dummy as rhoref,thvref to prevent overwriting base state
-    double *tmp2 = fields->atmp["tmp2"]->data;
+    real *tmp2 = fields->atmp["tmp2"]->data;
     if (swupdatebasestate)
+    {
         calc_base_state(pref, prefh,
                         &tmp2[0*kcells], &tmp2[1*kcells], &tmp2[2*kcells], &tmp2[3*kcells],
                         exnref, exnrefh, fields->sp[thvar]->datamean, fields->sp["qt"]->datamean);
+        invalidate_liquid_water();
+    }
 
     // extend later for gravity vector not normal to surface
     if (grid->swspatialorder == "2")
@@ -1056,7 +723,8 @@ void Thermo_moist::exec()
 
 unsigned long Thermo_moist::get_time_limit(unsigned long idt, const double dt)
 {
-    if(swmicro == "2mom_warm")
+    // With sub-stepped sedimentation the rain fall speed does not limit the time step
+    if(swmicro == "2mom_warm" && swmicrosubstep == "0")
     {
         double cfl = mp::calc_max_sedimentation_cfl(fields->atmp["tmp1"]->data, fields->sp["qr"]->data, fields->sp["nr"]->data,
                                                     fields->rhoref, grid->dzi, dt,
@@ -1075,104 +743,146 @@ unsigned long Thermo_moist::get_time_limit(unsigned long idt, const double dt)
 // BvS:micro 
 void Thermo_moist::exec_microphysics()
 {
-    // Switch to solve certain routines over xz-slices, to reduce calculations recurring in several microphysics routines
-    bool per_slice = true;
-
     // Remove the negative values from the precipitation fields
     mp::remove_neg_values(fields->sp["qr"]->data, grid->istart, grid->jstart, grid->kstart, grid->iend, grid->jend, grid->kend, grid->icells, grid->ijcells);
     mp::remove_neg_values(fields->sp["nr"]->data, grid->istart, grid->jstart, grid->kstart, grid->iend, grid->jend, grid->kend, grid->icells, grid->ijcells);
 
-    // Calculate the cloud liquid water concent using the saturation adjustment method
-    calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp["thl"]->data, fields->sp["qt"]->data, pref);
+    // Get the cloud liquid water content of the current state, calculated once per substep with the saturation adjustment method
+    real* ql = get_liquid_water_cache();
 
     const double dt = model->timeloop->get_dt();
 
-    // xz tmp slices for quantities which are used by multiple microphysics routines
+    // Without sub-stepping, the time step is limited such that the sedimentation CFL stays below cflmax_micro
+    const double cflmax_sed = (swmicrosubstep == "1") ? cflmax_micro : Constants::dhuge;
+
+    // Determine per xz-slice where cloud and rain are present, the routines below skip all other grid points
+    calc_active_boxes(cloud_boxes, ql, ql_min);
+    calc_active_boxes(rain_boxes, fields->sp["qr"]->data, qr_min);
+
+    // the fields are looked up before the threads start
+    real* restrict qrt  = fields->st["qr"]->data;
+    real* restrict nrt  = fields->st["nr"]->data;
+    real* restrict qtt  = fields->st["qt"]->data;
+    real* restrict thlt = fields->st["thl"]->data;
+    const real* restrict qr  = fields->sp["qr"]->data;
+    const real* restrict nr  = fields->sp["nr"]->data;
+    const real* restrict qt  = fields->sp["qt"]->data;
+    const real* restrict thl = fields->sp["thl"]->data;
+
+    // Every xz-slice only updates its own tendencies, so the threads share out the slices. The amount
+    // of cloud and rain differs a lot between the slices, so the slices are handed out dynamically.
     const int ikslice = grid->icells * grid->kcells;
-    double* rain_mass = &fields->atmp["tmp2"]->data[0*ikslice]; 
-    double* rain_diam = &fields->atmp["tmp2"]->data[1*ikslice]; 
-    double* mu_r      = &fields->atmp["tmp2"]->data[2*ikslice]; 
-    double* lambda_r  = &fields->atmp["tmp3"]->data[0*ikslice]; 
-
-    // xz tmp slices for intermediate calculations
-    double* tmpxz1    = &fields->atmp["tmp3"]->data[1*ikslice];
-    double* tmpxz2    = &fields->atmp["tmp3"]->data[2*ikslice];
-    double* tmpxz3    = &fields->atmp["tmp4"]->data[0*ikslice];
-    double* tmpxz4    = &fields->atmp["tmp4"]->data[1*ikslice];
-    double* tmpxz5    = &fields->atmp["tmp4"]->data[2*ikslice];
-    double* tmpxz6    = &fields->atmp["tmp5"]->data[0*ikslice];
-
-    // Autoconversion; formation of rain drop by coagulating cloud droplets
-    mp::autoconversion(fields->st["qr"]->data, fields->st["nr"]->data, fields->st["qt"]->data, fields->st["thl"]->data,
-                       fields->sp["qr"]->data, fields->atmp["tmp1"]->data, fields->rhoref, exnref,
-                       grid->istart, grid->jstart, grid->kstart, 
-                       grid->iend,   grid->jend,   grid->kend, 
-                       grid->icells, grid->ijcells);
-
-    // Accretion; growth of raindrops collecting cloud droplets
-    mp::accretion(fields->st["qr"]->data, fields->st["qt"]->data, fields->st["thl"]->data,
-                  fields->sp["qr"]->data, fields->atmp["tmp1"]->data, fields->rhoref, exnref,
-                  grid->istart, grid->jstart, grid->kstart, 
-                  grid->iend,   grid->jend,   grid->kend, 
-                  grid->icells, grid->ijcells);
-
-    if(per_slice)
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int j=grid->jstart; j<grid->jend; ++j)
     {
-        for (int j=grid->jstart; j<grid->jend; ++j)
+        const Active_box& cb = cloud_boxes[j];
+        const Active_box& rb = rain_boxes[j];
+
+        if (cb.iend > cb.istart)
         {
-            mp2d::prepare_microphysics_slice(rain_mass, rain_diam, mu_r, lambda_r, fields->sp["qr"]->data, fields->sp["nr"]->data, fields->rhoref,
-                                             grid->istart, grid->iend, grid->kstart, grid->kend, grid->icells, grid->ijcells, j);
-
-            // Evaporation; evaporation of rain drops in unsaturated environment
-            mp2d::evaporation(fields->st["qr"]->data, fields->st["nr"]->data,  fields->st["qt"]->data, fields->st["thl"]->data,
-                              fields->sp["qr"]->data, fields->sp["nr"]->data,  fields->atmp["tmp1"]->data,
-                              fields->sp["qt"]->data, fields->sp["thl"]->data, fields->rhoref, exnref, pref,
-                              rain_mass, rain_diam,
-                              grid->istart, grid->jstart, grid->kstart, 
-                              grid->iend,   grid->jend,   grid->kend, 
-                              grid->icells, grid->ijcells, j);
-
-            // Self collection and breakup; growth of raindrops by mutual (rain-rain) coagulation, and breakup by collisions
-            mp2d::selfcollection_breakup(fields->st["nr"]->data, fields->sp["qr"]->data, fields->sp["nr"]->data, fields->rhoref,
-                                         rain_mass, rain_diam, lambda_r,
-                                         grid->istart, grid->jstart, grid->kstart, 
-                                         grid->iend,   grid->jend,   grid->kend, 
-                                         grid->icells, grid->ijcells, j);
-
-            // Sedimentation; sub-grid sedimentation of rain 
-            mp2d::sedimentation_ss08(fields->st["qr"]->data, fields->st["nr"]->data, 
-                                     tmpxz1, tmpxz2, tmpxz3, tmpxz4, tmpxz5, tmpxz6, mu_r, lambda_r,
-                                     fields->sp["qr"]->data, fields->sp["nr"]->data, 
-                                     fields->rhoref, grid->dzi, grid->dz, dt,
-                                     grid->istart, grid->jstart, grid->kstart, 
-                                     grid->iend,   grid->jend,   grid->kend, 
-                                     grid->icells, grid->kcells, grid->ijcells, j);
+            // Autoconversion; formation of rain drop by coagulating cloud droplets
+            mp::autoconversion(qrt, nrt, qtt, thlt, qr, ql, fields->rhoref, exnref,
+                               cb.istart, j,   cb.kstart,
+                               cb.iend,   j+1, cb.kend,
+                               grid->icells, grid->ijcells);
+
+            // Accretion; growth of raindrops collecting cloud droplets
+            mp::accretion(qrt, qtt, thlt, qr, ql, fields->rhoref, exnref,
+                          cb.istart, j,   cb.kstart,
+                          cb.iend,   j+1, cb.kend,
+                          grid->icells, grid->ijcells);
         }
-    }
-    else
-    {
+
+        if (rb.iend == rb.istart)
+            continue;
+
+        // xz tmp slices of this thread for quantities which are used by multiple microphysics routines,
+        // and for intermediate calculations
+        real* slices = get_micro_slices();
+        real* rain_mass = &slices[ 0*ikslice];
+        real* rain_diam = &slices[ 1*ikslice];
+        real* mu_r      = &slices[ 2*ikslice];
+        real* lambda_r  = &slices[ 3*ikslice];
+        real* tmpxz1    = &slices[ 4*ikslice];
+        real* tmpxz2    = &slices[ 5*ikslice];
+        real* tmpxz3    = &slices[ 6*ikslice];
+        real* tmpxz4    = &slices[ 7*ikslice];
+        real* tmpxz5    = &slices[ 8*ikslice];
+        real* tmpxz6    = &slices[ 9*ikslice];
+        real* tmpxz7    = &slices[10*ikslice];
+        real* tmpxz8    = &slices[11*ikslice];
+
+        mp2d::prepare_microphysics_slice(rain_mass, rain_diam, mu_r, lambda_r, qr, nr, fields->rhoref, rain_table,
+                                         rb.istart, rb.iend, rb.kstart, rb.kend, grid->icells, grid->ijcells, j);
+
         // Evaporation; evaporation of rain drops in unsaturated environment
-        mp::evaporation(fields->st["qr"]->data, fields->st["nr"]->data,  fields->st["qt"]->data, fields->st["thl"]->data,
-                        fields->sp["qr"]->data, fields->sp["nr"]->data,  fields->atmp["tmp1"]->data,
-                        fields->sp["qt"]->data, fields->sp["thl"]->data, fields->rhoref, exnref, pref,
-                        grid->istart, grid->jstart, grid->kstart, 
-                        grid->iend,   grid->jend,   grid->kend, 
-                        grid->icells, grid->ijcells);
-       
+        mp2d::evaporation(qrt, nrt, qtt, thlt, qr, nr, ql, qt, thl, fields->rhoref, exnref, pref,
+                          rain_mass, rain_diam,
+                          rb.istart, grid->jstart, rb.kstart,
+                          rb.iend,   grid->jend,   rb.kend,
+                          grid->icells, grid->ijcells, j);
+
         // Self collection and breakup; growth of raindrops by mutual (rain-rain) coagulation, and breakup by collisions
-        mp::selfcollection_breakup(fields->st["nr"]->data, fields->sp["qr"]->data, fields->sp["nr"]->data, fields->rhoref,
-                                   grid->istart, grid->jstart, grid->kstart, 
-                                   grid->iend,   grid->jend,   grid->kend, 
-                                   grid->icells, grid->ijcells);
-    
-        // Sedimentation; sub-grid sedimentation of rain 
-        mp::sedimentation_ss08(fields->st["qr"]->data, fields->st["nr"]->data, 
-                               fields->atmp["tmp4"]->data, fields->atmp["tmp5"]->data,
-                               fields->sp["qr"]->data, fields->sp["nr"]->data, 
-                               fields->rhoref, grid->dzi, grid->dz, dt,
-                               grid->istart, grid->jstart, grid->kstart, 
-                               grid->iend,   grid->jend,   grid->kend, 
-                               grid->icells, grid->kcells, grid->ijcells);
+        mp2d::selfcollection_breakup(nrt, qr, nr, fields->rhoref,
+                                     rain_mass, rain_diam, lambda_r,
+                                     rb.istart, grid->jstart, rb.kstart,
+                                     rb.iend,   grid->jend,   rb.kend,
+                                     grid->icells, grid->ijcells, j);
+
+        // Sedimentation; sub-grid sedimentation of rain. Rain falls through the levels below the box and
+        // the flux stencil reaches above it, so only the columns without rain are skipped.
+        Rain_functions::sedimentation_ss08(qrt, nrt,
+                                           tmpxz1, tmpxz2, tmpxz3, tmpxz4, tmpxz5, tmpxz6, tmpxz7, tmpxz8, rain_mass, mu_r, lambda_r, rain_table,
+                                           qr, nr, fields->rhoref, grid->dzi, grid->dz, dt, cflmax_sed,
+                                           rb.istart, grid->jstart, grid->kstart,
+                                           rb.iend,   grid->jend,   grid->kend,
+                                           grid->icells, grid->kcells, grid->ijcells, j);
+    }
+}
+
+void Thermo_moist::calc_active_boxes(std::vector<Active_box>& boxes, const real* const restrict field, const double threshold)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    boxes.resize(grid->jcells);
+
+    // the boxes of the slices are independent, every thread sweeps whole slices
+    #pragma omp parallel for
+    for (int j=grid->jstart; j<grid->jend; ++j)
+    {
+        int imin = grid->iend;
+        int imax = grid->istart-1;
+        int kmin = grid->kend;
+        int kmax = grid->kstart-1;
+
+        for (int k=grid->kstart; k<grid->kend; ++k)
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk = i + j*jj + k*kk;
+                if (field[ijk] > threshold)
+                {
+                    imin = std::min(imin, i);
+                    imax = std::max(imax, i);
+                    kmin = std::min(kmin, k);
+                    kmax = std::max(kmax, k);
+                }
+            }
+
+        // An empty slice gets a box with istart == iend
+        if (imax < imin)
+        {
+            imin = grid->istart;
+            imax = grid->istart-1;
+            kmin = grid->kstart;
+            kmax = grid->kstart-1;
+        }
+
+        boxes[j].istart = imin;
+        boxes[j].iend   = imax+1;
+        boxes[j].kstart = kmin;
+        boxes[j].kend   = kmax+1;
     }
 }
 
@@ -1180,26 +890,26 @@ void Thermo_moist::get_mask(Field3d *mfield, Field3d *mfieldh, Mask *m)
 {
     if (m->name == "ql")
     {
-        calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+        get_liquid_water(fields->atmp["tmp1"]->data);
         calc_mask_ql(mfield->data, mfieldh->data, mfieldh->databot,
                      stats->nmask, stats->nmaskh, &stats->nmaskbot,
                      fields->atmp["tmp1"]->data);
     }
     else if (m->name == "qlcore")
     {
-        calc_buoyancy(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp1"]->data,thvref);
+        calc_buoyancy(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, get_liquid_water_cache(), thvref);
         grid->calc_mean(fields->atmp["tmp2"]->datamean, fields->atmp["tmp2"]->data, grid->kcells);
 
-        calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+        get_liquid_water(fields->atmp["tmp1"]->data);
         calc_mask_qlcore(mfield->data, mfieldh->data, mfieldh->databot,
                          stats->nmask, stats->nmaskh, &stats->nmaskbot,
                          fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, fields->atmp["tmp2"]->datamean);
     }
 }
 
-void Thermo_moist::calc_mask_ql(double* restrict mask, double* restrict maskh, double* restrict maskbot,
+void Thermo_moist::calc_mask_ql(real* restrict mask, real* restrict maskh, real* restrict maskbot,
                                 int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot,
-                                double* restrict ql)
+                                real* restrict ql)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -1258,9 +968,9 @@ void Thermo_moist::calc_mask_ql(double* restrict mask, double* restrict maskh, d
     //nmaskh[kend  ] = 0;
 }
 
-void Thermo_moist::calc_mask_qlcore(double* restrict mask, double* restrict maskh, double* restrict maskbot,
+void Thermo_moist::calc_mask_qlcore(real* restrict mask, real* restrict maskh, real* restrict maskbot,
                                     int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot,
-                                    double* restrict ql, double* restrict b, double* restrict bmean)
+                                    real* restrict ql, real* restrict b, real* restrict bmean)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -1319,73 +1029,35 @@ void Thermo_moist::exec_stats(Mask *m)
     const double NoOffset = 0.;
 
     // calc the buoyancy and its surface flux for the profiles
-    calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref);
+    calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, get_liquid_water_cache(), thvref);
     calc_buoyancy_fluxbot(fields->atmp["tmp1"]->datafluxbot, fields->sp[thvar]->databot, fields->sp[thvar]->datafluxbot, fields->sp["qt"]->databot, fields->sp["qt"]->datafluxbot, thvrefh);
 
     // define location
     const int sloc[] = {0,0,0};
 
-    // mean
-    stats->calc_mean(m->profs["b"].data, fields->atmp["tmp1"]->data, NoOffset, sloc,
-                     fields->atmp["tmp3"]->data, stats->nmask);
+    // mean, which the moments and fluxes need after its reduction
+    stats->calc_mean("b", fields->atmp["tmp1"]->data, NoOffset, sloc);
+    stats->reduce_profs();
 
-    // moments
-    for (int n=2; n<5; ++n)
+    // calculate the moments and the turbulent and diffusive fluxes, the diffusivity of buoyancy is taken from temperature
+    real* evisc = 0;
+    double tPr = 1.;
+    if (model->diff->get_switch() == "smag2")
     {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(fields->atmp["tmp1"]->data, m->profs["b"].data, m->profs["b"+sn].data, n, sloc,
-                           fields->atmp["tmp3"]->data, stats->nmask);
+        evisc = fields->sd["evisc"]->data;
+        tPr = static_cast<Diff_smag_2*>(model->diff)->tPr;
     }
 
-    // calculate the gradients
-    if (grid->swspatialorder == "2")
-        stats->calc_grad_2nd(fields->atmp["tmp1"]->data, m->profs["bgrad"].data, grid->dzhi, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-    else if (grid->swspatialorder == "4")
-        stats->calc_grad_4th(fields->atmp["tmp1"]->data, m->profs["bgrad"].data, grid->dzhi4, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-
-    // calculate turbulent fluxes
-    if (grid->swspatialorder == "2")
-        stats->calc_flux_2nd(fields->atmp["tmp1"]->data, m->profs["b"].data, fields->w->data, m->profs["w"].data,
-                             m->profs["bw"].data, fields->atmp["tmp2"]->data, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-    else if (grid->swspatialorder == "4")
-        stats->calc_flux_4th(fields->atmp["tmp1"]->data, fields->w->data, m->profs["bw"].data, fields->atmp["tmp2"]->data, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-
-    // calculate diffusive fluxes
-    if (grid->swspatialorder == "2")
-    {
-        if (model->diff->get_switch() == "smag2")
-        {
-            Diff_smag_2 *diffptr = static_cast<Diff_smag_2 *>(model->diff);
-            stats->calc_diff_2nd(fields->atmp["tmp1"]->data, fields->w->data, fields->sd["evisc"]->data,
-                                 m->profs["bdiff"].data, grid->dzhi,
-                                 fields->atmp["tmp1"]->datafluxbot, fields->atmp["tmp1"]->datafluxtop, diffptr->tPr, sloc,
-                                 fields->atmp["tmp4"]->data, stats->nmaskh);
-        }
-        else
-        {
-            stats->calc_diff_2nd(fields->atmp["tmp1"]->data, m->profs["bdiff"].data, grid->dzhi, fields->sp[thvar]->visc, sloc,
-                                 fields->atmp["tmp4"]->data, stats->nmaskh);
-        }
-    }
-    else if (grid->swspatialorder == "4")
-    {
-        // take the diffusivity of temperature for that of buoyancy
-        stats->calc_diff_4th(fields->atmp["tmp1"]->data, m->profs["bdiff"].data, grid->dzhi4, fields->sp[thvar]->visc, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
-    }
+    stats->calc_moments_fluxes(fields->atmp["tmp1"]->data, "b", NoOffset, "b2", "b3", "b4",
+                               fields->w->data, fields->atmp["tmp2"]->data, "bw", "bgrad", "bdiff", fields->sp[thvar]->visc,
+                               evisc, fields->atmp["tmp1"]->datafluxbot, fields->atmp["tmp1"]->datafluxtop, tPr, sloc);
 
     // calculate the total fluxes
-    stats->add_fluxes(m->profs["bflux"].data, m->profs["bw"].data, m->profs["bdiff"].data);
+    stats->add_fluxes("bflux", "bw", "bdiff");
 
     // calculate the liquid water stats
-    calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
-    stats->calc_mean(m->profs["ql"].data, fields->atmp["tmp1"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+    get_liquid_water(fields->atmp["tmp1"]->data);
+    stats->calc_mean("ql", fields->atmp["tmp1"]->data, NoOffset, sloc);
     stats->calc_count(fields->atmp["tmp1"]->data, m->profs["cfrac"].data, 0.,
                       fields->atmp["tmp3"]->data, stats->nmask);
 
@@ -1405,16 +1077,26 @@ void Thermo_moist::exec_stats(Mask *m)
             mp::zero(fields->atmp["tmp6"]->data, grid->ncells);
             mp::zero(fields->atmp["tmp7"]->data, grid->ncells);
 
-            mp::autoconversion(fields->atmp["tmp2"]->data, fields->atmp["tmp5"]->data, fields->atmp["tmp6"]->data, fields->atmp["tmp7"]->data,
-                               fields->sp["qr"]->data, fields->atmp["tmp1"]->data, fields->rhoref, exnref,
-                               grid->istart, grid->jstart, grid->kstart, 
-                               grid->iend,   grid->jend,   grid->kend, 
-                               grid->icells, grid->ijcells);
+            real* restrict tmp2 = fields->atmp["tmp2"]->data;
+            real* restrict tmp5 = fields->atmp["tmp5"]->data;
+            real* restrict tmp6 = fields->atmp["tmp6"]->data;
+            real* restrict tmp7 = fields->atmp["tmp7"]->data;
+            const real* restrict qr = fields->sp["qr"]->data;
+            const real* restrict nr = fields->sp["nr"]->data;
+            const real* restrict ql = fields->atmp["tmp1"]->data;
+
+            // the per-slice kernels are threaded over the xz-slices
+            #pragma omp parallel for
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                mp::autoconversion(tmp2, tmp5, tmp6, tmp7, qr, ql, fields->rhoref, exnref,
+                                   grid->istart, j,   grid->kstart,
+                                   grid->iend,   j+1, grid->kend,
+                                   grid->icells, grid->ijcells);
 
-            stats->calc_mean(m->profs["auto_qrt" ].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["auto_nrt" ].data, fields->atmp["tmp5"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["auto_qtt" ].data, fields->atmp["tmp6"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["auto_thlt"].data, fields->atmp["tmp7"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("auto_qrt", fields->atmp["tmp2"]->data, NoOffset, sloc);
+            stats->calc_mean("auto_nrt", fields->atmp["tmp5"]->data, NoOffset, sloc);
+            stats->calc_mean("auto_qtt", fields->atmp["tmp6"]->data, NoOffset, sloc);
+            stats->calc_mean("auto_thlt", fields->atmp["tmp7"]->data, NoOffset, sloc);
 
             // Evaporation
             mp::zero(fields->atmp["tmp2"]->data, grid->ncells);
@@ -1429,25 +1111,26 @@ void Thermo_moist::exec_stats(Mask *m)
                             grid->iend,   grid->jend,   grid->kend, 
                             grid->icells, grid->ijcells);
 
-            stats->calc_mean(m->profs["evap_qrt" ].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["evap_nrt" ].data, fields->atmp["tmp5"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["evap_qtt" ].data, fields->atmp["tmp6"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["evap_thlt"].data, fields->atmp["tmp7"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("evap_qrt", fields->atmp["tmp2"]->data, NoOffset, sloc);
+            stats->calc_mean("evap_nrt", fields->atmp["tmp5"]->data, NoOffset, sloc);
+            stats->calc_mean("evap_qtt", fields->atmp["tmp6"]->data, NoOffset, sloc);
+            stats->calc_mean("evap_thlt", fields->atmp["tmp7"]->data, NoOffset, sloc);
 
             // Accretion
             mp::zero(fields->atmp["tmp2"]->data, grid->ncells);
             mp::zero(fields->atmp["tmp5"]->data, grid->ncells);
             mp::zero(fields->atmp["tmp6"]->data, grid->ncells);
 
-            mp::accretion(fields->atmp["tmp2"]->data, fields->atmp["tmp5"]->data, fields->atmp["tmp6"]->data,
-                          fields->sp["qr"]->data, fields->atmp["tmp1"]->data, fields->rhoref, exnref,
-                          grid->istart, grid->jstart, grid->kstart, 
-                          grid->iend,   grid->jend,   grid->kend, 
-                          grid->icells, grid->ijcells);
+            #pragma omp parallel for
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                mp::accretion(tmp2, tmp5, tmp6, qr, ql, fields->rhoref, exnref,
+                              grid->istart, j,   grid->kstart,
+                              grid->iend,   j+1, grid->kend,
+                              grid->icells, grid->ijcells);
 
-            stats->calc_mean(m->profs["accr_qrt" ].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["accr_qtt" ].data, fields->atmp["tmp5"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["accr_thlt"].data, fields->atmp["tmp6"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("accr_qrt", fields->atmp["tmp2"]->data, NoOffset, sloc);
+            stats->calc_mean("accr_qtt", fields->atmp["tmp5"]->data, NoOffset, sloc);
+            stats->calc_mean("accr_thlt", fields->atmp["tmp6"]->data, NoOffset, sloc);
 
             // Selfcollection and breakup
             mp::zero(fields->atmp["tmp2"]->data, grid->ncells);
@@ -1457,49 +1140,41 @@ void Thermo_moist::exec_stats(Mask *m)
                                        grid->iend,   grid->jend,   grid->kend, 
                                        grid->icells, grid->ijcells);
 
-            stats->calc_mean(m->profs["scbr_nrt" ].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("scbr_nrt", fields->atmp["tmp2"]->data, NoOffset, sloc);
 
             // Sedimentation
             mp::zero(fields->atmp["tmp2"]->data, grid->ncells);
             mp::zero(fields->atmp["tmp5"]->data, grid->ncells);
-            mp::zero(fields->atmp["tmp6"]->data, grid->ncells);
-            mp::zero(fields->atmp["tmp7"]->data, grid->ncells);
-
-            // 1. Get number of substeps based on sedimentation with CFL=1
-            //const double dt = model->timeloop->get_sub_time_step();
-            //int nsubstep = mp::get_sedimentation_steps(fields->sp["qr"]->data, fields->sp["nr"]->data, 
-            //                                           fields->rhoref, grid->dzi, dt,
-            //                                           grid->istart, grid->jstart, grid->kstart, 
-            //                                           grid->iend,   grid->jend,   grid->kend, 
-            //                                           grid->icells, grid->ijcells);
-
-            //// 2. Synchronize over all MPI processes 
-            //grid->get_max(&nsubstep);
-
-            //// Stay a bit further from CFL=1
-            //nsubstep *= 2;
-
-            //// Sedimentation in nsubstep steps:
-            //mp::sedimentation_sub(fields->atmp["tmp2"]->data, fields->atmp["tmp5"]->data, 
-            //                      fields->atmp["tmp6"]->data, fields->atmp["tmp7"]->data,
-            //                      fields->sp["qr"]->data, fields->sp["nr"]->data, 
-            //                      fields->rhoref, grid->dzi, grid->dzhi, dt,
-            //                      grid->istart, grid->jstart, grid->kstart, 
-            //                      grid->iend,   grid->jend,   grid->kend, 
-            //                      grid->icells, grid->kcells, grid->ijcells,
-            //                      nsubstep);
 
+            // Sedimentation per xz-slice, sub-stepped as in the model tendency, in the xz-slices of the threads
             const double dt = model->timeloop->get_sub_time_step();
-            mp::sedimentation_ss08(fields->atmp["tmp2"]->data, fields->atmp["tmp5"]->data, 
-                                   fields->atmp["tmp6"]->data, fields->atmp["tmp7"]->data,
-                                   fields->sp["qr"]->data, fields->sp["nr"]->data, 
-                                   fields->rhoref, grid->dzi, grid->dz, dt,
-                                   grid->istart, grid->jstart, grid->kstart, 
-                                   grid->iend,   grid->jend,   grid->kend, 
-                                   grid->icells, grid->kcells, grid->ijcells);
-
-            stats->calc_mean(m->profs["sed_qrt"].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["sed_nrt"].data, fields->atmp["tmp5"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            const double cflmax_sed = (swmicrosubstep == "1") ? cflmax_micro : Constants::dhuge;
+            const int ikslice = grid->icells * grid->kcells;
+
+            #pragma omp parallel for
+            for (int j=grid->jstart; j<grid->jend; ++j)
+            {
+                real* slices = get_micro_slices();
+                real* rain_mass = &slices[ 0*ikslice];
+                real* rain_diam = &slices[ 1*ikslice];
+                real* mu_r      = &slices[ 2*ikslice];
+                real* lambda_r  = &slices[ 3*ikslice];
+
+                mp2d::prepare_microphysics_slice(rain_mass, rain_diam, mu_r, lambda_r, qr, nr, fields->rhoref, rain_table,
+                                                 grid->istart, grid->iend, grid->kstart, grid->kend, grid->icells, grid->ijcells, j);
+
+                Rain_functions::sedimentation_ss08(tmp2, tmp5,
+                                                   &slices[4*ikslice], &slices[5*ikslice], &slices[ 6*ikslice], &slices[ 7*ikslice],
+                                                   &slices[8*ikslice], &slices[9*ikslice], &slices[10*ikslice], &slices[11*ikslice],
+                                                   rain_mass, mu_r, lambda_r, rain_table, qr, nr,
+                                                   fields->rhoref, grid->dzi, grid->dz, dt, cflmax_sed,
+                                                   grid->istart, grid->jstart, grid->kstart,
+                                                   grid->iend,   grid->jend,   grid->kend,
+                                                   grid->icells, grid->kcells, grid->ijcells, j);
+            }
+
+            stats->calc_mean("sed_qrt", fields->atmp["tmp2"]->data, NoOffset, sloc);
+            stats->calc_mean("sed_nrt", fields->atmp["tmp5"]->data, NoOffset, sloc);
         }
     }
 
@@ -1507,7 +1182,7 @@ void Thermo_moist::exec_stats(Mask *m)
     if (swupdatebasestate == 1)
     {
         const int kcells = grid->kcells;
-        double* restrict tmp2 = fields->atmp["tmp2"]->data;
+        real* restrict tmp2 = fields->atmp["tmp2"]->data;
         calc_base_state(&tmp2[0*kcells], &tmp2[1*kcells], &tmp2[2*kcells], &tmp2[3*kcells],
                         &tmp2[4*kcells], &tmp2[5*kcells], &tmp2[6*kcells], &tmp2[7*kcells],
                         fields->sp[thvar]->datamean, fields->sp["qt"]->datamean);
@@ -1528,7 +1203,7 @@ void Thermo_moist::exec_cross()
 
     Cross* cross = model->cross;
 
-    // With one additional temp field, we wouldn't have to re-calculate the ql or b field for simple,lngrad,path, etc.
+    // The ql field is taken from the cache, only the b field is re-calculated for simple,lngrad, etc.
     for (std::vector<std::string>::iterator it=crosslist.begin(); it<crosslist.end(); ++it)
     {
         /* BvS: for now, don't call getThermoField() or getBuoyancySurf(), but directly the function itself. With CUDA enabled,
@@ -1536,41 +1211,41 @@ void Thermo_moist::exec_cross()
 
         if (*it == "b")
         {
-            calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref);
+            calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, get_liquid_water_cache(), thvref);
             nerror += cross->cross_simple(fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, *it);
         }
         else if (*it == "ql")
         {
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            get_liquid_water(fields->atmp["tmp1"]->data);
             nerror += cross->cross_simple(fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, *it);
         }
         else if (*it == "blngrad")
         {
-            calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref);
+            calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, get_liquid_water_cache(), thvref);
             // Note: tmp1 twice used as argument -> overwritten in crosspath()
             nerror += cross->cross_lngrad(fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, fields->atmp["tmp1"]->data, grid->dzi4, *it);
         }
         else if (*it == "qlpath")
         {
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            get_liquid_water(fields->atmp["tmp1"]->data);
             // Note: tmp1 twice used as argument -> overwritten in crosspath()
             nerror += cross->cross_path(fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, fields->atmp["tmp1"]->data, "qlpath");
         }
         else if (*it == "qlbase")
         {
             const double ql_threshold = 0.;
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            get_liquid_water(fields->atmp["tmp1"]->data);
             nerror += cross->cross_height_threshold(fields->atmp["tmp1"]->data, fields->atmp["tmp1"]->databot, fields->atmp["tmp2"]->data, grid->z, ql_threshold, Bottom_to_top, "qlbase");
         }
         else if (*it == "qltop")
         {
             const double ql_threshold = 0.;
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            get_liquid_water(fields->atmp["tmp1"]->data);
             nerror += cross->cross_height_threshold(fields->atmp["tmp1"]->data, fields->atmp["tmp1"]->databot, fields->atmp["tmp2"]->data, grid->z, ql_threshold, Top_to_bottom, "qltop");
         }
         else if (*it == "maxthvcloud")
         {
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            get_liquid_water(fields->atmp["tmp1"]->data);
             calc_maximum_thv_perturbation_cloud(fields->atmp["tmp2"]->databot, fields->atmp["tmp2"]->data,
                                                 fields->sp["thl"]->data, fields->sp["qt"]->data, fields->atmp["tmp1"]->data, pref, fields->atmp["tmp2"]->datamean);
             nerror += cross->cross_plane(fields->atmp["tmp2"]->databot, fields->atmp["tmp1"]->data, "maxthvcloud");
@@ -1602,9 +1277,9 @@ void Thermo_moist::exec_dump()
     {
         // TODO BvS restore getThermoField(), the combination of checkThermoField with getThermoField is more elegant...
         if (*it == "b")
-            calc_buoyancy(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp1"]->data, thvref);
+            calc_buoyancy(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, get_liquid_water_cache(), thvref);
         else if (*it == "ql")
-            calc_liquid_water(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            get_liquid_water(fields->atmp["tmp2"]->data);
         else
             throw 1;
 
@@ -1627,15 +1302,18 @@ void Thermo_moist::get_thermo_field(Field3d* fld, Field3d* tmp, const std::strin
 
     // BvS: getThermoField() is called from subgrid-model, before thermo(), so re-calculate the hydrostatic pressure
     // Pass dummy as rhoref,thvref to prevent overwriting base state
-    double* restrict tmp2 = fields->atmp["tmp2"]->data;
+    real* restrict tmp2 = fields->atmp["tmp2"]->data;
     if (swupdatebasestate)
+    {
         calc_base_state(pref, prefh, &tmp2[0*kcells], &tmp2[1*kcells], &tmp2[2*kcells], &tmp2[3*kcells], exnref, exnrefh,
                 fields->sp[thvar]->datamean, fields->sp["qt"]->datamean);
+        invalidate_liquid_water();
+    }
 
     if (name == "b")
-        calc_buoyancy(fld->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, tmp->data, thvref);
+        calc_buoyancy(fld->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, get_liquid_water_cache(), thvref);
     else if (name == "ql")
-        calc_liquid_water(fld->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+        get_liquid_water(fld->data);
     else if (name == "N2")
         calc_N2(fld->data, fields->sp[thvar]->data, grid->dzi, thvref);
     else
@@ -1676,39 +1354,6 @@ double Thermo_moist::get_buoyancy_diffusivity()
     return fields->sp[thvar]->visc;
 }
 
-namespace
-{
-    inline double sat_adjust(const double thl, const double qt, const double p, const double exn)
-    {
-        int niter = 0;
-        int nitermax = 30;
-        double ql, tl, tnr_old = 1.e9, tnr, qs=0;
-        tl = thl * exn;
-
-        // Calculate if q-qs(Tl) <= 0. If so, return 0. Else continue with saturation adjustment
-        if(qt-qsat(p, tl) <= 0)
-            return 0.;
-
-        tnr = tl;
-        while (std::fabs(tnr-tnr_old)/tnr_old> 1e-5 && niter < nitermax)
-        {
-            ++niter;
-            tnr_old = tnr;
-            qs = qsat(p,tnr);
-            tnr = tnr - (tnr+(Lv/cp)*qs-tl-(Lv/cp)*qt)/(1+(std::pow(Lv,2)*qs)/ (Rv*cp*std::pow(tnr,2)));
-        }
-
-        if (niter == nitermax)
-        {
-            printf("Saturation adjustment not converged!! [thl=%f K, qt=%f kg/kg, p=%f p]\n",thl,qt,p);
-            throw 1;
-        }
-
-        ql = std::max(0.,qt - qs);
-        return ql;
-    }
-}
-
 /**
  * This function calculates the hydrostatic pressure at full and half levels,
  * with option to return base state profiles like reference density and temperature
@@ -1724,11 +1369,11 @@ namespace
  * @param thlmean Pointer to input liq. water potential temperature array (horizontal mean, full level)
  * @param qtmean Pointer to input tot. moisture mix. ratio  array (horizontal mean, full level)
  */
-void  Thermo_moist::calc_base_state(double* restrict pref,    double* restrict prefh,
-                                    double* restrict rho,     double* restrict rhoh,
-                                    double* restrict thv,     double* restrict thvh,
-                                    double* restrict ex,      double* restrict exh,
-                                    double* restrict thlmean, double* restrict qtmean)
+void  Thermo_moist::calc_base_state(real* restrict pref,    real* restrict prefh,
+                                    real* restrict rho,     real* restrict rhoh,
+                                    real* restrict thv,     real* restrict thvh,
+                                    real* restrict ex,      real* restrict exh,
+                                    real* restrict thlmean, real* restrict qtmean)
 {
     const int kstart = grid->kstart;
     const int kend   = grid->kend;
@@ -1775,104 +1420,78 @@ void  Thermo_moist::calc_base_state(double* restrict pref,    double* restrict p
     pref[kstart-1] = 2.*prefh[kstart] - pref[kstart];
 }
 
-void Thermo_moist::calc_buoyancy_tend_2nd(double* restrict wt, double* restrict thl, double* restrict qt,
-                                          double* restrict ph, double* restrict thlh, double* restrict qth,
-                                          double* restrict ql, double* restrict thvrefh)
+void Thermo_moist::calc_buoyancy_tend_2nd(real* restrict wt, real* restrict thl, real* restrict qt,
+                                          real* restrict ph, real* restrict thlh, real* restrict qth,
+                                          real* restrict ql, real* restrict thvrefh)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    double tl, exnh;
-
-    for (int k=grid->kstart+1; k<grid->kend; k++)
+    // The tiles cover disjoint parts of the 2d buffers, so the threads share out the tiles.
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
     {
-        exnh = exner(ph[k]);
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                const int ij  = i + j*jj;
-                thlh[ij] = interp2(thl[ijk-kk], thl[ijk]);
-                qth[ij]  = interp2(qt[ijk-kk], qt[ijk]);
-                tl       = thlh[ij] * exnh;
-                // Calculate first estimate of ql using Tl
-                // if ql(Tl)>0, saturation adjustment routine needed
-                ql[ij]  = qth[ij]-qsat(ph[k],tl);
-            }
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ij  = i + j*jj;
-                if (ql[ij]>0)   // already doesn't vectorize because of iteration in sat_adjust()
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; k++)
+        {
+            const double exnh = exner(ph[k]);
+            for (int j=t->jstart; j<t->jend; j++)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; i++)
                 {
-                    ql[ij] = sat_adjust(thlh[ij], qth[ij], ph[k], exnh);
+                    const int ijk = i + j*jj + k*kk;
+                    const int ij  = i + j*jj;
+                    thlh[ij] = interp2(thl[ijk-kk], thl[ijk]);
+                    qth[ij]  = interp2(qt[ijk-kk], qt[ijk]);
                 }
-                else
-                    ql[ij] = 0.;
-            }
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+            for (int j=t->jstart; j<t->jend; j++)
             {
-                const int ijk = i + j*jj + k*kk;
-                const int ij  = i + j*jj;
-                wt[ijk] += buoyancy(exnh, thlh[ij], qth[ij], ql[ij], thvrefh[k]);
+                const int ij = t->istart + j*jj;
+                sat_adjust_row(&ql[ij], &thlh[ij], &qth[ij], ph[k], exnh, t->iend-t->istart);
             }
+            for (int j=t->jstart; j<t->jend; j++)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    const int ij  = i + j*jj;
+                    wt[ijk] += buoyancy(exnh, thlh[ij], qth[ij], ql[ij], thvrefh[k]);
+                }
+        }
     }
 }
 
 
-void Thermo_moist::calc_buoyancy(double* restrict b, double* restrict thl, double* restrict qt,
-                                 double* restrict p, double* restrict ql, double* restrict thvref)
+void Thermo_moist::calc_buoyancy(real* restrict b, real* restrict thl, real* restrict qt,
+                                 real* restrict p, real* restrict ql, real* restrict thvref)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    double tl, ex;
-
-    for (int k=0; k<grid->kcells; k++)
+    // The liquid water is taken from the cache, which contains all levels including the ghost cells
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
     {
-        ex = exner(p[k]);
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                const int ij  = i + j*jj;
-                tl  = thl[ijk] * ex;
-                ql[ij]  = qt[ijk]-qsat(p[k],tl);   // not real ql, just estimate
-            }
-
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                const int ij  = i + j*jj;
-                if (ql[ij] > 0)
-                    ql[ij] = sat_adjust(thl[ijk], qt[ijk], p[k], ex);
-                else
-                    ql[ij] = 0.;
-            }
-
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                const int ij  = i + j*jj;
-                b[ijk] = buoyancy(ex, thl[ijk], qt[ijk], ql[ij], thvref[k]);
-            }
+        const Tile* t = &grid->tiles[n];
+        for (int k=0; k<grid->kcells; k++)
+        {
+            const double ex = exner(p[k]);
+            for (int j=t->jstart; j<t->jend; j++)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    b[ijk] = buoyancy(ex, thl[ijk], qt[ijk], ql[ijk], thvref[k]);
+                }
+        }
     }
 
     grid->boundary_cyclic(b);
 }
 
 // Calculate the maximum in-cloud virtual temperature perturbation (thv - <thv>) with height
-void Thermo_moist::calc_maximum_thv_perturbation_cloud(double* restrict thv_pert, double* restrict thv, double* restrict thl,
-                                                       double* restrict qt, double* restrict ql, double* restrict p, double* restrict thvmean)
+void Thermo_moist::calc_maximum_thv_perturbation_cloud(real* restrict thv_pert, real* restrict thv, real* restrict thl,
+                                                       real* restrict qt, real* restrict ql, real* restrict p, real* restrict thvmean)
 {
     double ex;
     const int jj = grid->icells;
@@ -1903,9 +1522,11 @@ void Thermo_moist::calc_maximum_thv_perturbation_cloud(double* restrict thv_pert
     // Calculate domain averaged virtual temperature
     grid->calc_mean(thvmean, thv, grid->kcells);
 
-    // Calculate maximum in-cloud virtual temperature perturbation per column
-    for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+    // Calculate maximum in-cloud virtual temperature perturbation per column, the threads
+    // share out the j rows so that every column is only updated by a single thread
+    #pragma omp parallel for
+    for (int j=grid->jstart; j<grid->jend; j++)
+        for (int k=grid->kstart; k<grid->kend; k++)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
             {
@@ -1922,56 +1543,72 @@ void Thermo_moist::calc_maximum_thv_perturbation_cloud(double* restrict thv_pert
             }
 }
 
-void Thermo_moist::calc_liquid_water(double* restrict ql, double* restrict thl, double* restrict qt, double* restrict p)
+void Thermo_moist::calc_liquid_water(real* restrict ql, real* restrict thl, real* restrict qt, real* restrict p)
 {
-    double ex;
-
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    // Fill ghost cells with zeros to prevent problems in calculating ql or qlcore masks
-    for (int k=0; k<grid->kstart; k++)
+    // Calculate the ql field at all levels, the ghost cells are needed for the buoyancy. Every row
+    // only writes its own ql, so the threads share out the levels.
+    #pragma omp parallel for
+    for (int k=0; k<grid->kcells; k++)
     {
+        const double ex = exner(p[k]);
         for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                ql[ijk] = 0.;
-            }
+        {
+            const int ijk = grid->istart + j*jj + k*kk;
+            sat_adjust_row(&ql[ijk], &thl[ijk], &qt[ijk], p[k], ex, grid->imax);
+        }
     }
+}
+
+real* Thermo_moist::get_liquid_water_cache()
+{
+    // The cache belongs to one prognostic state, which is identified by the model time and the substep.
+    // Any change of thl or qt within a substep (e.g. a new base state pressure) has to invalidate it explicitly.
+    const unsigned long itime = model->timeloop->get_itime();
+    const int substep = model->timeloop->get_substep();
 
-    for (int k=grid->kend; k<grid->kcells; k++)
+    if (!ql_valid || itime != ql_itime || substep != ql_substep)
     {
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                ql[ijk] = 0.;
-            }
+        calc_liquid_water(qlcache, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+
+        ql_valid   = true;
+        ql_itime   = itime;
+        ql_substep = substep;
     }
 
-    // Calculate the ql field
-    for (int k=grid->kstart; k<grid->kend; k++)
+    return qlcache;
+}
+
+void Thermo_moist::get_liquid_water(real* restrict ql)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    const real* restrict qlc = get_liquid_water_cache();
+
+    // Fill ghost cells with zeros to prevent problems in calculating ql or qlcore masks
+    for (int k=0; k<grid->kcells; k++)
     {
-        ex = exner(p[k]);
+        const real fac = (k >= grid->kstart && k < grid->kend) ? 1. : 0.;
         for (int j=grid->jstart; j<grid->jend; j++)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
             {
                 const int ijk = i + j*jj + k*kk;
-                ql[ijk] = sat_adjust(thl[ijk], qt[ijk], p[k], ex);
+                ql[ijk] = fac*qlc[ijk];
             }
     }
 }
 
-void Thermo_moist::calc_N2(double* restrict N2, double* restrict thl, double* restrict dzi,
-                           double* restrict thvref)
+void Thermo_moist::calc_N2(real* restrict N2, real* restrict thl, real* restrict dzi,
+                           real* restrict thvref)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
@@ -1982,10 +1619,10 @@ void Thermo_moist::calc_N2(double* restrict N2, double* restrict thl, double* re
             }
 }
 
-void Thermo_moist::calc_buoyancy_bot(double* restrict b,      double* restrict bbot,
-                                     double* restrict thl,    double* restrict thlbot,
-                                     double* restrict qt,     double* restrict qtbot,
-                                     double* restrict thvref, double* restrict thvrefh)
+void Thermo_moist::calc_buoyancy_bot(real* restrict b,      real* restrict bbot,
+                                     real* restrict thl,    real* restrict thlbot,
+                                     real* restrict qt,     real* restrict qtbot,
+                                     real* restrict thvref, real* restrict thvrefh)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -2003,8 +1640,8 @@ void Thermo_moist::calc_buoyancy_bot(double* restrict b,      double* restrict b
         }
 }
 
-void Thermo_moist::calc_buoyancy_fluxbot(double* restrict bfluxbot, double* restrict thlbot, double* restrict thlfluxbot, double* restrict qtbot, double* restrict qtfluxbot,
-        double* restrict thvrefh)
+void Thermo_moist::calc_buoyancy_fluxbot(real* restrict bfluxbot, real* restrict thlbot, real* restrict thlfluxbot, real* restrict qtbot, real* restrict qtfluxbot,
+        real* restrict thvrefh)
 {
     const int jj = grid->icells;
     const int kstart = grid->kstart;
@@ -2158,50 +1795,45 @@ void Thermo_moist::init_dump()
     }
 }
 
-void Thermo_moist::calc_buoyancy_tend_4th(double* restrict wt, double* restrict thl,  double* restrict qt,
-                                          double* restrict ph, double* restrict thlh, double* restrict qth,
-                                          double* restrict ql, double* restrict thvrefh)
+void Thermo_moist::calc_buoyancy_tend_4th(real* restrict wt, real* restrict thl,  real* restrict qt,
+                                          real* restrict ph, real* restrict thlh, real* restrict qth,
+                                          real* restrict ql, real* restrict thvrefh)
 {
     const int jj  = grid->icells;
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
 
-    double tl, exnh;
-
-    for (int k=grid->kstart+1; k<grid->kend; k++)
+    // The tiles cover disjoint parts of the 2d buffers, so the threads share out the tiles.
+    #pragma omp parallel for
+    for (int n=0; n<(int)grid->tiles.size(); ++n)
     {
-        exnh = exner(ph[k]);
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk1;
-                const int ij  = i + j*jj;
-                thlh[ij] = interp4(thl[ijk-kk2], thl[ijk-kk1], thl[ijk], thl[ijk+kk1]);
-                qth[ij]  = interp4(qt[ijk-kk2],  qt[ijk-kk1],  qt[ijk],  qt[ijk+kk1]);
-                tl       = thlh[ij] * exnh;
-                // Calculate first estimate of ql using Tl
-                // if ql(Tl)>0, saturation adjustment routine needed
-                ql[ij]  = qth[ij]-qsat(ph[k],tl);
-            }
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ij = i + j*jj;
-                if (ql[ij]>0)   // already doesn't vectorize because of iteration in sat_adjust()
-                    ql[ij] = sat_adjust(thlh[ij], qth[ij], ph[k], exnh);
-                else
-                    ql[ij] = 0.;
-            }
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        const Tile* t = &grid->tiles[n];
+        for (int k=grid->kstart+1; k<grid->kend; k++)
+        {
+            const double exnh = exner(ph[k]);
+            for (int j=t->jstart; j<t->jend; j++)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    const int ij  = i + j*jj;
+                    thlh[ij] = interp4(thl[ijk-kk2], thl[ijk-kk1], thl[ijk], thl[ijk+kk1]);
+                    qth[ij]  = interp4(qt[ijk-kk2],  qt[ijk-kk1],  qt[ijk],  qt[ijk+kk1]);
+                }
+            for (int j=t->jstart; j<t->jend; j++)
             {
-                const int ijk = i + j*jj + k*kk1;
-                const int ij  = i + j*jj;
-                wt[ijk] += buoyancy(exnh, thlh[ij], qth[ij], ql[ij], thvrefh[k]);
+                const int ij = t->istart + j*jj;
+                sat_adjust_row(&ql[ij], &thlh[ij], &qth[ij], ph[k], exnh, t->iend-t->istart);
             }
+            for (int j=t->jstart; j<t->jend; j++)
+                #pragma ivdep
+                for (int i=t->istart; i<t->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    const int ij  = i + j*jj;
+                    wt[ijk] += buoyancy(exnh, thlh[ij], qth[ij], ql[ij], thvrefh[k]);
+                }
+        }
     }
 }
 
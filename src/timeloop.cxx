@@ -60,6 +60,8 @@ Timeloop::Timeloop(Model* modelin, Input* inputin)
     n += inputin->get_item(&rkorder     , "time", "rkorder"     , "", 3               );
     n += inputin->get_item(&outputiter  , "time", "outputiter"  , "", 20              );
     n += inputin->get_item(&iotimeprec  , "time", "iotimeprec"  , "", 0               );
+    n += inputin->get_item(&swrestart   , "time", "swrestart"   , "", "files"         );
+    n += inputin->get_item(&swcompress  , "time", "swcompress"  , "", "0"             );
 
     if (master->mode == "post")
         n += inputin->get_item(&postproctime, "time", "postproctime", "");
@@ -68,6 +70,24 @@ Timeloop::Timeloop(Model* modelin, Input* inputin)
     if (n > 0)
         throw 1;
 
+    if (!(swrestart == "files" || swrestart == "container"))
+    {
+        master->print_error("\"%s\" is an illegal value for swrestart\n", swrestart.c_str());
+        throw 1;
+    }
+
+    if (!(swcompress == "0" || swcompress == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swcompress\n", swcompress.c_str());
+        throw 1;
+    }
+
+    if (swcompress == "1" && swrestart == "container")
+    {
+        master->print_error("swcompress = 1 is not supported in combination with swrestart = container\n");
+        throw 1;
+    }
+
     // 3 and 4 are the only valid values for the rkorder
     if (!(rkorder == 3 || rkorder == 4))
     {
@@ -262,7 +282,7 @@ inline double Timeloop::rk4subdt(const double dt)
     return cB[substep]*dt;
 }
 
-void Timeloop::rk3(double * restrict a, double * restrict at, const double dt)
+void Timeloop::rk3(real * restrict a, real * restrict at, const double dt)
 {
     const double cA [] = {0., -5./9., -153./128.};
     const double cB [] = {1./3., 15./16., 8./15.};
@@ -270,6 +290,7 @@ void Timeloop::rk3(double * restrict a, double * restrict at, const double dt)
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -282,6 +303,7 @@ void Timeloop::rk3(double * restrict a, double * restrict at, const double dt)
     const int substepn = (substep+1) % 3;
 
     // substep 0 resets the tendencies, because cA[0] == 0
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -292,7 +314,7 @@ void Timeloop::rk3(double * restrict a, double * restrict at, const double dt)
             }
 }
 
-void Timeloop::rk4(double * restrict a, double * restrict at, const double dt)
+void Timeloop::rk4(real * restrict a, real * restrict at, const double dt)
 {
     const double cA [] = {
         0.,
@@ -311,6 +333,7 @@ void Timeloop::rk4(double * restrict a, double * restrict at, const double dt)
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -323,6 +346,7 @@ void Timeloop::rk4(double * restrict a, double * restrict at, const double dt)
     const int substepn = (substep+1) % 5;
 
     // substep 0 resets the tendencies, because cA[0] == 0
+    #pragma omp parallel for
     for (int k=grid->kstart; k<grid->kend; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
@@ -353,6 +377,15 @@ bool Timeloop::is_stats_step()
 
 void Timeloop::save(int starttime)
 {
+    save(starttime, itime, idt, iteration);
+}
+
+void Timeloop::save(int starttime, unsigned long itimein, unsigned long idtin, int iterationin)
+{
+    // The restart container stores the time state in its header, it is written by Fields::save.
+    if (swrestart == "container")
+        return;
+
     int nerror = 0;
 
     if (master->mpiid == 0)
@@ -372,9 +405,9 @@ void Timeloop::save(int starttime)
         }
         else
         {
-            fwrite(&itime    , sizeof(unsigned long), 1, pFile);
-            fwrite(&idt      , sizeof(unsigned long), 1, pFile);
-            fwrite(&iteration, sizeof(int), 1, pFile);
+            fwrite(&itimein    , sizeof(unsigned long), 1, pFile);
+            fwrite(&idtin      , sizeof(unsigned long), 1, pFile);
+            fwrite(&iterationin, sizeof(int), 1, pFile);
 
             fclose(pFile);
             master->print_message("OK\n");
@@ -391,6 +424,31 @@ void Timeloop::load(int starttime)
 {
     int nerror = 0;
 
+    // Read the time state from the header of the restart container if it exists.
+    char restartname[256];
+    std::sprintf(restartname, "restart.%07d", starttime);
+    if (grid->has_restart(restartname))
+    {
+        master->print_message("Loading time from \"%s\" ... ", restartname);
+
+        Restart_header header;
+        if (grid->read_restart_header(restartname, header))
+        {
+            master->print_message("FAILED\n");
+            throw 1;
+        }
+        master->print_message("OK\n");
+
+        itime     = header.itime;
+        idt       = header.idt;
+        iteration = header.iteration;
+
+        time = (double)itime / ifactor;
+        dt   = (double)idt   / ifactor;
+
+        return;
+    }
+
     if (master->mpiid == 0)
     {
         char filename[256];